@@ -4,6 +4,8 @@
 #include "query.h"
 #include "reducer.h"
 #include "result_processor.h"
+#include "profile.h"
+#include "slowlog.h"
 #include "expr/expression.h"
 #include "aggregate_plan.h"
 #include "rmutil/rm_assert.h"
@@ -41,15 +43,38 @@ typedef enum {
   QEXEC_F_SENDRAWIDS = 0x2000,
 
   /* Flag for scorer function to create explanation strings */
-  QEXEC_F_SEND_SCOREEXPLAIN = 0x4000
+  QEXEC_F_SEND_SCOREEXPLAIN = 0x4000,
+
+  /* Profile the iterators and result processors of the query. Used by FT.PROFILE */
+  QEXEC_F_PROFILE = 0x8000,
+
+  /* Compute the rows of the next cursor read in the background, after sending a chunk */
+  QEXEC_F_CURSOR_PREFETCH = 0x10000
 
 } QEFlags;
 
 typedef enum {
   /* Received EOF from iterator */
   QEXEC_S_ITERDONE = 0x02,
+
+  /* A chunk of results was sent. Used by cursors */
+  QEXEC_S_CHUNKSENT = 0x04,
 } QEStateFlags;
 
+/** Rows of a PREFETCH cursor, computed on the search pool ahead of its next read */
+typedef struct {
+  /** The rows, and the first of them not sent yet */
+  SearchResult *rows;
+  size_t next;
+  /** The estimated memory of the rows */
+  size_t memory;
+  /** The result of the last call to the pipeline, and its error */
+  int rc;
+  QueryError err;
+  /** The queued computation of the rows, if any */
+  struct CursorPrefetchTask *task;
+} CursorPrefetch;
+
 typedef struct {
   /* plan containing the logical sequence of steps */
   AGGPlan ap;
@@ -73,6 +98,12 @@ typedef struct {
   /** Root iterator. This is owned by the request */
   IndexIterator *rootiter;
 
+  /** The property holding the distance from the center of a NEAREST geo filter, if any */
+  const RLookupKey *geoDistanceKey;
+
+  /** Profiles of the iterators, if the request is profiled. The tree is under this node */
+  ProfileNode *profile;
+
   /** Context, owned by request */
   RedisSearchCtx *sctx;
 
@@ -97,6 +128,12 @@ typedef struct {
   /** Cursor settings */
   unsigned cursorMaxIdle;
   unsigned cursorChunkSize;
+  CursorPrefetch prefetch;
+
+  /** When the current command on the request started, and the time it spent in every stage. The
+   * stages of the pipeline are only timed while the slowlog is enabled */
+  uint64_t startNS;
+  uint64_t stageNS[SLOWLOG_NUM_STAGES];
 } AREQ;
 
 /**
@@ -216,6 +253,9 @@ void Grouper_AddReducer(Grouper *g, Reducer *r, RLookupKey *dst);
 void AREQ_Execute(AREQ *req, RedisModuleCtx *outctx);
 void AREQ_Free(AREQ *req);
 
+/** Cancel the queued prefetch of the request, if any, and free the rows it computed */
+void AREQ_CancelPrefetch(AREQ *req);
+
 /**
  * Start the cursor on the current request
  * @param r the request
@@ -5,6 +5,8 @@
 #include "cursor.h"
 #include "rmutil/util.h"
 #include "score_explain.h"
+#include "commands.h"
+#include "module.h"
 
 typedef enum { COMMAND_AGGREGATE, COMMAND_SEARCH, COMMAND_EXPLAIN } CommandType;
 static void runCursor(RedisModuleCtx *outputCtx, Cursor *cursor, size_t num);
@@ -144,6 +146,172 @@ static size_t serializeResult(AREQ *req, RedisModuleCtx *outctx, const SearchRes
   return count;
 }
 
+/** Serialize a result, adding the time it takes to the reply stage if the stages are timed */
+static size_t serializeResultTimed(AREQ *req, RedisModuleCtx *outctx, const SearchResult *r,
+                                   const cachedVars *cv) {
+  if (!req->qiter.stageNS) {
+    return serializeResult(req, outctx, r, cv);
+  }
+  uint64_t start = Slowlog_NowNS();
+  size_t count = serializeResult(req, outctx, r, cv);
+  req->stageNS[SLOWLOG_STAGE_REPLY] += Slowlog_NowNS() - start;
+  return count;
+}
+
+/**
+ * Log the chunk just sent to the slowlog if it was slow, and reset the stage times for the next
+ * chunk. The pipeline time not spent in the other stages is counted as iteration time
+ */
+static void logSlowChunk(AREQ *req, uint64_t chunkNS) {
+  uint64_t *stageNS = req->stageNS;
+  uint64_t other =
+      stageNS[SLOWLOG_STAGE_SORT] + stageNS[SLOWLOG_STAGE_LOAD] + stageNS[SLOWLOG_STAGE_REPLY];
+  stageNS[SLOWLOG_STAGE_ITERATE] = chunkNS > other ? chunkNS - other : 0;
+
+  const char *command = RS_CURSOR_CMD;
+  if (!(req->stateflags & QEXEC_S_CHUNKSENT)) {
+    command = req->reqflags & QEXEC_F_IS_SEARCH ? RS_SEARCH_CMD : RS_AGGREGATE_CMD;
+  }
+  SlowlogQuery q = {.command = command,
+                    .index = req->sctx->spec->name,
+                    .args = (const char **)req->args,
+                    .nargs = req->nargs,
+                    .numResults = req->qiter.totalResults,
+                    .durationNS = Slowlog_NowNS() - req->startNS};
+  memcpy(q.stageNS, stageNS, sizeof(q.stageNS));
+  Slowlog_Add(&q);
+  memset(stageNS, 0, sizeof(req->stageNS));
+}
+
+/******************************************************************************
+ * Cursor prefetching
+ ******************************************************************************/
+
+typedef struct CursorPrefetchTask {
+  // The request to compute the rows of, or NULL if the prefetch was cancelled before it ran
+  AREQ *req;
+} CursorPrefetchTask;
+
+/** An estimate of the memory taken by a row */
+static size_t resultMemory(const SearchResult *r) {
+  size_t sz = sizeof(*r);
+  const RLookupRow *row = &r->rowdata;
+  for (size_t ii = 0; row->dyn && ii < array_len(row->dyn); ++ii) {
+    const RSValue *v = row->dyn[ii];
+    if (!v) {
+      continue;
+    }
+    sz += sizeof(*v);
+    v = RSValue_Dereference(v);
+    if (RSValue_IsString(v)) {
+      size_t len = 0;
+      RSValue_StringPtrLen(v, &len);
+      sz += len;
+    }
+  }
+  return sz;
+}
+
+static size_t prefetchedRows(const CursorPrefetch *pf) {
+  return pf->rows ? array_len(pf->rows) - pf->next : 0;
+}
+
+/** Compute rows until the next read has a full chunk of them, or they take too much memory */
+static void fillPrefetch(AREQ *req) {
+  CursorPrefetch *pf = &req->prefetch;
+  ResultProcessor *rp = req->qiter.endProc;
+  if (!pf->rows) {
+    pf->rows = array_new(SearchResult, 16);
+  }
+  while (pf->rc == RS_RESULT_OK && prefetchedRows(pf) < req->cursorChunkSize &&
+         pf->memory < RSGlobalConfig.cursorPrefetchMaxMemory) {
+    SearchResult r = {0};
+    pf->rc = rp->Next(rp, &r);
+    if (pf->rc != RS_RESULT_OK) {
+      SearchResult_Destroy(&r);
+      break;
+    }
+    pf->memory += resultMemory(&r);
+    pf->rows = array_append(pf->rows, r);
+  }
+}
+
+/**
+ * Runs on the search pool. The GIL is held for the whole chunk, so the main thread only ever sees
+ * the prefetch queued or done; a read or a free of the cursor in between cancels it
+ */
+static void prefetchRows(void *p) {
+  CursorPrefetchTask *task = p;
+  RedisModule_ThreadSafeContextLock(RSDummyContext);
+  AREQ *req = task->req;
+  if (req) {
+    req->prefetch.task = NULL;
+    req->qiter.err = &req->prefetch.err;
+    ConcurrentSearchCtx_ReopenKeys(&req->conc);
+    fillPrefetch(req);
+  }
+  RedisModule_ThreadSafeContextUnlock(RSDummyContext);
+  rm_free(task);
+}
+
+static void schedulePrefetch(AREQ *req) {
+  CursorPrefetch *pf = &req->prefetch;
+  if (pf->task || pf->rc != RS_RESULT_OK || prefetchedRows(pf) >= req->cursorChunkSize) {
+    return;
+  }
+  ConcurrentSearch_SearchPoolStart();
+  CursorPrefetchTask *task = rm_malloc(sizeof(*task));
+  task->req = req;
+  pf->task = task;
+  ConcurrentSearch_ThreadPoolRun(prefetchRows, task, CONCURRENT_POOL_SEARCH);
+}
+
+static void detachPrefetch(CursorPrefetch *pf) {
+  if (pf->task) {
+    pf->task->req = NULL;
+    pf->task = NULL;
+  }
+}
+
+void AREQ_CancelPrefetch(AREQ *req) {
+  CursorPrefetch *pf = &req->prefetch;
+  detachPrefetch(pf);
+  for (size_t ii = pf->next; pf->rows && ii < array_len(pf->rows); ++ii) {
+    SearchResult_Destroy(&pf->rows[ii]);
+  }
+  if (pf->rows) {
+    array_free(pf->rows);
+  }
+  QueryError_ClearError(&pf->err);
+  memset(pf, 0, sizeof(*pf));
+}
+
+/** Get the next row of the request: a prefetched one if there is any, or else from the pipeline */
+static int nextResult(AREQ *req, SearchResult *r) {
+  CursorPrefetch *pf = &req->prefetch;
+  if (prefetchedRows(pf)) {
+    SearchResult_Destroy(r);
+    *r = pf->rows[pf->next++];
+    pf->memory -= resultMemory(r);
+    if (pf->next == array_len(pf->rows)) {
+      array_clear(pf->rows);
+      pf->next = 0;
+      pf->memory = 0;
+    }
+    return RS_RESULT_OK;
+  }
+  if (pf->rc != RS_RESULT_OK) {
+    if (pf->rc == RS_RESULT_ERROR) {
+      QueryError_ClearError(req->qiter.err);
+      *req->qiter.err = pf->err;
+      memset(&pf->err, 0, sizeof(pf->err));
+    }
+    return pf->rc;
+  }
+  ResultProcessor *rp = req->qiter.endProc;
+  return rp->Next(rp, r);
+}
+
 /**
  * Sends a chunk of <n> rows, optionally also sending the preamble
  */
@@ -152,7 +320,7 @@ static int sendChunk(AREQ *req, RedisModuleCtx *outctx, size_t limit) {
   size_t nelem = 0;
   SearchResult r = {0};
   int rc = RS_RESULT_EOF;
-  ResultProcessor *rp = req->qiter.endProc;
+  uint64_t chunkStart = req->qiter.stageNS ? Slowlog_NowNS() : 0;
 
   cachedVars cv = {0};
   cv.lastLk = AGPLN_GetLookup(&req->ap, NULL, AGPLN_GETLOOKUP_LAST);
@@ -160,11 +328,11 @@ static int sendChunk(AREQ *req, RedisModuleCtx *outctx, size_t limit) {
 
   RedisModule_ReplyWithArray(outctx, REDISMODULE_POSTPONED_ARRAY_LEN);
 
-  rc = rp->Next(rp, &r);
+  rc = nextResult(req, &r);
   RedisModule_ReplyWithLongLong(outctx, req->qiter.totalResults);
   nelem++;
   if (rc == RS_RESULT_OK && nrows++ < limit && !(req->reqflags & QEXEC_F_NOROWS)) {
-    nelem += serializeResult(req, outctx, &r, &cv);
+    nelem += serializeResultTimed(req, outctx, &r, &cv);
   } else if (rc == RS_RESULT_ERROR) {
     RedisModule_ReplyWithArray(outctx, 1);
     QueryError_ReplyAndClear(outctx, req->qiter.err);
@@ -176,9 +344,9 @@ static int sendChunk(AREQ *req, RedisModuleCtx *outctx, size_t limit) {
     goto done;
   }
 
-  while (nrows++ < limit && (rc = rp->Next(rp, &r)) == RS_RESULT_OK) {
+  while (nrows++ < limit && (rc = nextResult(req, &r)) == RS_RESULT_OK) {
     if (!(req->reqflags & QEXEC_F_NOROWS)) {
-      nelem += serializeResult(req, outctx, &r, &cv);
+      nelem += serializeResultTimed(req, outctx, &r, &cv);
     }
     // Serialize it as a search result
     SearchResult_Clear(&r);
@@ -189,6 +357,10 @@ done:
   if (rc != RS_RESULT_OK) {
     req->stateflags |= QEXEC_S_ITERDONE;
   }
+  if (req->qiter.stageNS) {
+    logSlowChunk(req, Slowlog_NowNS() - chunkStart);
+  }
+  req->stateflags |= QEXEC_S_CHUNKSENT;
   // Reset the total results length:
   req->qiter.totalResults = 0;
   RedisModule_ReplySetArrayLength(outctx, nelem);
@@ -201,7 +373,7 @@ void AREQ_Execute(AREQ *req, RedisModuleCtx *outctx) {
 }
 
 static int buildRequest(RedisModuleCtx *ctx, RedisModuleString **argv, int argc, int type,
-                        QueryError *status, AREQ **r) {
+                        uint32_t reqflags, QueryError *status, AREQ **r) {
 
   int rc = REDISMODULE_ERR;
   const char *indexname = RedisModule_StringPtrLen(argv[1], NULL);
@@ -209,6 +381,8 @@ static int buildRequest(RedisModuleCtx *ctx, RedisModuleString **argv, int argc,
   RedisSearchCtx *sctx = NULL;
   RedisModuleCtx *thctx = NULL;
 
+  (*r)->startNS = Slowlog_NowNS();
+  (*r)->reqflags |= reqflags;
   if (type == COMMAND_SEARCH) {
     (*r)->reqflags |= QEXEC_F_IS_SEARCH;
   }
@@ -240,6 +414,9 @@ static int buildRequest(RedisModuleCtx *ctx, RedisModuleString **argv, int argc,
   }
 
   rc = AREQ_BuildPipeline(*r, 0, status);
+  if (rc == REDISMODULE_OK && Slowlog_IsEnabled()) {
+    (*r)->qiter.stageNS = (*r)->stageNS;
+  }
 
 done:
   if (rc != REDISMODULE_OK && *r) {
@@ -259,16 +436,17 @@ static int execCommandCommon(RedisModuleCtx *ctx, RedisModuleString **argv, int
     return RedisModule_WrongArity(ctx);
   }
 
-  const char *indexname = RedisModule_StringPtrLen(argv[1], NULL);
+  uint64_t start = LatencyStats_Now();
   AREQ *r = NULL;
   QueryError status = {0};
 
-  if (buildRequest(ctx, argv, argc, type, &status, &r) != REDISMODULE_OK) {
+  if (buildRequest(ctx, argv, argc, type, 0, &status, &r) != REDISMODULE_OK) {
     goto error;
   }
 
+  IndexSpec *sp = r->sctx->spec;
   if (r->reqflags & QEXEC_F_IS_CURSOR) {
-    int rc = AREQ_StartCursor(r, ctx, r->sctx->spec->name, &status);
+    int rc = AREQ_StartCursor(r, ctx, sp->name, &status);
     if (rc != REDISMODULE_OK) {
       goto error;
     }
@@ -276,6 +454,8 @@ static int execCommandCommon(RedisModuleCtx *ctx, RedisModuleString **argv, int
     // Execute() will call free when appropriate.
     AREQ_Execute(r, ctx);
   }
+  LatencyStats_RecordSince(&sp->latency, type == COMMAND_SEARCH ? LATENCY_SEARCH : LATENCY_AGGREGATE,
+                           start);
   return REDISMODULE_OK;
 
 error:
@@ -292,10 +472,74 @@ int RSSearchCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
   return execCommandCommon(ctx, argv, argc, COMMAND_SEARCH);
 }
 
+/**
+ * FT.PROFILE {index} SEARCH|AGGREGATE {query} [args...]
+ *
+ * Runs the query with its iterators and result processors profiled, and replies with the reply of
+ * the query followed by its profile. The profiled times include the time of the children of each
+ * iterator, and of the processors upstream of each processor.
+ */
+int RSProfileCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
+  if (argc < 4) {
+    return RedisModule_WrongArity(ctx);
+  }
+
+  CommandType type;
+  const char *typeStr = RedisModule_StringPtrLen(argv[2], NULL);
+  if (!strcasecmp(typeStr, "SEARCH")) {
+    type = COMMAND_SEARCH;
+  } else if (!strcasecmp(typeStr, "AGGREGATE")) {
+    type = COMMAND_AGGREGATE;
+  } else {
+    return RedisModule_ReplyWithError(ctx, "Unknown profiled command. Use SEARCH or AGGREGATE");
+  }
+
+  ProfileClock clk;
+  ProfileClock_Start(&clk);
+
+  // Drop the command type, so the arguments are laid out like those of the profiled command
+  RedisModuleString *qargv[argc - 1];
+  qargv[0] = argv[0];
+  qargv[1] = argv[1];
+  memcpy(qargv + 2, argv + 3, (argc - 3) * sizeof(*argv));
+
+  AREQ *r = NULL;
+  QueryError status = {0};
+  if (buildRequest(ctx, qargv, argc - 1, type, QEXEC_F_PROFILE, &status, &r) != REDISMODULE_OK) {
+    goto error;
+  }
+  if (r->reqflags & QEXEC_F_IS_CURSOR) {
+    QueryError_SetError(&status, QUERY_EINVAL, "Cursors cannot be profiled");
+    goto error;
+  }
+
+  RedisModule_ReplyWithArray(ctx, 2);
+  sendChunk(r, ctx, -1);
+  ProfileClock_Stop(&clk, r->profile);
+
+  RedisModule_ReplyWithArray(ctx, 8);
+  RedisModule_ReplyWithSimpleString(ctx, "Total time");
+  RedisModule_ReplyWithDouble(ctx, (double)r->profile->wallNS / 1000000);
+  RedisModule_ReplyWithSimpleString(ctx, "Total CPU time");
+  RedisModule_ReplyWithDouble(ctx, (double)r->profile->cpuNS / 1000000);
+  RedisModule_ReplyWithSimpleString(ctx, "Iterators profile");
+  Profile_ReplyIterators(ctx, r->profile);
+  RedisModule_ReplyWithSimpleString(ctx, "Result processors profile");
+  Profile_ReplyPipeline(ctx, &r->qiter);
+  AREQ_Free(r);
+  return REDISMODULE_OK;
+
+error:
+  if (r) {
+    AREQ_Free(r);
+  }
+  return QueryError_ReplyAndClear(ctx, &status);
+}
+
 char *RS_GetExplainOutput(RedisModuleCtx *ctx, RedisModuleString **argv, int argc,
                           QueryError *status) {
   AREQ *r = NULL;
-  if (buildRequest(ctx, argv, argc, COMMAND_EXPLAIN, status, &r) != REDISMODULE_OK) {
+  if (buildRequest(ctx, argv, argc, COMMAND_EXPLAIN, 0, status, &r) != REDISMODULE_OK) {
     return NULL;
   }
   char *ret = QAST_DumpExplain(&r->ast, r->sctx->spec);
@@ -337,6 +581,9 @@ static void runCursor(RedisModuleCtx *outputCtx, Cursor *cursor, size_t num) {
   if (req->stateflags & QEXEC_S_ITERDONE) {
     goto delcursor;
   } else {
+    if (req->reqflags & QEXEC_F_CURSOR_PREFETCH) {
+      schedulePrefetch(req);
+    }
     // Update the idle timeout
     Cursor_Pause(cursor);
     return;
@@ -361,11 +608,17 @@ static void cursorRead(RedisModuleCtx *ctx, uint64_t cid, size_t count) {
     RedisModule_ReplyWithError(ctx, "Cursor not found");
     return;
   }
+  uint64_t start = LatencyStats_Now();
   QueryError status = {0};
   AREQ *req = cursor->execState;
+  req->startNS = Slowlog_NowNS();
   req->qiter.err = &status;
+  // A prefetch which did not run yet is not waited for: this read computes its rows
+  detachPrefetch(&req->prefetch);
   ConcurrentSearchCtx_ReopenKeys(&req->conc);
+  IndexSpec *sp = req->sctx->spec;
   runCursor(ctx, cursor, count);
+  LatencyStats_RecordSince(&sp->latency, LATENCY_CURSOR_READ, start);
 }
 
 int RSCursorCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
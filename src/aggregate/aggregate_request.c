@@ -96,6 +96,7 @@ static int parseCursorSettings(AREQ *req, ArgsCursor *ac, QueryError *status) {
                         .type = AC_ARGTYPE_UINT,
                         .target = &req->cursorChunkSize,
                         .intflags = AC_F_GE1},
+                       {AC_MKBITFLAG("PREFETCH", &req->reqflags, QEXEC_F_CURSOR_PREFETCH)},
                        {NULL}};
 
   int rv;
@@ -729,6 +730,7 @@ int AREQ_ApplyContext(AREQ *req, RedisSearchCtx *sctx, QueryError *status) {
 
   QueryAST *ast = &req->ast;
 
+  uint64_t t0 = Slowlog_NowNS();
   int rv = QAST_Parse(ast, sctx, &req->searchopts, req->query, strlen(req->query), status);
   if (rv != REDISMODULE_OK) {
     return REDISMODULE_ERR;
@@ -736,16 +738,26 @@ int AREQ_ApplyContext(AREQ *req, RedisSearchCtx *sctx, QueryError *status) {
 
   applyGlobalFilters(opts, ast, sctx);
 
+  uint64_t t1 = Slowlog_NowNS();
   if (!(opts->flags & Search_Verbatim)) {
     if (QAST_Expand(ast, opts->expanderName, opts, sctx, status) != REDISMODULE_OK) {
       return REDISMODULE_ERR;
     }
   }
 
+  uint64_t t2 = Slowlog_NowNS();
   ConcurrentSearchCtx_Init(sctx->redisCtx, &req->conc);
-  req->rootiter = QAST_Iterate(ast, opts, sctx, &req->conc);
+  if (req->reqflags & QEXEC_F_PROFILE) {
+    req->profile = NewProfileNode("ROOT", NULL, 0);
+    req->rootiter = QAST_IterateProfiled(ast, opts, sctx, &req->conc, req->profile);
+  } else {
+    req->rootiter = QAST_Iterate(ast, opts, sctx, &req->conc);
+  }
   RS_LOG_ASSERT(req->rootiter, "QAST_Iterate failed");
 
+  req->stageNS[SLOWLOG_STAGE_PARSE] += t1 - t0;
+  req->stageNS[SLOWLOG_STAGE_EXPAND] += t2 - t1;
+  req->stageNS[SLOWLOG_STAGE_ITERATORS] += Slowlog_NowNS() - t2;
   return REDISMODULE_OK;
 }
 
@@ -873,9 +885,14 @@ static ResultProcessor *getArrangeRP(AREQ *req, AGGPlan *pln, const PLN_BaseStep
     up = pushRP(req, rp, up);
   }
 
-  // No sort? then it must be sort by score, which is the default.
+  // No sort? then it must be sort by score, which is the default, or by the distance of a NEAREST
+  // geo filter
   if (rp == NULL && (req->reqflags & QEXEC_F_IS_SEARCH)) {
-    rp = RPSorter_NewByScore(limit);
+    if (req->geoDistanceKey) {
+      rp = RPSorter_NewByFields(limit, &req->geoDistanceKey, 1, SORTASCMAP_INIT);
+    } else {
+      rp = RPSorter_NewByScore(limit);
+    }
     up = pushRP(req, rp, up);
   }
 
@@ -950,6 +967,19 @@ static void buildImplicitPipeline(AREQ *req, QueryError *Status) {
     rp = getScorerRP(req);
     PUSH_RP();
   }
+
+  /** Keep the results nearest to the center of a NEAREST geo filter, out of the ones matching the
+   * whole query. Their distance is exposed as a property, which the results are ordered by unless
+   * the query sorts them otherwise */
+  const GeoFilter *gf = req->searchopts.legacy.gf;
+  if (gf && gf->nearest) {
+    req->geoDistanceKey =
+        RLookup_GetKey(first, GEO_DISTANCE_FIELD, RLOOKUP_F_OCREAT | RLOOKUP_F_NOINCREF);
+    rp = RPGeoDistance_New(gf, req->geoDistanceKey);
+    PUSH_RP();
+    rp = RPSorter_NewByFields(gf->nearest, &req->geoDistanceKey, 1, SORTASCMAP_INIT);
+    PUSH_RP();
+  }
 }
 
 /**
@@ -1128,12 +1158,18 @@ int AREQ_BuildPipeline(AREQ *req, int options, QueryError *status) {
     }
   }
 
+  if (req->reqflags & QEXEC_F_PROFILE) {
+    Profile_WrapPipeline(&req->qiter);
+  }
+
   return REDISMODULE_OK;
 error:
   return REDISMODULE_ERR;
 }
 
 void AREQ_Free(AREQ *req) {
+  // The buffered rows reference the pipeline
+  AREQ_CancelPrefetch(req);
   // First, free the result processors
   ResultProcessor *rp = req->qiter.endProc;
   while (rp) {
@@ -1145,6 +1181,10 @@ void AREQ_Free(AREQ *req) {
     req->rootiter->Free(req->rootiter);
     req->rootiter = NULL;
   }
+  if (req->profile) {
+    ProfileNode_Free(req->profile);
+    req->profile = NULL;
+  }
 
   // Go through each of the steps and free it..
   AGPLN_FreeSteps(&req->ap);
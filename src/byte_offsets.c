@@ -115,4 +115,18 @@ uint32_t RSByteOffsetIterator_Next(RSByteOffsetIterator *iter) {
 
   iter->lastValue = ReadVarint(&iter->rdr) + iter->lastValue;
   return iter->lastValue;
-}
\ No newline at end of file
+}
+
+uint32_t RSByteOffsetIterator_SkipTo(RSByteOffsetIterator *iter, uint32_t pos) {
+  if (pos > iter->endPos) {
+    return RSBYTEOFFSET_EOF;
+  }
+  while (iter->curPos < pos) {
+    if (BufferReader_AtEnd(&iter->rdr)) {
+      return RSBYTEOFFSET_EOF;
+    }
+    iter->lastValue = ReadVarint(&iter->rdr) + iter->lastValue;
+    iter->curPos++;
+  }
+  return iter->lastValue;
+}
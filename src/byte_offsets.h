@@ -5,6 +5,10 @@
 #include "varint.h"
 #include "rmalloc.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef struct __attribute__((packed)) RSByteOffsetMap {
   // ID this belongs to.
   uint16_t fieldId;
@@ -86,4 +90,14 @@ int RSByteOffset_Iterate(const RSByteOffsets *offsets, uint32_t fieldId,
  */
 uint32_t RSByteOffsetIterator_Next(RSByteOffsetIterator *iter);
 
+/**
+ * Advances the iterator to the given position (which may be the current one), and
+ * returns its byte offset. Returns RSBYTEOFFSET_EOF if the position is past the
+ * end of the field
+ */
+uint32_t RSByteOffsetIterator_SkipTo(RSByteOffsetIterator *iter, uint32_t pos);
+
+#ifdef __cplusplus
+}
+#endif
 #endif
\ No newline at end of file
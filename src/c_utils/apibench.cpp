@@ -26,7 +26,9 @@ static int my_OnLoad(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
 }
 }
 
-int main(int, char **) {
+int main(int argc, char **argv) {
+  // with "bulk", documents are added through a bulk loader
+  bool bulk = argc > 1 && !strcmp(argv[1], "bulk");
   const char *arguments[] = {"SAFEMODE", "NOGC"};
   RMCK_Bootstrap(my_OnLoad, arguments, 2);
   RediSearch_Initialize();
@@ -37,17 +39,30 @@ int main(int, char **) {
 
   RediSearch_CreateField(idx, "f1", RSFLDTYPE_FULLTEXT, RSFLDOPT_NONE);
   // Ok so far..
+  auto loadBegin = std::chrono::system_clock::now();
+  RSBulkLoader *bl = bulk ? RediSearch_BeginBulkLoad(idx) : NULL;
   for (size_t ii = 0; ii < NUM_DOCS; ++ii) {
     auto d = RediSearch_CreateDocument(&ii, sizeof ii, 1.0, NULL);
     RediSearch_DocumentAddFieldCString(d, "f1", "hello", RSFLDTYPE_DEFAULT);
-    RediSearch_SpecAddDocument(idx, d);
+    if (bl) {
+      RediSearch_BulkAdd(bl, d, REDISEARCH_ADD_REPLACE, NULL);
+    } else {
+      RediSearch_SpecAddDocument(idx, d);
+    }
 
     if ((ii + 1) % 10000 == 0) {
       printf("\r%lu/%lu done        ", ii + 1, NUM_DOCS);
       fflush(stdout);
     }
   }
+  if (bl) {
+    RediSearch_EndBulkLoad(bl, NULL);
+  }
   printf("\n");
+  printf("loaded in %llums\n",
+         (unsigned long long)std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now() - loadBegin)
+             .count());
 
   // so far so good?
   // now, execute the query
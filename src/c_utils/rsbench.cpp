@@ -0,0 +1,554 @@
+/**
+ * rsbench - reproducible end-to-end benchmarks of the module, run against the redis mock.
+ *
+ * A synthetic corpus is generated from a seed: the words of the text fields follow a Zipfian
+ * distribution over a generated vocabulary, and every document also has a numeric, a tag and a geo
+ * field. Every document is a pure function of the seed, its id and its version, so two runs with
+ * the same arguments index and query exactly the same data.
+ *
+ * The workloads run in the order they are given, each on the index left by the previous ones, and
+ * the results are written as JSON: the throughput, the latency percentiles and the RSS of the
+ * process after every workload. Queries run through the same request pipeline as FT.SEARCH and
+ * FT.AGGREGATE, without the reply serialization.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <redisearch.h>
+#include <module.h>
+#include <version.h>
+#include <redisearch_api.h>
+#include <spec.h>
+#include <config.h>
+#include <fork_gc.h>
+#include <search_ctx.h>
+#include <aggregate/aggregate.h>
+#include <util/histogram.h>
+#include <cpptests/redismock/redismock.h>
+#include <cpptests/redismock/util.h>
+
+REDISEARCH_API_INIT_SYMBOLS();
+
+extern "C" {
+
+static int my_OnLoad(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
+
+  if (RedisModule_Init(ctx, "ft", REDISEARCH_MODULE_VERSION, REDISMODULE_APIVER_1) ==
+      REDISMODULE_ERR)
+    return REDISMODULE_ERR;
+  return RediSearch_InitModuleInternal(ctx, argv, argc);
+}
+}
+
+#define NUM_TAGS 200
+// The documents are spread around this point
+#define GEO_LON -73.98
+#define GEO_LAT 40.75
+#define PRICE_MAX 100000
+
+struct Options {
+  size_t numDocs = 100000;
+  size_t numQueries = 1000;
+  size_t numUpdates = 20000;
+  size_t gcCycles = 5;
+  size_t vocabulary = 50000;
+  size_t bodyWords = 50;
+  double zipf = 1.0;
+  // the fraction of the documents deleted and re-added between GC cycles
+  double churn = 0.05;
+  uint64_t seed = 42;
+  const char *output = NULL;
+  std::vector<std::string> workloads;
+};
+
+static const char *defaultWorkloads[] = {"index",   "term",      "phrase", "prefix", "fuzzy",
+                                         "numeric", "tag",       "geo",    "aggregate",
+                                         "update",  "gc"};
+
+/******************************************************************************************
+ * Corpus
+ ******************************************************************************************/
+
+// splitmix64, so that every document can seed its own generator
+static uint64_t mix(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+class Random {
+  uint64_t state;
+
+ public:
+  explicit Random(uint64_t seed) : state(seed) {
+  }
+  uint64_t next() {
+    return state = mix(state);
+  }
+  // uniform in [0, 1)
+  double uniform() {
+    return (next() >> 11) * (1.0 / (1ULL << 53));
+  }
+  size_t below(size_t n) {
+    return next() % n;
+  }
+};
+
+class Zipf {
+  std::vector<double> cdf;
+
+ public:
+  Zipf(size_t n, double s) : cdf(n) {
+    double sum = 0;
+    for (size_t i = 0; i < n; i++) {
+      sum += 1 / pow(i + 1, s);
+      cdf[i] = sum;
+    }
+    for (auto &c : cdf) {
+      c /= sum;
+    }
+  }
+  size_t sample(Random &rnd) const {
+    size_t i = std::lower_bound(cdf.begin(), cdf.end(), rnd.uniform()) - cdf.begin();
+    return std::min(i, cdf.size() - 1);
+  }
+};
+
+class Corpus {
+  const Options &opts;
+  std::vector<std::string> words;
+  Zipf wordDist;
+  Zipf tagDist;
+
+  // Pronounceable words of 2 syllables and up, so the stemmer and the fuzzy matcher see
+  // something close to text
+  static std::string makeWord(size_t n) {
+    static const char *syllables[] = {"ba", "ce", "di", "fo", "gu", "ha", "je", "ki", "lo",
+                                      "mu", "na", "pe", "qui", "ro", "su", "ta", "ve", "wi",
+                                      "xo", "zu", "bra", "cle", "dri", "flo", "gru", "pla",
+                                      "sme", "tri", "sto", "vul"};
+    const size_t ns = sizeof(syllables) / sizeof(*syllables);
+    std::string w = syllables[n % ns];
+    n /= ns;
+    do {
+      w += syllables[n % ns];
+      n /= ns;
+    } while (n);
+    return w;
+  }
+
+ public:
+  explicit Corpus(const Options &o)
+      : opts(o), wordDist(o.vocabulary, o.zipf), tagDist(NUM_TAGS, o.zipf) {
+    for (size_t i = 0; i < opts.vocabulary; i++) {
+      words.push_back(makeWord(i));
+    }
+  }
+
+  const std::string &randomWord(Random &rnd) const {
+    return words[wordDist.sample(rnd)];
+  }
+
+  std::string randomTag(Random &rnd) const {
+    return "tag" + std::to_string(tagDist.sample(rnd));
+  }
+
+  struct Doc {
+    std::string key;
+    std::string title;
+    std::string body;
+    std::string tags;
+    std::string loc;
+    double price;
+  };
+
+  Doc generate(size_t id, size_t version) const {
+    Random rnd(mix(opts.seed ^ mix(id * 1000003 + version)));
+    Doc d;
+    d.key = "doc" + std::to_string(id);
+    for (size_t i = 0; i < 5; i++) {
+      d.title += (i ? " " : "") + randomWord(rnd);
+    }
+    for (size_t i = 0; i < opts.bodyWords; i++) {
+      d.body += (i ? " " : "") + randomWord(rnd);
+    }
+    size_t ntags = 1 + rnd.below(3);
+    for (size_t i = 0; i < ntags; i++) {
+      d.tags += (i ? "," : "") + randomTag(rnd);
+    }
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.6f,%.6f", GEO_LON + rnd.uniform() - 0.5,
+             GEO_LAT + rnd.uniform() - 0.5);
+    d.loc = buf;
+    d.price = rnd.below(PRICE_MAX);
+    return d;
+  }
+};
+
+/******************************************************************************************
+ * Measurements
+ ******************************************************************************************/
+
+static uint64_t nowNS() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static size_t currentRSS() {
+  FILE *fp = fopen("/proc/self/statm", "r");
+  long pages = 0;
+  if (fp) {
+    long size;
+    if (fscanf(fp, "%ld %ld", &size, &pages) != 2) {
+      pages = 0;
+    }
+    fclose(fp);
+  }
+  return pages * sysconf(_SC_PAGESIZE);
+}
+
+static size_t peakRSS() {
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return ru.ru_maxrss * 1024;
+}
+
+struct WorkloadResult {
+  std::string name;
+  Histogram latency;
+  uint64_t totalNS = 0;
+  // results of queries, or bytes collected by the GC
+  size_t items = 0;
+  size_t rss = 0;
+
+  explicit WorkloadResult(const std::string &n) : name(n) {
+    memset(&latency, 0, sizeof(latency));
+  }
+
+  template <typename F>
+  void run(F op) {
+    uint64_t start = nowNS();
+    items += op();
+    uint64_t elapsed = nowNS() - start;
+    Histogram_Record(&latency, elapsed);
+    totalNS += elapsed;
+  }
+};
+
+/******************************************************************************************
+ * Workloads
+ ******************************************************************************************/
+
+class Bench {
+  const Options &opts;
+  const Corpus &corpus;
+  RedisModuleCtx *ctx;
+  IndexSpec *sp;
+  Random rnd;
+  // the current version of every document, bumped when it is updated
+  std::vector<size_t> versions;
+
+  void addDocument(size_t id) {
+    Corpus::Doc d = corpus.generate(id, versions[id]);
+    RSDoc *doc = RediSearch_CreateDocument(d.key.c_str(), d.key.size(), 1.0, NULL);
+    RediSearch_DocumentAddFieldCString(doc, "title", d.title.c_str(), RSFLDTYPE_DEFAULT);
+    RediSearch_DocumentAddFieldCString(doc, "body", d.body.c_str(), RSFLDTYPE_DEFAULT);
+    RediSearch_DocumentAddFieldCString(doc, "tags", d.tags.c_str(), RSFLDTYPE_DEFAULT);
+    RediSearch_DocumentAddFieldCString(doc, "loc", d.loc.c_str(), RSFLDTYPE_DEFAULT);
+    RediSearch_DocumentAddFieldNumber(doc, "price", d.price, RSFLDTYPE_DEFAULT);
+    RediSearch_SpecAddDocument(sp, doc);
+  }
+
+  /* Run a request through the pipeline of FT.SEARCH or FT.AGGREGATE, returning the number of
+   * results it produced */
+  size_t execute(bool search, const std::vector<std::string> &args) {
+    std::vector<const char *> cargs;
+    for (auto &a : args) {
+      cargs.push_back(a.c_str());
+    }
+    RMCK::ArgvList argv(ctx, &cargs[0], cargs.size());
+    QueryError status = {QueryErrorCode(0)};
+    AREQ *r = AREQ_New();
+    if (search) {
+      r->reqflags |= QEXEC_F_IS_SEARCH;
+    }
+    RedisSearchCtx sctxStatic = SEARCH_CTX_STATIC(ctx, sp);
+    RedisSearchCtx *sctx = (RedisSearchCtx *)rm_malloc(sizeof(*sctx));
+    *sctx = sctxStatic;
+
+    size_t n = 0;
+    if (AREQ_Compile(r, argv, argv.size(), &status) != REDISMODULE_OK ||
+        AREQ_ApplyContext(r, sctx, &status) != REDISMODULE_OK ||
+        AREQ_BuildPipeline(r, 0, &status) != REDISMODULE_OK) {
+      fprintf(stderr, "query '%s' failed: %s\n", cargs[0], QueryError_GetError(&status));
+      exit(1);
+    }
+    ResultProcessor *rp = AREQ_RP(r);
+    SearchResult res = {0};
+    while (rp->Next(rp, &res) == RS_RESULT_OK) {
+      n++;
+      SearchResult_Clear(&res);
+    }
+    SearchResult_Destroy(&res);
+    AREQ_Free(r);
+    QueryError_ClearError(&status);
+    return n;
+  }
+
+  size_t search(const std::string &query) {
+    return execute(true, {query, "NOCONTENT", "LIMIT", "0", "10"});
+  }
+
+  std::string makeQuery(const std::string &workload) {
+    char buf[256];
+    if (workload == "term") {
+      return corpus.randomWord(rnd);
+    } else if (workload == "phrase") {
+      // two adjacent words of a document, so that the phrase matches
+      Corpus::Doc d = corpus.generate(rnd.below(opts.numDocs), 0);
+      size_t pos = d.body.find(' ', rnd.below(d.body.size() / 2));
+      size_t end = d.body.find(' ', d.body.find(' ', pos + 1) + 1);
+      return "\"" + d.body.substr(pos + 1, end - pos - 1) + "\"";
+    } else if (workload == "prefix") {
+      return corpus.randomWord(rnd).substr(0, 3) + "*";
+    } else if (workload == "fuzzy") {
+      return "%" + corpus.randomWord(rnd) + "%";
+    } else if (workload == "numeric") {
+      size_t lo = rnd.below(PRICE_MAX);
+      snprintf(buf, sizeof(buf), "@price:[%zu %zu]", lo, lo + PRICE_MAX / 100);
+      return buf;
+    } else if (workload == "tag") {
+      return "@tags:{" + corpus.randomTag(rnd) + "}";
+    } else {
+      snprintf(buf, sizeof(buf), "@loc:[%.6f %.6f 5 km]", GEO_LON + rnd.uniform() - 0.5,
+               GEO_LAT + rnd.uniform() - 0.5);
+      return buf;
+    }
+  }
+
+  /* Delete a fraction of the documents and add them back as new versions, leaving the old
+   * entries for the GC */
+  void churn() {
+    size_t n = opts.numDocs * opts.churn;
+    for (size_t i = 0; i < n; i++) {
+      size_t id = rnd.below(opts.numDocs);
+      std::string key = "doc" + std::to_string(id);
+      RediSearch_DeleteDocument(sp, key.c_str(), key.size());
+      versions[id]++;
+      addDocument(id);
+    }
+  }
+
+  size_t gcCycle() {
+    ForkGC *gc = (ForkGC *)sp->gc->gcCtx;
+    size_t before = gc->stats.totalCollected;
+    sp->gc->callbacks.periodicCallback(ctx, gc);
+    return gc->stats.totalCollected - before;
+  }
+
+ public:
+  Bench(const Options &o, const Corpus &c) : opts(o), corpus(c), rnd(mix(o.seed)) {
+    ctx = RedisModule_GetThreadSafeContext(NULL);
+    RSIndexOptions *idxopts = RediSearch_CreateIndexOptions();
+    RediSearch_IndexOptionsSetGCPolicy(idxopts, GC_POLICY_FORK);
+    RediSearch_IndexOptionsSetFlags(idxopts, RSIDXOPT_DOCTBLSIZE_UNLIMITED);
+    sp = RediSearch_CreateIndex("bench", idxopts);
+    RediSearch_FreeIndexOptions(idxopts);
+    RSFieldID title = RediSearch_CreateField(sp, "title", RSFLDTYPE_FULLTEXT, RSFLDOPT_NONE);
+    RediSearch_TextFieldSetWeight(sp, title, 2.0);
+    RediSearch_CreateField(sp, "body", RSFLDTYPE_FULLTEXT, RSFLDOPT_NONE);
+    RediSearch_CreateField(sp, "tags", RSFLDTYPE_TAG, RSFLDOPT_SORTABLE);
+    RediSearch_CreateField(sp, "loc", RSFLDTYPE_GEO, RSFLDOPT_NONE);
+    RediSearch_CreateField(sp, "price", RSFLDTYPE_NUMERIC, RSFLDOPT_SORTABLE);
+    versions.resize(opts.numDocs);
+  }
+
+  ~Bench() {
+    RediSearch_DropIndex(sp);
+    RedisModule_FreeThreadSafeContext(ctx);
+  }
+
+  bool run(WorkloadResult &res) {
+    const std::string &w = res.name;
+    if (w == "index") {
+      for (size_t id = 0; id < opts.numDocs; id++) {
+        res.run([&] { return addDocument(id), 1; });
+      }
+    } else if (w == "update") {
+      // updates go to the popular documents more often
+      Zipf docs(opts.numDocs, opts.zipf);
+      for (size_t i = 0; i < opts.numUpdates; i++) {
+        size_t id = docs.sample(rnd);
+        versions[id]++;
+        res.run([&] { return addDocument(id), 1; });
+      }
+    } else if (w == "gc") {
+      RSGlobalConfig.forkGcCleanThreshold = 0;
+      for (size_t i = 0; i < opts.gcCycles; i++) {
+        churn();
+        res.run([&] { return gcCycle(); });
+      }
+    } else if (w == "aggregate") {
+      for (size_t i = 0; i < opts.numQueries; i++) {
+        std::vector<std::string> args = {corpus.randomWord(rnd), "GROUPBY", "1", "@tags",
+                                         "REDUCE", "COUNT", "0", "AS", "count", "REDUCE", "AVG",
+                                         "1", "@price", "AS", "avg_price", "SORTBY", "2",
+                                         "@count", "DESC", "LIMIT", "0", "10"};
+        res.run([&] { return execute(false, args); });
+      }
+    } else if (w == "term" || w == "phrase" || w == "prefix" || w == "fuzzy" ||
+               w == "numeric" || w == "tag" || w == "geo") {
+      for (size_t i = 0; i < opts.numQueries; i++) {
+        std::string q = makeQuery(w);
+        res.run([&] { return search(q); });
+      }
+    } else {
+      return false;
+    }
+    res.rss = currentRSS();
+    return true;
+  }
+};
+
+/******************************************************************************************
+ * Main
+ ******************************************************************************************/
+
+static void writeResult(FILE *fp, const WorkloadResult &r, bool last) {
+  const Histogram *h = &r.latency;
+  double secs = r.totalNS / 1e9;
+  fprintf(fp, "    {\"name\": \"%s\", \"ops\": %lu, \"seconds\": %.6f, \"ops_per_sec\": %.2f, ",
+          r.name.c_str(), (unsigned long)h->count, secs, secs > 0 ? h->count / secs : 0);
+  fprintf(fp, "\"items\": %zu, ", r.items);
+  fprintf(fp,
+          "\"latency_ns\": {\"mean\": %lu, \"p50\": %lu, \"p90\": %lu, \"p99\": %lu, "
+          "\"p99.9\": %lu, \"max\": %lu}, ",
+          (unsigned long)(h->count ? h->total / h->count : 0),
+          (unsigned long)Histogram_Percentile(h, 50), (unsigned long)Histogram_Percentile(h, 90),
+          (unsigned long)Histogram_Percentile(h, 99), (unsigned long)Histogram_Percentile(h, 99.9),
+          (unsigned long)h->max);
+  fprintf(fp, "\"rss_bytes\": %zu}%s\n", r.rss, last ? "" : ",");
+}
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s [options] [workload ...]\n"
+          "  --docs N        documents in the corpus (default 100000)\n"
+          "  --queries N     queries per query workload (default 1000)\n"
+          "  --updates N     updates in the update workload (default 20000)\n"
+          "  --gc-cycles N   GC cycles in the gc workload (default 5)\n"
+          "  --churn F       fraction of the documents replaced before every GC cycle (0.05)\n"
+          "  --vocabulary N  distinct words (default 50000)\n"
+          "  --body-words N  words in the body of a document (default 50)\n"
+          "  --zipf S        exponent of the word, tag and update distributions (default 1.0)\n"
+          "  --seed N        seed of the corpus and the queries (default 42)\n"
+          "  --output FILE   write the JSON results to FILE instead of stdout\n"
+          "Workloads: index update gc term phrase prefix fuzzy numeric tag geo aggregate.\n"
+          "All of them run by default, in this order: index, the queries, update, gc.\n",
+          prog);
+  exit(1);
+}
+
+static void parseArgs(int argc, char **argv, Options &opts) {
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    if (a.compare(0, 2, "--")) {
+      opts.workloads.push_back(a);
+      continue;
+    }
+    if (i + 1 == argc) {
+      usage(argv[0]);
+    }
+    const char *v = argv[++i];
+    if (a == "--docs") {
+      opts.numDocs = strtoull(v, NULL, 10);
+    } else if (a == "--queries") {
+      opts.numQueries = strtoull(v, NULL, 10);
+    } else if (a == "--updates") {
+      opts.numUpdates = strtoull(v, NULL, 10);
+    } else if (a == "--gc-cycles") {
+      opts.gcCycles = strtoull(v, NULL, 10);
+    } else if (a == "--churn") {
+      opts.churn = atof(v);
+    } else if (a == "--vocabulary") {
+      opts.vocabulary = strtoull(v, NULL, 10);
+    } else if (a == "--body-words") {
+      opts.bodyWords = strtoull(v, NULL, 10);
+    } else if (a == "--zipf") {
+      opts.zipf = atof(v);
+    } else if (a == "--seed") {
+      opts.seed = strtoull(v, NULL, 10);
+    } else if (a == "--output") {
+      opts.output = v;
+    } else {
+      usage(argv[0]);
+    }
+  }
+  if (!opts.numDocs || !opts.vocabulary || opts.bodyWords < 4) {
+    usage(argv[0]);
+  }
+  if (opts.workloads.empty()) {
+    opts.workloads.assign(std::begin(defaultWorkloads), std::end(defaultWorkloads));
+  }
+}
+
+int main(int argc, char **argv) {
+  Options opts;
+  parseArgs(argc, argv, opts);
+
+  const char *arguments[] = {"SAFEMODE", "NOGC"};
+  RMCK_Bootstrap(my_OnLoad, arguments, 2);
+  RediSearch_Initialize();
+  // measure whole queries, and nothing else
+  RSGlobalConfig.queryTimeoutMS = 0;
+  RSGlobalConfig.slowlogLogSlowerThan = -1;
+
+  Corpus corpus(opts);
+  std::vector<WorkloadResult> results;
+  {
+    Bench bench(opts, corpus);
+    for (auto &w : opts.workloads) {
+      results.emplace_back(w);
+      fprintf(stderr, "running %s...\n", w.c_str());
+      if (!bench.run(results.back())) {
+        fprintf(stderr, "unknown workload '%s'\n", w.c_str());
+        usage(argv[0]);
+      }
+    }
+  }
+
+  FILE *fp = opts.output ? fopen(opts.output, "w") : stdout;
+  if (!fp) {
+    perror(opts.output);
+    return 1;
+  }
+  fprintf(fp, "{\n");
+#ifdef RS_GIT_SHA
+  fprintf(fp, "  \"git_sha\": \"%s\",\n", RS_GIT_SHA);
+#endif
+  fprintf(fp,
+          "  \"options\": {\"docs\": %zu, \"queries\": %zu, \"updates\": %zu, \"gc_cycles\": %zu, "
+          "\"churn\": %g, \"vocabulary\": %zu, \"body_words\": %zu, \"zipf\": %g, \"seed\": %lu},\n",
+          opts.numDocs, opts.numQueries, opts.numUpdates, opts.gcCycles, opts.churn,
+          opts.vocabulary, opts.bodyWords, opts.zipf, (unsigned long)opts.seed);
+  fprintf(fp, "  \"workloads\": [\n");
+  for (size_t i = 0; i < results.size(); i++) {
+    writeResult(fp, results[i], i + 1 == results.size());
+  }
+  fprintf(fp, "  ],\n");
+  fprintf(fp, "  \"peak_rss_bytes\": %zu\n}\n", peakRSS());
+  if (fp != stdout) {
+    fclose(fp);
+  }
+  return 0;
+}
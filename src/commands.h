@@ -16,6 +16,7 @@
 #define RS_INFO_CMD RS_CMD_PREFIX ".INFO"
 #define RS_SEARCH_CMD RS_CMD_PREFIX ".SEARCH"
 #define RS_AGGREGATE_CMD RS_CMD_PREFIX ".AGGREGATE"
+#define RS_PROFILE_CMD RS_CMD_PREFIX ".PROFILE"
 
 #define RS_EXPLAIN_CMD RS_CMD_PREFIX ".EXPLAIN"
 #define RS_EXPLAINCLI_CMD RS_CMD_PREFIX ".EXPLAINCLI"
@@ -52,6 +53,8 @@
 
 #define RS_CONFIG RS_CMD_PREFIX ".CONFIG"
 
+#define RS_SLOWLOG RS_CMD_PREFIX ".SLOWLOG"
+
 #define RS_ALIASADD RS_CMD_PREFIX ".ALIASADD"
 #define RS_ALIASDEL RS_CMD_PREFIX ".ALIASDEL"
 #define RS_ALIASUPDATE RS_CMD_PREFIX ".ALIASUPDATE"
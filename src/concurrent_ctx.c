@@ -18,21 +18,34 @@ int ConcurrentSearch_CreatePool(int numThreads) {
   return poolId;
 }
 
+size_t ConcurrentSearch_NumIndexThreads(void) {
+  long numProcs = 0;
+
+  if (!RSGlobalConfig.poolSizeNoAuto) {
+    numProcs = sysconf(_SC_NPROCESSORS_ONLN);
+  }
+
+  if (numProcs < 1) {
+    numProcs = RSGlobalConfig.indexPoolSize;
+  }
+  return numProcs;
+}
+
 /** Start the concurrent search thread pool. Should be called when initializing the module */
 void ConcurrentSearch_ThreadPoolStart() {
+  ConcurrentSearch_SearchPoolStart();
+  ConcurrentSearch_IndexPoolStart();
+}
 
+void ConcurrentSearch_IndexPoolStart(void) {
+  if (CONCURRENT_POOL_INDEX == -1) {
+    CONCURRENT_POOL_INDEX = ConcurrentSearch_CreatePool(ConcurrentSearch_NumIndexThreads());
+  }
+}
+
+void ConcurrentSearch_SearchPoolStart(void) {
   if (CONCURRENT_POOL_SEARCH == -1) {
     CONCURRENT_POOL_SEARCH = ConcurrentSearch_CreatePool(RSGlobalConfig.searchPoolSize);
-    long numProcs = 0;
-
-    if (!RSGlobalConfig.poolSizeNoAuto) {
-      numProcs = sysconf(_SC_NPROCESSORS_ONLN);
-    }
-
-    if (numProcs < 1) {
-      numProcs = RSGlobalConfig.indexPoolSize;
-    }
-    CONCURRENT_POOL_INDEX = ConcurrentSearch_CreatePool(numProcs);
   }
 }
 
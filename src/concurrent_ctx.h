@@ -7,6 +7,10 @@
 #include <time.h>
 #include <dep/thpool/thpool.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #if defined(__FreeBSD__)
 #define CLOCK_MONOTONIC_RAW CLOCK_MONOTONIC
 #endif
@@ -106,6 +110,14 @@ static inline void ConcurrentSearch_SetKey(ConcurrentSearchCtx *ctx, RedisModule
 
 /** Start the concurrent search thread pool. Should be called when initializing the module */
 void ConcurrentSearch_ThreadPoolStart();
+/** Start the search thread pool only, if it is not running yet. It is started with the other pools
+ * in concurrent mode, and on demand otherwise (e.g. for cursors which prefetch their rows) */
+void ConcurrentSearch_SearchPoolStart(void);
+/** Start the indexing thread pool only, if it is not running yet. It is started on demand outside
+ * of concurrent mode for bulk loads, which tokenize their documents on it */
+void ConcurrentSearch_IndexPoolStart(void);
+/** The number of indexing threads: one per core, unless INDEX_THREADS is set */
+size_t ConcurrentSearch_NumIndexThreads(void);
 void ConcurrentSearch_ThreadPoolDestroy(void);
 
 /* Create a new thread pool, and return its identifying id */
@@ -201,4 +213,7 @@ static inline int CheckConcurrentSupport(RedisModuleCtx *ctx) {
   return 1;
 }
 
+#ifdef __cplusplus
+}
+#endif
 #endif
@@ -7,6 +7,7 @@
 #include <stdlib.h>
 #include <limits.h>
 #include "rmalloc.h"
+#include "trie/spell_index.h"
 
 #define RETURN_ERROR(s) return REDISMODULE_ERR;
 #define RETURN_PARSE_ERROR(rc)                                    \
@@ -257,6 +258,56 @@ CONFIG_GETTER(getCursorMaxIdle) {
   return sdscatprintf(ss, "%lld", config->cursorMaxIdle);
 }
 
+CONFIG_SETTER(setCursorPrefetchMaxMemory) {
+  int acrc = AC_GetSize(ac, &config->cursorPrefetchMaxMemory, AC_F_GE1);
+  RETURN_STATUS(acrc);
+}
+
+CONFIG_GETTER(getCursorPrefetchMaxMemory) {
+  sds ss = sdsempty();
+  return sdscatprintf(ss, "%lu", config->cursorPrefetchMaxMemory);
+}
+
+CONFIG_SETTER(setSlowlogLogSlowerThan) {
+  int acrc = AC_GetLongLong(ac, &config->slowlogLogSlowerThan, 0);
+  RETURN_STATUS(acrc);
+}
+
+CONFIG_GETTER(getSlowlogLogSlowerThan) {
+  sds ss = sdsempty();
+  return sdscatprintf(ss, "%lld", config->slowlogLogSlowerThan);
+}
+
+CONFIG_SETTER(setSlowlogMaxLen) {
+  int acrc = AC_GetSize(ac, &config->slowlogMaxLen, AC_F_GE0);
+  RETURN_STATUS(acrc);
+}
+
+CONFIG_GETTER(getSlowlogMaxLen) {
+  sds ss = sdsempty();
+  return sdscatprintf(ss, "%lu", config->slowlogMaxLen);
+}
+
+CONFIG_SETTER(setWordCacheSize) {
+  int acrc = AC_GetSize(ac, &config->wordCacheSize, AC_F_GE0);
+  RETURN_STATUS(acrc);
+}
+
+CONFIG_GETTER(getWordCacheSize) {
+  sds ss = sdsempty();
+  return sdscatprintf(ss, "%lu", config->wordCacheSize);
+}
+
+CONFIG_SETTER(setParallelTokenizeMinSize) {
+  int acrc = AC_GetSize(ac, &config->parallelTokenizeMinSize, AC_F_GE0);
+  RETURN_STATUS(acrc);
+}
+
+CONFIG_GETTER(getParallelTokenizeMinSize) {
+  sds ss = sdsempty();
+  return sdscatprintf(ss, "%lu", config->parallelTokenizeMinSize);
+}
+
 CONFIG_SETTER(setMinPhoneticTermLen) {
   int acrc = AC_GetSize(ac, &config->minPhoneticTermLen, AC_F_GE1);
   RETURN_STATUS(acrc);
@@ -267,6 +318,33 @@ CONFIG_GETTER(getMinPhoneticTermLen) {
   return sdscatprintf(ss, "%lu", config->minPhoneticTermLen);
 }
 
+CONFIG_SETTER(setSpellCheckIndexDistance) {
+  size_t dist = 0;
+  int acrc = AC_GetSize(ac, &dist, 0);
+  CHECK_RETURN_PARSE_ERROR(acrc);
+  if (dist > SPELL_INDEX_MAX_DIST) {
+    QueryError_SetError(status, QUERY_ELIMIT, "Value exceeds maximum spell index distance");
+    return REDISMODULE_ERR;
+  }
+  config->spellCheckIndexDistance = dist;
+  return REDISMODULE_OK;
+}
+
+CONFIG_GETTER(getSpellCheckIndexDistance) {
+  sds ss = sdsempty();
+  return sdscatprintf(ss, "%lu", config->spellCheckIndexDistance);
+}
+
+CONFIG_SETTER(setSpellCheckIndexMaxMemory) {
+  int acrc = AC_GetSize(ac, &config->spellCheckIndexMaxMemory, AC_F_GE0);
+  RETURN_STATUS(acrc);
+}
+
+CONFIG_GETTER(getSpellCheckIndexMaxMemory) {
+  sds ss = sdsempty();
+  return sdscatprintf(ss, "%lu", config->spellCheckIndexMaxMemory);
+}
+
 CONFIG_SETTER(setGcPolicy) {
   const char *policy;
   int acrc = AC_GetString(ac, &policy, NULL, 0);
@@ -412,6 +490,16 @@ RSConfigOptions RSGlobalConfigOptions = {
          .helpText = "Minumum length of term to be considered for phonetic matching",
          .setValue = setMinPhoneticTermLen,
          .getValue = getMinPhoneticTermLen},
+        {.name = "SPELLCHECK_INDEX_DISTANCE",
+         .helpText = "Serve spellcheck queries up to this distance from a deletion index, built on "
+                     "first use (0 to disable)",
+         .setValue = setSpellCheckIndexDistance,
+         .getValue = getSpellCheckIndexDistance},
+        {.name = "SPELLCHECK_INDEX_MAX_MEMORY",
+         .helpText = "the memory, in bytes, a spellcheck deletion index may take before it is "
+                     "dropped (0 for no limit)",
+         .setValue = setSpellCheckIndexMaxMemory,
+         .getValue = getSpellCheckIndexMaxMemory},
         {.name = "GC_POLICY",
          .helpText = "gc policy to use (DEFAULT/LEGACY)",
          .setValue = setGcPolicy,
@@ -441,6 +529,31 @@ RSConfigOptions RSGlobalConfigOptions = {
                      "high memory consumption.",
          .setValue = setCursorMaxIdle,
          .getValue = getCursorMaxIdle},
+        {.name = "CURSOR_PREFETCH_MAX_MEMORY",
+         .helpText = "the memory, in bytes, the rows a PREFETCH cursor computes ahead of its next "
+                     "read may take",
+         .setValue = setCursorPrefetchMaxMemory,
+         .getValue = getCursorPrefetchMaxMemory},
+        {.name = "SLOWLOG_LOG_SLOWER_THAN",
+         .helpText = "log queries slower than this many microseconds to FT.SLOWLOG (negative to "
+                     "disable the log)",
+         .setValue = setSlowlogLogSlowerThan,
+         .getValue = getSlowlogLogSlowerThan},
+        {.name = "SLOWLOG_MAX_LEN",
+         .helpText = "the number of queries kept in FT.SLOWLOG",
+         .setValue = setSlowlogMaxLen,
+         .getValue = getSlowlogMaxLen},
+        {.name = "WORD_CACHE_SIZE",
+         .helpText = "the number of words in each cache of stems or phonetic codes (0 to disable "
+                     "the caches)",
+         .setValue = setWordCacheSize,
+         .getValue = getWordCacheSize,
+         .flags = RSCONFIGVAR_F_IMMUTABLE},
+        {.name = "PARALLEL_TOKENIZE_MIN_SIZE",
+         .helpText = "tokenize the text fields of documents with at least this many bytes of text "
+                     "on several threads (0 to disable)",
+         .setValue = setParallelTokenizeMinSize,
+         .getValue = getParallelTokenizeMinSize},
         {.name = "NO_MEM_POOLS",
          .helpText = "Set RediSearch to run without memory pools",
          .setValue = setNoMemPools,
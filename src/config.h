@@ -61,8 +61,23 @@ typedef struct {
   // longer ones
   long long cursorMaxIdle;
 
+  // The estimated memory the rows a PREFETCH cursor computes ahead of its next read may take
+  size_t cursorPrefetchMaxMemory;
+
   long long timeoutPolicy;
 
+  // Log queries slower than this many microseconds to FT.SLOWLOG. Negative values disable the log
+  long long slowlogLogSlowerThan;
+  // The number of entries kept in FT.SLOWLOG
+  size_t slowlogMaxLen;
+
+  // The number of words in each cache of stems or phonetic codes. 0 disables the caches
+  size_t wordCacheSize;
+
+  // Tokenize the text fields of documents of at least this many bytes of text on several threads.
+  // 0 disables it
+  size_t parallelTokenizeMinSize;
+
   size_t maxDocTableSize;
   size_t searchPoolSize;
   size_t indexPoolSize;
@@ -72,6 +87,11 @@ typedef struct {
 
   size_t minPhoneticTermLen;
 
+  // Serve FT.SPELLCHECK queries of up to this distance from a spell index. 0 disables the index
+  size_t spellCheckIndexDistance;
+  // The memory a spell index may take before it is dropped. 0 for no limit
+  size_t spellCheckIndexMaxMemory;
+
   GCPolicy gcPolicy;
   size_t forkGcRunIntervalSec;
   size_t forkGcCleanThreshold;
@@ -150,6 +170,12 @@ sds RSConfig_GetInfoString(const RSConfig *config);
 #define DEFAULT_MIN_PHONETIC_TERM_LEN 3
 #define DEFAULT_FORK_GC_RUN_INTERVAL 30
 #define DEFAULT_MAX_RESULTS_TO_UNSORTED_MODE 1000
+#define DEFAULT_SLOWLOG_LOG_SLOWER_THAN 10000
+#define DEFAULT_SLOWLOG_MAX_LEN 128
+#define DEFAULT_WORD_CACHE_SIZE 16384
+#define DEFAULT_PARALLEL_TOKENIZE_MIN_SIZE 65536
+#define DEFAULT_CURSOR_PREFETCH_MAX_MEMORY (16 << 20)
+#define DEFAULT_SPELLCHECK_INDEX_MAX_MEMORY (256 << 20)
 // default configuration
 #define RS_DEFAULT_CONFIG                                                                         \
   {                                                                                               \
@@ -162,6 +188,11 @@ sds RSConfig_GetInfoString(const RSConfig *config);
     .gcPolicy = GCPolicy_Fork, .forkGcRunIntervalSec = DEFAULT_FORK_GC_RUN_INTERVAL,              \
     .forkGcSleepBeforeExit = 0, .maxResultsToUnsortedMode = DEFAULT_MAX_RESULTS_TO_UNSORTED_MODE, \
     .forkGcRetryInterval = 5, .forkGcCleanThreshold = 100, .noMemPool = 0,                          \
+    .spellCheckIndexDistance = 0, .slowlogLogSlowerThan = DEFAULT_SLOWLOG_LOG_SLOWER_THAN,        \
+    .slowlogMaxLen = DEFAULT_SLOWLOG_MAX_LEN, .wordCacheSize = DEFAULT_WORD_CACHE_SIZE,           \
+    .parallelTokenizeMinSize = DEFAULT_PARALLEL_TOKENIZE_MIN_SIZE,                                \
+    .cursorPrefetchMaxMemory = DEFAULT_CURSOR_PREFETCH_MAX_MEMORY,                                \
+    .spellCheckIndexMaxMemory = DEFAULT_SPELLCHECK_INDEX_MAX_MEMORY,                              \
   }
 
 #endif
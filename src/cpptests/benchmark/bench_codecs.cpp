@@ -0,0 +1,220 @@
+#include "common.h"
+#include <varint.h>
+#include <buffer.h>
+#include <string>
+#include <utility>
+#include <vector>
+extern "C" {
+#include <qint.h>
+}
+
+#define NUM_RECORDS 100000
+
+// Every storage combination that has an encoder and a decoder of its own
+static const int indexFlags[] = {
+    Index_DocIdsOnly,
+    Index_StoreFreqs,
+    Index_StoreFieldFlags,
+    Index_StoreFieldFlags | Index_WideSchema,
+    Index_StoreTermOffsets,
+    Index_StoreFreqs | Index_StoreFieldFlags,
+    Index_StoreFreqs | Index_StoreFieldFlags | Index_WideSchema,
+    Index_StoreFreqs | Index_StoreTermOffsets,
+    Index_StoreFieldFlags | Index_StoreTermOffsets,
+    Index_StoreFieldFlags | Index_StoreTermOffsets | Index_WideSchema,
+    Index_StoreFreqs | Index_StoreFieldFlags | Index_StoreTermOffsets,
+    Index_StoreFreqs | Index_StoreFieldFlags | Index_StoreTermOffsets | Index_WideSchema,
+    Index_StoreNumeric,
+};
+
+static std::string flagsLabel(IndexFlags flags) {
+  static const std::pair<int, const char *> names[] = {{Index_StoreFreqs, "freqs"},
+                                                       {Index_StoreFieldFlags, "fields"},
+                                                       {Index_StoreTermOffsets, "offsets"},
+                                                       {Index_WideSchema, "wide"},
+                                                       {Index_StoreNumeric, "numeric"}};
+  std::string s;
+  for (auto &n : names) {
+    if (flags & n.first) {
+      s += (s.empty() ? "" : ",") + std::string(n.second);
+    }
+  }
+  return s.empty() ? "docids" : s;
+}
+
+static void indexFlagsArgs(benchmark::internal::Benchmark *b) {
+  for (int flags : indexFlags) {
+    b->Arg(flags);
+  }
+}
+
+static void BM_Encode(benchmark::State &state) {
+  IndexFlags flags = (IndexFlags)state.range(0);
+  state.SetLabel(flagsLabel(flags));
+  size_t bytes = 0;
+  for (auto _ : state) {
+    InvertedIndex *idx = RSBench::createIndex(flags, NUM_RECORDS);
+    state.PauseTiming();
+    for (size_t i = 0; i < idx->size; i++) {
+      bytes += IndexBlock_DataLen(&idx->blocks[i]);
+    }
+    InvertedIndex_Free(idx);
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * NUM_RECORDS);
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_Encode)->Apply(indexFlagsArgs);
+
+static void BM_Decode(benchmark::State &state) {
+  IndexFlags flags = (IndexFlags)state.range(0);
+  state.SetLabel(flagsLabel(flags));
+  InvertedIndex *idx = RSBench::createIndex(flags, NUM_RECORDS);
+  for (auto _ : state) {
+    IndexReader *ir = RSBench::newReader(idx);
+    RSIndexResult *res;
+    while (IR_Read(ir, &res) != INDEXREAD_EOF) {
+      benchmark::DoNotOptimize(res);
+    }
+    IR_Free(ir);
+  }
+  state.SetItemsProcessed(state.iterations() * NUM_RECORDS);
+  InvertedIndex_Free(idx);
+}
+BENCHMARK(BM_Decode)->Apply(indexFlagsArgs);
+
+/* Skip through an index in strides of range(1) documents */
+static void BM_SkipTo(benchmark::State &state) {
+  IndexFlags flags = (IndexFlags)state.range(0);
+  state.SetLabel(flagsLabel(flags));
+  t_docId stride = state.range(1);
+  InvertedIndex *idx = RSBench::createIndex(flags, NUM_RECORDS);
+  size_t skips = 0;
+  for (auto _ : state) {
+    IndexReader *ir = RSBench::newReader(idx);
+    RSIndexResult *res;
+    for (t_docId id = stride; IR_SkipTo(ir, id, &res) != INDEXREAD_EOF; id += stride) {
+      skips++;
+    }
+    IR_Free(ir);
+  }
+  state.SetItemsProcessed(skips);
+  InvertedIndex_Free(idx);
+}
+BENCHMARK(BM_SkipTo)
+    ->ArgsProduct({{(INDEX_DEFAULT_FLAGS) & INDEX_STORAGE_MASK, Index_DocIdsOnly, Index_StoreNumeric},
+                   {2, 16, 128, 1024}});
+
+// Values of 1 to 4 bytes, as qint stores them
+static std::vector<uint32_t> qintValues() {
+  std::vector<uint32_t> v;
+  for (uint32_t i = 0; i < 4096; i++) {
+    v.push_back((i * 2654435761U) >> ((i % 4) * 8));
+  }
+  return v;
+}
+
+static void BM_QintEncode(benchmark::State &state) {
+  int len = state.range(0);
+  std::vector<uint32_t> values = qintValues();
+  Buffer buf;
+  Buffer_Init(&buf, values.size() * 5);
+  Buffer *b = &buf;
+  for (auto _ : state) {
+    BufferWriter bw = NewBufferWriter(b);
+    for (size_t i = 0; i + len <= values.size(); i += len) {
+      switch (len) {
+        case 1:
+          qint_encode1(&bw, values[i]);
+          break;
+        case 2:
+          qint_encode2(&bw, values[i], values[i + 1]);
+          break;
+        case 3:
+          qint_encode3(&bw, values[i], values[i + 1], values[i + 2]);
+          break;
+        default:
+          qint_encode4(&bw, values[i], values[i + 1], values[i + 2], values[i + 3]);
+          break;
+      }
+    }
+    b->offset = 0;
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+  Buffer_Free(b);
+}
+BENCHMARK(BM_QintEncode)->DenseRange(1, 4);
+
+static void BM_QintDecode(benchmark::State &state) {
+  int len = state.range(0);
+  std::vector<uint32_t> values = qintValues();
+  Buffer buf;
+  Buffer_Init(&buf, values.size() * 5);
+  Buffer *b = &buf;
+  BufferWriter bw = NewBufferWriter(b);
+  for (size_t i = 0; i + len <= values.size(); i += len) {
+    qint_encode(&bw, &values[i], len);
+  }
+  uint32_t out[4];
+  for (auto _ : state) {
+    BufferReader br = NewBufferReader(b);
+    while (!BufferReader_AtEnd(&br)) {
+      switch (len) {
+        case 1:
+          qint_decode1(&br, out);
+          break;
+        case 2:
+          qint_decode2(&br, out, out + 1);
+          break;
+        case 3:
+          qint_decode3(&br, out, out + 1, out + 2);
+          break;
+        default:
+          qint_decode4(&br, out, out + 1, out + 2, out + 3);
+          break;
+      }
+      benchmark::DoNotOptimize(out);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+  Buffer_Free(b);
+}
+BENCHMARK(BM_QintDecode)->DenseRange(1, 4);
+
+/* Varints of range(0) bits */
+static void BM_WriteVarint(benchmark::State &state) {
+  uint32_t mask = (uint32_t)((1ULL << state.range(0)) - 1);
+  Buffer buf;
+  Buffer_Init(&buf, 4096 * 5);
+  Buffer *b = &buf;
+  for (auto _ : state) {
+    BufferWriter bw = NewBufferWriter(b);
+    for (uint32_t i = 0; i < 4096; i++) {
+      WriteVarint((i * 2654435761U) & mask, &bw);
+    }
+    b->offset = 0;
+  }
+  state.SetItemsProcessed(state.iterations() * 4096);
+  Buffer_Free(b);
+}
+BENCHMARK(BM_WriteVarint)->Arg(7)->Arg(14)->Arg(21)->Arg(32);
+
+static void BM_ReadVarint(benchmark::State &state) {
+  uint32_t mask = (uint32_t)((1ULL << state.range(0)) - 1);
+  Buffer buf;
+  Buffer_Init(&buf, 4096 * 5);
+  Buffer *b = &buf;
+  BufferWriter bw = NewBufferWriter(b);
+  for (uint32_t i = 0; i < 4096; i++) {
+    WriteVarint((i * 2654435761U) & mask, &bw);
+  }
+  for (auto _ : state) {
+    BufferReader br = NewBufferReader(b);
+    while (!BufferReader_AtEnd(&br)) {
+      benchmark::DoNotOptimize(ReadVarint(&br));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * 4096);
+  Buffer_Free(b);
+}
+BENCHMARK(BM_ReadVarint)->Arg(7)->Arg(14)->Arg(21)->Arg(32);
@@ -0,0 +1,159 @@
+#include "common.h"
+#include <index.h>
+#include <map>
+#include <utility>
+
+#define NUM_DOCS 1000000
+
+/* The child indexes of the iterators. Child i holds every document that is a multiple of
+ * density * (i + 1), so the children overlap, and their intersection gets sparser with the
+ * fan-out. Kept across benchmarks, since building them dominates everything else */
+static InvertedIndex *childIndex(int i, int density) {
+  static std::map<std::pair<int, int>, InvertedIndex *> cache;
+  InvertedIndex *&idx = cache[std::make_pair(i, density)];
+  if (!idx) {
+    t_docId step = density * (i + 1);
+    idx = RSBench::createIndex((IndexFlags)((INDEX_DEFAULT_FLAGS) & INDEX_STORAGE_MASK),
+                               NUM_DOCS / step, step);
+  }
+  return idx;
+}
+
+static IndexIterator *childIterator(int i, int density) {
+  return NewReadIterator(RSBench::newReader(childIndex(i, density)));
+}
+
+/* Read an iterator to its end, returning the number of results */
+static size_t drain(IndexIterator *it) {
+  RSIndexResult *res;
+  size_t n = 0;
+  while (it->Read(it->ctx, &res) != INDEXREAD_EOF) {
+    benchmark::DoNotOptimize(res);
+    n++;
+  }
+  return n;
+}
+
+/* Skip through an iterator in strides of the given number of documents, returning the number of
+ * hits */
+static size_t skipThrough(IndexIterator *it, t_docId stride) {
+  RSIndexResult *res;
+  size_t n = 0;
+  int rc;
+  for (t_docId id = stride; (rc = it->SkipTo(it->ctx, id, &res)) != INDEXREAD_EOF; id += stride) {
+    n += rc == INDEXREAD_OK;
+  }
+  return n;
+}
+
+static IndexIterator **children(int n, int density) {
+  IndexIterator **its = (IndexIterator **)rm_calloc(n, sizeof(*its));
+  for (int i = 0; i < n; i++) {
+    its[i] = childIterator(i, density);
+  }
+  return its;
+}
+
+// {fan-out, density}
+#define FANOUT_ARGS \
+  ArgsProduct({{2, 4, 8, 16}, {1, 16, 256}})->ArgNames({"fanout", "density"})
+
+static void BM_Union(benchmark::State &state) {
+  int n = state.range(0), density = state.range(1);
+  size_t results = 0;
+  for (auto _ : state) {
+    IndexIterator *it = NewUnionIterator(children(n, density), n, NULL, 0, 1);
+    results += drain(it);
+    it->Free(it);
+  }
+  state.counters["results"] = benchmark::Counter(results, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_Union)->FANOUT_ARGS;
+
+static void BM_UnionQuickExit(benchmark::State &state) {
+  int n = state.range(0), density = state.range(1);
+  size_t results = 0;
+  for (auto _ : state) {
+    IndexIterator *it = NewUnionIterator(children(n, density), n, NULL, 1, 1);
+    results += drain(it);
+    it->Free(it);
+  }
+  state.counters["results"] = benchmark::Counter(results, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_UnionQuickExit)->FANOUT_ARGS;
+
+static void BM_Intersect(benchmark::State &state) {
+  int n = state.range(0), density = state.range(1);
+  size_t results = 0;
+  for (auto _ : state) {
+    IndexIterator *it =
+        NewIntersecIterator(children(n, density), n, NULL, RS_FIELDMASK_ALL, -1, 0, 1);
+    results += drain(it);
+    it->Free(it);
+  }
+  state.counters["results"] = benchmark::Counter(results, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_Intersect)->FANOUT_ARGS;
+
+/* An intersection with a slop checks the term offsets of every candidate */
+static void BM_IntersectSlop(benchmark::State &state) {
+  int n = state.range(0), density = state.range(1);
+  size_t results = 0;
+  for (auto _ : state) {
+    IndexIterator *it =
+        NewIntersecIterator(children(n, density), n, NULL, RS_FIELDMASK_ALL, 2, 1, 1);
+    results += drain(it);
+    it->Free(it);
+  }
+  state.counters["results"] = benchmark::Counter(results, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_IntersectSlop)->ArgsProduct({{2, 4}, {1, 16}})->ArgNames({"fanout", "density"});
+
+static void BM_Not(benchmark::State &state) {
+  int density = state.range(0);
+  size_t results = 0;
+  for (auto _ : state) {
+    IndexIterator *it = NewNotIterator(childIterator(0, density), NUM_DOCS, NULL, 1);
+    results += drain(it);
+    it->Free(it);
+  }
+  state.counters["results"] = benchmark::Counter(results, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_Not)->Arg(1)->Arg(16)->Arg(256)->ArgName("density");
+
+static void BM_Optional(benchmark::State &state) {
+  int density = state.range(0);
+  size_t results = 0;
+  for (auto _ : state) {
+    IndexIterator *it = NewOptionalIterator(childIterator(0, density), NUM_DOCS, 1);
+    results += drain(it);
+    it->Free(it);
+  }
+  state.counters["results"] = benchmark::Counter(results, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_Optional)->Arg(1)->Arg(16)->Arg(256)->ArgName("density");
+
+/* Skipping through a union and an intersection, as the parent of the iterator in a query does */
+static void BM_UnionSkipTo(benchmark::State &state) {
+  int n = state.range(0), stride = state.range(1);
+  size_t hits = 0;
+  for (auto _ : state) {
+    IndexIterator *it = NewUnionIterator(children(n, 1), n, NULL, 0, 1);
+    hits += skipThrough(it, stride);
+    it->Free(it);
+  }
+  state.counters["hits"] = benchmark::Counter(hits, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_UnionSkipTo)->ArgsProduct({{2, 8}, {16, 1024}})->ArgNames({"fanout", "stride"});
+
+static void BM_IntersectSkipTo(benchmark::State &state) {
+  int n = state.range(0), stride = state.range(1);
+  size_t hits = 0;
+  for (auto _ : state) {
+    IndexIterator *it = NewIntersecIterator(children(n, 1), n, NULL, RS_FIELDMASK_ALL, -1, 0, 1);
+    hits += skipThrough(it, stride);
+    it->Free(it);
+  }
+  state.counters["hits"] = benchmark::Counter(hits, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_IntersectSkipTo)->ArgsProduct({{2, 8}, {16, 1024}})->ArgNames({"fanout", "stride"});
@@ -0,0 +1,86 @@
+#include "common.h"
+#include <trie/trie_type.h>
+#include <trie/levenshtein.h>
+#include <rmalloc.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+/* The titles dictionary used by test_trie: "term,score" lines, scored one above their score */
+static Trie *loadTitles(const char *path) {
+  FILE *fp = fopen(path, "r");
+  if (!fp) {
+    return NULL;
+  }
+  Trie *t = NewTrie();
+  char *line = NULL;
+  size_t cap = 0;
+  while (getline(&line, &cap, fp) != -1) {
+    char *sep = strchr(line, ',');
+    if (!sep) continue;
+    *sep = 0;
+    double score = atof(sep + 1) + 1;
+    Trie_InsertStringBuffer(t, line, sep - line, score, 0, NULL);
+  }
+  free(line);
+  fclose(fp);
+  return t;
+}
+
+/* The numbers dictionary used by t_trie.cpp */
+static Trie *loadNumbers(size_t n) {
+  Trie *t = NewTrie();
+  for (size_t ii = 0; ii < n; ++ii) {
+    std::string s = std::to_string(ii);
+    Trie_InsertStringBuffer(t, s.c_str(), s.size(), 1, 0, NULL);
+  }
+  return t;
+}
+
+/* Run fuzzy queries of the terms at distance range(0), counting the matches per query */
+static void fuzzyQueries(benchmark::State &state, Trie *t, const char **terms) {
+  size_t numQueries = 0, numMatches = 0;
+  for (auto _ : state) {
+    for (const char **term = terms; *term; term++) {
+      TrieIterator *it = Trie_Iterate(t, *term, strlen(*term), state.range(0), 0);
+      rune *rstr;
+      t_len len;
+      float score;
+      int d;
+      while (TrieIterator_Next(it, &rstr, &len, NULL, &score, &d)) {
+        numMatches++;
+      }
+      DFAFilter_Free((DFAFilter *)it->ctx);
+      rm_free(it->ctx);
+      TrieIterator_Free(it);
+      numQueries++;
+    }
+  }
+  state.SetItemsProcessed(numQueries);
+  state.counters["matches/query"] = numQueries ? (double)numMatches / numQueries : 0;
+}
+
+/* Fuzzy queries on the titles dictionary: the file at $RS_BENCH_TITLES, or the test data one */
+static void BM_FuzzyTitles(benchmark::State &state) {
+  static const char *terms[] = {"dostoevsky", "dostoevski", "cbs",     "cbxs", "gangsta",
+                                "gengsta",    "jezebel",    "hezebel", NULL};
+  const char *path = getenv("RS_BENCH_TITLES");
+  Trie *t = loadTitles(path ? path : RS_BENCH_DEFAULT_TITLES);
+  if (!t) {
+    state.SkipWithError("cannot read the titles");
+    return;
+  }
+  fuzzyQueries(state, t, terms);
+  TrieType_Free(t);
+}
+BENCHMARK(BM_FuzzyTitles)->Arg(1)->Arg(2)->Arg(3);
+
+/* Fuzzy queries on 100K numbers, a dense trie with short terms */
+static void BM_FuzzyNumbers(benchmark::State &state) {
+  static const char *terms[] = {"1", "12", "123", "1234", "98765", "55555", NULL};
+  Trie *t = loadNumbers(100000);
+  fuzzyQueries(state, t, terms);
+  TrieType_Free(t);
+}
+BENCHMARK(BM_FuzzyNumbers)->Arg(1)->Arg(2)->Arg(3);
@@ -0,0 +1,54 @@
+#include "common.h"
+#include <varint.h>
+extern "C" {
+#include <rmutil/alloc.h>
+}
+
+InvertedIndex *RSBench::createIndex(IndexFlags flags, size_t n, t_docId step) {
+  InvertedIndex *idx = NewInvertedIndex(flags, 1);
+  if (flags & Index_StoreNumeric) {
+    for (size_t i = 1; i <= n; i++) {
+      InvertedIndex_WriteNumericEntry(idx, i * step, i % 1000);
+    }
+    return idx;
+  }
+
+  IndexEncoder enc = InvertedIndex_GetEncoder(flags);
+  VarintVectorWriter *vw = NewVarintVectorWriter(8);
+  for (size_t i = 1; i <= n; i++) {
+    ForwardIndexEntry h = {0};
+    h.docId = i * step;
+    h.fieldMask = 1 << (i % 4);
+    h.freq = 1 + i % 4;
+    h.term = "hello";
+    h.len = 5;
+    VVW_Reset(vw);
+    for (size_t pos = 0; pos < h.freq; pos++) {
+      VVW_Write(vw, pos * 3 + 1);
+    }
+    h.vw = vw;
+    InvertedIndex_WriteForwardIndexEntry(idx, enc, &h);
+  }
+  VVW_Free(vw);
+  return idx;
+}
+
+IndexReader *RSBench::newReader(InvertedIndex *idx) {
+  if (idx->flags & Index_StoreNumeric) {
+    return NewNumericReader(NULL, idx, NULL);
+  }
+  return NewTermIndexReader(idx, NULL, RS_FIELDMASK_ALL, NULL, 1);
+}
+
+/* Like BENCHMARK_MAIN, after setting up the allocator. Pass --benchmark_format=json for machine
+ * readable output */
+int main(int argc, char **argv) {
+  RMUTil_InitAlloc();
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,141 @@
+#include "common.h"
+#include <tokenize.h>
+#include <stemmer.h>
+#include <stopwords.h>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static const char *words[] = {
+    "running",    "the",       "Searching",  "indexes", "generously", "of",       "connection",
+    "happiness",  "arbitrary", "a",          "Quickly", "documents",  "nationalization",
+    "relational", "and",       "conditional", "to",     "hopefully",  "organizations", "is",
+    "operating",  "stemmers",  "HELLO",      "world",   "fishing",    "computers", "in"};
+static const size_t numWords = sizeof(words) / sizeof(*words);
+
+/* Text of about n words, with the punctuation and the casing the tokenizer normalizes */
+static std::string sampleText(size_t n) {
+  static const char *separators[] = {" ", " ", " ", ", ", ". ", " - ", "\t", "; "};
+  std::string s;
+  for (size_t i = 0; i < n; i++) {
+    s += words[(i * 7919) % numWords];
+    s += separators[(i * 31) % 8];
+  }
+  return s;
+}
+
+/* Tokenize a text of range(0) words, with or without a stemmer */
+static void tokenize(benchmark::State &state, bool stem) {
+  std::string text = sampleText(state.range(0));
+  std::vector<char> buf(text.size() + 1);
+  Stemmer *stemmer = stem ? NewStemmer(SnowballStemmer, RS_LANG_ENGLISH) : NULL;
+  RSTokenizer *tk = NewSimpleTokenizer(stemmer, DefaultStopWordList(), TOKENIZE_DEFAULT_OPTIONS);
+  size_t tokens = 0;
+  for (auto _ : state) {
+    // the tokenizer normalizes the text in place
+    memcpy(&buf[0], text.c_str(), buf.size());
+    tk->Start(tk, &buf[0], text.size(), TOKENIZE_DEFAULT_OPTIONS);
+    Token tok;
+    while (tk->Next(tk, &tok)) {
+      benchmark::DoNotOptimize(tok.tok);
+      tokens++;
+    }
+  }
+  state.SetItemsProcessed(tokens);
+  state.SetBytesProcessed(state.iterations() * text.size());
+  tk->Free(tk);
+  if (stemmer) {
+    stemmer->Free(stemmer);
+  }
+}
+
+static void BM_Tokenize(benchmark::State &state) {
+  tokenize(state, false);
+}
+BENCHMARK(BM_Tokenize)->Arg(16)->Arg(1024)->Arg(65536);
+
+static void BM_TokenizeStem(benchmark::State &state) {
+  tokenize(state, true);
+}
+BENCHMARK(BM_TokenizeStem)->Arg(16)->Arg(1024)->Arg(65536);
+
+/* Tokenize a real text: the file at $RS_BENCH_CORPUS (e.g. the Shakespeare plays CSV), or the
+ * book of Genesis from the test data */
+static void BM_TokenizeCorpus(benchmark::State &state) {
+  const char *path = getenv("RS_BENCH_CORPUS");
+  std::ifstream f(path ? path : RS_BENCH_DEFAULT_CORPUS);
+  if (!f) {
+    state.SkipWithError("cannot read the corpus");
+    return;
+  }
+  std::stringstream ss;
+  ss << f.rdbuf();
+  std::string text = ss.str();
+  std::vector<char> buf(text.size() + 1);
+  RSTokenizer *tk = NewSimpleTokenizer(NULL, DefaultStopWordList(), TOKENIZE_DEFAULT_OPTIONS);
+  size_t tokens = 0;
+  for (auto _ : state) {
+    memcpy(&buf[0], text.c_str(), buf.size());
+    tk->Start(tk, &buf[0], text.size(), TOKENIZE_NOSTEM);
+    Token tok;
+    while (tk->Next(tk, &tok)) {
+      benchmark::DoNotOptimize(tok.tok);
+      tokens++;
+    }
+  }
+  state.SetItemsProcessed(tokens);
+  state.SetBytesProcessed(state.iterations() * text.size());
+  tk->Free(tk);
+}
+BENCHMARK(BM_TokenizeCorpus);
+
+/* Look the sample words up in the default stopword list */
+static void BM_StopWords(benchmark::State &state) {
+  StopWordList *sl = DefaultStopWordList();
+  std::vector<std::string> lower;
+  for (size_t i = 0; i < numWords; i++) {
+    std::string w = words[i];
+    for (auto &c : w) {
+      c = tolower(c);
+    }
+    lower.push_back(w);
+  }
+  for (auto _ : state) {
+    for (auto &w : lower) {
+      benchmark::DoNotOptimize(StopWordList_Contains(sl, w.c_str(), w.size()));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * numWords);
+}
+BENCHMARK(BM_StopWords);
+
+/* Stem words with the stemmer of the language range(0) */
+static void BM_Stem(benchmark::State &state) {
+  RSLanguage lang = (RSLanguage)state.range(0);
+  state.SetLabel(RSLanguage_ToString(lang));
+  Stemmer *stemmer = NewStemmer(SnowballStemmer, lang);
+  std::vector<std::string> lower;
+  for (size_t i = 0; i < numWords; i++) {
+    std::string w = words[i];
+    for (auto &c : w) {
+      c = tolower(c);
+    }
+    lower.push_back(w);
+  }
+  for (auto _ : state) {
+    for (auto &w : lower) {
+      size_t len;
+      benchmark::DoNotOptimize(stemmer->Stem(stemmer->ctx, w.c_str(), w.size(), &len));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * numWords);
+  stemmer->Free(stemmer);
+}
+BENCHMARK(BM_Stem)
+    ->Arg(RS_LANG_ENGLISH)
+    ->Arg(RS_LANG_FRENCH)
+    ->Arg(RS_LANG_GERMAN)
+    ->Arg(RS_LANG_SPANISH)
+    ->Arg(RS_LANG_RUSSIAN);
@@ -0,0 +1,150 @@
+extern "C" {
+#include <util/khtable.h>
+#include <util/fnv.h>
+#include <dep/triemap/triemap.h>
+}
+#include "common.h"
+#include <value.h>
+#include <string>
+#include <vector>
+
+static std::vector<std::string> sampleKeys(size_t n) {
+  std::vector<std::string> keys;
+  for (size_t i = 0; i < n; i++) {
+    keys.push_back("key:" + std::to_string(i * 2654435761U % 1000003));
+  }
+  return keys;
+}
+
+static void BM_ValueNumber(benchmark::State &state) {
+  for (auto _ : state) {
+    RSValue *v = RS_NumVal(42);
+    benchmark::DoNotOptimize(v);
+    RSValue_Decref(v);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ValueNumber);
+
+static void BM_ValueCopiedString(benchmark::State &state) {
+  std::string s(state.range(0), 'x');
+  for (auto _ : state) {
+    RSValue *v = RS_NewCopiedString(s.c_str(), s.size());
+    benchmark::DoNotOptimize(v);
+    RSValue_Decref(v);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ValueCopiedString)->Arg(8)->Arg(64)->Arg(1024);
+
+enum { CMP_NUMBERS, CMP_STRINGS, CMP_MIXED };
+
+/* Compare numbers, strings, or numbers to numeric strings, as sorting by a field does */
+static void BM_ValueCmp(benchmark::State &state) {
+  static const char *labels[] = {"numbers", "strings", "number to string"};
+  int kind = state.range(0);
+  state.SetLabel(labels[kind]);
+  std::vector<RSValue *> vals;
+  for (size_t i = 0; i < 1024; i++) {
+    std::string s = std::to_string(i * 2654435761U % 100000);
+    if (kind == CMP_NUMBERS || (kind == CMP_MIXED && i % 2)) {
+      vals.push_back(RS_NumVal(i * 2654435761U % 100000));
+    } else {
+      vals.push_back(RS_NewCopiedString(s.c_str(), s.size()));
+    }
+  }
+  for (auto _ : state) {
+    for (size_t i = 1; i < vals.size(); i++) {
+      benchmark::DoNotOptimize(RSValue_Cmp(vals[i - 1], vals[i], NULL));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * (vals.size() - 1));
+  for (auto v : vals) {
+    RSValue_Decref(v);
+  }
+}
+BENCHMARK(BM_ValueCmp)->Arg(CMP_NUMBERS)->Arg(CMP_STRINGS)->Arg(CMP_MIXED);
+
+typedef struct {
+  KHTableEntry base;
+  const char *key;
+  size_t len;
+  uint32_t hash;
+} benchEntry;
+
+static int benchEntryCompare(const KHTableEntry *e, const void *s, size_t n, uint32_t h) {
+  const benchEntry *ent = (const benchEntry *)e;
+  return !(ent->hash == h && ent->len == n && !memcmp(ent->key, s, n));
+}
+
+static uint32_t benchEntryHash(const KHTableEntry *e) {
+  return ((const benchEntry *)e)->hash;
+}
+
+static KHTableEntry *benchEntryAlloc(void *ctx) {
+  return (KHTableEntry *)rm_calloc(1, sizeof(benchEntry));
+}
+
+static void benchEntryFree(KHTableEntry *e, void *ctx, void *arg) {
+  rm_free(e);
+}
+
+/* Look up range(0) keys in a table holding them, as the forward index does with the terms of a
+ * document */
+static void BM_KHTableLookup(benchmark::State &state) {
+  static const KHTableProcs procs = {
+      .Compare = benchEntryCompare, .Hash = benchEntryHash, .Alloc = benchEntryAlloc};
+  std::vector<std::string> keys = sampleKeys(state.range(0));
+  std::vector<uint32_t> hashes;
+  KHTable table;
+  KHTable_Init(&table, &procs, NULL, keys.size());
+  for (auto &k : keys) {
+    uint32_t h = rs_fnv_32a_buf(k.c_str(), k.size(), 0);
+    int isNew;
+    benchEntry *ent = (benchEntry *)KHTable_GetEntry(&table, k.c_str(), k.size(), h, &isNew);
+    ent->key = k.c_str();
+    ent->len = k.size();
+    ent->hash = h;
+    hashes.push_back(h);
+  }
+  for (auto _ : state) {
+    for (size_t i = 0; i < keys.size(); i++) {
+      benchmark::DoNotOptimize(
+          KHTable_GetEntry(&table, keys[i].c_str(), keys[i].size(), hashes[i], NULL));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+  KHTable_FreeEx(&table, NULL, benchEntryFree);
+}
+BENCHMARK(BM_KHTableLookup)->Arg(64)->Arg(4096)->Arg(262144);
+
+static void BM_TrieMapAdd(benchmark::State &state) {
+  std::vector<std::string> keys = sampleKeys(state.range(0));
+  for (auto _ : state) {
+    TrieMap *t = NewTrieMap();
+    for (auto &k : keys) {
+      TrieMap_Add(t, (char *)k.c_str(), k.size(), NULL, NULL);
+    }
+    state.PauseTiming();
+    TrieMap_Free(t, NULL);
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+BENCHMARK(BM_TrieMapAdd)->Arg(64)->Arg(4096)->Arg(262144);
+
+static void BM_TrieMapFind(benchmark::State &state) {
+  std::vector<std::string> keys = sampleKeys(state.range(0));
+  TrieMap *t = NewTrieMap();
+  for (auto &k : keys) {
+    TrieMap_Add(t, (char *)k.c_str(), k.size(), NULL, NULL);
+  }
+  for (auto _ : state) {
+    for (auto &k : keys) {
+      benchmark::DoNotOptimize(TrieMap_Find(t, (char *)k.c_str(), k.size()));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+  TrieMap_Free(t, NULL);
+}
+BENCHMARK(BM_TrieMapFind)->Arg(64)->Arg(4096)->Arg(262144);
@@ -0,0 +1,18 @@
+#ifndef RS_BENCHMARK_COMMON_H_
+#define RS_BENCHMARK_COMMON_H_
+
+#include <benchmark/benchmark.h>
+#include <inverted_index.h>
+
+namespace RSBench {
+
+/* Create an index of the given flags, holding n documents: step, 2*step, 3*step... Every record
+ * has 1 to 4 term offsets, or a value for numeric indexes */
+InvertedIndex *createIndex(IndexFlags flags, size_t n, t_docId step = 1);
+
+/* Create a reader of an index, of any flags */
+IndexReader *newReader(InvertedIndex *idx);
+
+}  // namespace RSBench
+
+#endif
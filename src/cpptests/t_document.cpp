@@ -2,6 +2,15 @@
 #include "redismock/redismock.h"
 #include "redismock/util.h"
 #include "document.h"
+#include "forward_index.h"
+#include "config.h"
+#include "spec.h"
+#include "indexer.h"
+#include "slowlog.h"
+#include "redisearch_api.h"
+#include <map>
+#include <string>
+#include <vector>
 
 class DocumentTest : public ::testing::Test {
  protected:
@@ -109,3 +118,192 @@ TEST_F(DocumentTest, testLoadSchema) {
 }
 
 #endif // HAVE_RM_SCANCURSOR_CREATE
+
+namespace {
+// What tokenizing a document produced
+struct TokenizedDoc {
+  struct Term {
+    uint32_t freq;
+    t_fieldMask fieldMask;
+    std::vector<uint32_t> positions;
+    bool operator==(const Term &o) const {
+      return freq == o.freq && fieldMask == o.fieldMask && positions == o.positions;
+    }
+  };
+  std::map<std::string, Term> terms;
+  uint32_t maxFreq = 0, totalFreq = 0, totalTokens = 0;
+  std::vector<uint32_t> byteOffsets;
+  std::vector<uint32_t> fieldPositions;
+  std::vector<std::string> sortables;
+};
+}  // namespace
+
+static std::vector<uint32_t> decodeVector(VarintVectorWriter *vw) {
+  std::vector<uint32_t> ret;
+  BufferReader br = {.buf = &vw->buf, .pos = 0};
+  uint32_t cur = 0;
+  for (size_t ii = 0; ii < vw->nmemb; ++ii) {
+    cur += ReadVarint(&br);
+    ret.push_back(cur);
+  }
+  return ret;
+}
+
+static TokenizedDoc tokenizeDoc(IndexSpec *sp, const std::vector<std::string> &fields) {
+  RSDoc *d = RediSearch_CreateDocument("doc1", 4, 1.0, NULL);
+  for (size_t ii = 0; ii < fields.size(); ++ii) {
+    std::string name = "t" + std::to_string(ii);
+    RediSearch_DocumentAddFieldCString(d, name.c_str(), fields[ii].c_str(), RSFLDTYPE_DEFAULT);
+  }
+  QueryError status = {QueryErrorCode(0)};
+  RSAddDocumentCtx *aCtx = NewAddDocumentCtx(sp, d, &status);
+  rm_free(d);
+  TokenizedDoc ret;
+  if (!aCtx) {
+    return ret;
+  }
+  EXPECT_EQ(REDISMODULE_OK, Document_Preprocess(aCtx));
+
+  ForwardIndexIterator it = ForwardIndex_Iterate(aCtx->fwIdx);
+  ForwardIndexEntry *ent;
+  while ((ent = ForwardIndexIterator_Next(&it))) {
+    ret.terms[std::string(ent->term, ent->len)] = {ent->freq, ent->fieldMask,
+                                                   decodeVector(ent->vw)};
+  }
+  ret.maxFreq = aCtx->fwIdx->maxFreq;
+  ret.totalFreq = aCtx->fwIdx->totalFreq;
+  ret.totalTokens = aCtx->totalTokens;
+  ret.byteOffsets = decodeVector(&aCtx->offsetsWriter);
+  for (size_t ii = 0; ii < aCtx->byteOffsets->numFields; ++ii) {
+    const RSByteOffsetField &f = aCtx->byteOffsets->fields[ii];
+    ret.fieldPositions.insert(ret.fieldPositions.end(), {f.fieldId, f.firstTokPos, f.lastTokPos});
+  }
+  for (size_t ii = 0; aCtx->sv && ii < aCtx->sv->len; ++ii) {
+    RSValue *v = RSSortingVector_Get(aCtx->sv, ii);
+    ret.sortables.push_back(v ? RSValue_StringPtrLen(v, NULL) : "");
+  }
+  AddDocumentCtx_Free(aCtx);
+  return ret;
+}
+
+TEST_F(DocumentTest, testParallelTokenize) {
+  RediSearch_Initialize();
+  IndexSpec *sp = RediSearch_CreateIndex("tokidx", NULL);
+  for (int ii = 0; ii < 3; ++ii) {
+    RediSearch_CreateTextField(sp, ("t" + std::to_string(ii)).c_str());
+  }
+  // the tokenizer removes escapes in place, which must not show in the sortable value
+  RediSearch_CreateField(sp, "t3", RSFLDTYPE_FULLTEXT, RSFLDOPT_SORTABLE);
+
+  // separators, stop words, stems and escapes, in fields of several chunks
+  const char *words[] = {"Hello",   "world,",  "the",  "running", "runs", "foo\\ bar",
+                         "a-b",     "(quoted)", "to",  "be\\",   "RUN",  "\\,x",
+                         "numbers", "1234",    "of",   "\n",     "end."};
+  const size_t sizes[] = {100000, 300, 40000, 0};
+  std::vector<std::string> fields(4);
+  unsigned seed = 7;
+  for (size_t ii = 0; ii < fields.size(); ++ii) {
+    std::string &text = fields[ii];
+    while (text.size() < sizes[ii]) {
+      seed = seed * 1103515245 + 12345;
+      text += words[(seed >> 16) % (sizeof(words) / sizeof(*words))];
+      text += (seed >> 8) % 5 ? " " : "\n";
+    }
+  }
+  fields[3] = "Foo\\ bar baz";
+
+  size_t minSize = RSGlobalConfig.parallelTokenizeMinSize;
+  int noAuto = RSGlobalConfig.poolSizeNoAuto;
+  size_t poolSize = RSGlobalConfig.indexPoolSize;
+  RSGlobalConfig.poolSizeNoAuto = 1;
+  RSGlobalConfig.indexPoolSize = 4;
+
+  RSGlobalConfig.parallelTokenizeMinSize = 0;
+  TokenizedDoc serial = tokenizeDoc(sp, fields);
+  RSGlobalConfig.parallelTokenizeMinSize = 1024;
+  TokenizedDoc parallel = tokenizeDoc(sp, fields);
+  // the pooled context of the first document is reused, with its arena and chunk indexes
+  TokenizedDoc again = tokenizeDoc(sp, fields);
+
+  RSGlobalConfig.parallelTokenizeMinSize = minSize;
+  RSGlobalConfig.poolSizeNoAuto = noAuto;
+  RSGlobalConfig.indexPoolSize = poolSize;
+
+  ASSERT_LT(1000, serial.totalTokens);
+  ASSERT_EQ(serial.totalTokens, parallel.totalTokens);
+  ASSERT_EQ(serial.maxFreq, parallel.maxFreq);
+  ASSERT_EQ(serial.totalFreq, parallel.totalFreq);
+  ASSERT_EQ(serial.byteOffsets, parallel.byteOffsets);
+  ASSERT_EQ(serial.fieldPositions, parallel.fieldPositions);
+  ASSERT_EQ(std::vector<std::string>{"foo\\ bar baz"}, serial.sortables);
+  ASSERT_EQ(serial.sortables, parallel.sortables);
+  ASSERT_EQ(serial.terms.size(), parallel.terms.size());
+  for (const auto &kv : serial.terms) {
+    ASSERT_TRUE(kv.second == parallel.terms[kv.first]) << kv.first;
+  }
+  ASSERT_EQ(parallel.totalTokens, again.totalTokens);
+  ASSERT_EQ(parallel.byteOffsets, again.byteOffsets);
+  ASSERT_EQ(parallel.fieldPositions, again.fieldPositions);
+  ASSERT_TRUE(parallel.terms == again.terms);
+  RediSearch_DropIndex(sp);
+}
+
+TEST_F(DocumentTest, testReplaceUnchanged) {
+  RediSearch_Initialize();
+  IndexSpec *sp = RediSearch_CreateIndex("replidx", NULL);
+  RediSearch_CreateTextField(sp, "t");
+  RediSearch_CreateField(sp, "views", RSFLDTYPE_NUMERIC, RSFLDOPT_SORTABLE | RSFLDOPT_NOINDEX);
+  const FieldSpec *views = IndexSpec_GetField(sp, "views", strlen("views"));
+
+  auto addDoc = [&](const char *text, double numViews) {
+    RSDoc *d = RediSearch_CreateDocumentSimple("doc1");
+    RediSearch_DocumentAddFieldCString(d, "t", text, RSFLDTYPE_DEFAULT);
+    RediSearch_DocumentAddFieldNumber(d, "views", numViews, RSFLDTYPE_DEFAULT);
+    ASSERT_EQ(REDISMODULE_OK, RediSearch_SpecAddDocument(sp, d));
+  };
+  auto docViews = [&](t_docId id) {
+    RSDocumentMetadata *md = DocTable_Get(&sp->docs, id);
+    return RSSortingVector_Get(md->sortVector, views->sortIdx)->numval;
+  };
+
+  addDoc("hello world", 1);
+  t_docId id = DocTable_GetId(&sp->docs, "doc1", strlen("doc1"));
+  ASSERT_NE(0, id);
+
+  // only a sortable-only field changed, so the document is updated in place
+  addDoc("hello world", 2);
+  ASSERT_EQ(id, DocTable_GetId(&sp->docs, "doc1", strlen("doc1")));
+  ASSERT_EQ(2, docViews(id));
+
+  // the text changed, so the document is indexed again
+  addDoc("hello there", 3);
+  t_docId newId = DocTable_GetId(&sp->docs, "doc1", strlen("doc1"));
+  ASSERT_LT(id, newId);
+  ASSERT_EQ(3, docViews(newId));
+  ASSERT_EQ(1, sp->stats.numDocuments);
+  RediSearch_DropIndex(sp);
+}
+
+TEST_F(DocumentTest, testIndexingRate) {
+  RediSearch_Initialize();
+  IndexSpec *sp = RediSearch_CreateIndex("rateidx", NULL);
+  RediSearch_CreateTextField(sp, "t");
+  ASSERT_EQ(0, Indexer_DocsPerSec(sp->indexer));
+
+  const size_t numDocs = 200;
+  uint64_t start = Slowlog_NowNS();
+  for (size_t ii = 0; ii < numDocs; ++ii) {
+    std::string key = "doc" + std::to_string(ii);
+    RSDoc *d = RediSearch_CreateDocumentSimple(key.c_str());
+    RediSearch_DocumentAddFieldCString(d, "t", "hello world, the quick brown fox", RSFLDTYPE_DEFAULT);
+    ASSERT_EQ(REDISMODULE_OK, RediSearch_SpecAddDocument(sp, d));
+  }
+  uint64_t wallNS = Slowlog_NowNS() - start;
+
+  // the time spent indexing is a part of the wall time, so the rate is at least the one of the
+  // whole loop. Indexing a document takes well over 100ns, so the rate is below 10M docs/s
+  double rate = Indexer_DocsPerSec(sp->indexer);
+  ASSERT_GE(rate, numDocs * 1e9 / wallNS);
+  ASSERT_LT(rate, 1e7);
+  RediSearch_DropIndex(sp);
+}
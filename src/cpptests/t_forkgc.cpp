@@ -4,6 +4,7 @@
 #include "redisearch_api.h"
 #include "fork_gc.h"
 #include "tag_index.h"
+#include "int_index.h"
 #include "rules.h"
 #include "query_error.h"
 #include "inverted_index.h"
@@ -304,3 +305,37 @@ TEST_F(FGCTest, testRemoveMiddleBlock) {
   ASSERT_NE(ss.end(), ss.find(numToDocid(lastLastBlockId)));
   ASSERT_EQ(0, fgc->stats.gcBlocksDenied);
 }
+
+TEST_F(FGCTest, testRemoveIntIndexEntries) {
+  RediSearch_CreateNumericField(sp, "n");
+  FieldSpec *fs = (FieldSpec *)IndexSpec_GetField(sp, "n", 1);
+  fs->options = (FieldSpecOptions)(fs->options | FieldSpec_Int64);
+  for (unsigned i = 1; i <= 3; ++i) {
+    std::string val = std::to_string(-(int)i);
+    ASSERT_TRUE(RS::addDocument(ctx, sp, numToDocid(i).c_str(), "n", val.c_str()));
+  }
+  RedisSearchCtx sctx = SEARCH_CTX_STATIC(ctx, sp);
+  IntIndex *idx =
+      OpenIntIndex(&sctx, IndexSpec_GetFormattedKeyByName(sp, "n", INDEXFLD_T_NUMERIC), 0);
+  ASSERT_TRUE(idx != NULL);
+  ASSERT_EQ(3, idx->numEntries);
+  t_docId deletedId = DocTable_GetId(&sp->docs, "doc2", strlen("doc2"));
+  size_t numRecords = sp->stats.numRecords;
+
+  FGC_WaitAtFork(fgc);
+  ASSERT_TRUE(RS::deleteDocument(ctx, sp, "doc2"));
+  FGC_WaitAtApply(fgc);
+  FGC_WaitClear(fgc);
+
+  // the value of the deleted document is cleared from the existence bitmap and from every slice
+  ASSERT_EQ(2, idx->numEntries);
+  ASSERT_EQ(2, Bitmap_Card(&idx->exists));
+  int64_t v;
+  ASSERT_FALSE(IntIndex_Get(idx, deletedId, &v));
+  for (size_t ii = 0; ii < INTIDX_NUM_SLICES; ++ii) {
+    ASSERT_FALSE(Bitmap_Test(&idx->slices[ii], deletedId));
+  }
+  ASSERT_TRUE(IntIndex_Get(idx, DocTable_GetId(&sp->docs, "doc3", strlen("doc3")), &v));
+  ASSERT_EQ(-3, v);
+  ASSERT_EQ(numRecords - 1, sp->stats.numRecords);
+}
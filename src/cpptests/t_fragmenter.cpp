@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "fragmenter.h"
+#include "index_result.h"
+#include "varint.h"
+#include <sstream>
+#include <string>
+#include <vector>
+
+class FragmenterTest : public ::testing::Test {};
+
+TEST_F(FragmenterTest, testFragmentizeOffsets) {
+  // two fields: the first one takes positions 1-3, the second one the rest
+  std::vector<std::string> fields = {
+      "one quick three",
+      "the quick brown fox saw a quick dog far far away from every other animal in the quick town"};
+  std::string word = "quick";
+
+  RSByteOffsets *offsets = NewByteOffsets();
+  RSByteOffsets_ReserveFields(offsets, fields.size());
+  ByteOffsetWriter bw;
+  ByteOffsetWriter_Init(&bw);
+  VarintVectorWriter *pw = NewVarintVectorWriter(8);
+  uint32_t pos = 1;
+  for (size_t ii = 0; ii < fields.size(); ++ii) {
+    RSByteOffsetField *f = RSByteOffsets_AddField(offsets, ii, pos);
+    std::istringstream ss(fields[ii]);
+    std::string tok;
+    size_t byteOff = 0;
+    while (ss >> tok) {
+      byteOff = fields[ii].find(tok, byteOff);
+      ByteOffsetWriter_Write(&bw, byteOff);
+      if (tok == word) {
+        VVW_Write(pw, pos);
+      }
+      byteOff += tok.size();
+      pos++;
+    }
+    f->lastTokPos = pos - 1;
+  }
+  ByteOffsetWriter_Move(&bw, offsets);
+  ByteOffsetWriter_Cleanup(&bw);
+
+  RSToken tok = {.str = (char *)word.c_str(), .len = word.size()};
+  RSIndexResult *res = NewTokenRecord(NewQueryTerm(&tok, 0), 1);
+  res->term.offsets.data = pw->buf.data;
+  res->term.offsets.len = pw->buf.offset;
+
+  const std::string &doc = fields[1];
+  RSOffsetIterator offsIter = RSIndexResult_IterateOffsets(res);
+  RSByteOffsetIterator bytesIter;
+  ASSERT_EQ(REDISMODULE_OK, RSByteOffset_Iterate(offsets, 1, &bytesIter));
+  FragmentTermIterator fragIter;
+  FragmentTermIterator_InitOffsets(&fragIter, &bytesIter, &offsIter);
+  FragmentList frags;
+  FragmentList_Init(&frags, 8, 6);
+  FragmentList_FragmentizeIter(&frags, doc.c_str(), doc.size(), &fragIter, 0);
+  offsIter.Free(offsIter.ctx);
+
+  // the match of the first field is not used; the first two matches of the second field are
+  // close enough to share a fragment, along with the tokens between them
+  ASSERT_EQ(2, frags.numFrags);
+  const Fragment *ff = FragmentList_GetFragments(&frags);
+  ASSERT_EQ("quick brown fox saw a quick", std::string(ff[0].buf, ff[0].len));
+  ASSERT_EQ(2, ff[0].numMatches);
+  ASSERT_EQ(6, ff[0].totalTokens);
+  ASSERT_EQ("quick", std::string(ff[1].buf, ff[1].len));
+  ASSERT_EQ(doc.rfind(word), ff[1].buf - doc.c_str());
+  ASSERT_EQ(1, ff[1].totalTokens);
+
+  HighlightTags tags = {.openTag = "<b>", .closeTag = "</b>"};
+  char *hl = FragmentList_HighlightWholeDocS(&frags, &tags);
+  ASSERT_STREQ(
+      "the <b>quick</b> brown fox saw a <b>quick</b> dog far far away from every other animal in "
+      "the <b>quick</b> town",
+      hl);
+  rm_free(hl);
+
+  FragmentList_Free(&frags);
+  IndexResult_Free(res);
+  VVW_Free(pw);
+  RSByteOffsets_Free(offsets);
+}
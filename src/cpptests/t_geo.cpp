@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include "dep/geo/rs_geo.h"
+#include "redismock/util.h"
+#include "redisearch_api.h"
+#include "aggregate/aggregate.h"
+#include "result_processor.h"
+#include "geo_index.h"
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+class GeoTest : public ::testing::Test {};
+
+static double rangesWidth(const GeoHashRange *ranges, size_t n) {
+  double w = 0;
+  for (size_t i = 0; i < n; i++) {
+    w += ranges[i].max - ranges[i].min;
+  }
+  return w;
+}
+
+TEST_F(GeoTest, testCoveringRanges) {
+  struct {
+    double lon;
+    double lat;
+    double radius;
+  } circles[] = {{-0.1757, 51.5156, 100},  {-0.1757, 51.5156, 1000}, {34.78, 32.08, 50000},
+                 {-122.4, 37.77, 1000000}, {179.99, 0.5, 20000},     {10, 84, 5000}};
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> unit(-1, 1);
+
+  for (auto &c : circles) {
+    GeoHashRange ranges[GEO_COVER_MAX_RANGES];
+    size_t n = calcCoveringRanges(c.lon, c.lat, c.radius, ranges);
+    ASSERT_GT(n, 0);
+    ASSERT_LE(n, GEO_COVER_MAX_RANGES);
+    for (size_t i = 1; i < n; i++) {
+      ASSERT_LT(ranges[i - 1].max, ranges[i].min);
+    }
+
+    // the covering should never be larger than the 9 squares we used to search
+    GeoHashRange squares[GEO_RANGE_COUNT] = {{0}};
+    calcRanges(c.lon, c.lat, c.radius, squares);
+    ASSERT_LE(rangesWidth(ranges, n), rangesWidth(squares, GEO_RANGE_COUNT));
+
+    // every point within the radius must be covered
+    // sample a box which is slightly larger than the circle
+    double dlat = c.radius / 111000 * 1.1;
+    double dlon = std::min(180.0, dlat / cos(c.lat * M_PI / 180));
+    size_t inside = 0;
+    for (int i = 0; i < 20000; i++) {
+      double lon = c.lon + unit(gen) * dlon;
+      double lat = c.lat + unit(gen) * dlat;
+      if (lon < GEO_LONG_MIN || lon > GEO_LONG_MAX || lat < GEO_LAT_MIN || lat > GEO_LAT_MAX ||
+          !isWithinRadiusLonLat(c.lon, c.lat, lon, lat, c.radius, NULL)) {
+        continue;
+      }
+      inside++;
+      double bits;
+      encodeGeo(lon, lat, &bits);
+      bool found = false;
+      for (size_t j = 0; j < n && !found; j++) {
+        found = bits >= ranges[j].min && bits <= ranges[j].max;
+      }
+      ASSERT_TRUE(found) << lon << "," << lat << " around " << c.lon << "," << c.lat;
+    }
+    ASSERT_GT(inside, 0);
+  }
+}
+
+TEST_F(GeoTest, testNearestWithText) {
+  RSIndex *index = RediSearch_CreateIndex("geonearest", NULL);
+  RediSearch_CreateTextField(index, "t");
+  RediSearch_CreateGeoField(index, "g");
+  // documents every ~111m east of the center, added from the farthest one so that the order of
+  // their ids is the opposite of the order of their distances. Every 4th one is foo; the nearest
+  // three documents are not
+  for (int i = 19; i >= 0; i--) {
+    std::string id = "doc" + std::to_string(i);
+    std::string loc = std::to_string(0.001 * i) + ",0";
+    RSDoc *d = RediSearch_CreateDocumentSimple(id.c_str());
+    RediSearch_DocumentAddFieldCString(d, "t", i % 4 == 3 ? "foo" : "bar", RSFLDTYPE_DEFAULT);
+    RediSearch_DocumentAddFieldCString(d, "g", loc.c_str(), RSFLDTYPE_GEO);
+    RediSearch_SpecAddDocument(index, d);
+  }
+
+  RedisModuleCtx *ctx = RedisModule_GetThreadSafeContext(NULL);
+  QueryError qerr = {QueryErrorCode(0)};
+  AREQ *req = AREQ_New();
+  req->reqflags |= QEXEC_F_IS_SEARCH;
+  {
+    RMCK::ArgvList args(ctx, "foo", "NOCONTENT", "GEOFILTER", "g", "0", "0", "10", "km",
+                        "NEAREST", "3");
+    ASSERT_EQ(REDISMODULE_OK, AREQ_Compile(req, args, args.size(), &qerr))
+        << QueryError_GetError(&qerr);
+  }
+  RedisSearchCtx *sctx = NewSearchCtxDefault(ctx);
+  sctx->spec = index;
+  sctx->refcount = 1;
+  ASSERT_EQ(REDISMODULE_OK, AREQ_ApplyContext(req, sctx, &qerr)) << QueryError_GetError(&qerr);
+  ASSERT_EQ(REDISMODULE_OK, AREQ_BuildPipeline(req, 0, &qerr)) << QueryError_GetError(&qerr);
+
+  // the nearest foo documents, rather than the foo documents among the nearest ones, ordered by
+  // their distance
+  ResultProcessor *rp = AREQ_RP(req);
+  RLookup *lk = AGPLN_GetLookup(&req->ap, NULL, AGPLN_GETLOOKUP_FIRST);
+  const RLookupKey *distKey = RLookup_GetKey(lk, GEO_DISTANCE_FIELD, RLOOKUP_F_NOINCREF);
+  ASSERT_TRUE(distKey != NULL);
+  std::vector<std::string> ids;
+  std::vector<double> dists;
+  SearchResult res = {0};
+  int rc;
+  while ((rc = rp->Next(rp, &res)) == RS_RESULT_OK) {
+    size_t n;
+    const char *key = DMD_KeyPtrLen(res.dmd, &n);
+    ids.push_back(std::string(key, n));
+    double dist;
+    ASSERT_TRUE(RSValue_ToNumber(RLookup_GetItem(distKey, &res.rowdata), &dist));
+    dists.push_back(dist);
+    SearchResult_Clear(&res);
+  }
+  ASSERT_EQ(RS_RESULT_EOF, rc);
+  ASSERT_EQ(std::vector<std::string>({"doc3", "doc7", "doc11"}), ids);
+  ASSERT_EQ(3, req->qiter.totalResults);
+  for (size_t i = 0; i < dists.size(); i++) {
+    // in km
+    ASSERT_NEAR(0.1113 * (4 * i + 3), dists[i], 0.01);
+  }
+
+  SearchResult_Destroy(&res);
+  AREQ_Free(req);
+  RedisModule_FreeThreadSafeContext(ctx);
+  RediSearch_DropIndex(index);
+}
+
+static size_t countHits(IndexIterator *it) {
+  size_t n = 0;
+  RSIndexResult *hit;
+  while (it->Read(it->ctx, &hit) == INDEXREAD_OK) {
+    n++;
+  }
+  return n;
+}
+
+TEST_F(GeoTest, testRangesBuiltOnce) {
+  RSIndex *index = RediSearch_CreateIndex("georanges", NULL);
+  RediSearch_CreateGeoField(index, "g");
+  for (int i = 0; i < 20; i++) {
+    std::string loc = std::to_string(0.01 * i) + ",0";
+    RSDoc *d = RediSearch_CreateDocumentSimple(("doc" + std::to_string(i)).c_str());
+    RediSearch_DocumentAddFieldCString(d, "g", loc.c_str(), RSFLDTYPE_GEO);
+    RediSearch_SpecAddDocument(index, d);
+  }
+
+  RedisModuleCtx *ctx = RedisModule_GetThreadSafeContext(NULL);
+  RedisSearchCtx *sctx = NewSearchCtxDefault(ctx);
+  sctx->spec = index;
+  GeoFilter *gf = NewGeoFilter(0, 0, 5, "km");
+  gf->property = rm_strdup("g");
+
+  // the iterators of a filter share its covering ranges, which outlive every one of them
+  IndexIterator *it1 = NewGeoRangeIterator(sctx, gf);
+  NumericFilter **ranges = gf->numericFilters;
+  IndexIterator *it2 = NewGeoRangeIterator(sctx, gf);
+  ASSERT_EQ(ranges, gf->numericFilters);
+  ASSERT_EQ(5, countHits(it1));
+  ASSERT_EQ(5, countHits(it2));
+  it1->Free(it1);
+  it2->Free(it2);
+
+  GeoFilter_Free(gf);
+  SearchCtx_Free(sctx);
+  RedisModule_FreeThreadSafeContext(ctx);
+  RediSearch_DropIndex(index);
+}
@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+#include <util/histogram.h>
+
+class HistogramTest : public ::testing::Test {};
+
+TEST_F(HistogramTest, testPercentiles) {
+  Histogram h = {0};
+  ASSERT_EQ(0, Histogram_Percentile(&h, 50));
+
+  for (uint64_t v = 1; v <= 1000; v++) {
+    Histogram_Record(&h, v);
+  }
+  ASSERT_EQ(1000, h.count);
+  ASSERT_EQ(500500, h.total);
+  ASSERT_EQ(1000, h.max);
+
+  // every percentile is reported within 1/HIST_SUB_BUCKETS above the exact value
+  double ps[] = {1, 10, 50, 90, 99, 99.9};
+  for (double p : ps) {
+    uint64_t exact = (uint64_t)(p * 10 + 0.5);
+    uint64_t v = Histogram_Percentile(&h, p);
+    ASSERT_GE(v, exact) << p;
+    ASSERT_LE(v, exact + exact / HIST_SUB_BUCKETS) << p;
+  }
+  ASSERT_EQ(1000, Histogram_Percentile(&h, 100));
+}
+
+TEST_F(HistogramTest, testSmallValues) {
+  Histogram h = {0};
+  for (uint64_t v = 0; v < HIST_SUB_BUCKETS; v++) {
+    Histogram_Record(&h, v);
+  }
+  // small values get a bucket each, and are exact
+  ASSERT_EQ(0, Histogram_Percentile(&h, 1));
+  ASSERT_EQ(3, Histogram_Percentile(&h, 50));
+  ASSERT_EQ(HIST_SUB_BUCKETS - 1, Histogram_Percentile(&h, 100));
+}
+
+TEST_F(HistogramTest, testOverflow) {
+  Histogram h = {0};
+  uint64_t huge = 1ULL << 40;
+  Histogram_Record(&h, 10);
+  Histogram_Record(&h, huge);
+  Histogram_Record(&h, huge + 1);
+  // values past the last bucket are reported as the largest one
+  ASSERT_EQ(huge + 1, Histogram_Percentile(&h, 50));
+  ASSERT_EQ(huge + 1, h.max);
+}
@@ -7,6 +7,7 @@
 #include "../spec.h"
 #include "../tokenize.h"
 #include "../varint.h"
+#include "../profile.h"
 #include "../rmutil/alloc.h"
 #include <assert.h>
 #include <math.h>
@@ -358,7 +359,7 @@ TEST_F(IndexTest, testNot) {
   // printf("Reading!\n");
   IndexIterator **irs = (IndexIterator **)calloc(2, sizeof(IndexIterator *));
   irs[0] = NewReadIterator(r1);
-  irs[1] = NewNotIterator(NewReadIterator(r2), w2->lastId, 1);
+  irs[1] = NewNotIterator(NewReadIterator(r2), w2->lastId, NULL, 1);
 
   IndexIterator *ui = NewIntersecIterator(irs, 2, NULL, RS_FIELDMASK_ALL, -1, 0, 1);
   RSIndexResult *h = NULL;
@@ -382,7 +383,7 @@ TEST_F(IndexTest, testPureNot) {
   IndexReader *r1 = NewTermIndexReader(w, NULL, RS_FIELDMASK_ALL, NULL, 1);  //
   printf("last id: %llu\n", (unsigned long long)w->lastId);
 
-  IndexIterator *ir = NewNotIterator(NewReadIterator(r1), w->lastId + 5, 1);
+  IndexIterator *ir = NewNotIterator(NewReadIterator(r1), w->lastId + 5, NULL, 1);
 
   RSIndexResult *h = NULL;
   int expected[] = {1,  2,  4,  5,  7,  8,  10, 11, 13, 14, 16, 17, 19,
@@ -397,6 +398,78 @@ TEST_F(IndexTest, testPureNot) {
   InvertedIndex_Free(w);
 }
 
+TEST_F(IndexTest, testPureNotUniverse) {
+  InvertedIndex *w = createIndex(10, 3);
+  IndexReader *r1 = NewTermIndexReader(w, NULL, RS_FIELDMASK_ALL, NULL, 1);
+
+  // only even ids are alive
+  Bitmap live;
+  Bitmap_Init(&live);
+  for (t_docId id = 2; id <= w->lastId + 5; id += 2) {
+    Bitmap_Set(&live, id);
+  }
+
+  IndexIterator *ir = NewNotIterator(NewReadIterator(r1), w->lastId + 5, &live, 1);
+  ASSERT_EQ(Bitmap_Card(&live), ir->NumEstimated(ir->ctx));
+
+  RSIndexResult *h = NULL;
+  int expected[] = {2, 4, 8, 10, 14, 16, 20, 22, 26, 28, 32, 34};
+  size_t i = 0;
+  while (ir->Read(ir->ctx, &h) != INDEXREAD_EOF) {
+    ASSERT_LT(i, sizeof(expected) / sizeof(expected[0]));
+    ASSERT_EQ(expected[i++], h->docId);
+  }
+  ASSERT_EQ(sizeof(expected) / sizeof(expected[0]), i);
+
+  // ids outside of the universe are never a match
+  ir->Rewind(ir->ctx);
+  ASSERT_EQ(INDEXREAD_NOTFOUND, ir->SkipTo(ir->ctx, 7, &h));
+  ASSERT_EQ(INDEXREAD_OK, ir->SkipTo(ir->ctx, 8, &h));
+  ASSERT_EQ(8, h->docId);
+
+  ir->Free(ir);
+  InvertedIndex_Free(w);
+  Bitmap_Cleanup(&live);
+}
+
+TEST_F(IndexTest, testWildcard) {
+  // without a live bitmap, all the ids up to maxId are returned
+  IndexIterator *it = NewWildcardIterator(5, NULL);
+  RSIndexResult *h = NULL;
+  for (t_docId id = 1; id <= 5; id++) {
+    ASSERT_EQ(INDEXREAD_OK, it->Read(it->ctx, &h));
+    ASSERT_EQ(id, h->docId);
+  }
+  ASSERT_EQ(INDEXREAD_EOF, it->Read(it->ctx, &h));
+  it->Free(it);
+
+  // with a live bitmap, deleted and unused ids are skipped - including whole empty chunks
+  Bitmap live;
+  Bitmap_Init(&live);
+  t_docId ids[] = {3, 64, 65, 9000, 20001};
+  for (auto id : ids) {
+    Bitmap_Set(&live, id);
+  }
+  it = NewWildcardIterator(20000, &live);
+  ASSERT_EQ(5, it->NumEstimated(it->ctx));
+  for (size_t i = 0; i < 4; i++) {
+    ASSERT_EQ(INDEXREAD_OK, it->Read(it->ctx, &h));
+    ASSERT_EQ(ids[i], h->docId);
+    ASSERT_EQ(ids[i], it->LastDocId(it->ctx));
+  }
+  // 20001 is live but beyond the top id of the iterator
+  ASSERT_EQ(INDEXREAD_EOF, it->Read(it->ctx, &h));
+
+  it->Rewind(it->ctx);
+  ASSERT_EQ(INDEXREAD_OK, it->SkipTo(it->ctx, 64, &h));
+  ASSERT_EQ(64, h->docId);
+  ASSERT_EQ(INDEXREAD_NOTFOUND, it->SkipTo(it->ctx, 100, &h));
+  ASSERT_EQ(9000, h->docId);
+  ASSERT_EQ(INDEXREAD_EOF, it->SkipTo(it->ctx, 9001, &h));
+  it->Free(it);
+  Bitmap_Cleanup(&live);
+}
+
 // Note -- in test_index.c, this test was never actually run!
 TEST_F(IndexTest, DISABLED_testOptional) {
   InvertedIndex *w = createIndex(16, 1);
@@ -626,6 +699,53 @@ TEST_F(IndexTest, testIntersection) {
   InvertedIndex_Free(w2);
 }
 
+TEST_F(IndexTest, testProfileIterator) {
+  InvertedIndex *w = createIndex(1000, 4);
+  InvertedIndex *w2 = createIndex(1000, 2);
+  IndexReader *r1 = NewTermIndexReader(w, NULL, RS_FIELDMASK_ALL, NULL, 1);
+  IndexReader *r2 = NewTermIndexReader(w2, NULL, RS_FIELDMASK_ALL, NULL, 1);
+
+  ProfileNode *root = NewProfileNode("ROOT", NULL, 0);
+  ProfileNode *n1 = NewProfileNode("TOKEN", "foo", 3);
+  ProfileNode *n2 = NewProfileNode("TOKEN", "bar", 3);
+  ProfileNode *ni = NewProfileNode("INTERSECT", NULL, 0);
+  ProfileNode_AddChild(root, ni);
+  ProfileNode_AddChild(ni, n1);
+  ProfileNode_AddChild(ni, n2);
+
+  IndexIterator **irs = (IndexIterator **)calloc(2, sizeof(IndexIterator *));
+  irs[0] = NewProfileIterator(NewReadIterator(r1), n1);
+  irs[1] = NewProfileIterator(NewReadIterator(r2), n2);
+  IndexIterator *ii = NewIntersecIterator(irs, 2, NULL, RS_FIELDMASK_ALL, -1, 0, 1);
+  ii = NewProfileIterator(ii, ni);
+  ASSERT_STREQ("INTERSECTION", ni->type);
+  ASSERT_STREQ("IIDX", n1->type);
+
+  RSIndexResult *h = NULL;
+  size_t count = 0;
+  while (ii->Read(ii->ctx, &h) != INDEXREAD_EOF) {
+    ASSERT_EQ((count + 1) * 4, h->docId);
+    ++count;
+  }
+  ASSERT_EQ(500, count);
+  ASSERT_FALSE(IITER_HAS_NEXT(ii));
+
+  // Every read of the intersection moves both children once, until the denser one is exhausted
+  ASSERT_EQ(count + 1, ni->numReads);
+  ASSERT_EQ(count, ni->numResults);
+  ASSERT_EQ(0, ni->numSkipTos);
+  ASSERT_EQ(count + 1, n1->numReads + n1->numSkipTos);
+  ASSERT_EQ(count + 1, n2->numReads + n2->numSkipTos);
+  ASSERT_EQ(count, n2->numResults);
+  ASSERT_LT(0, ni->wallNS);
+  ASSERT_LE(n1->wallNS + n2->wallNS, ni->wallNS);
+
+  ii->Free(ii);
+  ProfileNode_Free(root);
+  InvertedIndex_Free(w);
+  InvertedIndex_Free(w2);
+}
+
 TEST_F(IndexTest, testBuffer) {
   // TEST_START();
   Buffer b = {0};
@@ -962,7 +1082,7 @@ TEST_F(IndexTest, testDocTable) {
   ASSERT_EQ(N + 1, dt.size);
   ASSERT_EQ(N, dt.maxDocId);
 #ifdef __x86_64__
-  ASSERT_EQ(10980, (int)dt.memsize);
+  ASSERT_EQ(11780, (int)dt.memsize);
 #endif
   for (int i = 0; i < N; i++) {
     sprintf(buf, "doc_%d", i);
@@ -986,10 +1106,14 @@ TEST_F(IndexTest, testDocTable) {
     t_docId xid = DocIdMap_Get(&dt.dim, buf, strlen(buf));
 
     ASSERT_EQ((int)xid, i + 1);
+    ASSERT_TRUE(DocTable_IsLive(&dt, i + 1));
+    ASSERT_TRUE(DocTable_Exists(&dt, i + 1));
 
     int rc = DocTable_Delete(&dt, dmd->keyPtr, sdslen(dmd->keyPtr));
     ASSERT_EQ(1, rc);
     ASSERT_TRUE((int)(dmd->flags & Document_Deleted));
+    ASSERT_FALSE(DocTable_IsLive(&dt, i + 1));
+    ASSERT_FALSE(DocTable_Exists(&dt, i + 1));
     DMD_Decref(dmd);
     dmd = DocTable_Get(&dt, i + 1);
     ASSERT_TRUE(!dmd);
@@ -997,6 +1121,10 @@ TEST_F(IndexTest, testDocTable) {
 
   ASSERT_FALSE(DocIdMap_Get(&dt.dim, "foo bar", strlen("foo bar")));
   ASSERT_FALSE(DocTable_Get(&dt, N + 2));
+  ASSERT_FALSE(DocTable_IsLive(&dt, N + 2));
+  // all the documents were deleted, so the live bitmap should not hold any memory
+  ASSERT_EQ(0, Bitmap_Card(&dt.live));
+  ASSERT_EQ(0, dt.live.numAllocated);
 
   t_docId strDocId = DocTable_Put(&dt, "Hello", 5, 1.0, 0, NULL, 0);
   ASSERT_TRUE(0 != strDocId);
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include "int_index.h"
+#include "index.h"
+#include "util/bitmap.h"
+#include <vector>
+#include <random>
+
+class IntIndexTest : public ::testing::Test {};
+
+TEST_F(IntIndexTest, testBitmap) {
+  Bitmap bm;
+  Bitmap_Init(&bm);
+  ASSERT_EQ(0, Bitmap_Next(&bm, 1));
+
+  ASSERT_TRUE(Bitmap_Set(&bm, 3));
+  ASSERT_FALSE(Bitmap_Set(&bm, 3));
+  ASSERT_TRUE(Bitmap_Set(&bm, 100000));
+  ASSERT_EQ(2, Bitmap_Card(&bm));
+  ASSERT_TRUE(Bitmap_Test(&bm, 3));
+  ASSERT_FALSE(Bitmap_Test(&bm, 4));
+
+  ASSERT_EQ(3, Bitmap_Next(&bm, 1));
+  ASSERT_EQ(3, Bitmap_Next(&bm, 3));
+  ASSERT_EQ(100000, Bitmap_Next(&bm, 4));
+  ASSERT_EQ(0, Bitmap_Next(&bm, 100001));
+
+  ASSERT_TRUE(Bitmap_Clear(&bm, 100000));
+  ASSERT_FALSE(Bitmap_Clear(&bm, 100000));
+  ASSERT_EQ(1, Bitmap_Card(&bm));
+  ASSERT_EQ(1, bm.numAllocated);
+  ASSERT_EQ(0, Bitmap_Next(&bm, 4));
+  Bitmap_Cleanup(&bm);
+}
+
+static std::vector<t_docId> readAll(IndexIterator *it) {
+  std::vector<t_docId> ids;
+  RSIndexResult *res = NULL;
+  while (INDEXREAD_OK == it->Read(it->ctx, &res)) {
+    ids.push_back(res->docId);
+  }
+  return ids;
+}
+
+TEST_F(IntIndexTest, testRanges) {
+  IntIndex *idx = NewIntIndex();
+  std::mt19937_64 gen(1337);
+  const size_t N = 20000;
+  std::vector<int64_t> values(N + 1);
+  for (t_docId docId = 1; docId <= N; docId++) {
+    // spread values around zero, and leave some ids without a value
+    if (docId % 7 == 0) continue;
+    int64_t v = (int64_t)(gen() % 2000) - 1000;
+    if (docId % 101 == 0) v = docId % 2 ? INT64_MIN : INT64_MAX;
+    values[docId] = v;
+    IntIndex_Add(idx, docId, v);
+  }
+
+  struct {
+    int64_t min;
+    int64_t max;
+  } rngs[] = {{-1000, 1000}, {-5, 5}, {0, 0}, {-1, -1}, {500, 499}, {INT64_MIN, -999},
+              {999, INT64_MAX}, {INT64_MIN, INT64_MAX}, {INT64_MAX, INT64_MAX}};
+
+  for (auto &r : rngs) {
+    IndexIterator *it = NewIntIndexIterator(idx, r.min, r.max);
+    std::vector<t_docId> got = readAll(it);
+    std::vector<t_docId> expected;
+    for (t_docId docId = 1; docId <= N; docId++) {
+      if (docId % 7 && values[docId] >= r.min && values[docId] <= r.max) {
+        expected.push_back(docId);
+      }
+    }
+    ASSERT_EQ(expected, got) << r.min << ".." << r.max;
+    it->Free(it);
+  }
+
+  int64_t v;
+  ASSERT_TRUE(IntIndex_Get(idx, 1, &v));
+  ASSERT_EQ(values[1], v);
+  ASSERT_FALSE(IntIndex_Get(idx, 7, &v));
+  IntIndex_Free(idx);
+}
+
+TEST_F(IntIndexTest, testSkipTo) {
+  IntIndex *idx = NewIntIndex();
+  for (t_docId docId = 1; docId <= 10000; docId++) {
+    IntIndex_Add(idx, docId, docId % 10);
+  }
+  IndexIterator *it = NewIntIndexIterator(idx, 3, 3);
+  RSIndexResult *res = NULL;
+  ASSERT_EQ(INDEXREAD_OK, it->SkipTo(it->ctx, 5003, &res));
+  ASSERT_EQ(5003, res->docId);
+  ASSERT_EQ(INDEXREAD_NOTFOUND, it->SkipTo(it->ctx, 5004, &res));
+  ASSERT_EQ(5013, res->docId);
+  ASSERT_EQ(INDEXREAD_EOF, it->SkipTo(it->ctx, 9994, &res));
+  it->Rewind(it->ctx);
+  ASSERT_EQ(INDEXREAD_OK, it->Read(it->ctx, &res));
+  ASSERT_EQ(3, res->docId);
+  it->Free(it);
+  IntIndex_Free(idx);
+}
+
+TEST_F(IntIndexTest, testFilterBounds) {
+  int64_t min, max;
+  NumericFilter *f = NewNumericFilter(1.5, 10, 1, 0);
+  ASSERT_TRUE(IntIndex_FilterBounds(f, &min, &max));
+  ASSERT_EQ(2, min);
+  ASSERT_EQ(9, max);
+  NumericFilter_Free(f);
+
+  f = NewNumericFilter(NF_NEGATIVE_INFINITY, NF_INFINITY, 0, 0);
+  ASSERT_TRUE(IntIndex_FilterBounds(f, &min, &max));
+  ASSERT_EQ(INT64_MIN, min);
+  ASSERT_EQ(INT64_MAX, max);
+  NumericFilter_Free(f);
+
+  f = NewNumericFilter(5, 5, 0, 1);
+  ASSERT_FALSE(IntIndex_FilterBounds(f, &min, &max));
+  NumericFilter_Free(f);
+}
@@ -2,7 +2,9 @@
 #include <gtest/gtest.h>
 #include <set>
 #include <string>
+#include <vector>
 #include "common.h"
+#include "concurrent_ctx.h"
 
 #define DOCID1 "doc1"
 #define DOCID2 "doc2"
@@ -745,4 +747,204 @@ TEST_F(LLApiTest, duplicateFieldAdd) {
 
   RediSearch_FreeDocument(d);
   RediSearch_DropIndex(index);
-}
\ No newline at end of file
+}
+
+TEST_F(LLApiTest, testBulkLoad) {
+  RSIndex* index = RediSearch_CreateIndex("index", NULL);
+  RediSearch_CreateField(index, FIELD_NAME_1, RSFLDTYPE_FULLTEXT, RSFLDOPT_NONE);
+  RediSearch_CreateField(index, NUMERIC_FIELD_NAME, RSFLDTYPE_NUMERIC, RSFLDOPT_NONE);
+
+  RSDoc* d = RediSearch_CreateDocumentSimple("existing");
+  RediSearch_DocumentAddFieldCString(d, FIELD_NAME_1, "old text", RSFLDTYPE_DEFAULT);
+  RediSearch_SpecAddDocument(index, d);
+
+  // enough documents for several batches, tokenized on the indexing pool, which the loader starts
+  const size_t numDocs = 1500;
+  RSBulkLoader* bl = RediSearch_BeginBulkLoad(index);
+  ASSERT_NE(-1, CONCURRENT_POOL_INDEX);
+  char buf[64];
+  for (size_t ii = 0; ii < numDocs; ++ii) {
+    sprintf(buf, "doc%lu", ii);
+    d = RediSearch_CreateDocumentSimple(buf);
+    sprintf(buf, "common term%lu %s", ii, ii % 2 ? "odd" : "even");
+    RediSearch_DocumentAddFieldCString(d, FIELD_NAME_1, buf, RSFLDTYPE_DEFAULT);
+    RediSearch_DocumentAddFieldNumber(d, NUMERIC_FIELD_NAME, ii, RSFLDTYPE_DEFAULT);
+    ASSERT_EQ(REDISMODULE_OK, RediSearch_BulkAdd(bl, d, 0, NULL));
+  }
+
+  // existing documents are only replaced when asked to
+  char* err = NULL;
+  d = RediSearch_CreateDocumentSimple("existing");
+  RediSearch_DocumentAddFieldCString(d, FIELD_NAME_1, "new text", RSFLDTYPE_DEFAULT);
+  ASSERT_EQ(REDISMODULE_ERR, RediSearch_BulkAdd(bl, d, 0, &err));
+  ASSERT_STREQ("Document already exists", err);
+  rm_free(err);
+  err = NULL;
+  d = RediSearch_CreateDocumentSimple("existing");
+  RediSearch_DocumentAddFieldCString(d, FIELD_NAME_1, "new text", RSFLDTYPE_DEFAULT);
+  ASSERT_EQ(REDISMODULE_OK, RediSearch_BulkAdd(bl, d, REDISEARCH_ADD_REPLACE, NULL));
+  ASSERT_EQ(REDISMODULE_OK, RediSearch_EndBulkLoad(bl, &err));
+  ASSERT_TRUE(err == NULL);
+
+  ASSERT_EQ(numDocs, search(index, "common").size());
+  ASSERT_EQ(numDocs / 2, search(index, "odd").size());
+  std::vector<std::string> res = search(index, "term1234");
+  ASSERT_EQ(1, res.size());
+  ASSERT_EQ("doc1234", res[0]);
+  ASSERT_EQ(100, search(index, "@num:[1000 1099]").size());
+  ASSERT_TRUE(search(index, "old").empty());
+  ASSERT_EQ(1, search(index, "new").size());
+
+  // a document added twice to the same load is rejected when it is indexed
+  bl = RediSearch_BeginBulkLoad(index);
+  for (int ii = 0; ii < 2; ++ii) {
+    d = RediSearch_CreateDocumentSimple("twice");
+    RediSearch_DocumentAddFieldCString(d, FIELD_NAME_1, "twice", RSFLDTYPE_DEFAULT);
+    ASSERT_EQ(REDISMODULE_OK, RediSearch_BulkAdd(bl, d, 0, NULL));
+  }
+  ASSERT_EQ(REDISMODULE_ERR, RediSearch_EndBulkLoad(bl, &err));
+  ASSERT_TRUE(err != NULL);
+  rm_free(err);
+  ASSERT_EQ(1, search(index, "twice").size());
+
+  RediSearch_DropIndex(index);
+}
+
+TEST_F(LLApiTest, testResultsBatch) {
+  RSIndex* index = RediSearch_CreateIndex("index", NULL);
+  RediSearch_CreateField(index, FIELD_NAME_1, RSFLDTYPE_FULLTEXT, RSFLDOPT_SORTABLE);
+  RediSearch_CreateField(index, NUMERIC_FIELD_NAME, RSFLDTYPE_NUMERIC, RSFLDOPT_SORTABLE);
+
+  char buf[64];
+  for (size_t ii = 0; ii < 10; ++ii) {
+    sprintf(buf, "doc%lu", ii);
+    RSDoc* d = RediSearch_CreateDocumentSimple(buf);
+    sprintf(buf, "hello %s", ii % 2 ? "odd" : "even");
+    RediSearch_DocumentAddFieldCString(d, FIELD_NAME_1, buf, RSFLDTYPE_DEFAULT);
+    // the last document has no numeric value
+    if (ii < 9) {
+      RediSearch_DocumentAddFieldNumber(d, NUMERIC_FIELD_NAME, ii * 10, RSFLDTYPE_DEFAULT);
+    }
+    RediSearch_SpecAddDocument(index, d);
+  }
+
+  const size_t n = 4;
+  RSDocId ids[n];
+  double scores[n];
+  const char* keys[n];
+  size_t keyLens[n];
+  const char* columns[] = {NUMERIC_FIELD_NAME, FIELD_NAME_1, "nosuchfield"};
+  RSColumnValue values[3 * n];
+  RSResultsBatch batch = {.ids = ids,
+                          .scores = scores,
+                          .keys = keys,
+                          .keyLens = keyLens,
+                          .columns = columns,
+                          .numColumns = 3,
+                          .values = values};
+
+  RSResultsIterator* it = RediSearch_IterateQuery(index, "hello", strlen("hello"), NULL);
+  ASSERT_TRUE(it != NULL);
+  size_t total = 0, nread;
+  while ((nread = RediSearch_ResultsIteratorNextBatch(it, index, &batch, n))) {
+    ASSERT_LE(nread, n);
+    for (size_t r = 0; r < nread; ++r, ++total) {
+      sprintf(buf, "doc%lu", total);
+      ASSERT_EQ(std::string(buf), std::string(keys[r], keyLens[r]));
+      size_t len;
+      ASSERT_EQ(std::string(buf), (const char*)RediSearch_GetDocumentKey(index, ids[r], &len));
+      ASSERT_GT(scores[r], 0);
+      if (total < 9) {
+        ASSERT_EQ(RSVALTYPE_DOUBLE, values[r].type);
+        ASSERT_EQ(total * 10, values[r].num);
+      } else {
+        ASSERT_EQ(RSVALTYPE_NOTFOUND, values[r].type);
+      }
+      ASSERT_EQ(RSVALTYPE_STRING, values[n + r].type);
+      ASSERT_EQ(std::string(total % 2 ? "hello odd" : "hello even"),
+                std::string(values[n + r].str, values[n + r].len));
+      ASSERT_EQ(RSVALTYPE_NOTFOUND, values[2 * n + r].type);
+    }
+  }
+  ASSERT_EQ(10, total);
+  RediSearch_ResultsIteratorFree(it);
+
+  // only the ids
+  RSResultsBatch idsOnly = {.ids = ids};
+  it = RediSearch_IterateQuery(index, "odd", strlen("odd"), NULL);
+  ASSERT_EQ(n, RediSearch_ResultsIteratorNextBatch(it, index, &idsOnly, n));
+  ASSERT_EQ(1, RediSearch_ResultsIteratorNextBatch(it, index, &idsOnly, n));
+  ASSERT_EQ(0, RediSearch_ResultsIteratorNextBatch(it, index, &idsOnly, n));
+  RediSearch_ResultsIteratorFree(it);
+
+  // deleted documents are still in the inverted index, and are skipped, with or without their
+  // metadata
+  RediSearch_DropDocument(index, "doc2", strlen("doc2"));
+  RediSearch_DropDocument(index, "doc5", strlen("doc5"));
+  it = RediSearch_IterateQuery(index, "hello", strlen("hello"), NULL);
+  ASSERT_EQ(n, RediSearch_ResultsIteratorNextBatch(it, index, &idsOnly, n));
+  ASSERT_EQ(n, RediSearch_ResultsIteratorNextBatch(it, index, &batch, n));
+  std::vector<std::string> got;
+  for (size_t r = 0; r < n; ++r) {
+    got.push_back(std::string(keys[r], keyLens[r]));
+  }
+  ASSERT_EQ(std::vector<std::string>({"doc6", "doc7", "doc8", "doc9"}), got);
+  ASSERT_EQ(0, RediSearch_ResultsIteratorNextBatch(it, index, &idsOnly, n));
+  RediSearch_ResultsIteratorFree(it);
+
+  RediSearch_DropIndex(index);
+}
+
+TEST_F(LLApiTest, testResultsBitmap) {
+  RSIndex* index = RediSearch_CreateIndex("index", NULL);
+  RediSearch_CreateField(index, FIELD_NAME_1, RSFLDTYPE_FULLTEXT, RSFLDOPT_NONE);
+
+  // documents spread over several bitmap chunks
+  const size_t numDocs = 10000;
+  char buf[64];
+  for (size_t ii = 0; ii < numDocs; ++ii) {
+    sprintf(buf, "doc%lu", ii);
+    RSDoc* d = RediSearch_CreateDocumentSimple(buf);
+    sprintf(buf, "%s %s", ii % 2 ? "odd" : "even", ii % 3 ? "other" : "three");
+    RediSearch_DocumentAddFieldCString(d, FIELD_NAME_1, buf, RSFLDTYPE_DEFAULT);
+    RediSearch_SpecAddDocument(index, d);
+  }
+  RediSearch_DropDocument(index, "doc3", strlen("doc3"));
+
+  auto getBitmap = [&](const char* q) {
+    RSResultsIterator* it = RediSearch_IterateQuery(index, q, strlen(q), NULL);
+    RSResultsBitmap* bm = RediSearch_ResultsIteratorGetBitmap(it, index);
+    RediSearch_ResultsIteratorFree(it);
+    return bm;
+  };
+
+  RSResultsBitmap* odd = getBitmap("odd");
+  RSResultsBitmap* three = getBitmap("three");
+  ASSERT_EQ(numDocs / 2 - 1, RediSearch_BitmapCardinality(odd));
+  ASSERT_EQ(numDocs / 3, RediSearch_BitmapCardinality(three));
+
+  // odd multiples of three, besides the deleted doc3
+  RSResultsBitmap* both = getBitmap("odd");
+  RediSearch_BitmapAnd(both, three);
+  size_t count = 0;
+  for (RSDocId id = RediSearch_BitmapNext(both, 1); id; id = RediSearch_BitmapNext(both, id + 1)) {
+    size_t len;
+    const char* key = (const char*)RediSearch_GetDocumentKey(index, id, &len);
+    ASSERT_TRUE(key != NULL);
+    size_t num = atol(std::string(key + 3, len - 3).c_str());
+    ASSERT_TRUE(num % 2 == 1 && num % 3 == 0);
+    count++;
+  }
+  ASSERT_EQ(count, RediSearch_BitmapCardinality(both));
+  ASSERT_EQ(1666, count);
+
+  RediSearch_BitmapOr(both, odd);
+  ASSERT_EQ(numDocs / 2 - 1, RediSearch_BitmapCardinality(both));
+  RediSearch_BitmapAndNot(both, three);
+  ASSERT_EQ(numDocs / 2 - 1 - 1666, RediSearch_BitmapCardinality(both));
+
+  RediSearch_BitmapFree(odd);
+  RediSearch_BitmapFree(three);
+  RediSearch_BitmapFree(both);
+  RediSearch_DropIndex(index);
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "slowlog.h"
+#include "config.h"
+
+class SlowlogTest : public ::testing::Test {
+ protected:
+  long long threshold;
+  size_t maxLen;
+
+  void SetUp() override {
+    threshold = RSGlobalConfig.slowlogLogSlowerThan;
+    maxLen = RSGlobalConfig.slowlogMaxLen;
+    Slowlog_Reset();
+  }
+
+  void TearDown() override {
+    RSGlobalConfig.slowlogLogSlowerThan = threshold;
+    RSGlobalConfig.slowlogMaxLen = maxLen;
+    Slowlog_Reset();
+  }
+
+  static SlowlogQuery query(uint64_t durationUS) {
+    static const char *args[] = {"hello world", "LIMIT", "0", "10"};
+    SlowlogQuery q = {0};
+    q.command = "FT.SEARCH";
+    q.index = "idx";
+    q.args = args;
+    q.nargs = 4;
+    q.durationNS = durationUS * 1000;
+    return q;
+  }
+};
+
+TEST_F(SlowlogTest, testThreshold) {
+  RSGlobalConfig.slowlogLogSlowerThan = 100;
+  SlowlogQuery q = query(99);
+  ASSERT_FALSE(Slowlog_Add(&q));
+  q = query(100);
+  ASSERT_TRUE(Slowlog_Add(&q));
+  ASSERT_EQ(1, Slowlog_Len());
+
+  // a negative threshold disables the log
+  RSGlobalConfig.slowlogLogSlowerThan = -1;
+  ASSERT_FALSE(Slowlog_IsEnabled());
+  q = query(1000000);
+  ASSERT_FALSE(Slowlog_Add(&q));
+  ASSERT_EQ(1, Slowlog_Len());
+
+  Slowlog_Reset();
+  ASSERT_EQ(0, Slowlog_Len());
+}
+
+TEST_F(SlowlogTest, testMaxLen) {
+  RSGlobalConfig.slowlogLogSlowerThan = 0;
+  RSGlobalConfig.slowlogMaxLen = 4;
+  for (int i = 0; i < 10; i++) {
+    SlowlogQuery q = query(i);
+    ASSERT_TRUE(Slowlog_Add(&q));
+    ASSERT_EQ(i < 4 ? i + 1 : 4, Slowlog_Len());
+  }
+
+  // shrinking the log keeps the newest entries, and growing it keeps them all
+  RSGlobalConfig.slowlogMaxLen = 2;
+  SlowlogQuery q = query(0);
+  Slowlog_Add(&q);
+  ASSERT_EQ(2, Slowlog_Len());
+  RSGlobalConfig.slowlogMaxLen = 8;
+  Slowlog_Add(&q);
+  ASSERT_EQ(3, Slowlog_Len());
+
+  RSGlobalConfig.slowlogMaxLen = 0;
+  ASSERT_FALSE(Slowlog_Add(&q));
+  ASSERT_EQ(0, Slowlog_Len());
+}
+
+TEST_F(SlowlogTest, testLongQuery) {
+  RSGlobalConfig.slowlogLogSlowerThan = 0;
+  std::string longArg(SLOWLOG_ENTRY_MAX_STRING * 2, 'x');
+  const char *args[SLOWLOG_ENTRY_MAX_ARGC * 2];
+  for (size_t i = 0; i < SLOWLOG_ENTRY_MAX_ARGC * 2; i++) {
+    args[i] = longArg.c_str();
+  }
+  SlowlogQuery q = query(0);
+  q.args = args;
+  q.nargs = SLOWLOG_ENTRY_MAX_ARGC * 2;
+  ASSERT_TRUE(Slowlog_Add(&q));
+  ASSERT_EQ(1, Slowlog_Len());
+}
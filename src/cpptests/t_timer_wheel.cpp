@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include <util/timer_wheel.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+class TimerWheelTest : public ::testing::Test {};
+
+static std::vector<uint64_t> expiries(DLLIST *expired) {
+  std::vector<uint64_t> ret;
+  DLLIST_FOREACH(it, expired) {
+    ret.push_back(DLLIST_ITEM(it, TimerWheelNode, llnode)->expiry);
+  }
+  return ret;
+}
+
+TEST_F(TimerWheelTest, testExpireInOrder) {
+  TimerWheel w;
+  TimerWheel_Init(&w, 1000);
+  // timers on every level of the wheel, and beyond its span
+  std::vector<uint64_t> ticks = {1001, 1063, 1064, 1100, 5000, 70000, 300000, 20000000, 40000000};
+  std::vector<TimerWheelNode> nodes(ticks.size());
+  for (size_t i = 0; i < ticks.size(); i++) {
+    TimerWheel_Add(&w, &nodes[i], ticks[i]);
+  }
+  ASSERT_EQ(ticks.size(), w.count);
+
+  for (size_t i = 0; i < ticks.size(); i++) {
+    DLLIST expired;
+    dllist_init(&expired);
+    // nothing expires a tick early
+    ASSERT_EQ(0, TimerWheel_Advance(&w, ticks[i] - 1, &expired));
+    ASSERT_EQ(1, TimerWheel_Advance(&w, ticks[i], &expired)) << ticks[i];
+    ASSERT_EQ(std::vector<uint64_t>{ticks[i]}, expiries(&expired));
+  }
+  ASSERT_EQ(0, w.count);
+}
+
+TEST_F(TimerWheelTest, testRemove) {
+  TimerWheel w;
+  TimerWheel_Init(&w, 0);
+  TimerWheelNode a = {0}, b = {0}, c = {0};
+  TimerWheel_Add(&w, &a, 10);
+  TimerWheel_Add(&w, &b, 10);
+  TimerWheel_Add(&w, &c, 5000);
+  ASSERT_TRUE(TimerWheel_IsQueued(&a));
+  TimerWheel_Remove(&w, &a);
+  TimerWheel_Remove(&w, &c);
+  ASSERT_FALSE(TimerWheel_IsQueued(&a));
+  ASSERT_EQ(1, w.count);
+
+  DLLIST expired;
+  dllist_init(&expired);
+  ASSERT_EQ(1, TimerWheel_Advance(&w, 10000, &expired));
+  ASSERT_EQ(&b.llnode, expired.next);
+
+  // a timer added after its expiry expires on the next tick
+  TimerWheel_Add(&w, &a, 10);
+  dllist_init(&expired);
+  ASSERT_EQ(0, TimerWheel_Advance(&w, 10000, &expired));
+  ASSERT_EQ(1, TimerWheel_Advance(&w, 10001, &expired));
+}
+
+TEST_F(TimerWheelTest, testRandom) {
+  std::mt19937_64 rng(42);
+  TimerWheel w;
+  TimerWheel_Init(&w, 12345);
+  std::vector<TimerWheelNode> nodes(5000);
+  for (auto &n : nodes) {
+    n = {0};
+    TimerWheel_Add(&w, &n, 12345 + rng() % 40000000);
+  }
+
+  // advancing by uneven steps expires every timer once its tick is reached
+  uint64_t now = 12345;
+  size_t total = 0;
+  while (total < nodes.size()) {
+    now += 1 + rng() % 100000;
+    DLLIST expired;
+    dllist_init(&expired);
+    total += TimerWheel_Advance(&w, now, &expired);
+    for (uint64_t e : expiries(&expired)) {
+      ASSERT_LE(e, now);
+    }
+    // take the expired timers off the list: the ones left in the wheel did not expire yet
+    while (!(DLLIST_IS_EMPTY(&expired))) {
+      dllist_delete(expired.next);
+    }
+    for (auto &n : nodes) {
+      ASSERT_TRUE(!TimerWheel_IsQueued(&n) || n.expiry > now);
+    }
+  }
+  ASSERT_EQ(0, w.count);
+}
@@ -2,6 +2,9 @@
 #include "stemmer.h"
 #include "tokenize.h"
 #include <set>
+#include <vector>
+#include <random>
+#include <cctype>
 
 class TokenizerTest : public ::testing::Test {};
 
@@ -120,4 +123,72 @@ TEST_F(TokenizerTest, testTrailingEscapes) {
   ASSERT_NE(tokens.end(), tokens.find("world "));  // note the space
   tk->Free(tk);
   free(txt);
-}
\ No newline at end of file
+}
+// The tokens of the simple tokenizer, as the scalar code splits and normalizes them
+static std::vector<std::string> referenceTokens(const std::string &txt) {
+  static const std::string seps(" \t,./(){}[]:;~!@#$%^&*-=+|'`\"<>?");
+  std::vector<std::string> raw;
+  size_t start = 0;
+  for (size_t i = 0; i < txt.size(); i++) {
+    if (seps.find(txt[i]) != std::string::npos && (i == start || txt[i - 1] != '\\')) {
+      raw.push_back(txt.substr(start, i - start));
+      start = i + 1;
+    }
+  }
+  if (start < txt.size()) {
+    raw.push_back(txt.substr(start));
+  }
+
+  std::vector<std::string> ret;
+  for (const auto &tok : raw) {
+    std::string norm;
+    bool escaped = false;
+    for (char c : tok) {
+      int uc = (unsigned char)c;
+      if (isupper(uc)) {
+        norm += tolower(uc);
+      } else if ((isblank(uc) && !escaped) || iscntrl(uc)) {
+      } else if (c == '\\' && !escaped) {
+        escaped = true;
+        continue;
+      } else {
+        norm += c;
+      }
+      escaped = false;
+    }
+    if (!norm.empty()) {
+      ret.push_back(norm);
+    }
+  }
+  return ret;
+}
+
+TEST_F(TokenizerTest, testFuzzAgainstScalar) {
+  // Mostly long words, so that the vectorized paths see whole blocks and tails at every alignment
+  static const char *pieces[] = {"a", "Z", "hello", "WORLD", "x_y", " ", "  ", "\\", "-", ".",
+                                 "\t", "\x01", "\x7f", "\xd7\xa9", "\xc3\x89", "~", "`", "_",
+                                 "abcdefghijklmnopqrstuvwxyz", "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123"};
+  std::mt19937 rng(42);
+  RSTokenizer *tk = GetSimpleTokenizer(NULL, NULL);
+  for (size_t n = 0; n < 5000; n++) {
+    std::string txt;
+    size_t npieces = rng() % 40;
+    for (size_t i = 0; i < npieces; i++) {
+      txt += pieces[rng() % (sizeof(pieces) / sizeof(*pieces))];
+    }
+    std::vector<std::string> expected = referenceTokens(txt);
+
+    // shift the text so that it starts at every offset of a block
+    size_t offset = n % 16;
+    std::vector<char> buf(offset + txt.size() + 1);
+    memcpy(buf.data() + offset, txt.c_str(), txt.size() + 1);
+    tk->Start(tk, buf.data() + offset, txt.size(), TOKENIZE_NOSTEM);
+    Token tok;
+    std::vector<std::string> got;
+    while (tk->Next(tk, &tok)) {
+      got.push_back(std::string(tok.tok, tok.tokLen));
+    }
+    ASSERT_EQ(expected, got) << "text: " << txt;
+  }
+  tk->Free(tk);
+}
@@ -2,6 +2,10 @@
 #include <trie/trie.h>
 #include <trie/trie_type.h>
 #include <set>
+#include <map>
+#include <vector>
+#include <random>
+#include <algorithm>
 #include <string>
 
 typedef std::set<std::string> ElemSet;
@@ -41,17 +45,17 @@ static ElemSet trieIterRange(Trie *t, const char *begin, size_t nbegin, const ch
   }
 
   ElemSet foundElements;
-  TrieNode_IterateRange(t->root, r1Ptr, nr1, true, r2Ptr, nr2, false,
-                        [](const rune *u16, size_t nrune, void *ctx) {
-                          size_t n;
-                          char *s = runesToStr(u16, nrune, &n);
-                          std::string xs(s, n);
-                          free(s);
-                          ElemSet *e = (ElemSet *)ctx;
-                          ASSERT_EQ(e->end(), e->find(xs));
-                          e->insert(xs);
-                        },
-                        &foundElements);
+  Trie_IterateRange(t, r1Ptr, nr1, true, r2Ptr, nr2, false,
+                    [](const rune *u16, size_t nrune, void *ctx) {
+                      size_t n;
+                      char *s = runesToStr(u16, nrune, &n);
+                      std::string xs(s, n);
+                      free(s);
+                      ElemSet *e = (ElemSet *)ctx;
+                      ASSERT_EQ(e->end(), e->find(xs));
+                      e->insert(xs);
+                    },
+                    &foundElements);
   return foundElements;
 }
 
@@ -119,3 +123,497 @@ TEST_F(TrieTest, testDeepEntry) {
   ASSERT_EQ(maxbuf, ret.size());
   TrieType_Free(t);
 }
+
+TEST_F(TrieTest, testFrozenRange) {
+  Trie *t = NewTrie();
+  // half of the entries in each layer
+  for (size_t ii = 0; ii < 1000; ++ii) {
+    char buf[64];
+    sprintf(buf, "%lu", (unsigned long)ii);
+    ASSERT_TRUE(trieInsert(t, buf));
+    if (ii == 500) {
+      Trie_Freeze(t);
+    }
+  }
+  ASSERT_EQ(1000, t->size);
+  ASSERT_EQ(501, t->frozen->size);
+
+  ASSERT_EQ(111, trieIterRange(t, "1", "1Z").size());
+  ASSERT_EQ(1000, trieIterRange(t, NULL, NULL).size());
+  ASSERT_EQ(1, trieIterRange(t, "1", "1").size());
+  ASSERT_EQ(1, trieIterRange(t, "999", "999").size());
+  ASSERT_EQ(1, trieIterRange(t, "10", 2, "10\x01", 3).size());
+  ASSERT_EQ(445, trieIterRange(t, NULL, "5").size());
+  TrieType_Free(t);
+}
+
+static ElemSet trieIterAll(Trie *t, const char *prefix, int maxDist, int prefixMode) {
+  TrieIterator *it = Trie_Iterate(t, prefix, strlen(prefix), maxDist, prefixMode);
+  ElemSet found;
+  rune *rstr;
+  t_len len;
+  float score;
+  RSPayload payload = {.data = NULL, .len = 0};
+  while (TrieIterator_Next(it, &rstr, &len, &payload, &score, NULL)) {
+    size_t n;
+    char *s = runesToStr(rstr, len, &n);
+    std::string xs(s, n);
+    free(s);
+    EXPECT_EQ(found.end(), found.find(xs));
+    found.insert(xs);
+  }
+  DFAFilter_Free((DFAFilter *)it->ctx);
+  free(it->ctx);
+  TrieIterator_Free(it);
+  return found;
+}
+
+TEST_F(TrieTest, testFrozenLayers) {
+  Trie *t = NewTrie();
+  const char *frozen[] = {"hello", "help", "helm", "world", "word"};
+  for (auto s : frozen) {
+    ASSERT_TRUE(Trie_InsertStringBuffer(t, s, strlen(s), 1, 0, NULL));
+  }
+  Trie_Freeze(t);
+  ASSERT_EQ(5, t->frozen->size);
+  ASSERT_EQ(0, t->root->numChildren);
+
+  ASSERT_TRUE(Trie_InsertStringBuffer(t, "helium", 6, 3, 0, NULL));
+  // existing entries are moved to the mutable layer, and are not counted twice
+  ASSERT_FALSE(Trie_InsertStringBuffer(t, "help", 4, 4, 1, NULL));
+  ASSERT_EQ(6, t->size);
+  ASSERT_EQ(4, t->frozen->size);
+
+  ASSERT_EQ(ElemSet({"hello", "help", "helm", "helium"}), trieIterAll(t, "hel", 0, 1));
+  ASSERT_EQ(ElemSet({"word", "world"}), trieIterAll(t, "wor", 0, 1));
+  ASSERT_EQ(ElemSet({"helm", "help", "hello"}), trieIterAll(t, "helo", 1, 0));
+
+  // the incremented score of help beats the rest
+  Vector *res = Trie_Search(t, "he", 2, 2, 0, 1, 0, 0);
+  ASSERT_EQ(2, Vector_Size(res));
+  TrieSearchResult *e;
+  Vector_Get(res, 0, &e);
+  ASSERT_EQ(std::string("help"), std::string(e->str, e->len));
+  Vector_Get(res, 1, &e);
+  ASSERT_EQ(std::string("helium"), std::string(e->str, e->len));
+  for (size_t i = 0; i < Vector_Size(res); i++) {
+    Vector_Get(res, i, &e);
+    TrieSearchResult_Free(e);
+  }
+  Vector_Free(res);
+
+  ASSERT_TRUE(Trie_Delete(t, "world", 5));
+  ASSERT_TRUE(Trie_Delete(t, "helium", 6));
+  ASSERT_FALSE(Trie_Delete(t, "world", 5));
+  ASSERT_EQ(4, t->size);
+  ASSERT_EQ(ElemSet({"word"}), trieIterAll(t, "wor", 0, 1));
+
+  // a frozen entry whose score is incremented to 0 is removed
+  ASSERT_TRUE(Trie_InsertStringBuffer(t, "wore", 4, 1, 0, NULL));
+  Trie_Freeze(t);
+  ASSERT_FALSE(Trie_InsertStringBuffer(t, "wore", 4, -1, 1, NULL));
+  ASSERT_EQ(4, t->size);
+  ASSERT_EQ(ElemSet({"word"}), trieIterAll(t, "wor", 0, 1));
+
+  // merging keeps the entries and their scores
+  Trie_Freeze(t);
+  ASSERT_EQ(4, t->frozen->size);
+  ASSERT_EQ(ElemSet({"hello", "help", "helm", "word"}), trieIterAll(t, "", 0, 1));
+  for (int i = 0; i < 20; i++) {
+    char *s;
+    t_len len;
+    double score;
+    ASSERT_TRUE(Trie_RandomKey(t, &s, &len, &score));
+    std::string xs(s, len);
+    free(s);
+    ASSERT_EQ(xs == "help" ? 5 : 1, score) << xs;
+  }
+  ASSERT_GT(Trie_MemUsage(t), 0);
+  TrieType_Free(t);
+}
+
+static std::map<std::string, float> trieEntries(Trie *t) {
+  TrieIterator *it = Trie_Iterate(t, "", 0, 0, 1);
+  std::map<std::string, float> found;
+  rune *rstr;
+  t_len len;
+  float score;
+  while (TrieIterator_Next(it, &rstr, &len, NULL, &score, NULL)) {
+    size_t n;
+    char *s = runesToStr(rstr, len, &n);
+    std::string xs(s, n);
+    free(s);
+    EXPECT_EQ(found.end(), found.find(xs));
+    found[xs] = score;
+  }
+  DFAFilter_Free((DFAFilter *)it->ctx);
+  free(it->ctx);
+  TrieIterator_Free(it);
+  return found;
+}
+
+TEST_F(TrieTest, testIncrementalMerge) {
+  Trie *t = NewTrie();
+  std::map<std::string, float> entries;
+  auto add = [&](const std::string &s, float score, int incr) {
+    Trie_InsertStringBuffer(t, s.c_str(), s.size(), score, incr, NULL);
+    entries[s] = incr && entries.count(s) ? entries[s] + score : score;
+  };
+  for (int i = 0; i < 1000; i++) {
+    add("f" + std::to_string(i), 1, 0);
+  }
+  Trie_Freeze(t);
+
+  // fill the delta until a merge starts. It starts by moving the frozen entries to the delta
+  int numDelta = 0;
+  while (!t->merge) {
+    add("d" + std::to_string(numDelta++), 1, 0);
+  }
+  ASSERT_EQ(TRIE_DELTA_MERGE_MIN, numDelta);
+  ASSERT_TRUE(t->frozen != NULL);
+  ASSERT_GT(t->frozen->size, 0);
+
+  // keep writing to every layer until the merge is done
+  std::mt19937 gen(5);
+  bool sawSealed = false;
+  for (int i = 0; t->merge; i++) {
+    sawSealed |= t->sealed != NULL;
+    add("n" + std::to_string(i), 2, 0);
+    add("f" + std::to_string(gen() % 1000), 1, 1);
+    std::string del = "d" + std::to_string(gen() % numDelta);
+    ASSERT_EQ(entries.erase(del), Trie_Delete(t, del.c_str(), del.size())) << del;
+    ASSERT_EQ(entries.size(), t->size);
+
+    if (i % 64 == 0) {
+      ASSERT_EQ(entries, trieEntries(t));
+      // prefix searches see all the layers too
+      auto it = std::next(entries.begin(), gen() % entries.size());
+      Vector *res = Trie_Search(t, it->first.c_str(), it->first.size(), 1, 0, 1, 0, 0);
+      ASSERT_EQ(1, Vector_Size(res));
+      TrieSearchResult *e;
+      Vector_Get(res, 0, &e);
+      ASSERT_EQ(it->first, std::string(e->str, e->len));
+      TrieSearchResult_Free(e);
+      Vector_Free(res);
+    }
+  }
+  ASSERT_TRUE(sawSealed);
+  ASSERT_TRUE(t->sealed == NULL);
+  ASSERT_EQ(entries, trieEntries(t));
+
+  Trie_Freeze(t);
+  ASSERT_EQ(entries.size(), t->frozen->size);
+  ASSERT_EQ(entries, trieEntries(t));
+  TrieType_Free(t);
+}
+
+static int levDistance(const std::string &a, const std::string &b) {
+  std::vector<int> prev(b.size() + 1), cur(b.size() + 1);
+  for (size_t j = 0; j <= b.size(); j++) prev[j] = j;
+  for (size_t i = 1; i <= a.size(); i++) {
+    cur[0] = i;
+    for (size_t j = 1; j <= b.size(); j++) {
+      cur[j] = std::min({prev[j] + 1, cur[j - 1] + 1, prev[j - 1] + (a[i - 1] != b[j - 1])});
+    }
+    std::swap(prev, cur);
+  }
+  return prev[b.size()];
+}
+
+TEST_F(TrieTest, testLevenshteinFilter) {
+  Trie *t = NewTrie();
+  std::mt19937 gen(7);
+  std::vector<std::string> words;
+  for (int i = 0; i < 3000; i++) {
+    std::string w;
+    size_t n = 1 + gen() % 8;
+    for (size_t j = 0; j < n; j++) w += 'a' + gen() % 5;
+    words.push_back(w);
+    trieInsert(t, w);
+  }
+  ElemSet uniq(words.begin(), words.end());
+
+  const char *queries[] = {"", "a", "abc", "bad", "eeeee", "abcdeabcde", "cabbage"};
+  for (auto q : queries) {
+    for (int maxDist = 0; maxDist <= 3; maxDist++) {
+      for (int prefixMode = 0; prefixMode <= 1; prefixMode++) {
+        std::map<std::string, int> expected;
+        for (auto &w : uniq) {
+          int d = levDistance(w, q);
+          if (prefixMode) {
+            for (size_t l = 0; l < w.size(); l++) d = std::min(d, levDistance(w.substr(0, l), q));
+          }
+          if (d <= maxDist) expected[w] = d;
+        }
+
+        std::map<std::string, int> got;
+        TrieIterator *it = Trie_Iterate(t, q, strlen(q), maxDist, prefixMode);
+        rune *rstr;
+        t_len len;
+        float score;
+        int dist;
+        while (TrieIterator_Next(it, &rstr, &len, NULL, &score, &dist)) {
+          size_t n;
+          char *s = runesToStr(rstr, len, &n);
+          got[std::string(s, n)] = dist;
+          free(s);
+        }
+        DFAFilter_Free((DFAFilter *)it->ctx);
+        free(it->ctx);
+        TrieIterator_Free(it);
+        ASSERT_EQ(expected, got) << q << " " << maxDist << " " << prefixMode;
+      }
+    }
+  }
+  TrieType_Free(t);
+}
+
+TEST_F(TrieTest, testLevenshteinUnicode) {
+  Trie *t = NewTrie();
+  trieInsert(t, "\xd7\xa9\xd7\x9c\xd7\x95\xd7\x9d");  // shalom
+  trieInsert(t, "Stra\xc3\x9f" "e");
+  ASSERT_EQ(1, trieIterAll(t, "\xd7\xa9\xd7\x97\xd7\x95\xd7\x9d", 1, 0).size());
+  ASSERT_EQ(0, trieIterAll(t, "\xd7\xa9\xd7\x97\xd7\x95\xd7\x9d", 0, 0).size());
+  ASSERT_EQ(1, trieIterAll(t, "STRASE", 1, 0).size());
+  TrieType_Free(t);
+}
+
+TEST_F(TrieTest, testLevenshteinCache) {
+  rune q[] = {'h', 'e', 'l', 'l', 'o'};
+  rune upper[] = {'H', 'E', 'L', 'L', 'O'};
+  LevAutomaton *a = LevAutomaton_Acquire(q, 5, 2);
+  // the same (folded) string and distance share an automaton
+  LevAutomaton *b = LevAutomaton_Acquire(upper, 5, 2);
+  LevAutomaton *c = LevAutomaton_Acquire(q, 5, 1);
+  ASSERT_EQ(a, b);
+  ASSERT_NE(a, c);
+  ASSERT_EQ((levMask)1 << 3 | (levMask)1 << 4, LevAutomaton_RuneMask(a, 'l'));
+  ASSERT_EQ(0, LevAutomaton_RuneMask(a, 'x'));
+  LevAutomaton_Release(b);
+  LevAutomaton_Release(c);
+
+  // automata in use survive being evicted
+  for (int i = 0; i < LEV_CACHE_SIZE + 1; i++) {
+    rune r[] = {(rune)('a' + i % 26), (rune)('a' + i / 26)};
+    LevAutomaton_Release(LevAutomaton_Acquire(r, 2, 1));
+  }
+  ASSERT_EQ(5, a->len);
+  ASSERT_FALSE(a->cached);
+  LevAutomaton_Release(a);
+
+  // longer strings are rejected rather than truncated
+  std::vector<rune> longq(LEV_MAX_STRING_LEN + 1, 'a');
+  ASSERT_EQ(NULL, LevAutomaton_Acquire(&longq[0], longq.size(), 1));
+  a = LevAutomaton_Acquire(&longq[0], LEV_MAX_STRING_LEN, 1);
+  ASSERT_EQ(LEV_MAX_STRING_LEN, a->len);
+  LevAutomaton_Release(a);
+}
+
+static void spellIndexCollect(const char *s, size_t len, int dist, void *ctx) {
+  (*(std::map<std::string, int> *)ctx)[std::string(s, len)] = dist;
+}
+
+static std::map<std::string, int> spellIndexFind(SpellIndex *idx, const std::string &q,
+                                                 int maxDist) {
+  std::map<std::string, int> got;
+  size_t n = SpellIndex_Find(idx, q.c_str(), q.size(), maxDist, spellIndexCollect, &got);
+  EXPECT_EQ(n, got.size());
+  return got;
+}
+
+TEST_F(TrieTest, testSpellIndex) {
+  Trie *t = NewTrie();
+  std::mt19937 gen(11);
+  ElemSet uniq;
+  for (int i = 0; i < 3000; i++) {
+    std::string w;
+    size_t n = 1 + gen() % 12;
+    for (size_t j = 0; j < n; j++) w += 'a' + gen() % 4;
+    uniq.insert(w);
+    trieInsert(t, w);
+  }
+  // small indexes are built by the first call
+  SpellIndex *idx = Trie_GetSpellIndex(t, 3, 0);
+  ASSERT_TRUE(idx != NULL);
+  ASSERT_EQ(3, SpellIndex_MaxDist(idx));
+  // the index is only rebuilt for larger distances
+  ASSERT_EQ(idx, Trie_GetSpellIndex(t, 2, 0));
+
+  std::vector<std::string> queries = {"a", "abc", "bad", "dddd", "abcdabcdabcd", "cabbage"};
+  for (int i = 0; i < 30; i++) {
+    queries.push_back(*std::next(uniq.begin(), gen() % uniq.size()));
+    queries.back()[gen() % queries.back().size()] = 'e';
+  }
+  for (auto &q : queries) {
+    for (int maxDist = 0; maxDist <= 3; maxDist++) {
+      std::map<std::string, int> expected;
+      for (auto &w : uniq) {
+        int d = levDistance(w, q);
+        if (d <= maxDist) expected[w] = d;
+      }
+      ASSERT_EQ(expected, spellIndexFind(idx, q, maxDist)) << q << " " << maxDist;
+    }
+  }
+  TrieType_Free(t);
+}
+
+TEST_F(TrieTest, testSpellIndexUpdates) {
+  Trie *t = NewTrie();
+  trieInsert(t, "hello");
+  trieInsert(t, "help");
+  SpellIndex *idx = Trie_GetSpellIndex(t, 1, 0);
+
+  // the index follows the trie once built
+  trieInsert(t, "hells");
+  ASSERT_EQ((std::map<std::string, int>{{"hello", 1}, {"hells", 1}, {"help", 1}}),
+            spellIndexFind(idx, "hell", 1));
+  ASSERT_EQ((std::map<std::string, int>{{"hello", 1}}), spellIndexFind(idx, "HALLO", 1));
+  Trie_Delete(t, "hello", 5);
+  ASSERT_EQ((std::map<std::string, int>{{"hells", 1}, {"help", 1}}),
+            spellIndexFind(idx, "hell", 1));
+  trieInsert(t, "hello");
+  ASSERT_EQ(3, spellIndexFind(idx, "hell", 1).size());
+
+  // scores are cached for indexed strings only, and dropped on deletion
+  double score = 0;
+  ASSERT_FALSE(SpellIndex_GetScore(idx, "help", 4, &score));
+  SpellIndex_SetScore(idx, "help", 4, 42);
+  SpellIndex_SetScore(idx, "world", 5, 42);
+  ASSERT_TRUE(SpellIndex_GetScore(idx, "help", 4, &score));
+  ASSERT_EQ(42, score);
+  ASSERT_FALSE(SpellIndex_GetScore(idx, "world", 5, &score));
+  SpellIndex_InvalidateScore(idx, "help", 4);
+  ASSERT_FALSE(SpellIndex_GetScore(idx, "help", 4, &score));
+  SpellIndex_SetScore(idx, "help", 4, 42);
+  Trie_Delete(t, "help", 4);
+  trieInsert(t, "help");
+  ASSERT_FALSE(SpellIndex_GetScore(idx, "help", 4, &score));
+
+  ASSERT_GT(Trie_MemUsage(t), SpellIndex_MemUsage(idx));
+
+  // queries too long for the trie find nothing, instead of matching their prefix
+  std::string longw(TRIE_MAX_PREFIX, 'a');
+  trieInsert(t, longw);
+  ASSERT_EQ((std::map<std::string, int>{{longw, 0}}), spellIndexFind(idx, longw, 1));
+  ASSERT_EQ(0, spellIndexFind(idx, longw + "a", 1).size());
+  TrieType_Free(t);
+}
+
+TEST_F(TrieTest, testSpellIndexBuild) {
+  Trie *t = NewTrie();
+  ElemSet words;
+  for (int i = 0; i < 4 * TRIE_SPELL_BUILD_STEP; i++) {
+    words.insert(std::to_string(i));
+    trieInsert(t, std::to_string(i));
+    if (i == 3 * TRIE_SPELL_BUILD_STEP) Trie_Freeze(t);
+  }
+
+  // large indexes are queued and built over a few calls and writes, which it follows meanwhile.
+  // Every call queues the next strings of all the layers, in lexical order
+  size_t calls = 1;
+  ASSERT_EQ(NULL, Trie_GetSpellIndex(t, 1, 0));
+  ASSERT_TRUE(t->spellQueueing);
+  size_t n;
+  char *cursor = runesToStr(t->spellCursor, t->spellCursorLen, &n);
+  ASSERT_EQ(*std::next(words.begin(), TRIE_SPELL_BUILD_STEP - 1), std::string(cursor, n));
+  free(cursor);
+  for (int i = 0; i < 10; i++) {
+    words.insert("x" + std::to_string(i));
+    trieInsert(t, "x" + std::to_string(i));
+    words.erase(std::to_string(i * 1000));
+    Trie_Delete(t, std::to_string(i * 1000).c_str(), std::to_string(i * 1000).size());
+    // strings before and after the last one queued
+    words.insert("0" + std::to_string(i));
+    trieInsert(t, "0" + std::to_string(i));
+    words.erase(std::to_string(i * 1000 + 999));
+    Trie_Delete(t, std::to_string(i * 1000 + 999).c_str(), std::to_string(i * 1000 + 999).size());
+  }
+  SpellIndex *idx;
+  while (!(idx = Trie_GetSpellIndex(t, 1, 0))) {
+    ASSERT_LT(++calls, 8);
+    if (calls == 2) Trie_Freeze(t);
+  }
+  ASSERT_GT(calls, 2);
+  for (std::string q : {"1", "100", "2000", "x", "x11", "12345"}) {
+    std::map<std::string, int> expected;
+    for (auto &w : words) {
+      int d = levDistance(w, q);
+      if (d <= 1) expected[w] = d;
+    }
+    ASSERT_EQ(expected, spellIndexFind(idx, q, 1)) << q;
+  }
+
+  // an index outgrowing its memory limit is dropped, and only built again with a larger limit
+  size_t mem = SpellIndex_MemUsage(idx);
+  ASSERT_EQ(idx, Trie_GetSpellIndex(t, 1, mem + 100));
+  for (int i = 0; t->spellIdx && i < 100; i++) {
+    trieInsert(t, "y" + std::to_string(i));
+  }
+  ASSERT_EQ(NULL, t->spellIdx);
+  ASSERT_EQ(NULL, Trie_GetSpellIndex(t, 1, mem + 100));
+  ASSERT_EQ(NULL, t->spellIdx);
+  ASSERT_EQ(NULL, Trie_GetSpellIndex(t, 1, 2 * mem));
+  ASSERT_TRUE(t->spellIdx != NULL);
+  TrieType_Free(t);
+}
+
+TEST_F(TrieTest, testSearchTopK) {
+  Trie *t = NewTrie();
+  std::mt19937 gen(3);
+  std::map<std::string, float> entries;
+  auto randWord = [&]() {
+    std::string w;
+    size_t n = 1 + gen() % 10;
+    for (size_t j = 0; j < n; j++) w += (gen() % 4 ? 'a' : 'A') + gen() % 3;
+    return w;
+  };
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < 2000; i++) {
+      std::string w = randWord();
+      float score = 1 + gen() % 1000;
+      // increments raise the score of entries below the bound of their subtrees
+      int incr = entries.count(w) && gen() % 2;
+      Trie_InsertStringBuffer(t, w.c_str(), w.size(), score, incr, NULL);
+      entries[w] = incr ? entries[w] + score : score;
+    }
+    for (int i = 0; i < 100; i++) {
+      auto it = std::next(entries.begin(), gen() % entries.size());
+      ASSERT_TRUE(Trie_Delete(t, it->first.c_str(), it->first.size()));
+      entries.erase(it);
+    }
+    if (round == 0) Trie_Freeze(t);
+  }
+
+  const char *queries[] = {"", "a", "B", "ab", "cab", "aaaa", "abcabc"};
+  for (auto q : queries) {
+    std::string fq(q);
+    std::transform(fq.begin(), fq.end(), fq.begin(), ::tolower);
+    for (size_t num : {1, 5, 50}) {
+      std::vector<float> expected;
+      for (auto &e : entries) {
+        std::string fw(e.first);
+        std::transform(fw.begin(), fw.end(), fw.begin(), ::tolower);
+        if (fw.compare(0, fq.size(), fq)) continue;
+        float score = e.first.size() && e.first == fq ? INT_MAX : e.second;
+        size_t slen = e.first.size(), len = strlen(q);
+        score /= sqrt(1 + (slen >= len ? slen - len : len - slen));
+        expected.push_back(score);
+      }
+      std::sort(expected.rbegin(), expected.rend());
+      expected.resize(std::min(expected.size(), num));
+
+      Vector *res = Trie_Search(t, q, strlen(q), num, 0, 1, 0, 0);
+      std::vector<float> got;
+      for (size_t i = 0; i < Vector_Size(res); i++) {
+        TrieSearchResult *e;
+        Vector_Get(res, i, &e);
+        got.push_back(e->score);
+        ASSERT_TRUE(entries.count(std::string(e->str, e->len)));
+        TrieSearchResult_Free(e);
+      }
+      Vector_Free(res);
+      ASSERT_EQ(expected, got) << q << " " << num;
+    }
+  }
+  TrieType_Free(t);
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "word_cache.h"
+#include "stemmer.h"
+#include "rmalloc.h"
+
+extern "C" {
+#include "phonetic_manager.h"
+}
+
+class WordCacheTest : public ::testing::Test {};
+
+TEST_F(WordCacheTest, testLookup) {
+  WordCache *c = WordCache_Get(WORDCACHE_STEMS, RS_LANG_ITALIAN);
+  ASSERT_TRUE(c != NULL);
+  ASSERT_EQ(c, WordCache_Get(WORDCACHE_STEMS, RS_LANG_ITALIAN));
+  ASSERT_NE(c, WordCache_Get(WORDCACHE_STEMS, RS_LANG_DUTCH));
+
+  WordCacheStats before;
+  WordCache_GetStats(WORDCACHE_STEMS, &before);
+
+  char buf[WORDCACHE_MAX_LEN];
+  ASSERT_EQ(-1, WordCache_Lookup(c, "parlando", 8, buf));
+  WordCache_Put(c, "parlando", 8, "parl", 4);
+  ASSERT_EQ(4, WordCache_Lookup(c, "parlando", 8, buf));
+  ASSERT_STREQ("parl", buf);
+  // a prefix of a cached word is a different word
+  ASSERT_EQ(-1, WordCache_Lookup(c, "parlan", 6, buf));
+
+  // words and values which are too long are not cached
+  std::string longWord(WORDCACHE_MAX_LEN, 'a');
+  WordCache_Put(c, longWord.c_str(), longWord.size(), "a", 1);
+  ASSERT_EQ(-1, WordCache_Lookup(c, longWord.c_str(), longWord.size(), buf));
+  WordCache_Put(c, "b", 1, longWord.c_str(), longWord.size());
+  ASSERT_EQ(-1, WordCache_Lookup(c, "b", 1, buf));
+
+  WordCacheStats after;
+  WordCache_GetStats(WORDCACHE_STEMS, &after);
+  ASSERT_EQ(before.hits + 1, after.hits);
+  ASSERT_EQ(before.misses + 4, after.misses);
+  ASSERT_EQ(before.entries + 1, after.entries);
+}
+
+TEST_F(WordCacheTest, testEviction) {
+  WordCache *c = WordCache_Get(WORDCACHE_STEMS, RS_LANG_SWEDISH);
+  WordCacheStats st;
+  WordCache_GetStats(WORDCACHE_STEMS, &st);
+
+  // the cache never holds more words than it has room for, and keeps the recent ones
+  size_t n = st.capacity * 2;
+  for (size_t i = 0; i < n; i++) {
+    std::string w = "word" + std::to_string(i);
+    WordCache_Put(c, w.c_str(), w.size(), w.c_str(), 4);
+  }
+  WordCache_GetStats(WORDCACHE_STEMS, &st);
+  ASSERT_LE(st.entries, st.capacity);
+  char buf[WORDCACHE_MAX_LEN];
+  std::string last = "word" + std::to_string(n - 1);
+  ASSERT_EQ(4, WordCache_Lookup(c, last.c_str(), last.size(), buf));
+}
+
+TEST_F(WordCacheTest, testStemmer) {
+  // stems served from the cache are the ones of the stemmer
+  Stemmer *s = NewStemmer(SnowballStemmer, RS_LANG_ENGLISH);
+  const char *words[] = {"arbitrary", "running", "stemmer", "cat"};
+  for (int round = 0; round < 2; round++) {
+    for (auto w : words) {
+      size_t sl = 0;
+      const char *stem = s->Stem(s->ctx, w, strlen(w), &sl);
+      if (!strcmp(w, "arbitrary")) {
+        ASSERT_STREQ("+arbitrari", stem);
+        ASSERT_EQ(strlen(stem), sl);
+      } else if (!strcmp(w, "running")) {
+        ASSERT_STREQ("+run", stem);
+      } else {
+        // the stem is the word itself
+        ASSERT_TRUE(stem == NULL) << w;
+      }
+    }
+  }
+  s->Free(s);
+
+  char *primary = NULL;
+  for (int round = 0; round < 2; round++) {
+    PhoneticManager_ExpandPhonetics(NULL, "john", 4, &primary, NULL);
+    ASSERT_STREQ("<JN", primary);
+    rm_free(primary);
+  }
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <util/workpool.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+class WorkPoolTest : public ::testing::Test {};
+
+static void incr(void *arg) {
+  ++*static_cast<std::atomic<int> *>(arg);
+}
+
+TEST_F(WorkPoolTest, testRunAll) {
+  WorkPool *p = NewWorkPool(4);
+  std::atomic<int> n(0);
+  for (int i = 0; i < 10000; i++) {
+    WorkPool_Add(p, incr, &n);
+  }
+  WorkPoolStats st;
+  WorkPool_GetStats(p, &st);
+  ASSERT_EQ(4, st.numThreads);
+  ASSERT_LE(st.maxQueued, st.queued);
+
+  // freeing the pool runs the queued tasks first
+  WorkPool_Free(p);
+  ASSERT_EQ(10000, n);
+}
+
+namespace {
+// A chain of tasks, each adding the next one, like an indexer scheduling itself again. The steps of
+// a chain never run concurrently
+struct Chain {
+  WorkPool *pool;
+  int steps;
+  std::atomic<int> running;
+  std::atomic<int> done;
+};
+}  // namespace
+
+static void chainStep(void *arg) {
+  Chain *c = static_cast<Chain *>(arg);
+  ASSERT_EQ(0, c->running++);
+  std::this_thread::yield();
+  c->running--;
+  if (++c->done < c->steps) {
+    WorkPool_Add(c->pool, chainStep, c);
+  }
+}
+
+TEST_F(WorkPoolTest, testChains) {
+  WorkPool *p = NewWorkPool(4);
+  std::vector<Chain> chains(50);
+  for (auto &c : chains) {
+    c.pool = p;
+    c.steps = 200;
+    c.running = 0;
+    c.done = 0;
+    WorkPool_Add(p, chainStep, &c);
+  }
+  WorkPool_Free(p);
+  for (auto &c : chains) {
+    ASSERT_EQ(200, c.done);
+  }
+}
+
+namespace {
+struct Waiter {
+  std::atomic<int> n;
+  std::atomic<bool> done;
+};
+}  // namespace
+
+static void incrWaiter(void *arg) {
+  static_cast<Waiter *>(arg)->n++;
+}
+
+// Wait for the other tasks, which only run if they are stolen from behind this one
+static void waitOthers(void *arg) {
+  Waiter *w = static_cast<Waiter *>(arg);
+  for (int i = 0; i < 10000 && w->n < 99; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  w->done = true;
+}
+
+TEST_F(WorkPoolTest, testStealing) {
+  WorkPool *p = NewWorkPool(2);
+  Waiter w;
+  w.n = 0;
+  w.done = false;
+  // tasks from outside the pool go to the queues in turn, so half of them are queued behind the
+  // waiting task
+  WorkPool_Add(p, waitOthers, &w);
+  for (int i = 0; i < 99; i++) {
+    WorkPool_Add(p, incrWaiter, &w);
+  }
+  while (!w.done) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_EQ(99, w.n);
+
+  WorkPoolStats st;
+  WorkPool_GetStats(p, &st);
+  ASSERT_GT(st.stolen, 0);
+  WorkPool_Free(p);
+}
@@ -3,7 +3,7 @@
 #include "rmutil/rm_assert.h"
 #include <err.h>
 
-#define Cursor_IsIdle(cur) ((cur)->pos != -1)
+#define Cursor_IsIdle(cur) TimerWheel_IsQueued(&(cur)->idleNode)
 CursorList RSCursors;
 
 static uint64_t curTimeNs() {
@@ -12,20 +12,32 @@ static uint64_t curTimeNs() {
   return tv.tv_nsec + (tv.tv_sec * 1000000000);
 }
 
-static void CursorList_Lock(CursorList *cl) {
-  pthread_mutex_lock(&cl->lock);
+/* Idle wheels tick every millisecond. A cursor times out on the first tick after its deadline */
+#define NS_PER_TICK 1000000
+#define Cursor_TimeoutTick(ns) (((ns) + NS_PER_TICK - 1) / NS_PER_TICK)
+
+static CursorShard *getShard(CursorList *cl, uint64_t cid) {
+  return &cl->shards[cid % RSCURSORS_NUM_SHARDS];
+}
+
+static void CursorShard_Lock(CursorShard *shard) {
+  pthread_mutex_lock(&shard->lock);
 }
 
-static void CursorList_Unlock(CursorList *cl) {
-  pthread_mutex_unlock(&cl->lock);
+static void CursorShard_Unlock(CursorShard *shard) {
+  pthread_mutex_unlock(&shard->lock);
 }
 
 void CursorList_Init(CursorList *cl) {
   memset(cl, 0, sizeof(*cl));
-  pthread_mutex_init(&cl->lock, NULL);
-  cl->lookup = kh_init(cursors);
-  Array_Init(&cl->idle);
-  srand48(getpid());
+  uint64_t now = curTimeNs() / NS_PER_TICK;
+  for (size_t ii = 0; ii < RSCURSORS_NUM_SHARDS; ++ii) {
+    CursorShard *shard = &cl->shards[ii];
+    pthread_mutex_init(&shard->lock, NULL);
+    shard->lookup = kh_init(cursors);
+    TimerWheel_Init(&shard->idle, now);
+  }
+  pthread_rwlock_init(&cl->specsLock, NULL);
 }
 
 static CursorSpecInfo *findInfo(const CursorList *cl, const char *keyName, size_t *index) {
@@ -40,34 +52,31 @@ static CursorSpecInfo *findInfo(const CursorList *cl, const char *keyName, size_
   return NULL;
 }
 
-static void Cursor_RemoveFromIdle(Cursor *cur) {
-  Array *idle = &cur->parent->idle;
-  Cursor **ll = ARRAY_GETARRAY_AS(idle, Cursor **);
-  size_t n = ARRAY_GETSIZE_AS(idle, Cursor *);
-
-  if (n > 1) {
-    Cursor *last = ll[n - 1]; /** Last cursor - move to current position */
-    last->pos = cur->pos;
-    ll[last->pos] = last;
+/* Remove a cursor from the lookup table of its shard. The shard must be locked */
+static void Cursor_RemoveFromShard(CursorShard *shard, Cursor *cur, khiter_t khi) {
+  RS_LOG_ASSERT(khi != kh_end(shard->lookup), "Iterator shouldn't be at end of cursor list");
+  if (Cursor_IsIdle(cur)) {
+    TimerWheel_Remove(&shard->idle, &cur->idleNode);
   }
+  kh_del(cursors, shard->lookup, khi);
+  RS_LOG_ASSERT(kh_get(cursors, shard->lookup, cur->id) == kh_end(shard->lookup),
+                                                    "Failed to delete cursor");
+}
 
-  Array_Resize(idle, sizeof(Cursor *) * (n - 1));
-  if (cur->nextTimeoutNs == cur->parent->nextIdleTimeoutNs) {
-    cur->parent->nextIdleTimeoutNs = 0;
+static void CursorSpecInfo_Decref(CursorSpecInfo *info) {
+  if (__atomic_sub_fetch(&info->refcount, 1, __ATOMIC_ACQ_REL) == 0) {
+    rm_free(info->keyName);
+    rm_free(info);
   }
-  cur->pos = -1;
 }
 
-/* Doesn't lock - simply deallocates and decrements */
-static void Cursor_FreeInternal(Cursor *cur, khiter_t khi) {
+/* Doesn't lock - simply deallocates and decrements. The cursor must not be in its shard anymore.
+ * The cursor holds a reference to its spec info, so the info is valid even if the spec was
+ * removed from the list in the meantime */
+static void Cursor_FreeInternal(Cursor *cur) {
   /* Decrement the used count */
-  RS_LOG_ASSERT(khi != kh_end(cur->parent->lookup), "Iterator shouldn't be at end of cursor list");
-  RS_LOG_ASSERT(kh_get(cursors, cur->parent->lookup, cur->id) != kh_end(cur->parent->lookup),
-                                                    "Cursor was not found");
-  kh_del(cursors, cur->parent->lookup, khi);
-  RS_LOG_ASSERT(kh_get(cursors, cur->parent->lookup, cur->id) == kh_end(cur->parent->lookup),
-                                                    "Failed to delete cursor");
-  cur->specInfo->used--;
+  __atomic_sub_fetch(&cur->specInfo->used, 1, __ATOMIC_RELAXED);
+  CursorSpecInfo_Decref(cur->specInfo);
   if (cur->execState) {
     Cursor_FreeExecState(cur->execState);
     cur->execState = NULL;
@@ -75,40 +84,31 @@ static void Cursor_FreeInternal(Cursor *cur, khiter_t khi) {
   rm_free(cur);
 }
 
-static void Cursors_ForEach(CursorList *cl, void (*callback)(CursorList *, Cursor *, void *),
-                            void *arg) {
-  for (size_t ii = 0; ii < ARRAY_GETSIZE_AS(&cl->idle, Cursor *); ++ii) {
-    Cursor *cur = *ARRAY_GETITEM_AS(&cl->idle, ii, Cursor **);
-    Cursor *oldCur = NULL;
-    /**
-     * The cursor `cur` might have been changed in the callback, if it has been
-     * swapped with another one, as deletion means swapping the last cursor to
-     * the current position. We ensure that we do not 'skip' over this cursor
-     * (effectively skipping over the cursor that was just relocated).
-     */
-
-    while (cur && cur != oldCur) {
-      callback(cl, cur, arg);
-      oldCur = cur;
-      if (cl->idle.len > ii) {
-        cur = *ARRAY_GETITEM_AS(&cl->idle, ii, Cursor **);
-      }
-    }
+/* Free the cursors of a list, linked by their idle nodes */
+static void Cursors_FreeList(DLLIST *list) {
+  while (!(DLLIST_IS_EMPTY(list))) {
+    DLLIST_node *it = list->next;
+    dllist_delete(it);
+    Cursor_FreeInternal(DLLIST_ITEM(it, Cursor, idleNode.llnode));
   }
 }
 
-typedef struct {
-  uint64_t now;
-  int numCollected;
-} cursorGcCtx;
-
-static void cursorGcCb(CursorList *cl, Cursor *cur, void *arg) {
-  cursorGcCtx *ctx = arg;
-  if (cur->nextTimeoutNs <= ctx->now) {
-    Cursor_RemoveFromIdle(cur);
-    Cursor_FreeInternal(cur, kh_get(cursors, cl->lookup, cur->id));
-    ctx->numCollected++;
+/* Remove the timed out cursors of the shard. Their execution states are freed once the shard is
+ * unlocked */
+static int CursorShard_Collect(CursorShard *shard, uint64_t now) {
+  DLLIST expired;
+  dllist_init(&expired);
+
+  CursorShard_Lock(shard);
+  int numCollected = TimerWheel_Advance(&shard->idle, now / NS_PER_TICK, &expired);
+  DLLIST_FOREACH(it, &expired) {
+    Cursor *cur = DLLIST_ITEM(it, Cursor, idleNode.llnode);
+    kh_del(cursors, shard->lookup, kh_get(cursors, shard->lookup, cur->id));
   }
+  CursorShard_Unlock(shard);
+
+  Cursors_FreeList(&expired);
+  return numCollected;
 }
 
 /**
@@ -118,76 +118,101 @@ static void cursorGcCb(CursorList *cl, Cursor *cur, void *arg) {
  *
  * - Every <n> operations
  * - If there are too many active cursors and we want to create a cursor
- * - If NextTimeout is set and is earlier than the current time.
  *
- * Garbage collection is throttled within a given interval as well.
+ * Garbage collection is throttled within a given interval as well, unless
+ * forced. A sweep only visits the cursors which timed out, so it is cheap.
+ *
+ * Must be called without any shard locked.
  */
 static int Cursors_GCInternal(CursorList *cl, int force) {
   uint64_t now = curTimeNs();
-  if (cl->nextIdleTimeoutNs && cl->nextIdleTimeoutNs > now) {
-    return -1;
-  } else if (!force && now - cl->lastCollect < RSCURSORS_SWEEP_THROTTLE) {
+  uint64_t lastCollect = __atomic_load_n(&cl->lastCollect, __ATOMIC_RELAXED);
+  if (!force && now - lastCollect < RSCURSORS_SWEEP_THROTTLE) {
     return -1;
   }
 
-  cl->lastCollect = now;
-  cursorGcCtx ctx = {.now = now};
-  Cursors_ForEach(cl, cursorGcCb, &ctx);
-  return ctx.numCollected;
+  __atomic_store_n(&cl->lastCollect, now, __ATOMIC_RELAXED);
+  int numCollected = 0;
+  for (size_t ii = 0; ii < RSCURSORS_NUM_SHARDS; ++ii) {
+    numCollected += CursorShard_Collect(&cl->shards[ii], now);
+  }
+  return numCollected;
 }
 
 int Cursors_CollectIdle(CursorList *cl) {
-  CursorList_Lock(cl);
-  int rc = Cursors_GCInternal(cl, 1);
-  CursorList_Unlock(cl);
-  return rc;
+  return Cursors_GCInternal(cl, 1);
 }
 
 void CursorList_AddSpec(CursorList *cl, const char *k, size_t capacity) {
+  pthread_rwlock_wrlock(&cl->specsLock);
   CursorSpecInfo *info = findInfo(cl, k, NULL);
   if (!info) {
     info = rm_malloc(sizeof(*info));
     info->keyName = rm_strdup(k);
     info->used = 0;
+    info->refcount = 1;
     cl->specs = rm_realloc(cl->specs, sizeof(*cl->specs) * ++cl->specsCount);
     cl->specs[cl->specsCount - 1] = info;
   }
   info->cap = capacity;
+  pthread_rwlock_unlock(&cl->specsLock);
 }
 
 void CursorList_RemoveSpec(CursorList *cl, const char *k) {
+  pthread_rwlock_wrlock(&cl->specsLock);
   size_t index;
   CursorSpecInfo *info = findInfo(cl, k, &index);
   if (info) {
     cl->specs[index] = cl->specs[cl->specsCount - 1];
     cl->specs = rm_realloc(cl->specs, sizeof(*cl->specs) * --cl->specsCount);
-    rm_free(info->keyName);
-    rm_free(info);
+    // the open cursors of the spec keep the info until they are freed
+    CursorSpecInfo_Decref(info);
   }
+  pthread_rwlock_unlock(&cl->specsLock);
 }
 
 static void CursorList_IncrCounter(CursorList *cl) {
-  if (++cl->counter % RSCURSORS_SWEEP_INTERVAL == 0) {
+  if (__atomic_add_fetch(&cl->counter, 1, __ATOMIC_RELAXED) % RSCURSORS_SWEEP_INTERVAL == 0) {
     Cursors_GCInternal(cl, 0);
   }
 }
 
 /**
- * Cursor ID is a 64 bit opaque integer. The upper 32 bits consist of the PID
- * of the process which generated the cursor, and the lower 32 bits consist of
- * the counter at the time at which it was generated. This doesn't make it
- * particularly "secure" but it does prevent accidental collisions from both
- * a stuck client and a crashed server
+ * Cursor ID is a 64 bit opaque random integer. Every thread draws from its
+ * own sequence, seeded by the PID, so reserving cursors from different
+ * threads does not share any state. This doesn't make it particularly
+ * "secure" but it does prevent accidental collisions from both a stuck
+ * client and a crashed server
  */
 static uint64_t CursorList_GenerateId(CursorList *curlist) {
-  uint64_t id = lrand48() + 1;  // 0 should never be returned as cursor id
+  static __thread unsigned short seed[3];
+  static __thread int seeded = 0;
+  if (!seeded) {
+    uintptr_t self = (uintptr_t)&seed;
+    seed[0] = getpid();
+    seed[1] = self >> 4;
+    seed[2] = self >> 20;
+    seeded = 1;
+  }
+  uint64_t id = nrand48(seed) + 1;  // 0 should never be returned as cursor id
   return id;
 }
 
+/* Count a new cursor of the spec, unless the spec has all the cursors it may have. Called with the
+ * specs lock held, so the info is still referenced by the list */
+static int CursorSpecInfo_Reserve(CursorSpecInfo *spec) {
+  if (__atomic_add_fetch(&spec->used, 1, __ATOMIC_RELAXED) <= spec->cap) {
+    __atomic_add_fetch(&spec->refcount, 1, __ATOMIC_RELAXED);
+    return 1;
+  }
+  __atomic_sub_fetch(&spec->used, 1, __ATOMIC_RELAXED);
+  return 0;
+}
+
 Cursor *Cursors_Reserve(CursorList *cl, const char *lookupName, unsigned interval,
                         QueryError *status) {
-  CursorList_Lock(cl);
   CursorList_IncrCounter(cl);
+  pthread_rwlock_rdlock(&cl->specsLock);
   CursorSpecInfo *spec = findInfo(cl, lookupName, NULL);
   Cursor *cur = NULL;
 
@@ -197,10 +222,13 @@ Cursor *Cursors_Reserve(CursorList *cl, const char *lookupName, unsigned interva
     goto done;
   }
 
-  if (spec->used >= spec->cap) {
-    Cursors_GCInternal(cl, 0);
-    if (spec->used >= spec->cap) {
-      /** Collect idle cursors now */
+  if (!CursorSpecInfo_Reserve(spec)) {
+    /** Collect idle cursors now. Their execution states are not freed under the specs lock */
+    pthread_rwlock_unlock(&cl->specsLock);
+    Cursors_GCInternal(cl, 1);
+    pthread_rwlock_rdlock(&cl->specsLock);
+    spec = findInfo(cl, lookupName, NULL);
+    if (!spec || !CursorSpecInfo_Reserve(spec)) {
       QueryError_SetError(status, QUERY_ELIMIT, "Too many cursors allocated for index");
       goto done;
     }
@@ -209,81 +237,79 @@ Cursor *Cursors_Reserve(CursorList *cl, const char *lookupName, unsigned interva
   cur = rm_calloc(1, sizeof(*cur));
   cur->parent = cl;
   cur->specInfo = spec;
-  cur->id = CursorList_GenerateId(cl);
-  cur->pos = -1;
   cur->timeoutIntervalMs = interval;
 
-  int dummy;
-  khiter_t iter = kh_put(cursors, cl->lookup, cur->id, &dummy);
-  kh_value(cl->lookup, iter) = cur;
+  int absent = 0;
+  while (!absent) {
+    cur->id = CursorList_GenerateId(cl);
+    CursorShard *shard = getShard(cl, cur->id);
+    CursorShard_Lock(shard);
+    khiter_t iter = kh_put(cursors, shard->lookup, cur->id, &absent);
+    if (absent) {
+      kh_value(shard->lookup, iter) = cur;
+    }
+    CursorShard_Unlock(shard);
+  }
 
 done:
-  if (cur) {
-    cur->specInfo->used++;
-  }
-  CursorList_Unlock(cl);
+  pthread_rwlock_unlock(&cl->specsLock);
   return cur;
 }
 
 int Cursor_Pause(Cursor *cur) {
   CursorList *cl = cur->parent;
-  cur->nextTimeoutNs = curTimeNs() + ((uint64_t)cur->timeoutIntervalMs * 1000000);
-
-  CursorList_Lock(cl);
   CursorList_IncrCounter(cl);
+  cur->nextTimeoutNs = curTimeNs() + ((uint64_t)cur->timeoutIntervalMs * 1000000);
 
-  if (cur->nextTimeoutNs < cl->nextIdleTimeoutNs || cl->nextIdleTimeoutNs == 0) {
-    cl->nextIdleTimeoutNs = cur->nextTimeoutNs;
-  }
-
-  /* Add to idle list */
-  *(Cursor **)(ARRAY_ADD_AS(&cl->idle, Cursor *)) = cur;
-  cur->pos = ARRAY_GETSIZE_AS(&cl->idle, Cursor **) - 1;
-  CursorList_Unlock(cl);
+  /* Add to idle wheel */
+  CursorShard *shard = getShard(cl, cur->id);
+  CursorShard_Lock(shard);
+  TimerWheel_Add(&shard->idle, &cur->idleNode, Cursor_TimeoutTick(cur->nextTimeoutNs));
+  CursorShard_Unlock(shard);
 
   return REDISMODULE_OK;
 }
 
 Cursor *Cursors_TakeForExecution(CursorList *cl, uint64_t cid) {
-  CursorList_Lock(cl);
   CursorList_IncrCounter(cl);
+  CursorShard *shard = getShard(cl, cid);
+  CursorShard_Lock(shard);
 
   Cursor *cur = NULL;
-  khiter_t iter = kh_get(cursors, cl->lookup, cid);
-  if (iter != kh_end(cl->lookup)) {
-    cur = kh_value(cl->lookup, iter);
-    if (cur->pos == -1) {
+  khiter_t iter = kh_get(cursors, shard->lookup, cid);
+  if (iter != kh_end(shard->lookup)) {
+    cur = kh_value(shard->lookup, iter);
+    if (!Cursor_IsIdle(cur)) {
       // Cursor is not idle!
       cur = NULL;
     } else {
       // Remove from idle
-      Cursor_RemoveFromIdle(cur);
+      TimerWheel_Remove(&shard->idle, &cur->idleNode);
     }
   }
 
-  CursorList_Unlock(cl);
+  CursorShard_Unlock(shard);
   return cur;
 }
 
 int Cursors_Purge(CursorList *cl, uint64_t cid) {
-  CursorList_Lock(cl);
   CursorList_IncrCounter(cl);
+  CursorShard *shard = getShard(cl, cid);
+  CursorShard_Lock(shard);
 
-  int rc;
-  khiter_t iter = kh_get(cursors, cl->lookup, cid);
-  if (iter != kh_end(cl->lookup)) {
-    Cursor *cur = kh_value(cl->lookup, iter);
-    if (Cursor_IsIdle(cur)) {
-      Cursor_RemoveFromIdle(cur);
-    }
-    Cursor_FreeInternal(cur, iter);
-    rc = REDISMODULE_OK;
+  Cursor *cur = NULL;
+  khiter_t iter = kh_get(cursors, shard->lookup, cid);
+  if (iter != kh_end(shard->lookup)) {
+    cur = kh_value(shard->lookup, iter);
+    Cursor_RemoveFromShard(shard, cur, iter);
+  }
+  CursorShard_Unlock(shard);
 
-  } else {
-    rc = REDISMODULE_ERR;
+  if (!cur) {
+    return REDISMODULE_ERR;
   }
-  CursorList_Unlock(cl);
-  return rc;
+  Cursor_FreeInternal(cur);
+  return REDISMODULE_OK;
 }
 
 int Cursor_Free(Cursor *cur) {
@@ -291,18 +317,27 @@ int Cursor_Free(Cursor *cur) {
 }
 
 void Cursors_RenderStats(CursorList *cl, const char *name, RedisModuleCtx *ctx) {
-  CursorList_Lock(cl);
+  size_t numIdle = 0, numTotal = 0;
+  for (size_t ii = 0; ii < RSCURSORS_NUM_SHARDS; ++ii) {
+    CursorShard *shard = &cl->shards[ii];
+    CursorShard_Lock(shard);
+    numIdle += shard->idle.count;
+    numTotal += kh_size(shard->lookup);
+    CursorShard_Unlock(shard);
+  }
+
+  pthread_rwlock_rdlock(&cl->specsLock);
   CursorSpecInfo *info = findInfo(cl, name, NULL);
   size_t n = 0;
 
   /** Output total information */
   RedisModule_ReplyWithArray(ctx, REDISMODULE_POSTPONED_ARRAY_LEN);
   RedisModule_ReplyWithSimpleString(ctx, "global_idle");
-  RedisModule_ReplyWithLongLong(ctx, ARRAY_GETSIZE_AS(&cl->idle, Cursor **));
+  RedisModule_ReplyWithLongLong(ctx, numIdle);
   n += 2;
 
   RedisModule_ReplyWithSimpleString(ctx, "global_total");
-  RedisModule_ReplyWithLongLong(ctx, kh_size(cl->lookup));
+  RedisModule_ReplyWithLongLong(ctx, numTotal);
   n += 2;
 
   if (info) {
@@ -311,49 +346,62 @@ void Cursors_RenderStats(CursorList *cl, const char *name, RedisModuleCtx *ctx)
     n += 2;
 
     RedisModule_ReplyWithSimpleString(ctx, "index_total");
-    RedisModule_ReplyWithLongLong(ctx, info->used);
+    RedisModule_ReplyWithLongLong(ctx, __atomic_load_n(&info->used, __ATOMIC_RELAXED));
     n += 2;
   }
 
   RedisModule_ReplySetArrayLength(ctx, n);
-  CursorList_Unlock(cl);
-}
-
-static void purgeCb(CursorList *cl, Cursor *cur, void *arg) {
-  CursorSpecInfo *info = arg;
-  if (cur->specInfo != info) {
-    return;
-  }
-
-  Cursor_RemoveFromIdle(cur);
-  Cursor_FreeInternal(cur, kh_get(cursors, cl->lookup, cur->id));
+  pthread_rwlock_unlock(&cl->specsLock);
 }
 
 void Cursors_PurgeWithName(CursorList *cl, const char *lookupName) {
+  DLLIST purged;
+  dllist_init(&purged);
+
+  pthread_rwlock_rdlock(&cl->specsLock);
   CursorSpecInfo *info = findInfo(cl, lookupName, NULL);
-  if (!info) {
-    return;
+  // Only idle cursors are purged; the running ones are freed when their execution ends
+  for (size_t ii = 0; info && ii < RSCURSORS_NUM_SHARDS; ++ii) {
+    CursorShard *shard = &cl->shards[ii];
+    CursorShard_Lock(shard);
+    for (khiter_t it = kh_begin(shard->lookup); it != kh_end(shard->lookup); ++it) {
+      if (!kh_exist(shard->lookup, it)) {
+        continue;
+      }
+      Cursor *cur = kh_val(shard->lookup, it);
+      if (cur->specInfo != info || !Cursor_IsIdle(cur)) {
+        continue;
+      }
+      Cursor_RemoveFromShard(shard, cur, it);
+      dllist_append(&purged, &cur->idleNode.llnode);
+    }
+    CursorShard_Unlock(shard);
   }
-  Cursors_ForEach(cl, purgeCb, info);
+  pthread_rwlock_unlock(&cl->specsLock);
+
+  Cursors_FreeList(&purged);
 }
 
 void CursorList_Destroy(CursorList *cl) {
   Cursors_GCInternal(cl, 1);
-  for (khiter_t ii = 0; ii != kh_end(cl->lookup); ++ii) {
-    if (!kh_exist(cl->lookup, ii)) {
-      continue;
+  for (size_t ii = 0; ii < RSCURSORS_NUM_SHARDS; ++ii) {
+    CursorShard *shard = &cl->shards[ii];
+    for (khiter_t it = 0; it != kh_end(shard->lookup); ++it) {
+      if (!kh_exist(shard->lookup, it)) {
+        continue;
+      }
+      Cursor *c = kh_val(shard->lookup, it);
+      fprintf(stderr, "[redisearch] leaked cursor at %p\n", c);
+      Cursor_RemoveFromShard(shard, c, it);
+      Cursor_FreeInternal(c);
     }
-    Cursor *c = kh_val(cl->lookup, ii);
-    fprintf(stderr, "[redisearch] leaked cursor at %p\n", c);
-    Cursor_FreeInternal(c, ii);
+    kh_destroy(cursors, shard->lookup);
+    pthread_mutex_destroy(&shard->lock);
   }
-  kh_destroy(cursors, cl->lookup);
 
   for (size_t ii = 0; ii < cl->specsCount; ++ii) {
-    CursorSpecInfo *sp = cl->specs[ii];
-    rm_free(sp->keyName);
-    rm_free(sp);
+    CursorSpecInfo_Decref(cl->specs[ii]);
   }
   rm_free(cl->specs);
-  pthread_mutex_destroy(&cl->lock);
+  pthread_rwlock_destroy(&cl->specsLock);
 }
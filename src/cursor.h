@@ -4,13 +4,16 @@
 #include <unistd.h>
 #include <pthread.h>
 #include "util/khash.h"
-#include "util/array.h"
+#include "util/timer_wheel.h"
 #include "search_ctx.h"
 
 typedef struct {
   char *keyName; /** Name of the key that refers to the spec */
   size_t cap;    /** Maximum number of cursors for the spec */
-  size_t used;   /** Number of cursors currently open */
+  size_t used;   /** Number of cursors currently open. Updated atomically */
+  /** References from the list of specs and from every open cursor, which may outlive the spec's
+   * removal from the list. Updated atomically; the info is freed once it drops to 0 */
+  size_t refcount;
 } CursorSpecInfo;
 
 struct CursorList;
@@ -37,32 +40,43 @@ typedef struct Cursor {
   /** Initial timeout interval */
   unsigned timeoutIntervalMs;
 
-  /** Position within idle list */
-  int pos;
+  /** Timer of the cursor while it is idle, in the idle wheel of its shard */
+  TimerWheelNode idleNode;
 } Cursor;
 
 KHASH_MAP_INIT_INT64(cursors, Cursor *);
+
+/**
+ * A shard of the cursor list. Every cursor lives in the shard of its ID, and
+ * the shard's lock protects its lookup table and idle cursors
+ */
+typedef struct {
+  pthread_mutex_t lock;
+
+  /** Cursor lookup by ID */
+  khash_t(cursors) * lookup;
+
+  /** Idle cursors, by the millisecond they time out at */
+  TimerWheel idle;
+} CursorShard;
+
+#define RSCURSORS_NUM_SHARDS 16
+
 /**
  * Cursor list. This is the global cursor list and does not distinguish
  * between different specs.
  */
 typedef struct CursorList {
-  /** Cursor lookup by ID */
-  khash_t(cursors) * lookup;
+  CursorShard shards[RSCURSORS_NUM_SHARDS];
 
   /** List of spec infos; we just iterate over this */
   CursorSpecInfo **specs;
   size_t specsCount;
-
-  /** List of idle cursors */
-  Array idle;
-
-  pthread_mutex_t lock;
+  pthread_rwlock_t specsLock;
 
   /**
-   * Counter - this serves two purposes:
-   * 1) When counter % n == 0, a GC sweep is performed
-   * 2) Used to calculate a monotonically incrementing cursor ID.
+   * Counter - when counter % n == 0, a GC sweep is performed. Updated
+   * atomically
    */
   uint32_t counter;
 
@@ -70,12 +84,6 @@ typedef struct CursorList {
    * Last time GC was performed.
    */
   uint64_t lastCollect;
-
-  /**
-   * Next timeout - set to the lowest entry.
-   * This is used as a hint to avoid excessive sweeps.
-   */
-  uint64_t nextIdleTimeoutNs;
 } CursorList;
 
 // This resides in the background as a global. We could in theory make this
@@ -105,6 +113,12 @@ extern CursorList RSCursors;
  * a network API) it becomes invisible to the cursor subsystem, so there is
  * never any worry that the cursor is accessed from different threads, or
  * that a client might accidentally refer to the same cursor twice.
+ *
+ * The list itself does not rely on the GIL: cursors are sharded by ID, and
+ * every operation on a cursor only locks its shard. The spec infos are
+ * guarded by a separate read-write lock, and their counts are atomic, so
+ * reservations for different cursors do not contend. Idle cursors are kept
+ * in a timer wheel per shard, so a GC sweep only visits the expired ones.
  */
 
 /**
@@ -1,4 +1,5 @@
 #include "rs_geo.h"
+#include <stdlib.h>
 
 int encodeGeo(double lon, double lat, double *bits) {
     GeoHashBits hash;
@@ -93,6 +94,136 @@ void calcRanges(double longitude, double latitude, double radius_meters,
   calcAllNeighbors(georadius, longitude, latitude, radius_meters, ranges);
 }
 
+typedef enum {
+  GEO_CELL_OUTSIDE,
+  GEO_CELL_INSIDE,
+  GEO_CELL_PARTIAL,
+} GeoCellCover;
+
+/* Check how a cell is covered by the circle. By the triangle inequality, every point of the cell
+ * is within `reach` of the cell's center, where reach is the distance to its farthest corner. So
+ * the cell is outside the circle if its center is more than radius + reach away from the circle's
+ * center, and inside of it if the center is less than radius - reach away. */
+static GeoCellCover coverCell(GeoHashBits cell, double lon, double lat, double radius) {
+  GeoHashArea area;
+  if (!geohashDecodeWGS84(cell, &area)) {
+    return GEO_CELL_PARTIAL;
+  }
+  double clon = (area.longitude.min + area.longitude.max) / 2;
+  double clat = (area.latitude.min + area.latitude.max) / 2;
+  double reach = 0;
+  double corners[4][2] = {{area.longitude.min, area.latitude.min},
+                          {area.longitude.min, area.latitude.max},
+                          {area.longitude.max, area.latitude.min},
+                          {area.longitude.max, area.latitude.max}};
+  for (int i = 0; i < 4; i++) {
+    double d = geohashGetDistance(clon, clat, corners[i][0], corners[i][1]);
+    if (d > reach) reach = d;
+  }
+
+  double dist = geohashGetDistance(lon, lat, clon, clat);
+  if (dist - reach > radius) {
+    return GEO_CELL_OUTSIDE;
+  } else if (dist + reach <= radius) {
+    return GEO_CELL_INSIDE;
+  }
+  return GEO_CELL_PARTIAL;
+}
+
+static int cmpRanges(const void *a, const void *b) {
+  double x = ((const GeoHashRange *)a)->min, y = ((const GeoHashRange *)b)->min;
+  return x < y ? -1 : x > y ? 1 : 0;
+}
+
+static void addCellRange(GeoHashBits cell, GeoHashRange *ranges, size_t *n) {
+  GeoHashFix52Bits min, max;
+  scoresOfGeoHashBox(cell, &min, &max);
+  ranges[*n].min = min;
+  ranges[*n].max = max;
+  ++*n;
+}
+
+size_t calcCoveringRanges(double longitude, double latitude, double radius_meters,
+                          GeoHashRange *ranges) {
+  GeoHashRadius georadius = geohashGetAreasByRadiusWGS84(longitude, latitude, radius_meters);
+  GeoHashBits cells[GEO_COVER_MAX_RANGES];
+  size_t ncells = 0, nranges = 0;
+
+  GeoHashBits initial[GEO_RANGE_COUNT] = {
+      georadius.hash,
+      georadius.neighbors.north,
+      georadius.neighbors.south,
+      georadius.neighbors.east,
+      georadius.neighbors.west,
+      georadius.neighbors.north_east,
+      georadius.neighbors.north_west,
+      georadius.neighbors.south_east,
+      georadius.neighbors.south_west,
+  };
+  for (size_t i = 0; i < GEO_RANGE_COUNT; i++) {
+    if (!HASHISZERO(initial[i])) {
+      cells[ncells++] = initial[i];
+    }
+  }
+
+  for (int depth = 0; ncells; depth++) {
+    // Emit the cells inside the circle, and keep the ones on its boundary
+    size_t npartial = 0;
+    for (size_t i = 0; i < ncells; i++) {
+      switch (coverCell(cells[i], longitude, latitude, radius_meters)) {
+        case GEO_CELL_OUTSIDE:
+          break;
+        case GEO_CELL_INSIDE:
+          addCellRange(cells[i], ranges, &nranges);
+          break;
+        case GEO_CELL_PARTIAL:
+          cells[npartial++] = cells[i];
+          break;
+      }
+    }
+    ncells = npartial;
+    if (!ncells) {
+      break;
+    }
+
+    // If we can't afford splitting the boundary cells, they are part of the covering as they are
+    if (depth == GEO_COVER_MAX_EXTRA_STEPS || cells[0].step >= GEO_STEP_MAX ||
+        nranges + ncells * 4 > GEO_COVER_MAX_RANGES) {
+      for (size_t i = 0; i < ncells; i++) {
+        addCellRange(cells[i], ranges, &nranges);
+      }
+      break;
+    }
+
+    // Replace every boundary cell with its 4 sub-cells, from the last one backwards so that we
+    // don't overwrite cells we haven't split yet
+    for (size_t i = ncells; i-- > 0;) {
+      GeoHashBits cell = cells[i];
+      for (uint64_t q = 0; q < 4; q++) {
+        cells[i * 4 + q] = (GeoHashBits){.bits = (cell.bits << 2) | q, .step = cell.step + 1};
+      }
+    }
+    ncells *= 4;
+  }
+
+  if (nranges < 2) {
+    return nranges;
+  }
+  // Merge adjacent and overlapping ranges. Neighbors may be the same square for huge radiuses
+  qsort(ranges, nranges, sizeof(*ranges), cmpRanges);
+  size_t n = 0;
+  for (size_t i = 1; i < nranges; i++) {
+    if (ranges[i].min <= ranges[n].max) {
+      if (ranges[i].max > ranges[n].max) {
+        ranges[n].max = ranges[i].max;
+      }
+    } else {
+      ranges[++n] = ranges[i];
+    }
+  }
+  return n + 1;
+}
+
 bool isWithinRadiusLonLat(double lon1, double lat1,
                          double lon2, double lat2,
                          double radius, double *distance) {
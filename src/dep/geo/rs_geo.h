@@ -4,8 +4,17 @@
 #include "geohash_helper.h"
 #include "geo_index.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #define GEO_RANGE_COUNT 9
 
+/* The maximal number of ranges calcCoveringRanges may return */
+#define GEO_COVER_MAX_RANGES 32
+/* How many steps finer than the 9 neighboring squares calcCoveringRanges may refine cells */
+#define GEO_COVER_MAX_EXTRA_STEPS 4
+
 /*
  * Encode longetude and latitude doubles into a single double.
  * This value can be sorted and used for distance. 
@@ -26,6 +35,21 @@ int  decodeGeo(double bits, double *xy);
 void calcRanges(double longitude, double latitude, double radius_meters,
                 GeoHashRange *ranges);
 
+/*
+ * Calculate a covering of the circle around a point with geohash cells of multiple resolutions.
+ *
+ * We start from the same squares as `calcRanges`, and refine the squares that cross the
+ * circle's boundary into their 4 sub-squares, dropping the ones that are completely outside of it,
+ * for as long as the covering stays within GEO_COVER_MAX_RANGES cells. The ranges of the cells are
+ * sorted and adjacent ranges are merged. `ranges` must have room for GEO_COVER_MAX_RANGES
+ * entries, and the number of ranges is returned.
+ *
+ * As with `calcRanges`, `isWithinRadiusLonLat` must be used to filter out results that are within
+ * the cells but not in radius.
+ */
+size_t calcCoveringRanges(double longitude, double latitude, double radius_meters,
+                          GeoHashRange *ranges);
+
 /*
  * Return true is distance is smaller than radius. radius must be in meters.
  * If `distance' is not NULL, the distance value is returned.
@@ -34,4 +58,7 @@ bool isWithinRadiusLonLat(double lon1, double lat1,
                          double lon2, double lat2,
                          double radius, double *distance);
 
+#ifdef __cplusplus
+}
+#endif
 #endif
@@ -23,6 +23,7 @@ DocTable NewDocTable(size_t cap, size_t max_size) {
       .dim = NewDocIdMap(),
   };
   ret.buckets = rm_calloc(cap, sizeof(*ret.buckets));
+  Bitmap_Init(&ret.live);
   return ret;
 }
 
@@ -53,24 +54,7 @@ RSDocumentMetadata *DocTable_Get(const DocTable *t, t_docId docId) {
 }
 
 int DocTable_Exists(const DocTable *t, t_docId docId) {
-  if (!docId || docId > t->maxDocId) {
-    return 0;
-  }
-  uint32_t ix = DocTable_GetBucket(t, docId);
-  if (ix >= t->cap) {
-    return 0;
-  }
-  const DMDChain *chain = t->buckets + ix;
-  if (chain == NULL) {
-    return 0;
-  }
-  DLLIST2_FOREACH(it, &chain->lroot) {
-    const RSDocumentMetadata *md = DLLIST2_ITEM(it, RSDocumentMetadata, llnode);
-    if (md->id == docId && !(md->flags & Document_Deleted)) {
-      return 1;
-    }
-  }
-  return 0;
+  return docId && docId <= t->maxDocId && DocTable_IsLive(t, docId);
 }
 
 RSDocumentMetadata *DocTable_GetByKeyR(const DocTable *t, RedisModuleString *s) {
@@ -223,6 +207,7 @@ t_docId DocTable_Put(DocTable *t, const char *s, size_t n, double score, u_char
   }
 
   DocTable_Set(t, docId, dmd);
+  Bitmap_Set(&t->live, docId);
   ++t->size;
   t->memsize += sizeof(RSDocumentMetadata) + sdsAllocSize(keyPtr);
   DocIdMap_Put(&t->dim, s, n, docId);
@@ -293,6 +278,7 @@ void DocTable_Free(DocTable *t) {
   }
   rm_free(t->buckets);
   DocIdMap_Free(&t->dim);
+  Bitmap_Cleanup(&t->live);
 }
 
 static void DocTable_DmdUnchain(DocTable *t, RSDocumentMetadata *md) {
@@ -321,6 +307,7 @@ RSDocumentMetadata *DocTable_Pop(DocTable *t, const char *s, size_t n) {
     }
 
     md->flags |= Document_Deleted;
+    Bitmap_Clear(&t->live, docId);
 
     DocTable_DmdUnchain(t, md);
     DocIdMap_Delete(&t->dim, s, n);
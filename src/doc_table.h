@@ -9,6 +9,7 @@
 #include "byte_offsets.h"
 #include "rmutil/sds.h"
 #include "util/dict.h"
+#include "util/bitmap.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -67,6 +68,11 @@ typedef struct {
 
   DMDChain *buckets;
   DocIdMap dim;
+
+  // A bit per docId, set while the document is in the table. Deleted documents stay in the
+  // inverted indexes until GC runs, and this lets readers reject them with a single bit test
+  // instead of walking a bucket chain
+  Bitmap live;
 } DocTable;
 
 /* increasing the ref count of the given dmd */
@@ -96,6 +102,13 @@ RSDocumentMetadata *DocTable_Get(const DocTable *t, t_docId docId);
 
 RSDocumentMetadata *DocTable_GetByKeyR(const DocTable *r, RedisModuleString *s);
 
+/* Return 1 if docId belongs to a document that is currently in the table, and 0 if it was deleted
+ * or never assigned. This does not touch the metadata, and should be preferred over
+ * DocTable_Get when only the existence of the document matters */
+static inline int DocTable_IsLive(const DocTable *t, t_docId docId) {
+  return Bitmap_Test(&t->live, docId);
+}
+
 /* Put a new document into the table, assign it an incremental id and store the metadata in the
  * table.
  *
@@ -5,6 +5,7 @@
 #include "forward_index.h"
 #include "numeric_filter.h"
 #include "numeric_index.h"
+#include "int_index.h"
 #include "rmutil/strings.h"
 #include "rmutil/util.h"
 #include "util/mempool.h"
@@ -16,6 +17,10 @@
 #include "tag_index.h"
 #include "aggregate/expr/expression.h"
 #include "rmutil/rm_assert.h"
+#include "concurrent_ctx.h"
+#include "toksep.h"
+#include "util/workpool.h"
+#include "util/fnv.h"
 
 // Memory pool for RSAddDocumentContext contexts
 static mempool_t *actxPool_g = NULL;
@@ -32,9 +37,11 @@ static void freeDocumentContext(void *p) {
   if (aCtx->fwIdx) {
     ForwardIndexFree(aCtx->fwIdx);
   }
+  if (aCtx->chunkIdxs) {
+    array_free_ex(aCtx->chunkIdxs, ForwardIndexFree(*(ForwardIndex **)ptr));
+  }
 
-  rm_free(aCtx->fspecs);
-  rm_free(aCtx->fdatas);
+  BlkAlloc_FreeAll(&aCtx->arena, NULL, NULL, 0);
   rm_free(aCtx);
 }
 
@@ -42,24 +49,51 @@ static void freeDocumentContext(void *p) {
 
 #define FIELD_IS_VALID(aCtx, ix) ((aCtx)->fspecs[ix].name != NULL)
 
-static int AddDocumentCtx_SetDocument(RSAddDocumentCtx *aCtx, IndexSpec *sp, Document *doc,
-                                      size_t oldFieldCount) {
+/* Hash the contents of the document which go into the indexes: the schema fields it has, the
+ * content of the indexable ones, its language and its payload. Two versions of a document with the
+ * same hash differ at most in their score and in their sortable-only fields */
+static uint64_t contentHash(const RSAddDocumentCtx *aCtx) {
+  const Document *doc = &aCtx->doc;
+  // the fields are hashed separately and summed, so their order does not matter
+  uint64_t fieldsSum = 0;
+  for (size_t ii = 0; ii < doc->numFields; ++ii) {
+    const FieldSpec *fs = aCtx->fspecs + ii;
+    const DocumentField *ff = doc->fields + ii;
+    if (!fs->name) {
+      continue;
+    }
+    uint64_t h = fnv_64a_buf(&fs->index, sizeof(fs->index), 0);
+    h = fnv_64a_buf(&ff->indexAs, sizeof(ff->indexAs), h);
+    if (FieldSpec_IsIndexable(fs)) {
+      size_t len;
+      const char *c = RedisModule_StringPtrLen(ff->text, &len);
+      h = fnv_64a_buf(&len, sizeof(len), h);
+      h = fnv_64a_buf(c, len, h);
+    }
+    fieldsSum += h;
+  }
+
+  uint64_t h = fnv_64a_buf(&fieldsSum, sizeof(fieldsSum), 0);
+  h = fnv_64a_buf(&doc->language, sizeof(doc->language), h);
+  uint8_t hasPayload = doc->payload != NULL;
+  h = fnv_64a_buf(&hasPayload, sizeof(hasPayload), h);
+  if (doc->payload) {
+    h = fnv_64a_buf(doc->payload, doc->payloadSize, h);
+  }
+  // 0 stands for an unknown hash
+  return h ? h : 1;
+}
+
+static int AddDocumentCtx_SetDocument(RSAddDocumentCtx *aCtx, IndexSpec *sp, Document *doc) {
   aCtx->stateFlags &= ~ACTX_F_INDEXABLES;
   aCtx->stateFlags &= ~ACTX_F_TEXTINDEXED;
   aCtx->stateFlags &= ~ACTX_F_OTHERINDEXED;
 
-  if (oldFieldCount < doc->numFields) {
-    // Pre-allocate the field specs
-    aCtx->fspecs = rm_realloc(aCtx->fspecs, sizeof(*aCtx->fspecs) * doc->numFields);
-    aCtx->fdatas = rm_realloc(aCtx->fdatas, sizeof(*aCtx->fdatas) * doc->numFields);
-  }
-
-  for (size_t ii = 0; ii < doc->numFields; ++ii) {
-    // zero out field data. We check at the destructor to see if there is any
-    // left-over tag data here; if we've realloc'd, then this contains
-    // garbage
-    aCtx->fdatas[ii].tags = NULL;
-  }
+  // the field specs and data of a previous call (on a partial update) stay in the arena until the
+  // context is freed
+  aCtx->fspecs = BlkAlloc_ArenaAlloc(&aCtx->arena, sizeof(*aCtx->fspecs) * doc->numFields);
+  aCtx->fdatas = BlkAlloc_ArenaAlloc(&aCtx->arena, sizeof(*aCtx->fdatas) * doc->numFields);
+  memset(aCtx->fdatas, 0, sizeof(*aCtx->fdatas) * doc->numFields);
   size_t numTextIndexable = 0;
 
   // size: uint16_t * SPEC_MAX_FIELDS
@@ -152,6 +186,7 @@ static int AddDocumentCtx_SetDocument(RSAddDocumentCtx *aCtx, IndexSpec *sp, Doc
   }
 
   Document_Move(&aCtx->doc, doc);
+  aCtx->contentHash = contentHash(aCtx);
   return 0;
 }
 
@@ -173,13 +208,15 @@ RSAddDocumentCtx *NewAddDocumentCtx(IndexSpec *sp, Document *b, QueryError *stat
   aCtx->docFlags = 0;
   aCtx->client.bc = NULL;
   aCtx->next = NULL;
+  aCtx->donecb = NULL;
+  aCtx->donecbData = NULL;
   aCtx->specFlags = sp->flags;
   aCtx->indexer = sp->indexer;
   RS_LOG_ASSERT(sp->indexer, "No indexer");
   Indexer_Incref(aCtx->indexer);
 
   // Assign the document:
-  if (AddDocumentCtx_SetDocument(aCtx, sp, b, aCtx->doc.numFields) != 0) {
+  if (AddDocumentCtx_SetDocument(aCtx, sp, b) != 0) {
     *status = aCtx->status;
     aCtx->status.detail = NULL;
     mempool_release(actxPool_g, aCtx);
@@ -255,23 +292,31 @@ static int AddDocumentCtx_ReplaceMerge(RSAddDocumentCtx *aCtx, RedisSearchCtx *s
    * fields must be reindexed.
    */
   // Free the old field data
-  size_t oldFieldCount = aCtx->doc.numFields;
-
   Document_Clear(&aCtx->doc);
   int rv = Document_LoadSchemaFields(&aCtx->doc, sctx);
   if (rv != REDISMODULE_OK) {
     QueryError_SetError(&aCtx->status, QUERY_ENODOC, "Could not load existing document");
-    aCtx->donecb(aCtx, sctx->redisCtx, aCtx->donecbData);
-    AddDocumentCtx_Free(aCtx);
+    doReplyFinish(aCtx, sctx->redisCtx);
     return 1;
   }
 
   // Keep hold of the new fields.
   Document_MakeStringsOwner(&aCtx->doc);
-  AddDocumentCtx_SetDocument(aCtx, sctx->spec, &aCtx->doc, oldFieldCount);
+  AddDocumentCtx_SetDocument(aCtx, sctx->spec, &aCtx->doc);
   return 0;
 }
 
+/* Check if the indexes already have the contents of the document being replaced, so that only
+ * its metadata and sortables need an update. The document table is only up to date when the
+ * context is not queued for the indexer thread */
+static int isContentIndexed(RSAddDocumentCtx *aCtx, RedisSearchCtx *sctx) {
+  if (!(aCtx->options & DOCUMENT_ADD_REPLACE) || AddDocumentCtx_IsBlockable(aCtx)) {
+    return 0;
+  }
+  const RSDocumentMetadata *md = DocTable_GetByKeyR(&sctx->spec->docs, aCtx->doc.docKey);
+  return md && md->contentHash == aCtx->contentHash;
+}
+
 static int handlePartialUpdate(RSAddDocumentCtx *aCtx, RedisSearchCtx *sctx) {
   // Handle partial update of fields
   if (aCtx->stateFlags & ACTX_F_INDEXABLES) {
@@ -290,6 +335,12 @@ void AddDocumentCtx_Submit(RSAddDocumentCtx *aCtx, RedisSearchCtx *sctx, uint32_
   if ((aCtx->options & DOCUMENT_ADD_PARTIAL) && handlePartialUpdate(aCtx, sctx)) {
     return;
   }
+  if (isContentIndexed(aCtx, sctx)) {
+    // e.g. a hash field which is not in the schema, or a sortable-only one, was set. The document
+    // keeps its ID and postings
+    AddDocumentCtx_UpdateNoIndex(aCtx, sctx);
+    return;
+  }
 
   // We actually modify (!) the strings in the document, so we always require
   // ownership
@@ -324,13 +375,9 @@ void AddDocumentCtx_Free(RSAddDocumentCtx *aCtx) {
    * Free preprocessed data; this is the only reliable place
    * to do it
    */
-  for (size_t ii = 0; ii < aCtx->doc.numFields; ++ii) {
-    if (FIELD_IS_VALID(aCtx, ii) && FIELD_IS(aCtx->fspecs + ii, INDEXFLD_T_TAG) &&
-        aCtx->fdatas[ii].tags) {
-      TagIndex_FreePreprocessedData(aCtx->fdatas[ii].tags);
-      aCtx->fdatas[ii].tags = NULL;
-    }
-  }
+  BlkAlloc_Clear(&aCtx->arena, NULL, NULL, 0);
+  aCtx->fspecs = NULL;
+  aCtx->fdatas = NULL;
 
   // Destroy the common fields:
   if (!(aCtx->stateFlags & ACTX_F_NOFREEDOC)) {
@@ -379,12 +426,29 @@ void AddDocumentCtx_Free(RSAddDocumentCtx *aCtx) {
 
 #define FIELD_PREPROCESSOR FIELD_HANDLER
 
-FIELD_PREPROCESSOR(fulltextPreprocessor) {
-  size_t fl;
-  const char *c = RedisModule_StringPtrLen(field->text, &fl);
+static uint32_t tokenizeOptions(const FieldSpec *fs) {
+  uint32_t options = TOKENIZE_DEFAULT_OPTIONS;
+  if (FieldSpec_IsNoStem(fs)) {
+    options |= TOKENIZE_NOSTEM;
+  }
+  if (FieldSpec_IsPhonetics(fs)) {
+    options |= TOKENIZE_PHONETICS;
+  }
+  return options;
+}
+
+FIELD_PREPROCESSOR(fulltextSortablePreprocessor) {
   if (FieldSpec_IsSortable(fs)) {
+    const char *c = RedisModule_StringPtrLen(field->text, NULL);
     RSSortingVector_Put(aCtx->sv, fs->sortIdx, (void *)c, RS_SORTABLE_STR);
   }
+  return 0;
+}
+
+FIELD_PREPROCESSOR(fulltextPreprocessor) {
+  size_t fl;
+  const char *c = RedisModule_StringPtrLen(field->text, &fl);
+  fulltextSortablePreprocessor(aCtx, field, fs, fdata, status);
 
   if (FieldSpec_IsIndexable(fs)) {
     ForwardIndexTokenizerCtx tokCtx;
@@ -397,14 +461,7 @@ FIELD_PREPROCESSOR(fulltextPreprocessor) {
 
     ForwardIndexTokenizerCtx_Init(&tokCtx, aCtx->fwIdx, c, curOffsetWriter, fs->ftId, fs->ftWeight);
 
-    uint32_t options = TOKENIZE_DEFAULT_OPTIONS;
-    if (FieldSpec_IsNoStem(fs)) {
-      options |= TOKENIZE_NOSTEM;
-    }
-    if (FieldSpec_IsPhonetics(fs)) {
-      options |= TOKENIZE_PHONETICS;
-    }
-    aCtx->tokenizer->Start(aCtx->tokenizer, (char *)c, fl, options);
+    aCtx->tokenizer->Start(aCtx->tokenizer, (char *)c, fl, tokenizeOptions(fs));
 
     Token tok = {0};
     uint32_t newTokPos;
@@ -423,7 +480,15 @@ FIELD_PREPROCESSOR(fulltextPreprocessor) {
 }
 
 FIELD_PREPROCESSOR(numericPreprocessor) {
-  if (RedisModule_StringToDouble(field->text, &fdata->numeric) == REDISMODULE_ERR) {
+  if (FieldSpec_IsInt64(fs)) {
+    long long ll;
+    if (RedisModule_StringToLongLong(field->text, &ll) == REDISMODULE_ERR) {
+      QueryError_SetCode(status, QUERY_ENOTNUMERIC);
+      return -1;
+    }
+    fdata->intval = ll;
+    fdata->numeric = (double)ll;
+  } else if (RedisModule_StringToDouble(field->text, &fdata->numeric) == REDISMODULE_ERR) {
     QueryError_SetCode(status, QUERY_ENOTNUMERIC);
     return -1;
   }
@@ -452,6 +517,21 @@ FIELD_BULK_INDEXER(numericIndexer) {
   return 0;
 }
 
+FIELD_BULK_INDEXER(intIndexer) {
+  IntIndex *idx = bulk->indexDatas[IXFLDPOS_NUMERIC];
+  if (!idx) {
+    RedisModuleString *keyName = IndexSpec_GetFormattedKey(ctx->spec, fs, INDEXFLD_T_NUMERIC);
+    idx = bulk->indexDatas[IXFLDPOS_NUMERIC] = OpenIntIndex(ctx, keyName, 1);
+    if (!idx) {
+      QueryError_SetError(status, QUERY_EGENERIC, "Could not open int index for indexing");
+      return -1;
+    }
+  }
+  ctx->spec->stats.invertedSize += IntIndex_Add(idx, aCtx->doc.docId, fdata->intval);
+  ctx->spec->stats.numRecords++;
+  return 0;
+}
+
 FIELD_PREPROCESSOR(geoPreprocessor) {
   // TODO: streamline
   const char *c = RedisModule_StringPtrLen(field->text, NULL);
@@ -479,7 +559,7 @@ FIELD_PREPROCESSOR(geoPreprocessor) {
 }
 
 FIELD_PREPROCESSOR(tagPreprocessor) {
-  fdata->tags = TagIndex_Preprocess(fs->tagSep, fs->tagFlags, field);
+  fdata->tags = TagIndex_Preprocess(fs->tagSep, fs->tagFlags, field, &aCtx->arena, &fdata->numTags);
 
   if (fdata->tags == NULL) {
     return 0;
@@ -505,7 +585,7 @@ FIELD_BULK_INDEXER(tagIndexer) {
   }
 
   ctx->spec->stats.invertedSize +=
-      TagIndex_Index(tidx, (const char **)fdata->tags, array_len(fdata->tags), aCtx->doc.docId);
+      TagIndex_Index(tidx, (const char **)fdata->tags, fdata->numTags, aCtx->doc.docId);
   ctx->spec->stats.numRecords++;
   return 0;
 }
@@ -529,6 +609,11 @@ int IndexerBulkAdd(IndexBulkData *bulk, RSAddDocumentCtx *cur, RedisSearchCtx *s
           rc = tagIndexer(bulk, cur, sctx, field, fs, fdata, status);
           break;
         case IXFLDPOS_NUMERIC:
+          if (FieldSpec_IsInt64(fs)) {
+            rc = intIndexer(bulk, cur, sctx, field, fs, fdata, status);
+            break;
+          }
+          // fall through
         case IXFLDPOS_GEO:
           rc = numericIndexer(bulk, cur, sctx, field, fs, fdata, status);
           break;
@@ -552,9 +637,243 @@ void IndexerBulkCleanup(IndexBulkData *cur, RedisSearchCtx *sctx) {
   }
 }
 
-int Document_AddToIndexes(RSAddDocumentCtx *aCtx) {
+////////////////////////////////////////////////////////////////////////////////
+/// Parallel tokenization of large documents                                 ///
+////////////////////////////////////////////////////////////////////////////////
+
+// Fields are split into chunks of at least this size, so a few large fields keep all the threads
+// busy
+#define TOKENIZE_MIN_CHUNK_SIZE (16 * 1024)
+
+static WorkPool *tokenizePool_g = NULL;
+static pthread_mutex_t tokenizePoolLock_g = PTHREAD_MUTEX_INITIALIZER;
+
+typedef struct {
+  const FieldSpec *fs;
+  // The text of the field, and the chunk of it the task tokenizes. The tokenizer stops at a NUL, so
+  // the separator ending the chunk is replaced by one while the chunks are tokenized
+  char *text;
+  size_t begin;
+  size_t end;
+  char sep;
+  // The tokens of the chunk, at positions from 1, and their offsets from the start of the field
+  ForwardIndex *fwIdx;
+  ByteOffsetWriter offsets;
+  uint32_t numTokens;
+} tokenizeTask;
+
+typedef struct {
+  RSAddDocumentCtx *aCtx;
+  tokenizeTask *tasks;
+  size_t numTasks;
+  // The next task to run. Tasks are taken by the pool threads and by the thread of the document
+  size_t next;
+  // Finished tasks, and the pool threads which helped and left
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  size_t done;
+  size_t helpersLeft;
+} tokenizeJob;
+
+static void tokenizeChunk(RSAddDocumentCtx *aCtx, tokenizeTask *t) {
+  // the pools of tokenizers may only be used with the GIL held
+  RSTokenizer *tokenizer = NewSimpleTokenizer(t->fwIdx->stemmer, aCtx->tokenizer->ctx.stopwords,
+                                              TOKENIZE_DEFAULT_OPTIONS);
+  ForwardIndexTokenizerCtx tokCtx;
+  ForwardIndexTokenizerCtx_Init(&tokCtx, t->fwIdx, t->text, aCtx->byteOffsets ? &t->offsets : NULL,
+                                t->fs->ftId, t->fs->ftWeight);
+  tokenizer->Start(tokenizer, t->text + t->begin, t->end - t->begin, tokenizeOptions(t->fs));
+
+  Token tok = {0};
+  while (tokenizer->Next(tokenizer, &tok)) {
+    forwardIndexTokenFunc(&tokCtx, &tok);
+  }
+  t->numTokens = tokenizer->ctx.lastOffset;
+  Token_Destroy(&tok);
+  if (tokenizer->ctx.stopwords) {
+    StopWordList_Unref(tokenizer->ctx.stopwords);
+  }
+  tokenizer->Free(tokenizer);
+}
+
+/* Run tasks of the job until none is left. Returns the number of tasks run */
+static size_t runTokenizeTasks(tokenizeJob *job) {
+  size_t n = 0;
+  size_t ix;
+  while ((ix = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED)) < job->numTasks) {
+    tokenizeChunk(job->aCtx, &job->tasks[ix]);
+    n++;
+  }
+  return n;
+}
+
+static void tokenizeHelper(void *arg) {
+  tokenizeJob *job = arg;
+  size_t n = runTokenizeTasks(job);
+  pthread_mutex_lock(&job->lock);
+  job->done += n;
+  job->helpersLeft++;
+  pthread_cond_signal(&job->cond);
+  pthread_mutex_unlock(&job->lock);
+}
+
+static WorkPool *getTokenizePool(void) {
+  pthread_mutex_lock(&tokenizePoolLock_g);
+  if (!tokenizePool_g) {
+    tokenizePool_g = NewWorkPool(ConcurrentSearch_NumIndexThreads());
+  }
+  pthread_mutex_unlock(&tokenizePoolLock_g);
+  return tokenizePool_g;
+}
+
+void Document_TokenizePoolDestroy(void) {
+  if (tokenizePool_g) {
+    WorkPool_Free(tokenizePool_g);
+    tokenizePool_g = NULL;
+  }
+}
+
+static int isTokenizedText(const DocumentField *ff, const FieldSpec *fs) {
+  return fs->name && FIELD_CHKIDX(ff->indexAs, INDEXFLD_T_FULLTEXT) && FieldSpec_IsIndexable(fs);
+}
+
+/* Split the text into chunks of about chunkSize, ending before a token separator, and add them to
+ * the tasks. Every chunk but the last one is at least chunkSize long */
+static void splitField(tokenizeTask *tasks, size_t *numTasks, const FieldSpec *fs, char *text,
+                       size_t len, size_t chunkSize) {
+  size_t begin = 0;
+  do {
+    size_t end = len;
+    if (len - begin > chunkSize + chunkSize / 2) {
+      end = begin + chunkSize;
+      // a separator escaped by a backslash is a part of a token
+      while (end < len && !(istoksep(text[end]) && text[end - 1] != '\\')) {
+        end++;
+      }
+    }
+    tasks[(*numTasks)++] =
+        (tokenizeTask){.fs = fs, .text = text, .begin = begin, .end = end, .sep = text[end]};
+    // the separator ending the chunk is not a part of any token
+    text[end] = '\0';
+    begin = end + 1;
+  } while (begin < len);
+}
+
+/* Tokenize the text fields of a large document on the threads of the tokenization pool, each field
+ * or chunk of a field into a forward index of its own. The indexes are merged in the order of the
+ * document, so the positions and byte offsets of the tokens are the ones of serial tokenization.
+ * Returns 1 if the text was tokenized, and its sortable values taken, or 0 if the document should
+ * be tokenized serially */
+static int tokenizeInParallel(RSAddDocumentCtx *aCtx) {
   Document *doc = &aCtx->doc;
-  int ourRv = REDISMODULE_OK;
+  size_t minSize = RSGlobalConfig.parallelTokenizeMinSize;
+  if (!minSize) {
+    return 0;
+  }
+  size_t textLen = 0;
+  for (size_t i = 0; i < doc->numFields; i++) {
+    if (isTokenizedText(doc->fields + i, aCtx->fspecs + i)) {
+      size_t fl;
+      RedisModule_StringPtrLen(doc->fields[i].text, &fl);
+      textLen += fl;
+    }
+  }
+  size_t numThreads = ConcurrentSearch_NumIndexThreads();
+  // the Chinese tokenizer segments the text with a dictionary, which is set up on first use
+  if (textLen < minSize || numThreads < 2 || doc->language == RS_LANG_CHINESE) {
+    return 0;
+  }
+
+  // a couple of chunks for every thread
+  size_t chunkSize = MAX(TOKENIZE_MIN_CHUNK_SIZE, textLen / (numThreads * 2));
+  size_t maxTasks = 0;
+  for (size_t i = 0; i < doc->numFields; i++) {
+    if (isTokenizedText(doc->fields + i, aCtx->fspecs + i)) {
+      size_t fl;
+      RedisModule_StringPtrLen(doc->fields[i].text, &fl);
+      maxTasks += fl / chunkSize + 1;
+    }
+  }
+  // the tokenizer normalizes the text in place, so the sortable values are taken first, as
+  // fulltextPreprocessor does
+  for (size_t i = 0; i < doc->numFields; i++) {
+    const FieldSpec *fs = aCtx->fspecs + i;
+    if (fs->name && FIELD_CHKIDX(doc->fields[i].indexAs, INDEXFLD_T_FULLTEXT)) {
+      fulltextSortablePreprocessor(aCtx, doc->fields + i, fs, aCtx->fdatas + i, &aCtx->status);
+    }
+  }
+
+  tokenizeTask *tasks = BlkAlloc_ArenaAlloc(&aCtx->arena, maxTasks * sizeof(*tasks));
+  size_t n = 0;
+  for (size_t i = 0; i < doc->numFields; i++) {
+    if (isTokenizedText(doc->fields + i, aCtx->fspecs + i)) {
+      size_t fl;
+      char *c = (char *)RedisModule_StringPtrLen(doc->fields[i].text, &fl);
+      splitField(tasks, &n, aCtx->fspecs + i, c, fl, chunkSize);
+    }
+  }
+  if (!aCtx->chunkIdxs) {
+    aCtx->chunkIdxs = array_new(ForwardIndex *, n);
+  }
+  for (size_t i = 0; i < n; i++) {
+    tokenizeTask *t = &tasks[i];
+    // the forward indexes of the chunks are kept with the context, and reset for the next document
+    if (i < array_len(aCtx->chunkIdxs)) {
+      t->fwIdx = aCtx->chunkIdxs[i];
+      ForwardIndex_Reset(t->fwIdx, doc, aCtx->fwIdx->idxFlags);
+    } else {
+      t->fwIdx = NewForwardIndexForText(t->end - t->begin, doc->language, aCtx->fwIdx->idxFlags);
+      aCtx->chunkIdxs = array_append(aCtx->chunkIdxs, t->fwIdx);
+    }
+    // the synonym map is read only, and owned by the index of the document
+    t->fwIdx->smap = aCtx->fwIdx->smap;
+    if (aCtx->byteOffsets) {
+      ByteOffsetWriter_Init(&t->offsets);
+    }
+  }
+
+  tokenizeJob job = {.aCtx = aCtx, .tasks = tasks, .numTasks = n};
+  pthread_mutex_init(&job.lock, NULL);
+  pthread_cond_init(&job.cond, NULL);
+  // this thread runs tasks too, so the document gets tokenized even if the pool is busy
+  size_t numHelpers = MIN(n - 1, numThreads);
+  WorkPool *pool = getTokenizePool();
+  for (size_t i = 0; i < numHelpers; i++) {
+    WorkPool_Add(pool, tokenizeHelper, &job);
+  }
+  size_t ran = runTokenizeTasks(&job);
+  pthread_mutex_lock(&job.lock);
+  job.done += ran;
+  while (job.done < n || job.helpersLeft < numHelpers) {
+    pthread_cond_wait(&job.cond, &job.lock);
+  }
+  pthread_mutex_unlock(&job.lock);
+  pthread_mutex_destroy(&job.lock);
+  pthread_cond_destroy(&job.cond);
+
+  RSByteOffsetField *curOffsetField = NULL;
+  for (size_t i = 0; i < n; i++) {
+    tokenizeTask *t = &tasks[i];
+    t->text[t->end] = t->sep;
+    if (aCtx->byteOffsets && t->begin == 0) {
+      curOffsetField =
+          RSByteOffsets_AddField(aCtx->byteOffsets, t->fs->ftId, aCtx->totalTokens + 1);
+    }
+    ForwardIndex_Merge(aCtx->fwIdx, t->fwIdx, aCtx->totalTokens);
+    aCtx->totalTokens += t->numTokens;
+    if (aCtx->byteOffsets) {
+      VVW_Append(&aCtx->offsetsWriter, &t->offsets, 0);
+      curOffsetField->lastTokPos = aCtx->totalTokens;
+      ByteOffsetWriter_Cleanup(&t->offsets);
+    }
+    t->fwIdx->smap = NULL;
+  }
+  return 1;
+}
+
+int Document_Preprocess(RSAddDocumentCtx *aCtx) {
+  Document *doc = &aCtx->doc;
+  int textTokenized = tokenizeInParallel(aCtx);
 
   for (size_t i = 0; i < doc->numFields; i++) {
     const FieldSpec *fs = aCtx->fspecs + i;
@@ -571,13 +890,26 @@ int Document_AddToIndexes(RSAddDocumentCtx *aCtx) {
         continue;
       }
 
+      if (ii == IXFLDPOS_FULLTEXT && textTokenized) {
+        // tokenized, and put in the sorting vector, by tokenizeInParallel
+        continue;
+      }
       PreprocessorFunc pp = preprocessorMap[ii];
       if (pp(aCtx, &doc->fields[i], fs, fdata, &aCtx->status) != 0) {
-        ourRv = REDISMODULE_ERR;
-        goto cleanup;
+        return REDISMODULE_ERR;
       }
     }
   }
+  return REDISMODULE_OK;
+}
+
+int Document_AddToIndexes(RSAddDocumentCtx *aCtx) {
+  int ourRv = REDISMODULE_OK;
+
+  if (Document_Preprocess(aCtx) != REDISMODULE_OK) {
+    ourRv = REDISMODULE_ERR;
+    goto cleanup;
+  }
 
   if (Indexer_Add(aCtx->indexer, aCtx) != 0) {
     ourRv = REDISMODULE_ERR;
@@ -713,7 +1045,13 @@ static void AddDocumentCtx_UpdateNoIndex(RSAddDocumentCtx *aCtx, RedisSearchCtx
           break;
         case INDEXFLD_T_NUMERIC: {
           double numval;
-          if (RedisModule_StringToDouble(f->text, &numval) == REDISMODULE_ERR) {
+          if (FieldSpec_IsInt64(fs)) {
+            long long ll;
+            if (RedisModule_StringToLongLong(f->text, &ll) == REDISMODULE_ERR) {
+              BAIL("Could not parse integer index value");
+            }
+            numval = (double)ll;
+          } else if (RedisModule_StringToDouble(f->text, &numval) == REDISMODULE_ERR) {
             BAIL("Could not parse numeric index value");
           }
           RSSortingVector_Put(md->sortVector, idx, &numval, RS_SORTABLE_NUM);
@@ -727,10 +1065,7 @@ static void AddDocumentCtx_UpdateNoIndex(RSAddDocumentCtx *aCtx, RedisSearchCtx
   }
 
 done:
-  if (aCtx->donecb) {
-    aCtx->donecb(aCtx, sctx->redisCtx, aCtx->donecbData);
-  }
-  AddDocumentCtx_Free(aCtx);
+  doReplyFinish(aCtx, sctx->redisCtx);
 }
 
 DocumentField *Document_GetField(Document *d, const char *fieldName) {
@@ -9,6 +9,7 @@
 #include "byte_offsets.h"
 #include "rmutil/args.h"
 #include "query_error.h"
+#include "util/block_alloc.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -243,8 +244,18 @@ typedef struct RSAddDocumentCtx {
   // New flags to assign to the document
   RSDocumentFlags docFlags;
 
+  // Hash of the indexed contents of the document (see RSDocumentMetadata)
+  uint64_t contentHash;
+
   // Scratch space used by per-type field preprocessors (see the source)
   struct FieldIndexerData *fdatas;
+
+  // Transient allocations made while indexing the document, such as the field specs and the
+  // preprocessed tags (see BlkAlloc_ArenaAlloc). They are released at once when the context is
+  // freed, and the blocks are kept for the next document
+  BlkAlloc arena;
+  // Forward indexes of the chunks of text tokenized in parallel, kept for the next document
+  struct ForwardIndex **chunkIdxs;
   QueryError status;     // Error message is placed here if there is an error during processing
   uint32_t totalTokens;  // Number of tokens, used for offset vector
   uint32_t specFlags;    // Cached index flags
@@ -293,6 +304,22 @@ void AddDocumentCtx_Finish(RSAddDocumentCtx *aCtx);
  */
 int Document_AddToIndexes(RSAddDocumentCtx *ctx);
 
+/**
+ * Run the preprocessors (tokenization, input validation, etc.) on the fields of
+ * the document, without writing anything to the index. This is the part of
+ * Document_AddToIndexes() which may run in parallel for several documents.
+ *
+ * Returns REDISMODULE_ERR if a field could not be processed, and the error is
+ * set on the context's status.
+ */
+int Document_Preprocess(RSAddDocumentCtx *ctx);
+
+/**
+ * Stop the threads tokenizing large documents (see PARALLEL_TOKENIZE_MIN_SIZE). They are started
+ * when the first such document is indexed.
+ */
+void Document_TokenizePoolDestroy(void);
+
 /**
  * Free the AddDocumentCtx. Should be done once AddToIndexes() completes; or
  * when the client is unblocked.
@@ -12,6 +12,7 @@
 #include "../rmutil/vector.h"
 #include "../stemmer.h"
 #include "../phonetic_manager.h"
+#include "../word_cache.h"
 #include "../score_explain.h"
 
 /******************************************************************************************
@@ -383,11 +384,19 @@ int StemmerExpander(RSQueryExpanderCtx *ctx, RSToken *token) {
     return REDISMODULE_OK;
   }
 
-  const sb_symbol *b = (const sb_symbol *)token->str;
-  const sb_symbol *stemmed = sb_stemmer_stem(sb, b, token->len);
+  char cached[WORDCACHE_MAX_LEN];
+  WordCache *cache = WordCache_Get(WORDCACHE_STEMS, ctx->language);
+  int sl = cache ? WordCache_Lookup(cache, token->str, token->len, cached) : -1;
+  const sb_symbol *stemmed = (const sb_symbol *)cached;
+  if (sl < 0) {
+    stemmed = sb_stemmer_stem(sb, (const sb_symbol *)token->str, token->len);
+    sl = stemmed ? sb_stemmer_length(sb) : 0;
+    if (stemmed && cache) {
+      WordCache_Put(cache, token->str, token->len, (const char *)stemmed, sl);
+    }
+  }
 
   if (stemmed) {
-    int sl = sb_stemmer_length(sb);
 
     // Make a copy of the stemmed buffer with the + prefix given to stems
     char *dup = rm_malloc(sl + 2);
@@ -5,6 +5,7 @@
 #include "redis_index.h"
 #include "numeric_index.h"
 #include "tag_index.h"
+#include "int_index.h"
 #include "tests/time_sample.h"
 #include <stdlib.h>
 #include <stdbool.h>
@@ -112,7 +113,9 @@ static void FGC_sendTerminator(ForkGC *fgc) {
 
 static int __attribute__((warn_unused_result)) FGC_recvFixed(ForkGC *fgc, void *buf, size_t len) {
   while (len) {
+    uint64_t start = LatencyStats_Now();
     ssize_t nrecvd = read(fgc->pipefd[GC_READERFD], buf, len);
+    fgc->childWaitUS += LatencyStats_Now() - start;
     if (nrecvd > 0) {
       buf += nrecvd;
       len -= nrecvd;
@@ -412,7 +415,7 @@ static void sendKht(ForkGC *gc, const khash_t(cardvals) *kh) {
 
 static void FGC_childCollectNumeric(ForkGC *gc, RedisSearchCtx *sctx) {
   RedisModuleKey *idxKey = NULL;
-  FieldSpec **numericFields = getFieldsByType(sctx->spec, INDEXFLD_T_NUMERIC | INDEXFLD_T_GEO);
+  FieldSpec **numericFields = getRangeTreeFields(sctx->spec);
 
   for (int i = 0; i < array_len(numericFields); ++i) {
     RedisModuleString *keyName =
@@ -505,6 +508,41 @@ static void FGC_childCollectTags(ForkGC *gc, RedisSearchCtx *sctx) {
   FGC_sendTerminator(gc);
 }
 
+static void FGC_childCollectInts(ForkGC *gc, RedisSearchCtx *sctx) {
+  FieldSpec **numericFields = getFieldsByType(sctx->spec, INDEXFLD_T_NUMERIC);
+  for (int i = 0; i < array_len(numericFields); ++i) {
+    if (!FieldSpec_IsInt64(numericFields[i])) {
+      continue;
+    }
+    RedisModuleString *keyName =
+        IndexSpec_GetFormattedKey(sctx->spec, numericFields[i], INDEXFLD_T_NUMERIC);
+    IntIndex *idx = OpenIntIndex(sctx, keyName, 0);
+    if (!idx) {
+      continue;
+    }
+
+    // send the ids of the deleted documents, for the parent to clear from the slices
+    Bitmap deleted;
+    IntIndex_FindDeleted(idx, &sctx->spec->docs, &deleted);
+    size_t n = Bitmap_Card(&deleted);
+    if (n) {
+      t_docId *ids = rm_malloc(n * sizeof(*ids));
+      size_t ii = 0;
+      for (t_docId id = Bitmap_Next(&deleted, 1); id; id = Bitmap_Next(&deleted, id + 1)) {
+        ids[ii++] = id;
+      }
+      FGC_sendBuffer(gc, numericFields[i]->name, strlen(numericFields[i]->name));
+      FGC_sendBuffer(gc, ids, n * sizeof(*ids));
+      rm_free(ids);
+    }
+    Bitmap_Cleanup(&deleted);
+  }
+  array_free(numericFields);
+
+  // we are done with int fields
+  FGC_sendTerminator(gc);
+}
+
 static void FGC_childScanIndexes(ForkGC *gc) {
   RedisSearchCtx *sctx = FGC_getSctx(gc, gc->ctx);
   if (!sctx || sctx->spec->uniqueId != gc->specUniqueId) {
@@ -515,6 +553,7 @@ static void FGC_childScanIndexes(ForkGC *gc) {
   FGC_childCollectTerms(gc, sctx);
   FGC_childCollectNumeric(gc, sctx);
   FGC_childCollectTags(gc, sctx);
+  FGC_childCollectInts(gc, sctx);
 
   SearchCtx_Free(sctx);
 }
@@ -753,6 +792,7 @@ static FGCError FGC_parentHandleTerms(ForkGC *gc, RedisModuleCtx *rctx) {
 
   FGC_applyInvertedIndex(gc, &idxbufs, &info, idx);
   FGC_updateStats(sctx, gc, info.ndocsCollected, info.nbytesCollected);
+  IndexSpec_InvalidateTermStats(sctx->spec, term, len);
 
 cleanup:
 
@@ -1043,6 +1083,58 @@ static FGCError FGC_parentHandleTags(ForkGC *gc, RedisModuleCtx *rctx) {
   return status;
 }
 
+static FGCError FGC_parentHandleInts(ForkGC *gc, RedisModuleCtx *rctx) {
+  size_t fieldNameLen, idsLen;
+  char *fieldName = NULL;
+  t_docId *ids = NULL;
+  if (FGC_recvBuffer(gc, (void **)&fieldName, &fieldNameLen) != REDISMODULE_OK) {
+    return FGC_CHILD_ERROR;
+  }
+  if (fieldName == RECV_BUFFER_EMPTY) {
+    return FGC_DONE;
+  }
+
+  FGCError status = FGC_COLLECTED;
+  Bitmap deleted;
+  Bitmap_Init(&deleted);
+  if (FGC_recvBuffer(gc, (void **)&ids, &idsLen) != REDISMODULE_OK) {
+    status = FGC_CHILD_ERROR;
+    goto cleanup;
+  }
+  for (size_t ii = 0; ii < idsLen / sizeof(*ids); ++ii) {
+    Bitmap_Set(&deleted, ids[ii]);
+  }
+
+  if (!FGC_lock(gc, rctx)) {
+    status = FGC_PARENT_ERROR;
+    goto cleanup;
+  }
+  RedisSearchCtx *sctx = FGC_getSctx(gc, rctx);
+  if (!sctx || sctx->spec->uniqueId != gc->specUniqueId) {
+    status = FGC_PARENT_ERROR;
+  } else {
+    RedisModuleString *keyName =
+        IndexSpec_GetFormattedKeyByName(sctx->spec, fieldName, INDEXFLD_T_NUMERIC);
+    IntIndex *idx = keyName ? OpenIntIndex(sctx, keyName, 0) : NULL;
+    if (idx) {
+      // Deleted documents never come back to life, so the ids are still dead in the parent
+      size_t nbytes;
+      size_t ndocs = IntIndex_RemoveDocs(idx, &deleted, &nbytes);
+      FGC_updateStats(sctx, gc, ndocs, nbytes);
+    }
+  }
+  if (sctx) {
+    SearchCtx_Free(sctx);
+  }
+  FGC_unlock(gc, rctx);
+
+cleanup:
+  Bitmap_Cleanup(&deleted);
+  rm_free(ids);
+  rm_free(fieldName);
+  return status;
+}
+
 int FGC_parentHandleFromChild(ForkGC *gc) {
   FGCError status = FGC_COLLECTED;
 
@@ -1056,6 +1148,7 @@ int FGC_parentHandleFromChild(ForkGC *gc) {
   COLLECT_FROM_CHILD(FGC_parentHandleTerms(gc, gc->ctx));
   COLLECT_FROM_CHILD(FGC_parentHandleNumeric(gc, gc->ctx));
   COLLECT_FROM_CHILD(FGC_parentHandleTags(gc, gc->ctx));
+  COLLECT_FROM_CHILD(FGC_parentHandleInts(gc, gc->ctx));
   return REDISMODULE_OK;
 }
 
@@ -1134,7 +1227,9 @@ static int periodicCb(RedisModuleCtx *ctx, void *privdata) {
 
   gc->execState = FGC_STATE_SCANNING;
 
+  uint64_t forkStart = LatencyStats_Now();
   cpid = FGC_fork(gc, ctx);  // duplicate the current process
+  uint64_t forkTime = LatencyStats_Now() - forkStart;
 
   if (cpid == -1) {
     gc->retryInterval.tv_sec = RSGlobalConfig.forkGcRetryInterval;
@@ -1191,9 +1286,16 @@ static int periodicCb(RedisModuleCtx *ctx, void *privdata) {
     }
 
     gc->execState = FGC_STATE_APPLYING;
+    gc->childWaitUS = 0;
+    uint64_t applyStart = LatencyStats_Now();
     if (FGC_parentHandleFromChild(gc) == REDISMODULE_ERR) {
       gcrv = 1;
     }
+    // The child sends its findings while it scans, so waiting on the pipe is waiting on the child
+    uint64_t applyTime = LatencyStats_Now() - applyStart;
+    LatencyStats_Record(&gc->stats.latency, LATENCY_GC_FORK, forkTime);
+    LatencyStats_Record(&gc->stats.latency, LATENCY_GC_CHILD, gc->childWaitUS);
+    LatencyStats_Record(&gc->stats.latency, LATENCY_GC_APPLY, applyTime - gc->childWaitUS);
     close(gc->pipefd[GC_READERFD]);
     if (FGC_haveRedisFork()) {
 
@@ -1282,6 +1384,7 @@ static void onTerminateCb(void *privdata) {
     RedisModule_FreeString(gc->ctx, (RedisModuleString *)gc->keyName);
   }
 
+  LatencyStats_Free(&gc->stats.latency);
   RedisModule_FreeThreadSafeContext(gc->ctx);
   rm_free(gc);
 }
@@ -1307,6 +1410,11 @@ static void statsCb(RedisModuleCtx *ctx, void *gcCtx) {
   RedisModule_ReplySetArrayLength(ctx, n);
 }
 
+static LatencyStats *latencyStatsCb(void *ctx) {
+  ForkGC *gc = ctx;
+  return &gc->stats.latency;
+}
+
 static void killCb(void *ctx) {
   ForkGC *gc = ctx;
   gc->deleting = 1;
@@ -1341,6 +1449,7 @@ ForkGC *FGC_New(const RedisModuleString *k, uint64_t specUniqueId, GCCallbacks *
   callbacks->onTerm = onTerminateCb;
   callbacks->periodicCallback = periodicCb;
   callbacks->renderStats = statsCb;
+  callbacks->getLatencyStats = latencyStatsCb;
   callbacks->getInterval = getIntervalCb;
   callbacks->kill = killCb;
   callbacks->onDelete = deleteCb;
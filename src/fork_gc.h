@@ -4,6 +4,7 @@
 
 #include "redismodule.h"
 #include "gc.h"
+#include "latency_stats.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -22,6 +23,9 @@ typedef struct {
 
   uint64_t gcNumericNodesMissed;
   uint64_t gcBlocksDenied;
+
+  // fork, child and apply times of the cycles
+  LatencyStats latency;
 } ForkGCStats;
 
 typedef enum FGCType { FGC_TYPE_INKEYSPACE, FGC_TYPE_NOKEYSPACE } FGCType;
@@ -54,6 +58,9 @@ typedef struct ForkGC {
 
   struct timespec retryInterval;
   volatile size_t deletedDocsFromLastRun;
+
+  // time spent waiting on the child in the current cycle, in microseconds
+  uint64_t childWaitUS;
 } ForkGC;
 
 ForkGC *FGC_New(const RedisModuleString *k, uint64_t specUniqueId, GCCallbacks *callbacks);
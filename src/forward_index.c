@@ -63,22 +63,22 @@ static void vvwFree(void *p) {
   rm_free(p);
 }
 
-static void ForwardIndex_InitCommon(ForwardIndex *idx, Document *doc, uint32_t idxFlags) {
+static void ForwardIndex_InitCommon(ForwardIndex *idx, RSLanguage language, uint32_t idxFlags) {
   idx->idxFlags = idxFlags;
   idx->maxFreq = 0;
   idx->totalFreq = 0;
 
-  if (idx->stemmer && !ResetStemmer(idx->stemmer, SnowballStemmer, doc->language)) {
+  if (idx->stemmer && !ResetStemmer(idx->stemmer, SnowballStemmer, language)) {
     idx->stemmer->Free(idx->stemmer);
     idx->stemmer = NULL;
   }
 
   if (!idx->stemmer) {
-    idx->stemmer = NewStemmer(SnowballStemmer, doc->language);
+    idx->stemmer = NewStemmer(SnowballStemmer, language);
   }
 }
 
-ForwardIndex *NewForwardIndex(Document *doc, uint32_t idxFlags) {
+static ForwardIndex *newForwardIndex(size_t termCount, RSLanguage language, uint32_t idxFlags) {
   ForwardIndex *idx = rm_malloc(sizeof(ForwardIndex));
 
   BlkAlloc_Init(&idx->terms);
@@ -90,19 +90,27 @@ ForwardIndex *NewForwardIndex(Document *doc, uint32_t idxFlags) {
       .Hash = khtHash,
   };
 
-  size_t termCount = estimtateTermCount(doc);
   idx->hits = rm_calloc(1, sizeof(*idx->hits));
   idx->stemmer = NULL;
+  idx->smap = NULL;
   idx->totalFreq = 0;
 
   KHTable_Init(idx->hits, &procs, &idx->entries, termCount);
   mempool_options options = {.initialCap = termCount, .alloc = vvwAlloc, .free = vvwFree};
   idx->vvwPool = mempool_new(&options);
 
-  ForwardIndex_InitCommon(idx, doc, idxFlags);
+  ForwardIndex_InitCommon(idx, language, idxFlags);
   return idx;
 }
 
+ForwardIndex *NewForwardIndex(Document *doc, uint32_t idxFlags) {
+  return newForwardIndex(estimtateTermCount(doc), doc->language, idxFlags);
+}
+
+ForwardIndex *NewForwardIndexForText(size_t textLen, RSLanguage language, uint32_t idxFlags) {
+  return newForwardIndex(textLen / CHARS_PER_TERM, language, idxFlags);
+}
+
 static void clearEntry(void *elem, void *pool) {
   khIdxEntry *ent = elem;
   ForwardIndexEntry *fwEnt = &ent->ent;
@@ -121,7 +129,7 @@ void ForwardIndex_Reset(ForwardIndex *idx, Document *doc, uint32_t idxFlags) {
     idx->smap = NULL;
   }
 
-  ForwardIndex_InitCommon(idx, doc, idxFlags);
+  ForwardIndex_InitCommon(idx, doc->language, idxFlags);
 }
 
 static inline int hasOffsets(const ForwardIndex *idx) {
@@ -186,6 +194,7 @@ static void ForwardIndex_HandleToken(ForwardIndex *idx, const char *tok, size_t
 
     h->len = tokLen;
     h->freq = 0;
+    h->occurrences = 0;
 
     if (hasOffsets(idx)) {
       h->vw = mempool_get(idx->vvwPool);
@@ -207,6 +216,7 @@ static void ForwardIndex_HandleToken(ForwardIndex *idx, const char *tok, size_t
     score *= STEM_TOKEN_FACTOR;
   }
   h->freq += MAX(1, (uint32_t)score);
+  h->occurrences++;
   idx->maxFreq = MAX(h->freq, idx->maxFreq);
   idx->totalFreq += h->freq;
   if (h->vw) {
@@ -264,6 +274,44 @@ int forwardIndexTokenFunc(void *ctx, const Token *tokInfo) {
   return 0;
 }
 
+void ForwardIndex_Merge(ForwardIndex *dst, ForwardIndex *src, uint32_t posOffset) {
+  ForwardIndexIterator it = ForwardIndex_Iterate(src);
+  ForwardIndexEntry *se;
+  while ((se = ForwardIndexIterator_Next(&it))) {
+    int isNew = 0;
+    khIdxEntry *kh = makeEntry(dst, se->term, se->len, se->hash, &isNew);
+    ForwardIndexEntry *h = &kh->ent;
+    if (isNew) {
+      // the term may live in the memory of src
+      h->fieldMask = 0;
+      h->hash = se->hash;
+      h->next = NULL;
+      h->term = copyTempString(dst, se->term, se->len);
+      h->len = se->len;
+      h->freq = 0;
+      h->occurrences = 0;
+      if (hasOffsets(dst)) {
+        h->vw = mempool_get(dst->vvwPool);
+        VVW_Reset(h->vw);
+      } else {
+        h->vw = NULL;
+      }
+    }
+
+    // every occurrence in src added the running frequency of the term to totalFreq, which was
+    // larger by the frequency of the term in dst
+    dst->totalFreq += se->occurrences * h->freq;
+    h->fieldMask |= se->fieldMask;
+    h->freq += se->freq;
+    h->occurrences += se->occurrences;
+    dst->maxFreq = MAX(h->freq, dst->maxFreq);
+    if (h->vw && se->vw) {
+      VVW_Append(h->vw, se->vw, posOffset);
+    }
+  }
+  dst->totalFreq += src->totalFreq;
+}
+
 ForwardIndexEntry *ForwardIndex_Find(ForwardIndex *i, const char *s, size_t n, uint32_t hash) {
   KHTableEntry *baseEnt = KHTable_GetEntry(i->hits, s, n, hash, NULL);
   if (!baseEnt) {
@@ -9,11 +9,17 @@
 #include "tokenize.h"
 #include "document.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef struct ForwardIndexEntry {
   struct ForwardIndexEntry *next;
   t_docId docId;
 
   uint32_t freq;
+  // The number of times the term was added, needed to merge indexes
+  uint32_t occurrences;
   t_fieldMask fieldMask;
 
   const char *term;
@@ -68,12 +74,21 @@ void ForwardIndexFree(ForwardIndex *idx);
 void ForwardIndex_Reset(ForwardIndex *idx, Document *doc, uint32_t idxFlags);
 
 ForwardIndex *NewForwardIndex(Document *doc, uint32_t idxFlags);
+// Create an index for textLen bytes of text in the given language
+ForwardIndex *NewForwardIndexForText(size_t textLen, RSLanguage language, uint32_t idxFlags);
 ForwardIndexIterator ForwardIndex_Iterate(ForwardIndex *i);
 ForwardIndexEntry *ForwardIndexIterator_Next(ForwardIndexIterator *iter);
 
 // Find an existing entry within the index
 ForwardIndexEntry *ForwardIndex_Find(ForwardIndex *i, const char *s, size_t n, uint32_t hash);
 
+/* Add the terms of src to dst, as if the tokens of src were added to dst after its own, with their
+ * positions advanced by posOffset. src keeps its terms, and must have the same flags as dst */
+void ForwardIndex_Merge(ForwardIndex *dst, ForwardIndex *src, uint32_t posOffset);
+
 void ForwardIndex_NormalizeFreq(ForwardIndex *, ForwardIndexEntry *);
 
+#ifdef __cplusplus
+}
+#endif
 #endif
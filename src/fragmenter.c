@@ -410,9 +410,9 @@ void FragmentList_Free(FragmentList *fragList) {
  *
  * 1) Gather all matching terms for the documents, and get their offsets (in position)
  * 2) Sort all terms, by position
- * 3) Start reading the byte offset list, until we reach the first term of the match
- *    list, then, consume the matches until the maximum distance has been reached,
- *    noting the terms for each.
+ * 3) Skip the byte offset list to the position of every match, noting the terms of
+ *    each. The tokens in between are neither visited nor looked up in the document;
+ *    only their number, which is the distance between the positions, is used.
  */
 void FragmentList_FragmentizeIter(FragmentList *fragList, const char *doc, size_t docLen,
                                   FragmentTermIterator *iter, int options) {
@@ -421,12 +421,14 @@ void FragmentList_FragmentizeIter(FragmentList *fragList, const char *doc, size_
   FragmentTerm *curTerm;
   size_t lastTokPos = -1;
   size_t lastByteEnd = 0;
+  uint32_t lastIterPos = 0;
 
   while (FragmentTermIterator_Next(iter, &curTerm)) {
-    if (curTerm == NULL) {
-      fragList->numToksSinceLastMatch++;
-      continue;
+    // Count the tokens skipped since the previous match. Positions start at 1
+    if (lastIterPos && curTerm->tokPos > lastIterPos) {
+      fragList->numToksSinceLastMatch += curTerm->tokPos - lastIterPos - 1;
     }
+    lastIterPos = Max(lastIterPos, curTerm->tokPos);
 
     if (curTerm->tokPos == lastTokPos) {
       continue;
@@ -459,34 +461,27 @@ void FragmentTermIterator_InitOffsets(FragmentTermIterator *iter, RSByteOffsetIt
                                       RSOffsetIterator *offIter) {
   iter->offsetIter = offIter;
   iter->byteIter = byteOffsets;
-  iter->curByteOffset = RSByteOffsetIterator_Next(iter->byteIter);
+  iter->curByteOffset = 0;
 
-  // Advance the offset iterator to the first offset we care about (i.e. that
-  // correlates with the first byte offset)
+  // Advance the offset iterator to the first offset we care about (i.e. the
+  // first position of the field, right after the one the byte iterator is at)
   do {
     iter->curTokPos = iter->offsetIter->Next(iter->offsetIter->ctx, &iter->curMatchRec);
-  } while (iter->byteIter->curPos > iter->curTokPos);
+  } while (iter->curTokPos <= iter->byteIter->curPos);
 }
 
 int FragmentTermIterator_Next(FragmentTermIterator *iter, FragmentTerm **termInfo) {
-  if (iter->curMatchRec == NULL || iter->curByteOffset == RSBYTEOFFSET_EOF ||
-      iter->curTokPos == RS_OFFSETVECTOR_EOF) {
+  if (iter->curMatchRec == NULL || iter->curTokPos == RS_OFFSETVECTOR_EOF) {
     return 0;
   }
 
-  if (iter->byteIter->curPos < iter->curTokPos) {
-    iter->curByteOffset = RSByteOffsetIterator_Next(iter->byteIter);
-    // No matching term at this position.
-    // printf("IterPos=%lu. LastMatchPos=%u\n", iter->byteIter->curPos, iter->curTokPos);
-    *termInfo = NULL;
-    return 1;
+  // Jump straight to the byte offset of the match
+  iter->curByteOffset = RSByteOffsetIterator_SkipTo(iter->byteIter, iter->curTokPos);
+  if (iter->curByteOffset == RSBYTEOFFSET_EOF) {
+    return 0;
   }
 
-  // printf("ByteOffset=%lu. LastMatchPos=%u\n", iter->curByteOffset, iter->curTokPos);
-
   RSQueryTerm *term = iter->curMatchRec;
-
-  // printf("Term Pointer: %p\n", term);
   iter->tmpTerm.score = term->idf;
   iter->tmpTerm.termId = term->id;
   iter->tmpTerm.len = term->len;
@@ -494,11 +489,7 @@ int FragmentTermIterator_Next(FragmentTermIterator *iter, FragmentTerm **termInf
   iter->tmpTerm.bytePos = iter->curByteOffset;
   *termInfo = &iter->tmpTerm;
 
-  uint32_t nextPos = iter->offsetIter->Next(iter->offsetIter->ctx, &iter->curMatchRec);
-  if (nextPos != iter->curTokPos) {
-    iter->curByteOffset = RSByteOffsetIterator_Next(iter->byteIter);
-  }
-  iter->curTokPos = nextPos;
+  iter->curTokPos = iter->offsetIter->Next(iter->offsetIter->ctx, &iter->curMatchRec);
   return 1;
 }
 
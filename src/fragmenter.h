@@ -10,6 +10,10 @@
 #include "stopwords.h"
 #include "byte_offsets.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /**
  *
  ## Implementation
@@ -58,6 +62,10 @@ typedef struct {
   FragmentTerm tmpTerm;
 } FragmentTermIterator;
 
+/**
+ * Yields the matched terms of the field in order of position, along with their byte
+ * offsets. The byte offsets of the tokens between the matches are skipped
+ */
 int FragmentTermIterator_Next(FragmentTermIterator *iter, FragmentTerm **termInfo);
 void FragmentTermIterator_InitOffsets(FragmentTermIterator *iter, RSByteOffsetIterator *bytesIter,
                                       RSOffsetIterator *offIter);
@@ -223,4 +231,7 @@ void FragmentList_HighlightFragments(FragmentList *fragList, const HighlightTags
 
 void FragmentList_Dump(const FragmentList *fragList);
 
+#ifdef __cplusplus
+}
+#endif
 #endif
\ No newline at end of file
@@ -171,6 +171,10 @@ void GCContext_RenderStats(GCContext* gc, RedisModuleCtx* ctx) {
   gc->callbacks.renderStats(ctx, gc->gcCtx);
 }
 
+struct LatencyStats* GCContext_GetLatencyStats(GCContext* gc) {
+  return gc->callbacks.getLatencyStats ? gc->callbacks.getLatencyStats(gc->gcCtx) : NULL;
+}
+
 void GCContext_OnDelete(GCContext* gc) {
   if (gc->callbacks.onDelete) {
     gc->callbacks.onDelete(gc->gcCtx);
@@ -11,10 +11,13 @@ extern "C" {
 #endif
 
 struct IndexSpec;
+struct LatencyStats;
 
 typedef struct GCCallbacks {
   int (*periodicCallback)(RedisModuleCtx* ctx, void* gcCtx);
   void (*renderStats)(RedisModuleCtx* ctx, void* gc);
+  // Optional, the latencies recorded by the GC
+  struct LatencyStats* (*getLatencyStats)(void* gc);
   void (*onDelete)(void* ctx);
   void (*onTerm)(void* ctx);
 
@@ -41,6 +44,7 @@ GCContext* GCContext_CreateGC(RedisModuleString* keyName, float initialHZ, uint6
 void GCContext_Start(GCContext* gc);
 void GCContext_Stop(GCContext* gc);
 void GCContext_RenderStats(GCContext* gc, RedisModuleCtx* ctx);
+struct LatencyStats* GCContext_GetLatencyStats(GCContext* gc);
 void GCContext_OnDelete(GCContext* gc);
 void GCContext_ForceInvoke(GCContext* gc, RedisModuleBlockedClient* bc);
 void GCContext_ForceBGInvoke(GCContext* gc);
@@ -3,18 +3,20 @@
 #include "rmutil/util.h"
 #include "rmalloc.h"
 #include "rmutil/rm_assert.h"
+#include "util/arr.h"
 
 static double extractUnitFactor(GeoDistance unit);
 
 /* Parse a geo filter from redis arguments. We assume the filter args start at argv[0], and FILTER
  * is not passed to us.
- * The GEO filter syntax is (FILTER) <property> LONG LAT DIST m|km|ft|mi
+ * The GEO filter syntax is (FILTER) <property> LONG LAT DIST m|km|ft|mi [NEAREST {k}]
  * Returns REDISMODUEL_OK or ERR  */
 int GeoFilter_Parse(GeoFilter *gf, ArgsCursor *ac, QueryError *status) {
   gf->lat = 0;
   gf->lon = 0;
   gf->radius = 0;
   gf->unitType = GEO_DISTANCE_KM;
+  gf->nearest = 0;
 
   if (AC_NumRemaining(ac) < 5) {
     QERR_MKBADARGS_FMT(status, "GEOFILTER requires 5 arguments");
@@ -49,18 +51,26 @@ int GeoFilter_Parse(GeoFilter *gf, ArgsCursor *ac, QueryError *status) {
     return REDISMODULE_ERR;
   }
 
+  if (AC_AdvanceIfMatch(ac, "NEAREST")) {
+    if ((rv = AC_GetSize(ac, &gf->nearest, AC_F_GE1)) != AC_OK) {
+      QERR_MKBADARGS_AC(status, "NEAREST", rv);
+      return REDISMODULE_ERR;
+    }
+  }
+
   return REDISMODULE_OK;
 }
 
-void GeoFilter_Free(GeoFilter *gf) {
-  if (gf->property) rm_free((char *)gf->property);
+static void geoFilterFreeRanges(GeoFilter *gf) {
   if (gf->numericFilters) {
-    for (int i = 0; i < GEO_RANGE_COUNT; ++i) {
-      if (gf->numericFilters[i])
-        NumericFilter_Free(gf->numericFilters[i]);
-    }
-    rm_free(gf->numericFilters);
+    array_free_ex(gf->numericFilters, NumericFilter_Free(*(NumericFilter **)ptr));
+    gf->numericFilters = NULL;
   }
+}
+
+void GeoFilter_Free(GeoFilter *gf) {
+  if (gf->property) rm_free((char *)gf->property);
+  geoFilterFreeRanges(gf);
   rm_free(gf);
 }
 
@@ -103,24 +113,36 @@ done:
   return docIds;
 }
 
-IndexIterator *NewGeoRangeIterator(RedisSearchCtx *ctx, const GeoFilter *gf) {
-  GeoHashRange ranges[GEO_RANGE_COUNT] = {{0}};
+/* Compute the covering ranges of the filter's circle, and store their numeric filters in the geo
+ * filter. They check every candidate against the radius */
+static void geoFilterBuildRanges(GeoFilter *gf) {
+  GeoHashRange ranges[GEO_COVER_MAX_RANGES];
   double radius_meter = gf->radius * extractUnitFactor(gf->unitType);
-  calcRanges(gf->lon, gf->lat, radius_meter, ranges);
+  size_t nranges = calcCoveringRanges(gf->lon, gf->lat, radius_meter, ranges);
 
-  IndexIterator **iters = rm_calloc(GEO_RANGE_COUNT, sizeof(*iters));
-  ((GeoFilter *)gf)->numericFilters = rm_calloc(GEO_RANGE_COUNT, sizeof(*gf->numericFilters));
+  gf->numericFilters = array_new(NumericFilter *, nranges);
+  for (size_t ii = 0; ii < nranges; ++ii) {
+    NumericFilter *filt = NewNumericFilter(ranges[ii].min, ranges[ii].max, 1, 1);
+    filt->fieldName = rm_strdup(gf->property);
+    filt->geoFilter = gf;
+    gf->numericFilters = array_append(gf->numericFilters, filt);
+  }
+}
+
+/* Create an iterator over the documents in a covering of the filter's circle. The ranges are
+ * computed once per filter, and shared by all the iterators created from it */
+static IndexIterator *geoCoveringIterator(RedisSearchCtx *ctx, GeoFilter *gf) {
+  if (!gf->numericFilters) {
+    geoFilterBuildRanges(gf);
+  }
+  size_t nranges = array_len(gf->numericFilters);
+  IndexIterator **iters = rm_calloc(nranges ? nranges : 1, sizeof(*iters));
   size_t itersCount = 0;
-  for (size_t ii = 0; ii < GEO_RANGE_COUNT; ++ii) {
-    if (ranges[ii].min != ranges[ii].max) {
-      NumericFilter *filt = gf->numericFilters[ii] =
-              NewNumericFilter(ranges[ii].min, ranges[ii].max, 1, 1);
-      filt->fieldName = rm_strdup(gf->property);
-      filt->geoFilter = gf;
-      struct indexIterator *numIter = NewNumericFilterIterator(ctx, filt, NULL, INDEXFLD_T_GEO);
-      if (numIter != NULL) {
-        iters[itersCount++] = numIter;
-      }
+  for (size_t ii = 0; ii < nranges; ++ii) {
+    NumericFilter *filt = gf->numericFilters[ii];
+    struct indexIterator *numIter = NewNumericFilterIterator(ctx, filt, NULL, INDEXFLD_T_GEO);
+    if (numIter != NULL) {
+      iters[itersCount++] = numIter;
     }
   }
 
@@ -132,11 +154,28 @@ IndexIterator *NewGeoRangeIterator(RedisSearchCtx *ctx, const GeoFilter *gf) {
     rm_free(iters);
     return it;
   }
-  IndexIterator *it = NewUnionIterator(iters, itersCount, NULL, 1, 1);
-  if (!it) {
-    return NULL;
+  return NewUnionIterator(iters, itersCount, NULL, 1, 1);
+}
+
+int GeoFilter_ResultDistance(const GeoFilter *gf, const RSIndexResult *cur, double *distance) {
+  if (cur->type == RSResultType_Numeric) {
+    int rv = isWithinRadius(gf, cur->num.value, distance);
+    *distance /= extractUnitFactor(gf->unitType);
+    return rv;
   }
-  return it;
+  if (!RSIndexResult_IsAggregate(cur)) {
+    return 0;
+  }
+  for (size_t ii = 0; ii < cur->agg.numChildren; ++ii) {
+    if (GeoFilter_ResultDistance(gf, cur->agg.children[ii], distance)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+IndexIterator *NewGeoRangeIterator(RedisSearchCtx *ctx, const GeoFilter *gf) {
+  return geoCoveringIterator(ctx, (GeoFilter *)gf);
 }
 
 GeoDistance GeoDistance_Parse(const char *s) {
@@ -261,16 +300,3 @@ int isWithinRadius(const GeoFilter *gf, double d, double *distance) {
   int rv = isWithinRadiusLonLat(gf->lon, gf->lat, xy[0], xy[1], radius_meters, distance);
   return rv;
 }
-
-static int checkResult(const GeoFilter *gf, const RSIndexResult *cur) {
-  double distance;
-  if (cur->type == RSResultType_Numeric) {
-    return isWithinRadius(gf, cur->num.value, &distance);
-  }
-  for (size_t ii = 0; ii < cur->agg.numChildren; ++ii) {
-    if (checkResult(gf, cur->agg.children[ii])) {
-      return 1;
-    }
-  }
-  return 0;
-}
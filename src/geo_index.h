@@ -10,6 +10,10 @@
 #include "dep/geo/rs_geo.h"
 #include "numeric_index.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef struct geoIndex {
   RedisSearchCtx *ctx;
   const FieldSpec *sp;
@@ -36,6 +40,11 @@ typedef struct GeoFilter {
   double lon;
   double radius;
   GeoDistance unitType;
+  // If set, only the `nearest` closest documents within the radius which match the rest of the
+  // query are returned. The limit is applied by the query pipeline to all the matches within the
+  // radius, see RPGeoDistance_New()
+  size_t nearest;
+  // The filters of the covering ranges, owned by the geo filter (array, see util/arr.h)
   NumericFilter **numericFilters;
 } GeoFilter;
 
@@ -54,10 +63,18 @@ int GeoFilter_Parse(GeoFilter *gf, ArgsCursor *ac, QueryError *status);
 void GeoFilter_Free(GeoFilter *gf);
 IndexIterator *NewGeoRangeIterator(RedisSearchCtx *ctx, const GeoFilter *gf);
 
+/* Get the distance of a hit of the filter's iterator from the center of the filter, in the
+ * filter's units. The hit may be an aggregate result which the filter's hit is a part of. Returns
+ * 0 if no part of the hit is within the filter's radius */
+int GeoFilter_ResultDistance(const GeoFilter *gf, const RSIndexResult *r, double *distance);
+
 /*****************************************************************************/
 
 #define INVALID_GEOHASH -1.0
 double calcGeoHash(double lon, double lat);
 int isWithinRadius(const GeoFilter *gf, double d, double *distance);
 
+#ifdef __cplusplus
+}
+#endif
 #endif
@@ -856,17 +856,25 @@ static size_t II_Len(void *ctx) {
 }
 
 /* A Not iterator works by wrapping another iterator, and returning OK for misses, and NOTFOUND
- * for hits */
+ * for hits. The ids it can return are taken from the universe bitmap if it has one, and are all
+ * the ids up to maxDocId otherwise */
 typedef struct {
   IndexIterator base;
   IndexIterator *child;
   IndexCriteriaTester *childCT;
+  const Bitmap *universe;
   t_docId lastDocId;
   t_docId maxDocId;
   size_t len;
   double weight;
 } NotIterator, NotContext;
 
+/* Return the first id of the universe which is greater than docId, or 0 if there is none */
+static inline t_docId NI_NextId(const NotContext *nc, t_docId docId) {
+  t_docId next = nc->universe ? Bitmap_Next(nc->universe, docId + 1) : docId + 1;
+  return next <= nc->maxDocId ? next : 0;
+}
+
 static void NI_Abort(void *ctx) {
   NotContext *nc = ctx;
   if (nc->child) {
@@ -904,6 +912,15 @@ static int NI_SkipTo(void *ctx, t_docId docId, RSIndexResult **hit) {
   if (docId > nc->maxDocId) {
     return INDEXREAD_EOF;
   }
+
+  // ids outside of the universe (e.g. deleted documents) never match
+  if (nc->universe && !Bitmap_Test(nc->universe, docId)) {
+    nc->base.current->docId = docId;
+    nc->lastDocId = docId;
+    *hit = nc->base.current;
+    return INDEXREAD_NOTFOUND;
+  }
+
   // If we don't have a child it means the sub iterator is of a meaningless expression.
   // So negating it means we will always return OK!
   if (!nc->child) {
@@ -976,25 +993,25 @@ static IndexCriteriaTester *NI_GetCriteriaTester(void *ctx) {
 
 static size_t NI_NumEstimated(void *ctx) {
   NotContext *nc = ctx;
-  return nc->maxDocId;
+  return nc->universe ? Bitmap_Card(nc->universe) : nc->maxDocId;
 }
 
 static int NI_ReadUnsorted(void *ctx, RSIndexResult **hit) {
   NotContext *nc = ctx;
-  while (nc->lastDocId > nc->maxDocId) {
-    if (!nc->childCT->Test(nc->childCT, nc->lastDocId)) {
-      nc->base.current->docId = nc->lastDocId;
+  for (t_docId id = NI_NextId(nc, nc->lastDocId); id; id = NI_NextId(nc, id)) {
+    nc->lastDocId = id;
+    if (!nc->childCT->Test(nc->childCT, id)) {
+      nc->base.current->docId = id;
       *hit = nc->base.current;
-      ++nc->lastDocId;
       return INDEXREAD_OK;
     }
-    ++nc->lastDocId;
   }
+  nc->lastDocId = nc->maxDocId + 1;
   return INDEXREAD_EOF;
 }
 
 /* Read from a NOT iterator. This is applicable only if the only or leftmost node of a query is a
- * NOT node. We simply read until max docId, skipping docIds that exist in the child*/
+ * NOT node. We simply walk the universe until max docId, skipping docIds that exist in the child*/
 static int NI_ReadSorted(void *ctx, RSIndexResult **hit) {
   NotContext *nc = ctx;
   if (nc->lastDocId > nc->maxDocId) return INDEXREAD_EOF;
@@ -1005,38 +1022,35 @@ static int NI_ReadSorted(void *ctx, RSIndexResult **hit) {
     cr = IITER_CURRENT_RECORD(nc->child);
 
     if (cr == NULL || cr->docId == 0) {
-      nc->child->Read(nc->child->ctx, &cr);
+      if (nc->child->Read(nc->child->ctx, &cr) == INDEXREAD_EOF) {
+        cr = NULL;
+      }
     }
   }
 
-  // advance our reader by one, and let's test if it's a valid value or not
-  nc->base.current->docId++;
-
-  // If we don't have a child result, or the child result is ahead of the current counter,
-  // we just increment our virtual result's id until we hit the child result's
-  // in which case we'll read from the child and bypass it by one.
-  if (cr == NULL || cr->docId > nc->base.current->docId) {
-    goto ok;
-  }
-
-  while (cr->docId == nc->base.current->docId) {
-    // advance our docId to the next possible id
-    nc->base.current->docId++;
-
-    // read the next entry from the child
-    if (nc->child->Read(nc->child->ctx, &cr) == INDEXREAD_EOF) {
+  // advance our reader to the next id of the universe, and skip it for as long as the child has
+  // it. The child is only ever read forward, up to the id we are testing
+  t_docId id = NI_NextId(nc, nc->base.current->docId);
+  while (id && cr) {
+    if (cr->docId < id) {
+      if (nc->child->Read(nc->child->ctx, &cr) == INDEXREAD_EOF) {
+        cr = NULL;
+      }
+    } else if (cr->docId == id) {
+      id = NI_NextId(nc, id);
+    } else {
       break;
     }
   }
 
-  // make sure we did not overflow
-  if (nc->base.current->docId > nc->maxDocId) {
+  if (!id) {
+    nc->lastDocId = nc->maxDocId + 1;
     return INDEXREAD_EOF;
   }
 
-ok:
   // Set the next entry and return ok
-  nc->lastDocId = nc->base.current->docId;
+  nc->base.current->docId = id;
+  nc->lastDocId = id;
   if (hit) *hit = nc->base.current;
   ++nc->len;
 
@@ -1063,7 +1077,8 @@ static t_docId NI_LastDocId(void *ctx) {
   return nc->lastDocId;
 }
 
-IndexIterator *NewNotIterator(IndexIterator *it, t_docId maxDocId, double weight) {
+IndexIterator *NewNotIterator(IndexIterator *it, t_docId maxDocId, const Bitmap *universe,
+                              double weight) {
 
   NotContext *nc = rm_malloc(sizeof(*nc));
   nc->base.current = NewVirtualResult(weight);
@@ -1071,6 +1086,7 @@ IndexIterator *NewNotIterator(IndexIterator *it, t_docId maxDocId, double weight
   nc->base.current->docId = 0;
   nc->child = it;
   nc->childCT = NULL;
+  nc->universe = universe;
   nc->lastDocId = 0;
   nc->maxDocId = maxDocId;
   nc->len = 0;
@@ -1319,18 +1335,28 @@ IndexIterator *NewOptionalIterator(IndexIterator *it, t_docId maxDocId, double w
   return ret;
 }
 
-/* Wildcard iterator, matchin ALL documents in the index. This is used for one thing only -
- * purely negative queries. If the root of the query is a negative expression, we cannot process
- * it
- * without a positive expression. So we create a wildcard iterator that basically just iterates
- * all
- * the incremental document ids, and matches every skip within its range. */
+/* Wildcard iterator, matchin ALL documents in the index. This is used for purely negative
+ * queries and for `*`. If the root of the query is a negative expression, we cannot process it
+ * without a positive expression. So we create a wildcard iterator that iterates all the live
+ * document ids, and matches every skip to a live id within its range.
+ *
+ * The live ids are read from the doc table's live bitmap, a word at a time, so deleted and unused
+ * ids are skipped without ever reaching the doc table. Without a bitmap it just counts from 1 to
+ * topId. */
 typedef struct {
   IndexIterator base;
+  const Bitmap *live;
   t_docId topId;
+  // the last id we returned
   t_docId current;
 } WildcardIterator, WildcardIteratorCtx;
 
+/* Return the first live id which is greater or equal to docId, or 0 if there is none */
+static inline t_docId WI_NextId(const WildcardIteratorCtx *nc, t_docId docId) {
+  t_docId next = nc->live ? Bitmap_Next(nc->live, docId) : docId;
+  return next <= nc->topId ? next : 0;
+}
+
 /* Free a wildcard iterator */
 static void WI_Free(IndexIterator *it) {
 
@@ -1339,54 +1365,62 @@ static void WI_Free(IndexIterator *it) {
   rm_free(it);
 }
 
-/* Read reads the next consecutive id, unless we're at the end */
+static void WI_Abort(void *ctx) {
+  WildcardIteratorCtx *nc = ctx;
+  nc->current = nc->topId + 1;
+}
+
+/* Read reads the next live id, unless we're at the end */
 static int WI_Read(void *ctx, RSIndexResult **hit) {
   WildcardIteratorCtx *nc = ctx;
-  if (nc->current > nc->topId) {
+  if (nc->current >= nc->topId) {
+    WI_Abort(nc);
+    return INDEXREAD_EOF;
+  }
+  t_docId next = WI_NextId(nc, nc->current + 1);
+  if (!next) {
+    WI_Abort(nc);
     return INDEXREAD_EOF;
   }
-  CURRENT_RECORD(nc)->docId = nc->current++;
+  nc->current = CURRENT_RECORD(nc)->docId = next;
   if (hit) {
     *hit = CURRENT_RECORD(nc);
   }
   return INDEXREAD_OK;
 }
 
-/* Skipto for wildcard iterator - always succeeds, but this should normally not happen as it has
- * no
- * meaning */
+/* Skipto for wildcard iterator - succeeds for every live id, and lands on the next live id
+ * otherwise */
 static int WI_SkipTo(void *ctx, t_docId docId, RSIndexResult **hit) {
-  // printf("WI_Skipto %d\n", docId);
   WildcardIteratorCtx *nc = ctx;
 
   if (nc->current > nc->topId) return INDEXREAD_EOF;
 
   if (docId == 0) return WI_Read(ctx, hit);
 
-  nc->current = docId;
-  CURRENT_RECORD(nc)->docId = docId;
+  t_docId next = WI_NextId(nc, docId);
+  if (!next) {
+    WI_Abort(nc);
+    return INDEXREAD_EOF;
+  }
+  nc->current = CURRENT_RECORD(nc)->docId = next;
   if (hit) {
     *hit = CURRENT_RECORD(nc);
   }
-  return INDEXREAD_OK;
-}
-
-static void WI_Abort(void *ctx) {
-  WildcardIteratorCtx *nc = ctx;
-  nc->current = nc->topId + 1;
+  return next == docId ? INDEXREAD_OK : INDEXREAD_NOTFOUND;
 }
 
 /* We always have next, in case anyone asks... ;) */
 static int WI_HasNext(void *ctx) {
   WildcardIteratorCtx *nc = ctx;
 
-  return nc->current <= nc->topId;
+  return nc->current < nc->topId;
 }
 
-/* Our len is the len of the index... */
+/* Our len is the number of live documents in the index... */
 static size_t WI_Len(void *ctx) {
   WildcardIteratorCtx *nc = ctx;
-  return nc->topId;
+  return nc->live ? Bitmap_Card(nc->live) : nc->topId;
 }
 
 /* Last docId */
@@ -1398,18 +1432,20 @@ static t_docId WI_LastDocId(void *ctx) {
 
 static void WI_Rewind(void *p) {
   WildcardIteratorCtx *ctx = p;
-  ctx->current = 1;
+  ctx->current = 0;
+  CURRENT_RECORD(ctx)->docId = 0;
 }
 
 static size_t WI_NumEstimated(void *p) {
-  return SIZE_MAX;
+  return WI_Len(p);
 }
 
 /* Create a new wildcard iterator */
-IndexIterator *NewWildcardIterator(t_docId maxId) {
+IndexIterator *NewWildcardIterator(t_docId maxId, const Bitmap *live) {
   WildcardIteratorCtx *c = rm_calloc(1, sizeof(*c));
-  c->current = 1;
+  c->current = 0;
   c->topId = maxId;
+  c->live = live;
 
   CURRENT_RECORD(c) = NewVirtualResult(1);
   CURRENT_RECORD(c)->freq = 1;
@@ -1466,7 +1502,6 @@ IndexIterator *NewEmptyIterator(void) {
   return &eofIterator;
 }
 
-// LCOV_EXCL_START unused
 const char *IndexIterator_GetTypeString(const IndexIterator *it) {
   if (it->Free == UnionIterator_Free) {
     return "UNION";
@@ -1486,4 +1521,3 @@ const char *IndexIterator_GetTypeString(const IndexIterator *it) {
     return "Unknown";
   }
 }
-// LCOV_EXCL_STOP
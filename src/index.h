@@ -46,18 +46,22 @@ IndexIterator *NewUnionIterator(IndexIterator **its, int num, DocTable *t, int q
 IndexIterator *NewIntersecIterator(IndexIterator **its, size_t num, DocTable *t,
                                    t_fieldMask fieldMask, int maxSlop, int inOrder, double weight);
 
-/* Create a NOT iterator by wrapping another index iterator */
-IndexIterator *NewNotIterator(IndexIterator *it, t_docId maxDocId, double weight);
+/* Create a NOT iterator by wrapping another index iterator. If universe is not NULL, only ids set
+ * in it are returned (typically the doc table's live documents), otherwise all the ids up to
+ * maxDocId are */
+IndexIterator *NewNotIterator(IndexIterator *it, t_docId maxDocId, const Bitmap *universe,
+                              double weight);
 
 /* Create an Optional clause iterator by wrapping another index iterator. An optional iterator
  * always returns OK on skips, but a virtual hit with frequency of 0 if there is no hit */
 IndexIterator *NewOptionalIterator(IndexIterator *it, t_docId maxDocId, double weight);
 
-/* Create a wildcard iterator, matching ALL documents in the index. This is used for one thing only
- * - purely negative queries. If the root of the query is a negative expression, we cannot process
- * it without a positive expression. So we create a wildcard iterator that basically just iterates
- * all the incremental document ids, and matches every skip within its range. */
-IndexIterator *NewWildcardIterator(t_docId maxId);
+/* Create a wildcard iterator, matching ALL documents in the index. This is used for `*` and for
+ * purely negative queries. If the root of the query is a negative expression, we cannot process
+ * it without a positive expression. So we create a wildcard iterator that iterates all the ids set
+ * in the live bitmap up to maxId, and matches every skip to one of them. If live is NULL, all the
+ * incremental document ids up to maxId are returned */
+IndexIterator *NewWildcardIterator(t_docId maxId, const Bitmap *live);
 
 /* Create a new IdListIterator from a pre populated list of document ids of size num. The doc ids
  * are sorted in this function, so there is no need to sort them. They are automatically freed in
@@ -6,6 +6,9 @@
 #include "index.h"
 #include "redis_index.h"
 #include "rmutil/rm_assert.h"
+#include "util/workpool.h"
+#include "module.h"
+#include "slowlog.h"
 
 #include <unistd.h>
 static void Indexer_FreeInternal(DocumentIndexer *indexer);
@@ -39,6 +42,7 @@ typedef struct mergedEntry {
   KHTableEntry base;        // Base structure
   ForwardIndexEntry *head;  // First document containing the term
   ForwardIndexEntry *tail;  // Last document containing the term
+  size_t count;             // Number of documents containing the term
 } mergedEntry;
 
 // Boilerplate hashtable compare function
@@ -59,6 +63,9 @@ static KHTableEntry *mergedAlloc(void *ctx) {
   return BlkAlloc_Alloc(ctx, sizeof(mergedEntry), sizeof(mergedEntry) * TERMS_PER_BLOCK);
 }
 
+static const KHTableProcs mergedProcs = {
+    .Alloc = mergedAlloc, .Compare = mergedCompare, .Hash = mergedHash};
+
 // This function used for debugging, and returns how many items are actually in the list
 static size_t countMerged(mergedEntry *ent) {
   size_t n = 0;
@@ -108,10 +115,12 @@ static RSAddDocumentCtx *doMerge(RSAddDocumentCtx *aCtx, KHTable *ht,
 
       if (isNew) {
         mergedEnt->head = mergedEnt->tail = entry;
+        mergedEnt->count = 1;
 
       } else {
         mergedEnt->tail->next = entry;
         mergedEnt->tail = entry;
+        mergedEnt->count++;
       }
 
       entry->next = NULL;
@@ -132,6 +141,19 @@ static RSAddDocumentCtx *doMerge(RSAddDocumentCtx *aCtx, KHTable *ht,
   return firstZeroId;
 }
 
+// Estimated size of an inverted index record, besides its offsets: flags, delta, frequency and
+// field mask
+#define RECORD_OVERHEAD_ESTIMATE 6
+
+// The average size of the inverted index records of a merged term
+static size_t mergedRecordSize(const mergedEntry *merged) {
+  size_t total = 0;
+  for (const ForwardIndexEntry *cur = merged->head; cur; cur = cur->next) {
+    total += RECORD_OVERHEAD_ESTIMATE + (cur->vw ? VVW_GetByteLength(cur->vw) : 0);
+  }
+  return total / merged->count;
+}
+
 // Writes all the entries in the hash table to the inverted index.
 // parentMap contains the actual mapping between the `docID` field and the actual
 // RSAddDocumentCtx which contains the document itself, which by this time should
@@ -164,7 +186,13 @@ static int writeMergedEntries(DocumentIndexer *indexer, RSAddDocumentCtx *aCtx,
         continue;
       }
 
+      // The entries of a term are written in document ID order, so we can size the buffers of the
+      // blocks they land in once, rather than growing them entry by entry
+      size_t remaining = merged->count, reserved = 0;
+      size_t recordSize = remaining > 1 ? mergedRecordSize(merged) : 0;
+
       for (; fwent != NULL; fwent = fwent->next) {
+        remaining--;
         // Get the Doc ID for this entry.
         // Note that we cache the lookup result itself, since accessing the
         // parent each time causes some memory access overhead. This saves
@@ -184,7 +212,13 @@ static int writeMergedEntries(DocumentIndexer *indexer, RSAddDocumentCtx *aCtx,
 
         // Finally assign the document ID to the entry
         fwent->docId = docId;
+        if (recordSize && reserved == 0) {
+          reserved = InvertedIndex_Reserve(invidx, remaining + 1, recordSize);
+        }
         writeIndexEntry(ctx->spec, invidx, encoder, fwent);
+        if (reserved) {
+          reserved--;
+        }
       }
 
       if (idxKey) {
@@ -291,6 +325,7 @@ static void doAssignIds(RSAddDocumentCtx *cur, RedisSearchCtx *ctx) {
     RSDocumentMetadata *md = DocTable_Get(&spec->docs, cur->doc.docId);
     md->maxFreq = cur->fwIdx->maxFreq;
     md->len = cur->fwIdx->totalFreq;
+    md->contentHash = cur->contentHash;
 
     if (cur->sv) {
       DocTable_SetSortingVector(&spec->docs, cur->doc.docId, cur->sv);
@@ -311,8 +346,8 @@ static void indexBulkFields(RSAddDocumentCtx *aCtx, RedisSearchCtx *sctx) {
   IndexBulkData *activeBulks[SPEC_MAX_FIELDS];
   size_t numActiveBulks = 0;
 
-  for (RSAddDocumentCtx *cur = aCtx; cur && cur->doc.docId; cur = cur->next) {
-    if (cur->stateFlags & ACTX_F_ERRORED) {
+  for (RSAddDocumentCtx *cur = aCtx; cur; cur = cur->next) {
+    if ((cur->stateFlags & ACTX_F_ERRORED) || cur->doc.docId == 0) {
       continue;
     }
 
@@ -366,6 +401,7 @@ static void Indexer_Process(DocumentIndexer *indexer, RSAddDocumentCtx *aCtx) {
     }
   }
 
+  uint64_t start = LatencyStats_Now();
   int useTermHt = indexer->size > 1 && (aCtx->stateFlags & ACTX_F_TEXTINDEXED) == 0;
   if (useTermHt) {
     firstZeroId = doMerge(aCtx, &indexer->mergeHt, parentMap);
@@ -433,6 +469,7 @@ static void Indexer_Process(DocumentIndexer *indexer, RSAddDocumentCtx *aCtx) {
   if (!(aCtx->stateFlags & ACTX_F_OTHERINDEXED)) {
     indexBulkFields(aCtx, &ctx);
   }
+  LatencyStats_RecordSince(&ctx.spec->latency, LATENCY_INDEXER_BATCH, start);
 
 cleanup:
   if (isBlocked) {
@@ -444,43 +481,102 @@ cleanup:
   }
 }
 
-#define SHOULD_STOP(idxer) ((idxer)->options & INDEXER_STOPPED)
+void Indexer_ProcessBatch(DocumentIndexer *indexer, RSAddDocumentCtx *head) {
+  RSAddDocumentCtx *parentMap[MAX_BULK_DOCS];
+  // the merge table of the indexer is used by its queue without the write lock, so batches have
+  // their own
+  BlkAlloc alloc;
+  KHTable mergeHt;
+  BlkAlloc_Init(&alloc);
+  KHTable_Init(&mergeHt, &mergedProcs, &alloc, 4096);
+
+  while (head) {
+    // cut the next batch off the chain
+    RSAddDocumentCtx *tail = head;
+    for (size_t n = 1; tail->next && n < INDEXER_MAX_BATCH; n++) {
+      tail = tail->next;
+    }
+    RSAddDocumentCtx *rest = tail->next;
+    tail->next = NULL;
+
+    uint64_t start = LatencyStats_Now();
+    uint64_t startNS = Slowlog_NowNS();
+    RedisSearchCtx ctx = *head->client.sctx;
+    doMerge(head, &mergeHt, parentMap);
+    doAssignIds(head, &ctx);
+    writeMergedEntries(indexer, head, &ctx, &mergeHt, parentMap);
+    indexBulkFields(head, &ctx);
+    BlkAlloc_Clear(&alloc, NULL, NULL, 0);
+    KHTable_Clear(&mergeHt);
+    LatencyStats_RecordSince(&ctx.spec->latency, LATENCY_INDEXER_BATCH, start);
+    __atomic_add_fetch(&indexer->indexingNS, Slowlog_NowNS() - startNS, __ATOMIC_RELAXED);
+
+    while (head) {
+      RSAddDocumentCtx *next = head->next;
+      AddDocumentCtx_Finish(head);
+      __atomic_add_fetch(&indexer->docsIndexed, 1, __ATOMIC_RELAXED);
+      head = next;
+    }
+    head = rest;
+  }
+  KHTable_Free(&mergeHt);
+  BlkAlloc_FreeAll(&alloc, NULL, 0, 0);
+}
 
-static void *Indexer_Run(void *p) {
-  DocumentIndexer *indexer = p;
+// The pool running the queues of the indexers
+static WorkPool *indexerPool_g = NULL;
 
-  pthread_mutex_lock(&indexer->lock);
-  while (!SHOULD_STOP(indexer)) {
-    while (indexer->head == NULL && !SHOULD_STOP(indexer)) {
-      pthread_cond_wait(&indexer->cond, &indexer->lock);
-    }
+// The number of documents an indexer processes before yielding its thread to the other indexers
+#define INDEXER_POOL_QUANTUM 64
+
+static void Indexer_ProcessOne(DocumentIndexer *indexer, RSAddDocumentCtx *aCtx) {
+  uint64_t start = Slowlog_NowNS();
+  Indexer_Process(indexer, aCtx);
+  __atomic_add_fetch(&indexer->docsIndexed, 1, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&indexer->indexingNS, Slowlog_NowNS() - start, __ATOMIC_RELAXED);
+  AddDocumentCtx_Finish(aCtx);
+}
+
+/**
+ * Process the documents at the head of the queue. An indexer is run by a single
+ * thread of the pool at a time, so its documents are indexed (and get their IDs)
+ * in order. It yields after a quantum of documents, moving to the back of the
+ * queue of the thread, so a busy index doesn't starve the others.
+ */
+static void Indexer_Run(void *p) {
+  DocumentIndexer *indexer = p;
 
+  for (size_t n = 0; n < INDEXER_POOL_QUANTUM; n++) {
+    pthread_mutex_lock(&indexer->lock);
     RSAddDocumentCtx *cur = indexer->head;
     if (cur == NULL) {
-      RS_LOG_ASSERT(SHOULD_STOP(indexer), "indexer was stopped");
       pthread_mutex_unlock(&indexer->lock);
       break;
     }
-
     indexer->size--;
-
     if ((indexer->head = cur->next) == NULL) {
       indexer->tail = NULL;
     }
     pthread_mutex_unlock(&indexer->lock);
-    Indexer_Process(indexer, cur);
-    AddDocumentCtx_Finish(cur);
-    pthread_mutex_lock(&indexer->lock);
+    Indexer_ProcessOne(indexer, cur);
   }
 
-  Indexer_FreeInternal(indexer);
-  return NULL;
+  pthread_mutex_lock(&indexer->lock);
+  indexer->scheduled = indexer->head != NULL;
+  int more = indexer->scheduled;
+  pthread_mutex_unlock(&indexer->lock);
+
+  if (more) {
+    WorkPool_Add(indexerPool_g, Indexer_Run, indexer);
+  } else {
+    // the reference taken when the indexer was scheduled
+    Indexer_Decref(indexer);
+  }
 }
 
 int Indexer_Add(DocumentIndexer *indexer, RSAddDocumentCtx *aCtx) {
-  if (!AddDocumentCtx_IsBlockable(aCtx)) {
-    Indexer_Process(indexer, aCtx);
-    AddDocumentCtx_Finish(aCtx);
+  if (!AddDocumentCtx_IsBlockable(aCtx) || (indexer->options & INDEXER_THREADLESS)) {
+    Indexer_ProcessOne(indexer, aCtx);
     return 0;
   }
 
@@ -492,14 +588,71 @@ int Indexer_Add(DocumentIndexer *indexer, RSAddDocumentCtx *aCtx) {
   } else {
     indexer->head = indexer->tail = aCtx;
   }
+  indexer->size++;
 
-  pthread_cond_signal(&indexer->cond);
+  int schedule = !indexer->scheduled;
+  if (schedule) {
+    indexer->scheduled = 1;
+    Indexer_Incref(indexer);
+  }
   pthread_mutex_unlock(&indexer->lock);
 
-  indexer->size++;
+  if (schedule) {
+    WorkPool_Add(indexerPool_g, Indexer_Run, indexer);
+  }
   return 0;
 }
 
+void Indexer_PoolStart(size_t numThreads) {
+  if (!indexerPool_g) {
+    indexerPool_g = NewWorkPool(numThreads);
+  }
+}
+
+void Indexer_PoolDestroy(void) {
+  if (indexerPool_g) {
+    // the queued documents need the GIL to be indexed
+    RedisModule_ThreadSafeContextUnlock(RSDummyContext);
+    WorkPool_Free(indexerPool_g);
+    indexerPool_g = NULL;
+    RedisModule_ThreadSafeContextLock(RSDummyContext);
+  }
+}
+
+void Indexer_PoolAddInfoFields(RedisModuleInfoCtx *ctx) {
+  if (!indexerPool_g) {
+    return;
+  }
+  WorkPoolStats st;
+  WorkPool_GetStats(indexerPool_g, &st);
+  RedisModule_InfoAddFieldULongLong(ctx, "threads", st.numThreads);
+  RedisModule_InfoAddFieldULongLong(ctx, "queued_indexes", st.queued);
+  RedisModule_InfoAddFieldULongLong(ctx, "max_thread_queue", st.maxQueued);
+  RedisModule_InfoAddFieldULongLong(ctx, "runs", st.done);
+  RedisModule_InfoAddFieldULongLong(ctx, "stolen_runs", st.stolen);
+}
+
+double Indexer_DocsPerSec(DocumentIndexer *indexer) {
+  uint64_t docs = __atomic_load_n(&indexer->docsIndexed, __ATOMIC_RELAXED);
+  uint64_t ns = __atomic_load_n(&indexer->indexingNS, __ATOMIC_RELAXED);
+  return ns ? docs * 1e9 / ns : 0;
+}
+
+void Indexer_ReplyStats(RedisModuleCtx *ctx, DocumentIndexer *indexer) {
+  uint64_t docs = __atomic_load_n(&indexer->docsIndexed, __ATOMIC_RELAXED);
+  pthread_mutex_lock(&indexer->lock);
+  size_t size = indexer->size;
+  pthread_mutex_unlock(&indexer->lock);
+
+  RedisModule_ReplyWithArray(ctx, 6);
+  RedisModule_ReplyWithSimpleString(ctx, "queue_size");
+  RedisModule_ReplyWithLongLong(ctx, size);
+  RedisModule_ReplyWithSimpleString(ctx, "docs_indexed");
+  RedisModule_ReplyWithLongLong(ctx, docs);
+  RedisModule_ReplyWithSimpleString(ctx, "docs_per_sec");
+  RedisModule_ReplyWithDouble(ctx, Indexer_DocsPerSec(indexer));
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
 /// Multiple Indexers                                                        ///
@@ -507,38 +660,30 @@ int Indexer_Add(DocumentIndexer *indexer, RSAddDocumentCtx *aCtx) {
 ////////////////////////////////////////////////////////////////////////////////
 
 /**
- * Each index (i.e. IndexSpec) will have its own dedicated indexing thread.
- * This is because documents only need to be indexed in order with respect
- * to their document IDs, and the ID namespace is only unique among a given
- * index.
+ * The indexers of all the indexes share a pool of threads, but each indexer is
+ * run by one thread at a time. This is because documents only need to be indexed
+ * in order with respect to their document IDs, and the ID namespace is only
+ * unique among a given index.
  *
- * Separating background threads also greatly simplifies the work of merging
- * or folding indexing and document ID assignment, as it can be assumed that
- * every item within the document ID belongs to the same index.
+ * Serializing each indexer also greatly simplifies the work of merging or
+ * folding indexing and document ID assignment, as it can be assumed that every
+ * item within the document ID belongs to the same index.
  */
 
-// Creates a new DocumentIndexer. This initializes the structure and starts the
-// thread. This does not insert it into the list of threads, though
-// todo: remove the withIndexThread var once we switch to threadpool
+// Creates a new DocumentIndexer. Its documents are indexed by the pool, unless
+// the index is temporary, concurrent writes are disabled or the pool is not
+// started, in which case they are indexed when added.
 DocumentIndexer *NewIndexer(IndexSpec *spec) {
   DocumentIndexer *indexer = rm_calloc(1, sizeof(*indexer));
   indexer->refcount = 1;
-  if ((spec->flags & Index_Temporary) || RSGlobalConfig.concurrentMode == 0) {
+  if ((spec->flags & Index_Temporary) || RSGlobalConfig.concurrentMode == 0 || !indexerPool_g) {
     indexer->options |= INDEXER_THREADLESS;
   }
   indexer->head = indexer->tail = NULL;
+  pthread_mutex_init(&indexer->lock, NULL);
 
   BlkAlloc_Init(&indexer->alloc);
-  static const KHTableProcs procs = {
-      .Alloc = mergedAlloc, .Compare = mergedCompare, .Hash = mergedHash};
-  KHTable_Init(&indexer->mergeHt, &procs, &indexer->alloc, 4096);
-
-  if (!(indexer->options & INDEXER_THREADLESS)) {
-    pthread_cond_init(&indexer->cond, NULL);
-    pthread_mutex_init(&indexer->lock, NULL);
-    pthread_create(&indexer->thr, NULL, Indexer_Run, indexer);
-    pthread_detach(indexer->thr);
-  }
+  KHTable_Init(&indexer->mergeHt, &mergedProcs, &indexer->alloc, 4096);
 
   indexer->next = NULL;
   indexer->redisCtx = RedisModule_GetThreadSafeContext(NULL);
@@ -551,10 +696,7 @@ DocumentIndexer *NewIndexer(IndexSpec *spec) {
 }
 
 static void Indexer_FreeInternal(DocumentIndexer *indexer) {
-  if (!(indexer->options & INDEXER_THREADLESS)) {
-    pthread_cond_destroy(&indexer->cond);
-    pthread_mutex_destroy(&indexer->lock);
-  }
+  pthread_mutex_destroy(&indexer->lock);
   rm_free(indexer->concCtx.openKeys);
   RedisModule_FreeString(indexer->redisCtx, indexer->specKeyName);
   KHTable_Clear(&indexer->mergeHt);
@@ -564,19 +706,18 @@ static void Indexer_FreeInternal(DocumentIndexer *indexer) {
   rm_free(indexer);
 }
 
+// The indexer is freed when the index and the documents in its queue have all
+// released it
 size_t Indexer_Decref(DocumentIndexer *indexer) {
   size_t ret = __sync_sub_and_fetch(&indexer->refcount, 1);
   if (!ret) {
-    pthread_mutex_lock(&indexer->lock);
-    indexer->options |= INDEXER_STOPPED;
-    pthread_cond_signal(&indexer->cond);
-    pthread_mutex_unlock(&indexer->lock);
+    Indexer_FreeInternal(indexer);
   }
   return ret;
 }
 
 size_t Indexer_Incref(DocumentIndexer *indexer) {
-  return ++indexer->refcount;
+  return __sync_add_and_fetch(&indexer->refcount, 1);
 }
 
 void Indexer_Free(DocumentIndexer *indexer) {
@@ -6,20 +6,27 @@
 #include "util/block_alloc.h"
 #include "concurrent_ctx.h"
 #include "util/arr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 // Preprocessors can store field data to this location
 typedef struct FieldIndexerData {
   double numeric;  // i.e. the numeric value of the field
+  int64_t intval;  // the exact value of INT64 numeric fields
   const char *geoSlon;
   const char *geoSlat;
   char **tags;
+  size_t numTags;
 } FieldIndexerData;
 
 typedef struct DocumentIndexer {
   RSAddDocumentCtx *head;          // first item in the queue
   RSAddDocumentCtx *tail;          // last item in the queue
   pthread_mutex_t lock;            // lock - only used when adding or removing items from the queue
-  pthread_cond_t cond;             // condition - used to wait on items added to the queue
   size_t size;                     // number of items in the queue
+  int scheduled;                   // set while the queue is run (or is about to be) by the pool
   ConcurrentSearchCtx concCtx;     // GIL locking. This is repopulated with the relevant key data
   RedisModuleCtx *redisCtx;        // Context for keeping the spec key
   RedisModuleString *specKeyName;  // Cached, used for opening/closing the spec key.
@@ -29,14 +36,30 @@ typedef struct DocumentIndexer {
   KHTable mergeHt;               // Hashtable and block allocator for merging
   BlkAlloc alloc;
   int options;
-  pthread_t thr;
   size_t refcount;
+  uint64_t docsIndexed;  // documents indexed, and the time spent on them, in nanoseconds
+  uint64_t indexingNS;
 } DocumentIndexer;
 
 #define INDEXER_THREADLESS 0x01
 
-// Set when the indexer is about to be deleted
-#define INDEXER_STOPPED 0x02
+/**
+ * Start the pool of threads shared by the indexers of all the indexes. Indexers
+ * created before it is started index documents in the thread adding them.
+ */
+void Indexer_PoolStart(size_t numThreads);
+
+/* Index the queued documents, then stop the threads of the pool */
+void Indexer_PoolDestroy(void);
+
+/* Add the stats of the pool to the module's section of INFO */
+void Indexer_PoolAddInfoFields(RedisModuleInfoCtx *ctx);
+
+/* The documents the indexer indexes per second of its indexing time */
+double Indexer_DocsPerSec(DocumentIndexer *indexer);
+
+/* Reply with the queue size and the throughput of an indexer, for FT.INFO */
+void Indexer_ReplyStats(RedisModuleCtx *ctx, DocumentIndexer *indexer);
 
 size_t Indexer_Decref(DocumentIndexer *indexer);
 
@@ -51,6 +74,18 @@ DocumentIndexer *NewIndexer(IndexSpec *spec);
  */
 int Indexer_Add(DocumentIndexer *indexer, RSAddDocumentCtx *aCtx);
 
+// The maximal number of documents Indexer_ProcessBatch() merges at once
+#define INDEXER_MAX_BATCH 512
+
+/**
+ * Index a chain (linked by their `next` field) of preprocessed, non-blockable
+ * documents. The terms of every INDEXER_MAX_BATCH documents are merged into a
+ * single dictionary, so that each inverted index is opened once per batch and
+ * written in document ID order. Every context in the chain is finished (see
+ * AddDocumentCtx_Finish()) before the function returns.
+ */
+void Indexer_ProcessBatch(DocumentIndexer *indexer, RSAddDocumentCtx *head);
+
 /**
  * Function to preprocess field data. This should do as much stateless processing
  * as possible on the field - this means things like input validation and normalization.
@@ -84,4 +119,7 @@ int IndexerBulkAdd(IndexBulkData *bulk, RSAddDocumentCtx *cur, RedisSearchCtx *s
                    QueryError *status);
 void IndexerBulkCleanup(IndexBulkData *cur, RedisSearchCtx *sctx);
 
+#ifdef __cplusplus
+}
+#endif
 #endif
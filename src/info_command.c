@@ -2,6 +2,8 @@
 #include "spec.h"
 #include "inverted_index.h"
 #include "cursor.h"
+#include "word_cache.h"
+#include "indexer.h"
 
 #define REPLY_KVNUM(n, k, v)                   \
   RedisModule_ReplyWithSimpleString(ctx, k);   \
@@ -84,6 +86,11 @@ int IndexInfoCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
       REPLY_KVNUM(nn, SPEC_WEIGHT_STR, fs->ftWeight);
     }
 
+    if (FieldSpec_IsInt64(fs)) {
+      RedisModule_ReplyWithSimpleString(ctx, SPEC_INT64_STR);
+      ++nn;
+    }
+
     if (FIELD_IS(fs, INDEXFLD_T_TAG)) {
       char buf[2];
       sprintf(buf, "%c", fs->tagSep);
@@ -124,6 +131,8 @@ int IndexInfoCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
   REPLY_KVNUM(n, "sortable_values_size_mb", sp->docs.sortablesSize / (float)0x100000);
 
   REPLY_KVNUM(n, "key_table_size_mb", TrieMap_MemUsage(sp->docs.dim.tm) / (float)0x100000);
+  size_t spellIdxSize = sp->terms->spellIdx ? SpellIndex_MemUsage(sp->terms->spellIdx) : 0;
+  REPLY_KVNUM(n, "spell_index_sz_mb", spellIdxSize / (float)0x100000);
   REPLY_KVNUM(n, "records_per_doc_avg",
               (float)sp->stats.numRecords / (float)sp->stats.numDocuments);
   REPLY_KVNUM(n, "bytes_per_record_avg",
@@ -146,6 +155,21 @@ int IndexInfoCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
   Cursors_RenderStats(&RSCursors, sp->name, ctx);
   n += 2;
 
+  const LatencyStats *latency[] = {&sp->latency, sp->gc ? GCContext_GetLatencyStats(sp->gc) : NULL};
+  RedisModule_ReplyWithSimpleString(ctx, "latency_stats");
+  LatencyStats_Reply(ctx, latency, 2);
+  n += 2;
+
+  if (sp->indexer) {
+    RedisModule_ReplyWithSimpleString(ctx, "indexer_stats");
+    Indexer_ReplyStats(ctx, sp->indexer);
+    n += 2;
+  }
+
+  RedisModule_ReplyWithSimpleString(ctx, "word_cache_stats");
+  WordCache_ReplyStats(ctx);
+  n += 2;
+
   if (sp->flags & Index_HasCustomStopwords) {
     ReplyWithStopWordsList(ctx, sp->stopwords);
     n += 2;
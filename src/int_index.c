@@ -0,0 +1,362 @@
+#include "int_index.h"
+#include "spec.h"
+#include "index_result.h"
+#include "rmalloc.h"
+#include <math.h>
+#include <string.h>
+
+#define INTINDEX_KEY_FMT "ni:%s/%s"
+
+// Flipping the sign bit maps int64 values to uint64 values with the same ordering
+#define INTIDX_SIGN_BIT (1ULL << (INTIDX_NUM_SLICES - 1))
+#define INTIDX_TO_ORDERED(v) ((uint64_t)(v) ^ INTIDX_SIGN_BIT)
+
+IntIndex *NewIntIndex(void) {
+  IntIndex *idx = rm_calloc(1, sizeof(*idx));
+  Bitmap_Init(&idx->exists);
+  for (size_t ii = 0; ii < INTIDX_NUM_SLICES; ++ii) {
+    Bitmap_Init(&idx->slices[ii]);
+  }
+  return idx;
+}
+
+void IntIndex_Free(void *p) {
+  IntIndex *idx = p;
+  Bitmap_Cleanup(&idx->exists);
+  for (size_t ii = 0; ii < INTIDX_NUM_SLICES; ++ii) {
+    Bitmap_Cleanup(&idx->slices[ii]);
+  }
+  rm_free(idx);
+}
+
+size_t IntIndex_MemUsage(const IntIndex *idx) {
+  size_t sz = sizeof(*idx) - sizeof(idx->exists) - sizeof(idx->slices);
+  sz += Bitmap_MemUsage(&idx->exists);
+  for (size_t ii = 0; ii < INTIDX_NUM_SLICES; ++ii) {
+    sz += Bitmap_MemUsage(&idx->slices[ii]);
+  }
+  return sz;
+}
+
+/* Set the bit of a document in one of the bitmaps, and return the number of bytes it grew by */
+static size_t setBit(Bitmap *bm, t_docId docId) {
+  size_t before = Bitmap_MemUsage(bm);
+  Bitmap_Set(bm, docId);
+  return Bitmap_MemUsage(bm) - before;
+}
+
+size_t IntIndex_Add(IntIndex *idx, t_docId docId, int64_t value) {
+  // Do not allow duplicate entries, same as the numeric range tree
+  if (docId <= idx->lastDocId) {
+    return 0;
+  }
+  idx->lastDocId = docId;
+
+  size_t grown = setBit(&idx->exists, docId);
+  uint64_t bits = (uint64_t)value;
+  while (bits) {
+    int slice = __builtin_ctzll(bits);
+    grown += setBit(&idx->slices[slice], docId);
+    bits &= bits - 1;
+  }
+  idx->numEntries++;
+  return grown;
+}
+
+void IntIndex_FindDeleted(const IntIndex *idx, const DocTable *docs, Bitmap *deleted) {
+  Bitmap_Init(deleted);
+  Bitmap_Or(deleted, &idx->exists);
+  Bitmap_AndNot(deleted, &docs->live);
+}
+
+size_t IntIndex_RemoveDocs(IntIndex *idx, const Bitmap *deleted, size_t *bytesCollected) {
+  size_t before = IntIndex_MemUsage(idx);
+  size_t numEntries = Bitmap_Card(&idx->exists);
+  Bitmap_AndNot(&idx->exists, deleted);
+  for (size_t ii = 0; ii < INTIDX_NUM_SLICES; ++ii) {
+    Bitmap_AndNot(&idx->slices[ii], deleted);
+  }
+  size_t removed = numEntries - Bitmap_Card(&idx->exists);
+  idx->numEntries -= removed;
+  *bytesCollected = before - IntIndex_MemUsage(idx);
+  return removed;
+}
+
+int IntIndex_Get(const IntIndex *idx, t_docId docId, int64_t *value) {
+  if (!Bitmap_Test(&idx->exists, docId)) {
+    return 0;
+  }
+  uint64_t bits = 0;
+  for (size_t ii = 0; ii < INTIDX_NUM_SLICES; ++ii) {
+    if (Bitmap_Test(&idx->slices[ii], docId)) {
+      bits |= 1ULL << ii;
+    }
+  }
+  *value = (int64_t)bits;
+  return 1;
+}
+
+#define INT64_RANGE_END 9223372036854775808.0  // 2^63, exactly representable as a double
+
+int IntIndex_FilterBounds(const NumericFilter *f, int64_t *min, int64_t *max) {
+  if (f->min >= INT64_RANGE_END || f->max < -INT64_RANGE_END) {
+    return 0;
+  }
+
+  if (f->min < -INT64_RANGE_END) {
+    *min = INT64_MIN;
+  } else {
+    double c = ceil(f->min);
+    *min = (int64_t)c;
+    if (!f->inclusiveMin && c == f->min) {
+      if (*min == INT64_MAX) return 0;
+      ++*min;
+    }
+  }
+
+  if (f->max >= INT64_RANGE_END) {
+    *max = INT64_MAX;
+  } else {
+    double c = floor(f->max);
+    *max = (int64_t)c;
+    if (!f->inclusiveMax && c == f->max) {
+      if (*max == INT64_MIN) return 0;
+      --*max;
+    }
+  }
+  return *min <= *max;
+}
+
+/******************************************************************************
+ * Int index iterator.
+ *
+ * The iterator evaluates the range one chunk of the existence bitmap at a time into a local word
+ * buffer, and then reads matching ids from the buffer. Nothing is materialized for chunks that are
+ * never reached, so a SkipTo from an intersection only evaluates the chunks it lands in.
+ ******************************************************************************/
+
+typedef struct {
+  IndexIterator base;
+  const IntIndex *idx;
+  // Inclusive bounds, in the order preserving unsigned representation
+  uint64_t min;
+  uint64_t max;
+  // The chunk currently evaluated into `words`, or -1
+  int64_t curChunk;
+  uint64_t words[BITMAP_CHUNK_WORDS];
+  t_docId lastDocId;
+} IntIndexIterator;
+
+static void evalChunk(IntIndexIterator *it, size_t chunk) {
+  const IntIndex *idx = it->idx;
+  const uint64_t *ex = Bitmap_GetChunk(&idx->exists, chunk);
+  it->curChunk = chunk;
+  if (!ex) {
+    memset(it->words, 0, sizeof(it->words));
+    return;
+  }
+
+  const uint64_t *slices[INTIDX_NUM_SLICES];
+  for (size_t ii = 0; ii < INTIDX_NUM_SLICES; ++ii) {
+    slices[ii] = Bitmap_GetChunk(&idx->slices[ii], chunk);
+  }
+
+  for (size_t w = 0; w < BITMAP_CHUNK_WORDS; ++w) {
+    uint64_t e = ex[w];
+    uint64_t gt = 0, lt = 0, eqMin = e, eqMax = e;
+    for (int ii = INTIDX_NUM_SLICES - 1; ii >= 0 && (eqMin | eqMax); --ii) {
+      uint64_t b = slices[ii] ? slices[ii][w] : 0;
+      if (ii == INTIDX_NUM_SLICES - 1) {
+        // The sign bit is compared flipped, see INTIDX_TO_ORDERED
+        b = e & ~b;
+      }
+      if ((it->min >> ii) & 1) {
+        eqMin &= b;
+      } else {
+        gt |= eqMin & b;
+        eqMin &= ~b;
+      }
+      if ((it->max >> ii) & 1) {
+        lt |= eqMax & ~b;
+        eqMax &= b;
+      } else {
+        eqMax &= ~b;
+      }
+    }
+    it->words[w] = (gt | eqMin) & (lt | eqMax);
+  }
+}
+
+/* Find the first matching docId which is >= from, or 0 if there is none */
+static t_docId INTI_Next(IntIndexIterator *it, t_docId from) {
+  size_t numChunks = it->idx->exists.numChunks;
+  size_t chunk = BITMAP_CHUNK_OF(from);
+  size_t word = BITMAP_WORD_OF(from);
+  uint64_t mask = ~0ULL << BITMAP_BIT_OF(from);
+
+  for (; chunk < numChunks; ++chunk, word = 0, mask = ~0ULL) {
+    if (!Bitmap_GetChunk(&it->idx->exists, chunk)) {
+      continue;
+    }
+    if (it->curChunk != (int64_t)chunk) {
+      evalChunk(it, chunk);
+    }
+    for (; word < BITMAP_CHUNK_WORDS; ++word, mask = ~0ULL) {
+      uint64_t w = it->words[word] & mask;
+      if (w) {
+        return (t_docId)chunk * BITMAP_CHUNK_BITS + word * BITMAP_WORD_BITS + __builtin_ctzll(w);
+      }
+    }
+  }
+  return 0;
+}
+
+static int INTI_Read(void *ctx, RSIndexResult **hit) {
+  IntIndexIterator *it = ctx;
+  if (!it->base.isValid) {
+    return INDEXREAD_EOF;
+  }
+  t_docId docId = INTI_Next(it, it->lastDocId + 1);
+  if (!docId) {
+    it->base.isValid = 0;
+    return INDEXREAD_EOF;
+  }
+  it->lastDocId = it->base.current->docId = docId;
+  *hit = it->base.current;
+  return INDEXREAD_OK;
+}
+
+static int INTI_SkipTo(void *ctx, t_docId docId, RSIndexResult **hit) {
+  IntIndexIterator *it = ctx;
+  if (!it->base.isValid) {
+    return INDEXREAD_EOF;
+  }
+  if (docId <= it->lastDocId) {
+    docId = it->lastDocId + 1;
+  }
+  t_docId found = INTI_Next(it, docId);
+  if (!found) {
+    it->base.isValid = 0;
+    return INDEXREAD_EOF;
+  }
+  it->lastDocId = it->base.current->docId = found;
+  *hit = it->base.current;
+  return found == docId ? INDEXREAD_OK : INDEXREAD_NOTFOUND;
+}
+
+static t_docId INTI_LastDocId(void *ctx) {
+  return ((IntIndexIterator *)ctx)->lastDocId;
+}
+
+static size_t INTI_NumEstimated(void *ctx) {
+  return Bitmap_Card(&((IntIndexIterator *)ctx)->idx->exists);
+}
+
+static void INTI_Abort(void *ctx) {
+  ((IntIndexIterator *)ctx)->base.isValid = 0;
+}
+
+static void INTI_Rewind(void *ctx) {
+  IntIndexIterator *it = ctx;
+  it->base.isValid = 1;
+  it->base.current->docId = 0;
+  it->lastDocId = 0;
+  it->curChunk = -1;
+}
+
+static void INTI_Free(IndexIterator *self) {
+  IndexResult_Free(self->current);
+  rm_free(self);
+}
+
+typedef struct {
+  IndexCriteriaTester base;
+  const IntIndex *idx;
+  int64_t min;
+  int64_t max;
+} IntCriteriaTester;
+
+static int INTI_Test(struct IndexCriteriaTester *ct, t_docId id) {
+  IntCriteriaTester *ict = (IntCriteriaTester *)ct;
+  int64_t value;
+  return IntIndex_Get(ict->idx, id, &value) && value >= ict->min && value <= ict->max;
+}
+
+static void INTI_TesterFree(struct IndexCriteriaTester *ct) {
+  rm_free(ct);
+}
+
+static IndexCriteriaTester *INTI_GetCriteriaTester(void *ctx) {
+  IntIndexIterator *it = ctx;
+  IntCriteriaTester *ct = rm_malloc(sizeof(*ct));
+  ct->idx = it->idx;
+  ct->min = (int64_t)(it->min ^ INTIDX_SIGN_BIT);
+  ct->max = (int64_t)(it->max ^ INTIDX_SIGN_BIT);
+  ct->base.Test = INTI_Test;
+  ct->base.Free = INTI_TesterFree;
+  return &ct->base;
+}
+
+IndexIterator *NewIntIndexIterator(const IntIndex *idx, int64_t min, int64_t max) {
+  IntIndexIterator *it = rm_calloc(1, sizeof(*it));
+  it->idx = idx;
+  it->min = INTIDX_TO_ORDERED(min);
+  it->max = INTIDX_TO_ORDERED(max);
+  it->curChunk = -1;
+
+  // The slices don't store values per record, so the hits are virtual
+  it->base.current = NewVirtualResult(1);
+  it->base.current->fieldMask = RS_FIELDMASK_ALL;
+
+  IndexIterator *ret = &it->base;
+  ret->ctx = it;
+  ret->isValid = 1;
+  ret->mode = MODE_SORTED;
+  ret->GetCriteriaTester = INTI_GetCriteriaTester;
+  ret->NumEstimated = INTI_NumEstimated;
+  ret->Read = INTI_Read;
+  ret->SkipTo = INTI_SkipTo;
+  ret->LastDocId = INTI_LastDocId;
+  ret->HasNext = NULL;
+  ret->Free = INTI_Free;
+  ret->Len = INTI_NumEstimated;
+  ret->Abort = INTI_Abort;
+  ret->Rewind = INTI_Rewind;
+  return ret;
+}
+
+RedisModuleString *fmtRedisIntIndexKey(RedisSearchCtx *ctx, const char *field) {
+  return RedisModule_CreateStringPrintf(ctx->redisCtx, INTINDEX_KEY_FMT, ctx->spec->name, field);
+}
+
+IntIndex *OpenIntIndex(RedisSearchCtx *ctx, RedisModuleString *keyName, int write) {
+  if (!ctx->spec->keysDict) {
+    return NULL;
+  }
+  KeysDictValue *kdv = dictFetchValue(ctx->spec->keysDict, keyName);
+  if (kdv) {
+    return kdv->p;
+  }
+  if (!write) {
+    return NULL;
+  }
+  kdv = rm_calloc(1, sizeof(*kdv));
+  kdv->dtor = IntIndex_Free;
+  kdv->p = NewIntIndex();
+  dictAdd(ctx->spec->keysDict, keyName, kdv);
+  return kdv->p;
+}
+
+IndexIterator *NewIntFilterIterator(RedisSearchCtx *ctx, const NumericFilter *flt) {
+  RedisModuleString *s =
+      IndexSpec_GetFormattedKeyByName(ctx->spec, flt->fieldName, INDEXFLD_T_NUMERIC);
+  if (!s) {
+    return NULL;
+  }
+  IntIndex *idx = OpenIntIndex(ctx, s, 0);
+  int64_t min, max;
+  if (!idx || !IntIndex_FilterBounds(flt, &min, &max)) {
+    return NULL;
+  }
+  return NewIntIndexIterator(idx, min, max);
+}
@@ -0,0 +1,89 @@
+#ifndef RS_INT_INDEX_H_
+#define RS_INT_INDEX_H_
+
+#include "redisearch.h"
+#include "redismodule.h"
+#include "search_ctx.h"
+#include "index_iterator.h"
+#include "numeric_filter.h"
+#include "util/bitmap.h"
+#include "doc_table.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * An Int Index is the index behind NUMERIC INT64 fields. Instead of binning values into the ranges
+ * of a NumericRangeTree, it stores them as a bit-sliced index:
+ *
+ * - One bitmap (the "existence" bitmap) has a bit set for every document that has a value.
+ * - One bitmap per bit of the 64 bit value (a "slice") has a bit set for every document whose
+ *   value has that bit set. Values are stored in two's complement, so slices for high bits of small
+ *   non negative values are never allocated.
+ *
+ * A range predicate is evaluated 64 documents at a time, by walking the slices from the most
+ * significant bit down and maintaining "greater than", "less than" and "equal" words. The cost is
+ * O(bits) word operations per 64 documents regardless of the selectivity of the range, and equality
+ * is just a range where min == max.
+ *
+ * Deleted documents are filtered by the doc table like in all the other indexes, until the GC
+ * clears their bits from the existence bitmap and the slices.
+ */
+
+#define INTIDX_NUM_SLICES 64
+
+typedef struct {
+  Bitmap exists;
+  Bitmap slices[INTIDX_NUM_SLICES];
+  size_t numEntries;
+  t_docId lastDocId;
+} IntIndex;
+
+/* Create a new, empty int index */
+IntIndex *NewIntIndex(void);
+
+/* Free the index and all its slices */
+void IntIndex_Free(void *idx);
+
+/* Add a value for a document. Documents must be added in increasing docId order, and
+ * duplicates are ignored. Returns the number of bytes the index has grown by */
+size_t IntIndex_Add(IntIndex *idx, t_docId docId, int64_t value);
+
+/* Exact lookup of a document's value. Returns 1 and sets *value if the document has a value in
+ * the index, and 0 otherwise */
+int IntIndex_Get(const IntIndex *idx, t_docId docId, int64_t *value);
+
+/* Find the documents which have a value in the index but are no longer live in the doc table.
+ * `deleted` is initialized by the call, and the caller should clean it up */
+void IntIndex_FindDeleted(const IntIndex *idx, const DocTable *docs, Bitmap *deleted);
+
+/* Remove the values of the documents set in `deleted`. Returns the number of removed entries, and
+ * sets the number of bytes freed in *bytesCollected */
+size_t IntIndex_RemoveDocs(IntIndex *idx, const Bitmap *deleted, size_t *bytesCollected);
+
+/* Return the number of bytes used by the index */
+size_t IntIndex_MemUsage(const IntIndex *idx);
+
+/* Convert the floating point bounds of a numeric filter into inclusive integer bounds. Returns 0
+ * if no integer can match the filter */
+int IntIndex_FilterBounds(const NumericFilter *f, int64_t *min, int64_t *max);
+
+/* Create an iterator over all the documents whose value is between min and max (inclusive) */
+IndexIterator *NewIntIndexIterator(const IntIndex *idx, int64_t min, int64_t max);
+
+/* Create an iterator for a numeric filter on an INT64 field. Returns NULL if the field has no
+ * index or no value can match the filter */
+IndexIterator *NewIntFilterIterator(RedisSearchCtx *ctx, const NumericFilter *flt);
+
+/* Open the int index of a field, creating it if `write` is set. Int indexes only live in the
+ * keys dictionary of keyless indexes; NULL is returned otherwise */
+IntIndex *OpenIntIndex(RedisSearchCtx *ctx, RedisModuleString *keyName, int write);
+
+/* Format the key name for an int index */
+RedisModuleString *fmtRedisIntIndexKey(RedisSearchCtx *ctx, const char *field);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -3,6 +3,7 @@
 #include "math.h"
 #include "varint.h"
 #include <stdio.h>
+#include <sys/param.h>
 #include <float.h>
 #include "rmalloc.h"
 #include "qint.h"
@@ -440,6 +441,25 @@ size_t InvertedIndex_WriteEntryGeneric(InvertedIndex *idx, IndexEncoder encoder,
   return ret;
 }
 
+size_t InvertedIndex_Reserve(InvertedIndex *idx, size_t numEntries, size_t entrySize) {
+  IndexBlock *blk = &INDEX_LAST_BLOCK(idx);
+  if (blk->numDocs >= INDEX_BLOCK_SIZE) {
+    // the first id of the block is set by the first write
+    blk = InvertedIndex_AddBlock(idx, 0);
+  }
+  size_t n = MIN(numEntries, INDEX_BLOCK_SIZE - blk->numDocs);
+  Buffer *buf = &blk->buf;
+  size_t needed = buf->offset + n * entrySize;
+  if (needed > buf->cap) {
+    // grow geometrically, since a term gets a reservation on every batch it is in, but not beyond
+    // what the block can still hold
+    size_t max = buf->offset + (INDEX_BLOCK_SIZE - blk->numDocs) * entrySize;
+    buf->cap = MIN(MAX(needed, buf->cap * 2), max);
+    buf->data = rm_realloc(buf->data, buf->cap);
+  }
+  return n;
+}
+
 /** Write a forward-index entry to the index */
 size_t InvertedIndex_WriteForwardIndexEntry(InvertedIndex *idx, IndexEncoder encoder,
                                             ForwardIndexEntry *ent) {
@@ -165,6 +165,13 @@ size_t InvertedIndex_WriteNumericEntry(InvertedIndex *idx, t_docId docId, double
 
 size_t InvertedIndex_WriteEntryGeneric(InvertedIndex *idx, IndexEncoder encoder, t_docId docId,
                                        RSIndexResult *entry);
+
+/* Prepare the index for writing numEntries entries of about entrySize bytes each, by growing the
+ * buffer of the block they are written to up front. The buffer grows geometrically, up to the size
+ * of a full block. Starts a new block if the last one is full.
+ * Returns the number of entries the block has room for - the rest should be reserved once these
+ * are written */
+size_t InvertedIndex_Reserve(InvertedIndex *idx, size_t numEntries, size_t entrySize);
 /* Create a new index reader for numeric records, optionally using a given filter. If the filter
  * is
  * NULL we will return all the records in the index */
@@ -0,0 +1,97 @@
+#include "latency_stats.h"
+#include "rmalloc.h"
+
+LatencyStats RSGlobalLatencyStats = {0};
+
+static const char *metricNames[LATENCY_NUM_METRICS] = {
+    [LATENCY_SEARCH] = "search",
+    [LATENCY_AGGREGATE] = "aggregate",
+    [LATENCY_CURSOR_READ] = "cursor_read",
+    [LATENCY_HASH_INDEXING] = "hash_indexing",
+    [LATENCY_INDEXER_BATCH] = "indexer_batch",
+    [LATENCY_GC_FORK] = "gc_fork",
+    [LATENCY_GC_CHILD] = "gc_child",
+    [LATENCY_GC_APPLY] = "gc_apply",
+};
+
+static const struct {
+  const char *name;
+  double p;
+} percentiles[] = {{"p50", 50}, {"p90", 90}, {"p99", 99}, {"p99.9", 99.9}};
+
+#define NUM_PERCENTILES (sizeof(percentiles) / sizeof(percentiles[0]))
+
+static Histogram *getHistogram(LatencyStats *s, LatencyMetric m) {
+  Histogram *h = __atomic_load_n(&s->metrics[m], __ATOMIC_ACQUIRE);
+  if (h) {
+    return h;
+  }
+  // Another thread may allocate it at the same time, in which case we use its histogram
+  Histogram *newh = rm_calloc(1, sizeof(*newh));
+  if (__atomic_compare_exchange_n(&s->metrics[m], &h, newh, 0, __ATOMIC_ACQ_REL,
+                                  __ATOMIC_ACQUIRE)) {
+    return newh;
+  }
+  rm_free(newh);
+  return h;
+}
+
+void LatencyStats_Record(LatencyStats *s, LatencyMetric m, uint64_t usec) {
+  if (s) {
+    Histogram_Record(getHistogram(s, m), usec);
+  }
+  Histogram_Record(getHistogram(&RSGlobalLatencyStats, m), usec);
+}
+
+void LatencyStats_Free(LatencyStats *s) {
+  for (size_t i = 0; i < LATENCY_NUM_METRICS; i++) {
+    rm_free(s->metrics[i]);
+    s->metrics[i] = NULL;
+  }
+}
+
+void LatencyStats_Reply(RedisModuleCtx *ctx, const LatencyStats **stats, size_t nstats) {
+  size_t n = 0;
+  RedisModule_ReplyWithArray(ctx, REDISMODULE_POSTPONED_ARRAY_LEN);
+  for (size_t i = 0; i < LATENCY_NUM_METRICS; i++) {
+    const Histogram *h = NULL;
+    for (size_t j = 0; j < nstats && !h; j++) {
+      h = stats[j] ? __atomic_load_n(&stats[j]->metrics[i], __ATOMIC_ACQUIRE) : NULL;
+    }
+    if (!h) {
+      continue;
+    }
+    RedisModule_ReplyWithSimpleString(ctx, metricNames[i]);
+    RedisModule_ReplyWithArray(ctx, 6 + 2 * NUM_PERCENTILES);
+    RedisModule_ReplyWithSimpleString(ctx, "calls");
+    RedisModule_ReplyWithLongLong(ctx, h->count);
+    RedisModule_ReplyWithSimpleString(ctx, "total_usec");
+    RedisModule_ReplyWithLongLong(ctx, h->total);
+    for (size_t j = 0; j < NUM_PERCENTILES; j++) {
+      RedisModule_ReplyWithSimpleString(ctx, percentiles[j].name);
+      RedisModule_ReplyWithLongLong(ctx, Histogram_Percentile(h, percentiles[j].p));
+    }
+    RedisModule_ReplyWithSimpleString(ctx, "max");
+    RedisModule_ReplyWithLongLong(ctx, h->max);
+    n += 2;
+  }
+  RedisModule_ReplySetArrayLength(ctx, n);
+}
+
+void LatencyStats_AddInfoFields(RedisModuleInfoCtx *ctx, const LatencyStats *s) {
+  for (size_t i = 0; i < LATENCY_NUM_METRICS; i++) {
+    const Histogram *h = __atomic_load_n(&s->metrics[i], __ATOMIC_ACQUIRE);
+    if (!h) {
+      continue;
+    }
+    RedisModule_InfoBeginDictField(ctx, (char *)metricNames[i]);
+    RedisModule_InfoAddFieldULongLong(ctx, "calls", h->count);
+    RedisModule_InfoAddFieldULongLong(ctx, "total_usec", h->total);
+    for (size_t j = 0; j < NUM_PERCENTILES; j++) {
+      RedisModule_InfoAddFieldULongLong(ctx, (char *)percentiles[j].name,
+                                        Histogram_Percentile(h, percentiles[j].p));
+    }
+    RedisModule_InfoAddFieldULongLong(ctx, "max", h->max);
+    RedisModule_InfoEndDictField(ctx);
+  }
+}
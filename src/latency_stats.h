@@ -0,0 +1,62 @@
+#ifndef RS_LATENCY_STATS_H_
+#define RS_LATENCY_STATS_H_
+
+#include <time.h>
+#include "redismodule.h"
+#include "util/histogram.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Latency histograms of the module's operations, in microseconds. Every index keeps its own, and
+ * every latency recorded for an index is also recorded in the global histograms */
+
+typedef enum {
+  LATENCY_SEARCH,          // FT.SEARCH, including the first chunk of a cursor
+  LATENCY_AGGREGATE,       // FT.AGGREGATE, including the first chunk of a cursor
+  LATENCY_CURSOR_READ,     // FT.CURSOR READ
+  LATENCY_HASH_INDEXING,   // Indexing a hash, on a keyspace notification or a scan
+  LATENCY_INDEXER_BATCH,   // A batch of documents processed by the indexer
+  LATENCY_GC_FORK,         // Forking the GC child
+  LATENCY_GC_CHILD,        // Waiting for the GC child to send its findings
+  LATENCY_GC_APPLY,        // Applying the findings of the GC child
+  LATENCY_NUM_METRICS
+} LatencyMetric;
+
+typedef struct LatencyStats {
+  // Allocated on the first latency recorded for each metric
+  Histogram *metrics[LATENCY_NUM_METRICS];
+} LatencyStats;
+
+extern LatencyStats RSGlobalLatencyStats;
+
+/* The current time in microseconds, for measuring latencies */
+static inline uint64_t LatencyStats_Now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+/* Record a latency in the stats (if given) and in the global stats */
+void LatencyStats_Record(LatencyStats *s, LatencyMetric m, uint64_t usec);
+
+/* Record the time passed since start, taken with LatencyStats_Now() */
+static inline void LatencyStats_RecordSince(LatencyStats *s, LatencyMetric m, uint64_t start) {
+  LatencyStats_Record(s, m, LatencyStats_Now() - start);
+}
+
+/* Free the histograms of the stats, but not the stats themselves */
+void LatencyStats_Free(LatencyStats *s);
+
+/* Reply with the histograms of the metrics recorded in any of the stats, for FT.INFO. NULL stats
+ * are skipped, and a metric recorded in more than one of them is taken from the first */
+void LatencyStats_Reply(RedisModuleCtx *ctx, const LatencyStats **stats, size_t n);
+
+/* Add the histograms of the metrics that have been recorded to an INFO section, a field each */
+void LatencyStats_AddInfoFields(RedisModuleInfoCtx *ctx, const LatencyStats *s);
+
+#ifdef __cplusplus
+}
+#endif
+#endif  // RS_LATENCY_STATS_H_
@@ -12,6 +12,7 @@
 #include "tests/time_sample.h"
 #include "numeric_index.h"
 #include "tag_index.h"
+#include "int_index.h"
 #include "config.h"
 #include <unistd.h>
 #include <sys/wait.h>
@@ -125,6 +126,9 @@ size_t gc_RandomTerm(RedisModuleCtx *ctx, GarbageCollectorCtx *gc, int *status)
       totalRemoved += params.docsCollected;
       gc_updateStats(sctx, gc, params.docsCollected, params.bytesCollected);
       totalCollected += params.bytesCollected;
+      if (params.docsCollected) {
+        IndexSpec_InvalidateTermStats(sctx->spec, term, strlen(term));
+      }
       // blockNum 0 means error or we've finished
       if (!blockNum) break;
 
@@ -301,7 +305,7 @@ size_t gc_NumericIndex(RedisModuleCtx *ctx, GarbageCollectorCtx *gc, int *status
   }
   IndexSpec *spec = sctx->spec;
   // find all the numeric fields
-  numericFields = getFieldsByType(spec, INDEXFLD_T_NUMERIC | INDEXFLD_T_GEO);
+  numericFields = getRangeTreeFields(spec);
 
   if (array_len(numericFields) == 0) {
     goto end;
@@ -380,6 +384,54 @@ end:
   return totalRemoved;
 }
 
+/* Clear the deleted documents from the int indexes of INT64 fields. Finding them takes a pass over
+ * the existence bitmap of each index, 64 documents per word */
+size_t gc_IntIndex(RedisModuleCtx *ctx, GarbageCollectorCtx *gc, int *status) {
+  size_t totalRemoved = 0;
+  FieldSpec **numericFields = NULL;
+  RedisSearchCtx *sctx = NewSearchCtx(ctx, (RedisModuleString *)gc->keyName, false);
+  if (!sctx || sctx->spec->uniqueId != gc->specUniqueId) {
+    RedisModule_Log(ctx, "warning", "No index spec for GC %s",
+                    RedisModule_StringPtrLen(gc->keyName, NULL));
+    *status = SPEC_STATUS_INVALID;
+    goto end;
+  }
+  IndexSpec *spec = sctx->spec;
+
+  numericFields = getFieldsByType(spec, INDEXFLD_T_NUMERIC);
+  for (int i = 0; i < array_len(numericFields); ++i) {
+    if (!FieldSpec_IsInt64(numericFields[i])) {
+      continue;
+    }
+    RedisModuleString *keyName =
+        IndexSpec_GetFormattedKey(spec, numericFields[i], INDEXFLD_T_NUMERIC);
+    IntIndex *idx = OpenIntIndex(sctx, keyName, 0);
+    if (!idx) {
+      continue;
+    }
+    Bitmap deleted;
+    IntIndex_FindDeleted(idx, &spec->docs, &deleted);
+    if (Bitmap_Card(&deleted)) {
+      size_t bytesCollected;
+      size_t removed = IntIndex_RemoveDocs(idx, &deleted, &bytesCollected);
+      gc_updateStats(sctx, gc, removed, bytesCollected);
+      totalRemoved += removed;
+    }
+    Bitmap_Cleanup(&deleted);
+  }
+
+end:
+  if (numericFields) {
+    array_free(numericFields);
+  }
+
+  if (sctx) {
+    SearchCtx_Free(sctx);
+  }
+
+  return totalRemoved;
+}
+
 /* The GC periodic callback, called in a separate thread. It selects a random term (using weighted
  * random) */
 int GC_PeriodicCallback(RedisModuleCtx *ctx, void *privdata) {
@@ -409,6 +461,8 @@ int GC_PeriodicCallback(RedisModuleCtx *ctx, void *privdata) {
 
   totalRemoved += gc_TagIndex(ctx, gc, &status);
 
+  totalRemoved += gc_IntIndex(ctx, gc, &status);
+
   gc->stats.numCycles++;
   gc->stats.effectiveCycles += totalRemoved > 0 ? 1 : 0;
 
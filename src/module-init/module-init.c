@@ -7,6 +7,7 @@
 #include <assert.h>
 #include <ctype.h>
 #include "concurrent_ctx.h"
+#include "indexer.h"
 #include "cursor.h"
 #include "extension.h"
 #include "alias.h"
@@ -134,6 +135,7 @@ int RediSearch_Init(RedisModuleCtx *ctx, int mode) {
 
   if (RSGlobalConfig.concurrentMode) {
     ConcurrentSearch_ThreadPoolStart();
+    Indexer_PoolStart(ConcurrentSearch_NumIndexThreads());
   }
 
   GC_ThreadPoolStart();
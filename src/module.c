@@ -30,6 +30,10 @@
 #include "alias.h"
 #include "module.h"
 #include "info_command.h"
+#include "latency_stats.h"
+#include "slowlog.h"
+#include "word_cache.h"
+#include "indexer.h"
 
 pthread_rwlock_t RWLock = PTHREAD_RWLOCK_INITIALIZER;
 
@@ -270,6 +274,7 @@ int QueryExplainCLICommand(RedisModuleCtx *ctx, RedisModuleString **argv, int ar
 
 int RSAggregateCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
 int RSSearchCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
+int RSProfileCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
 int RSCursorCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
 
 /* FT.DEL {index} {doc_id}
@@ -786,6 +791,17 @@ int IndexList(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
     RedisModule_Log(ctx, "verbose", "Successfully executed " #f);              \
   }
 
+/* The module's sections of INFO, holding the latencies of all the indexes and the state of the
+ * indexing threads */
+static void RSInfoFunc(RedisModuleInfoCtx *ctx, int for_crash_report) {
+  RedisModule_InfoAddSection(ctx, "latency");
+  LatencyStats_AddInfoFields(ctx, &RSGlobalLatencyStats);
+  if (RSGlobalConfig.concurrentMode) {
+    RedisModule_InfoAddSection(ctx, "indexer_pool");
+    Indexer_PoolAddInfoFields(ctx);
+  }
+}
+
 int RediSearch_InitModuleInternal(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
   char *err;
   if (ReadConfig(argv, argc, &err) == REDISMODULE_ERR) {
@@ -838,6 +854,8 @@ int RediSearch_InitModuleInternal(RedisModuleCtx *ctx, RedisModuleString **argv,
          INDEX_ONLY_CMD_ARGS);
   RM_TRY(RedisModule_CreateCommand, ctx, RS_AGGREGATE_CMD, RSAggregateCommand, "readonly",
          INDEX_ONLY_CMD_ARGS);
+  RM_TRY(RedisModule_CreateCommand, ctx, RS_PROFILE_CMD, RSProfileCommand, "readonly",
+         INDEX_ONLY_CMD_ARGS);
 
   RM_TRY(RedisModule_CreateCommand, ctx, RS_GET_CMD, GetSingleDocumentCommand, "readonly",
          INDEX_DOC_CMD_ARGS);
@@ -914,6 +932,8 @@ int RediSearch_InitModuleInternal(RedisModuleCtx *ctx, RedisModuleString **argv,
 
   RM_TRY(RedisModule_CreateCommand, ctx, RS_CONFIG, ConfigCommand, "readonly", 0, 0, 0);
 
+  RM_TRY(RedisModule_CreateCommand, ctx, RS_SLOWLOG, SlowlogCommand, "readonly", 0, 0, 0);
+
 // alias is a special case, we can not use the INDEX_ONLY_CMD_ARGS/INDEX_DOC_CMD_ARGS macros
 #ifndef RS_COORDINATOR
   // we are running in a normal mode so we should raise cross slot error on alias commands
@@ -928,6 +948,11 @@ int RediSearch_InitModuleInternal(RedisModuleCtx *ctx, RedisModuleString **argv,
 
   RM_TRY(RedisModule_CreateCommand, ctx, RS_ALIASDEL, AliasDelCommand, "readonly", 0, 0, 0);
 #endif
+
+  // Older servers have no module INFO sections, the latencies are still in FT.INFO
+  if (RedisModule_RegisterInfoFunc) {
+    RM_TRY(RedisModule_RegisterInfoFunc, ctx, RSInfoFunc);
+  }
   return REDISMODULE_OK;
 }
 
@@ -945,10 +970,15 @@ void __attribute__((destructor)) RediSearch_CleanupModule(void) {
     mempool_free_global();
     ConcurrentSearch_ThreadPoolDestroy();
     GC_ThreadPoolDestroy();
+    Indexer_PoolDestroy();
+    Document_TokenizePoolDestroy();
     IndexAlias_DestroyGlobal();
     freeGlobalAddStrings();
     SchemaPrefixes_Free();
     RedisModule_FreeThreadSafeContext(RSDummyContext);
     Dictionary_Free();
+    LatencyStats_Free(&RSGlobalLatencyStats);
+    Slowlog_Reset();
+    WordCache_FreeAll();
   }
 }
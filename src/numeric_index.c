@@ -386,6 +386,10 @@ static NumericRangeTree *openNumericKeysDict(RedisSearchCtx *ctx, RedisModuleStr
                                              int write) {
   KeysDictValue *kdv = dictFetchValue(ctx->spec->keysDict, keyName);
   if (kdv) {
+    // INT64 fields keep an IntIndex under their key, not a range tree
+    if (kdv->dtor != (void (*)(void *))NumericRangeTree_Free) {
+      return NULL;
+    }
     return kdv->p;
   }
   if (!write) {
@@ -3,6 +3,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include "rmalloc.h"
+#include "word_cache.h"
 
 static void PhoneticManager_AddPrefix(char** phoneticTerm) {
   if (!phoneticTerm || !(*phoneticTerm)) {
@@ -18,10 +19,26 @@ void PhoneticManager_ExpandPhonetics(PhoneticManagerCtx* ctx, const char* term,
                                      char** primary, char** secondary) {
   // currently ctx is irrelevant we support only one universal algorithm for all 4 languages
   // this phonetic manager was built for future thinking and easily add more algorithms
+
+  // only the primary code is cached, which is all the tokenizer and the query expander use
+  WordCache *cache = secondary ? NULL : WordCache_Get(WORDCACHE_PHONETICS, RS_LANG_ENGLISH);
+  if (cache) {
+    char cached[WORDCACHE_MAX_LEN];
+    int cachedLen = WordCache_Lookup(cache, term, len, cached);
+    if (cachedLen >= 0) {
+      *primary = rm_strndup(cached, cachedLen);
+      return;
+    }
+  }
+
   char bufTmp[len + 1];
   bufTmp[len] = 0;
   memcpy(bufTmp, term, len);
   DoubleMetaphone(bufTmp, primary, secondary);
   PhoneticManager_AddPrefix(primary);
   PhoneticManager_AddPrefix(secondary);
+
+  if (cache && *primary) {
+    WordCache_Put(cache, term, len, *primary, strlen(*primary));
+  }
 }
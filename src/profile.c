@@ -0,0 +1,278 @@
+#include <string.h>
+#include "profile.h"
+#include "index.h"
+#include "rmalloc.h"
+#include "util/arr.h"
+
+ProfileNode *NewProfileNode(const char *queryNode, const char *term, size_t termLen) {
+  ProfileNode *n = rm_calloc(1, sizeof(*n));
+  n->queryNode = queryNode;
+  if (term) {
+    n->term = rm_strndup(term, termLen);
+  }
+  return n;
+}
+
+void ProfileNode_AddChild(ProfileNode *parent, ProfileNode *child) {
+  if (!parent->children) {
+    parent->children = array_new(ProfileNode *, 2);
+  }
+  parent->children = array_append(parent->children, child);
+}
+
+void ProfileNode_Free(ProfileNode *n) {
+  if (n->children) {
+    for (size_t i = 0; i < array_len(n->children); i++) {
+      ProfileNode_Free(n->children[i]);
+    }
+    array_free(n->children);
+  }
+  rm_free(n->term);
+  rm_free(n);
+}
+
+/*******************************************************************************************************************
+ *  Profile Iterator
+ *
+ * Forwards every call to the child iterator, counting the calls and the time spent in them. The
+ * iterator never caches its validity, so that IITER_HAS_NEXT() always asks the child
+ *******************************************************************************************************************/
+
+typedef struct {
+  IndexIterator base;
+  IndexIterator *child;
+  ProfileNode *node;
+} ProfileIterator;
+
+static void PI_Free(IndexIterator *self);
+
+static inline void PI_Sync(ProfileIterator *pi) {
+  pi->base.current = pi->child->current;
+}
+
+static int PI_Read(void *ctx, RSIndexResult **e) {
+  ProfileIterator *pi = ctx;
+  ProfileClock clk;
+  ProfileClock_Start(&clk);
+  int rc = pi->child->Read(pi->child->ctx, e);
+  ProfileClock_Stop(&clk, pi->node);
+  pi->node->numReads++;
+  if (rc != INDEXREAD_EOF) {
+    pi->node->numResults++;
+  }
+  PI_Sync(pi);
+  return rc;
+}
+
+static int PI_SkipTo(void *ctx, t_docId docId, RSIndexResult **hit) {
+  ProfileIterator *pi = ctx;
+  ProfileClock clk;
+  ProfileClock_Start(&clk);
+  int rc = pi->child->SkipTo(pi->child->ctx, docId, hit);
+  ProfileClock_Stop(&clk, pi->node);
+  pi->node->numSkipTos++;
+  // Skipping past the requested id still moves the iterator to a result
+  if (rc != INDEXREAD_EOF) {
+    pi->node->numResults++;
+  }
+  PI_Sync(pi);
+  return rc;
+}
+
+static t_docId PI_LastDocId(void *ctx) {
+  ProfileIterator *pi = ctx;
+  return pi->child->LastDocId(pi->child->ctx);
+}
+
+static int PI_HasNext(void *ctx) {
+  ProfileIterator *pi = ctx;
+  return IITER_HAS_NEXT(pi->child);
+}
+
+static size_t PI_Len(void *ctx) {
+  ProfileIterator *pi = ctx;
+  return pi->child->Len(pi->child->ctx);
+}
+
+static size_t PI_NumEstimated(void *ctx) {
+  ProfileIterator *pi = ctx;
+  return IITER_NUM_ESTIMATED(pi->child);
+}
+
+static IndexCriteriaTester *PI_GetCriteriaTester(void *ctx) {
+  ProfileIterator *pi = ctx;
+  return IITER_GET_CRITERIA_TESTER(pi->child);
+}
+
+static void PI_Abort(void *ctx) {
+  ProfileIterator *pi = ctx;
+  pi->child->Abort(pi->child->ctx);
+  PI_Sync(pi);
+}
+
+static void PI_Rewind(void *ctx) {
+  ProfileIterator *pi = ctx;
+  pi->child->Rewind(pi->child->ctx);
+  PI_Sync(pi);
+}
+
+static void PI_Free(IndexIterator *self) {
+  ProfileIterator *pi = self->ctx;
+  pi->child->Free(pi->child);
+  rm_free(pi);
+}
+
+IndexIterator *NewProfileIterator(IndexIterator *child, ProfileNode *node) {
+  ProfileIterator *pi = rm_calloc(1, sizeof(*pi));
+  pi->child = child;
+  pi->node = node;
+  // A node evaluated to its single child's iterator wraps the child's profile iterator
+  node->type = child->Free == PI_Free ? ((ProfileIterator *)child->ctx)->node->type
+                                      : IndexIterator_GetTypeString(child);
+
+  IndexIterator *ret = &pi->base;
+  ret->ctx = pi;
+  ret->isValid = 0;
+  ret->mode = child->mode;
+  ret->current = child->current;
+  ret->Read = PI_Read;
+  ret->SkipTo = PI_SkipTo;
+  ret->LastDocId = PI_LastDocId;
+  ret->HasNext = PI_HasNext;
+  ret->Free = PI_Free;
+  ret->Len = child->Len ? PI_Len : NULL;
+  ret->NumEstimated = child->NumEstimated ? PI_NumEstimated : NULL;
+  ret->GetCriteriaTester = child->GetCriteriaTester ? PI_GetCriteriaTester : NULL;
+  ret->Abort = child->Abort ? PI_Abort : NULL;
+  ret->Rewind = child->Rewind ? PI_Rewind : NULL;
+  return ret;
+}
+
+/*******************************************************************************************************************
+ *  Profile Processor
+ *
+ * Sits right after the processor it profiles, counting the results it passes down and the time
+ * spent upstream of it
+ *******************************************************************************************************************/
+
+typedef struct {
+  ResultProcessor base;
+  ProfileNode node;
+} RPProfile;
+
+static int rpprofileNext(ResultProcessor *base, SearchResult *r) {
+  RPProfile *self = (RPProfile *)base;
+  ProfileClock clk;
+  ProfileClock_Start(&clk);
+  int rc = base->upstream->Next(base->upstream, r);
+  ProfileClock_Stop(&clk, &self->node);
+  self->node.numReads++;
+  if (rc == RS_RESULT_OK) {
+    self->node.numResults++;
+  }
+  return rc;
+}
+
+static void rpprofileFree(ResultProcessor *rp) {
+  rm_free(rp);
+}
+
+static ResultProcessor *RPProfile_New(ResultProcessor *rp) {
+  RPProfile *ret = rm_calloc(1, sizeof(*ret));
+  ret->node.type = rp->name;
+  ret->base.upstream = rp;
+  ret->base.parent = rp->parent;
+  ret->base.Next = rpprofileNext;
+  ret->base.Free = rpprofileFree;
+  ret->base.name = "Profile";
+  return &ret->base;
+}
+
+void Profile_WrapPipeline(QueryIterator *qiter) {
+  ResultProcessor *downstream = NULL;
+  for (ResultProcessor *rp = qiter->endProc; rp; rp = rp->upstream) {
+    ResultProcessor *prof = RPProfile_New(rp);
+    if (downstream) {
+      downstream->upstream = prof;
+    } else {
+      qiter->endProc = prof;
+    }
+    downstream = rp;
+  }
+}
+
+/*******************************************************************************************************************
+ *  Replies
+ *******************************************************************************************************************/
+
+static void replyTime(RedisModuleCtx *ctx, const char *name, uint64_t ns) {
+  RedisModule_ReplyWithSimpleString(ctx, name);
+  RedisModule_ReplyWithDouble(ctx, (double)ns / 1000000);
+}
+
+static void replyCounter(RedisModuleCtx *ctx, const char *name, size_t n) {
+  RedisModule_ReplyWithSimpleString(ctx, name);
+  RedisModule_ReplyWithLongLong(ctx, n);
+}
+
+static void replyIterator(RedisModuleCtx *ctx, const ProfileNode *n) {
+  size_t len = 0;
+  RedisModule_ReplyWithArray(ctx, REDISMODULE_POSTPONED_ARRAY_LEN);
+
+  RedisModule_ReplyWithSimpleString(ctx, "Type");
+  RedisModule_ReplyWithSimpleString(ctx, n->type ? n->type : "Unknown");
+  RedisModule_ReplyWithSimpleString(ctx, "Query node");
+  RedisModule_ReplyWithSimpleString(ctx, n->queryNode);
+  len += 4;
+  if (n->term) {
+    RedisModule_ReplyWithSimpleString(ctx, "Term");
+    RedisModule_ReplyWithStringBuffer(ctx, n->term, strlen(n->term));
+    len += 2;
+  }
+  replyCounter(ctx, "Reads", n->numReads);
+  replyCounter(ctx, "Skip-tos", n->numSkipTos);
+  replyCounter(ctx, "Results", n->numResults);
+  replyTime(ctx, "Time", n->wallNS);
+  replyTime(ctx, "CPU time", n->cpuNS);
+  len += 10;
+
+  if (n->children) {
+    RedisModule_ReplyWithSimpleString(ctx, "Child iterators");
+    RedisModule_ReplyWithArray(ctx, array_len(n->children));
+    for (size_t i = 0; i < array_len(n->children); i++) {
+      replyIterator(ctx, n->children[i]);
+    }
+    len += 2;
+  }
+  RedisModule_ReplySetArrayLength(ctx, len);
+}
+
+void Profile_ReplyIterators(RedisModuleCtx *ctx, const ProfileNode *root) {
+  size_t n = root && root->children ? array_len(root->children) : 0;
+  RedisModule_ReplyWithArray(ctx, n);
+  for (size_t i = 0; i < n; i++) {
+    replyIterator(ctx, root->children[i]);
+  }
+}
+
+void Profile_ReplyPipeline(RedisModuleCtx *ctx, const QueryIterator *qiter) {
+  // The chain is linked from its end, collect the profiles to reply from its root
+  const ProfileNode **nodes = array_new(const ProfileNode *, 8);
+  for (const ResultProcessor *rp = qiter->endProc; rp; rp = rp->upstream) {
+    if (rp->Next == rpprofileNext) {
+      nodes = array_append(nodes, &((const RPProfile *)rp)->node);
+    }
+  }
+
+  RedisModule_ReplyWithArray(ctx, array_len(nodes));
+  for (size_t i = array_len(nodes); i > 0; i--) {
+    const ProfileNode *n = nodes[i - 1];
+    RedisModule_ReplyWithArray(ctx, 8);
+    RedisModule_ReplyWithSimpleString(ctx, "Type");
+    RedisModule_ReplyWithSimpleString(ctx, n->type ? n->type : "Unknown");
+    replyCounter(ctx, "Results", n->numResults);
+    replyTime(ctx, "Time", n->wallNS);
+    replyTime(ctx, "CPU time", n->cpuNS);
+  }
+  array_free(nodes);
+}
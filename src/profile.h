@@ -0,0 +1,87 @@
+#ifndef RS_PROFILE_H_
+#define RS_PROFILE_H_
+
+#include <stdint.h>
+#include <time.h>
+#include "redismodule.h"
+#include "index_iterator.h"
+#include "result_processor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Profiling of a single query, used by FT.PROFILE.
+ *
+ * When a query is profiled, every iterator returned by Query_EvalNode() is wrapped in a profile
+ * iterator, and every result processor of the pipeline in a profile processor. These count the
+ * calls going through them and the time spent under them, and forward everything else to what
+ * they wrap. Queries that are not profiled are built without them, and pay nothing. */
+
+typedef struct ProfileNode {
+  // The type of the profiled iterator or result processor
+  const char *type;
+  // The query node the iterator was built for, and its term if it has one
+  const char *queryNode;
+  char *term;
+
+  size_t numReads;
+  size_t numSkipTos;
+  size_t numResults;
+
+  // Time spent under the node, including the time of its children / upstream processors
+  uint64_t wallNS;
+  uint64_t cpuNS;
+
+  struct ProfileNode **children;
+} ProfileNode;
+
+/* Create a new profile node. The term is copied if given */
+ProfileNode *NewProfileNode(const char *queryNode, const char *term, size_t termLen);
+
+/* Add a child to a node. The parent owns its children */
+void ProfileNode_AddChild(ProfileNode *parent, ProfileNode *child);
+
+/* Free a node and all its children */
+void ProfileNode_Free(ProfileNode *n);
+
+/* Wrap an iterator in a profile iterator, recording its calls in node. The returned iterator owns
+ * the child, but not the node */
+IndexIterator *NewProfileIterator(IndexIterator *child, ProfileNode *node);
+
+/* Wrap every result processor in the chain of the query iterator with a profile processor */
+void Profile_WrapPipeline(QueryIterator *qiter);
+
+typedef struct {
+  struct timespec wall;
+  struct timespec cpu;
+} ProfileClock;
+
+static inline void ProfileClock_Start(ProfileClock *clk) {
+  clock_gettime(CLOCK_MONOTONIC, &clk->wall);
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &clk->cpu);
+}
+
+static inline uint64_t profileElapsedNS(const struct timespec *start, const struct timespec *end) {
+  return (end->tv_sec - start->tv_sec) * 1000000000ULL + end->tv_nsec - start->tv_nsec;
+}
+
+/* Add the time elapsed since the clock was started to the wall and cpu time of a node */
+static inline void ProfileClock_Stop(const ProfileClock *clk, ProfileNode *n) {
+  struct timespec wall, cpu;
+  clock_gettime(CLOCK_MONOTONIC, &wall);
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu);
+  n->wallNS += profileElapsedNS(&clk->wall, &wall);
+  n->cpuNS += profileElapsedNS(&clk->cpu, &cpu);
+}
+
+/* Reply with the iterator profiles under root, which is the node the query was evaluated in */
+void Profile_ReplyIterators(RedisModuleCtx *ctx, const ProfileNode *root);
+
+/* Reply with the profiles of the result processors, from the root of the pipeline to its end */
+void Profile_ReplyPipeline(RedisModuleCtx *ctx, const QueryIterator *qiter);
+
+#ifdef __cplusplus
+}
+#endif
+#endif  // RS_PROFILE_H_
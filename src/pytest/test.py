@@ -1034,6 +1034,40 @@ def testGeo(env):
             'heathrow', -0.44155, 51.45865, '5', 'km')
         env.assertListEqual(sorted(res), sorted(res2))
 
+def testGeoNearest(env):
+    env.assertOk(env.execute_command('ft.create', 'idx', 'ON', 'HASH',
+                                     'schema', 'name', 'text', 'location', 'geo'))
+    for i, hotel in enumerate(hotels):
+        env.assertOk(env.execute_command('ft.add', 'idx', 'hotel{}'.format(i), 1.0, 'fields', 'name',
+                                         hotel[0], 'location', '{},{}'.format(hotel[2], hotel[1])))
+    waitForIndex(env, 'idx')
+
+    # the 3 hotels within 1 km are the closest ones within 10 km
+    res = env.cmd('ft.search', 'idx', 'hilton', 'NOCONTENT',
+                  'geofilter', 'location', -0.1757, 51.5156, 10, 'km', 'NEAREST', 3)
+    env.assertEqual(3, res[0])
+    env.assertEqual(sorted(['hotel2', 'hotel21', 'hotel79']), sorted(res[1:]))
+
+    # asking for more than there are within the radius returns what there is
+    res = env.cmd('ft.search', 'idx', 'hilton', 'NOCONTENT',
+                  'geofilter', 'location', -0.1757, 51.5156, 1, 'km', 'NEAREST', 10)
+    env.assertEqual(3, res[0])
+
+    res = env.cmd('ft.search', 'idx', 'hilton', 'NOCONTENT',
+                  'geofilter', 'location', -0.44155, 51.45865, 10, 'km', 'NEAREST', 1)
+    env.assertEqual([1L, 'hotel94'], res)
+
+    # the limit applies to the documents matching the whole query, which are sorted by distance
+    res = env.cmd('ft.search', 'idx', 'hilton', 'RETURN', 1, '__geo_distance',
+                  'geofilter', 'location', -0.1757, 51.5156, 10, 'km', 'NEAREST', 5)
+    env.assertEqual(5, res[0])
+    dists = [float(fields[1]) for fields in res[2::2]]
+    env.assertEqual(sorted(dists), dists)
+    env.assertLessEqual(dists[-1], 10)
+
+    env.expect('ft.search', 'idx', 'hilton', 'geofilter', 'location', -0.1757, 51.5156, 10, 'km',
+               'NEAREST', 0).error()
+
 def testTagErrors(env):
     env.expect("ft.create", "test", 'ON', 'HASH',
                 "SCHEMA",  "tags", "TAG").equal('OK')
@@ -1332,6 +1366,25 @@ def testNumericRange(env):
             'ft.search', 'idx', 'hello kitty @score:[-inf +inf]', "nocontent")
         env.assertEqual(100, res[0])
 
+def testInt64NumericRange(env):
+    r = env
+    env.assertOk(r.execute_command(
+        'ft.create', 'idx', 'ON', 'HASH', 'schema', 'title', 'text', 'ts', 'numeric', 'int64', 'sortable'))
+
+    for i in xrange(100):
+        r.execute_command('hset', 'doc%d' % i, 'title', 'hello kitty', 'ts', 1600000000000 + i - 50)
+    r.execute_command('hset', 'docbad', 'title', 'hello kitty', 'ts', '1.5')
+
+    for _ in r.retry_with_rdb_reload():
+        waitForIndex(env, 'idx')
+        env.assertEqual(100, r.execute_command('ft.search', 'idx', '@ts:[-inf +inf]', 'nocontent')[0])
+        env.assertEqual(51, r.execute_command('ft.search', 'idx', '@ts:[1600000000000 +inf]', 'nocontent')[0])
+        env.assertEqual(49, r.execute_command('ft.search', 'idx', '@ts:[(1599999999950 (1599999999999.5]', 'nocontent')[0])
+        env.assertEqual([1, 'doc50'], r.execute_command('ft.search', 'idx', '@ts:[1600000000000 1600000000000]', 'nocontent'))
+        env.assertEqual(50, r.execute_command('ft.search', 'idx', 'hello -@ts:[1600000000000 +inf]', 'nocontent')[0])
+        res = r.execute_command('ft.search', 'idx', 'hello', 'nocontent', 'sortby', 'ts', 'desc', 'limit', 0, 2)
+        env.assertEqual([100, 'doc99', 'doc98'], res)
+
 def testSuggestions(env):
     r = env
     r.expect('ft.SUGADD', 'ac', 'hello world', 1).equal(1)
@@ -121,6 +121,30 @@ def testTimeout(env):
         if not rv:
             break
     env.assertEqual(0, rv)
+
+def testPrefetch(env):
+    loadDocs(env)
+    q = ['FT.AGGREGATE', 'idx', '*', 'LOAD', 1, '@__key', 'SORTBY', 2, '@__key', 'ASC', 'WITHCURSOR', 'COUNT', 7]
+
+    def rows(resp):
+        return [r for chunk in resp for r in chunk[0][1:]]
+
+    expected = rows(exhaustCursor(env, 'idx', env.cmd(*q)))
+    env.assertEqual(100, len(expected))
+
+    # the rows computed ahead of a read are the same ones, in the same order
+    env.assertEqual(expected, rows(exhaustCursor(env, 'idx', env.cmd(*(q + ['PREFETCH'])))))
+    # a read of another count takes the prefetched rows first
+    env.assertEqual(expected, rows(exhaustCursor(env, 'idx', env.cmd(*(q + ['PREFETCH'])), 'COUNT', 3)))
+
+    # a cursor deleted before its prefetch is read
+    resp = env.cmd(*(q + ['PREFETCH']))
+    env.expect('FT.CURSOR', 'DEL', 'idx', resp[1]).ok()
+    env.assertEqual(0, getCursorStats(env)['index_total'])
+
+    env.expect('FT.CONFIG', 'SET', 'CURSOR_PREFETCH_MAX_MEMORY', 1).ok()
+    env.assertEqual(expected, rows(exhaustCursor(env, 'idx', env.cmd(*(q + ['PREFETCH'])))))
+
 '''
 def testErrors(env):
     env.expect('ft.create idx schema name text').equal('OK')
@@ -280,3 +280,27 @@ def testMultiFilters2(env):
                 'student:yes1', ['first', 'yes1', 'last', 'yes1', 'age', '17']]
     res = env.cmd('ft.search test *')
     env.assertEqual(sortedResults(res), sortedResults(res1))
+
+def testUpdateUnindexedFields(env):
+    env.skipOnCluster()
+    conn = getConnectionByEnv(env)
+    env.expect('FT.CREATE', 'idx', 'ON', 'HASH',
+               'SCHEMA', 't', 'TEXT', 'views', 'NUMERIC', 'SORTABLE', 'NOINDEX').ok()
+    conn.execute_command('HSET', 'doc1', 't', 'hello world', 'views', '1')
+    docId = env.cmd('FT.DEBUG', 'DOCIDTOID', 'idx', 'doc1')
+
+    # fields out of the schema and sortable-only fields are updated without re-indexing
+    conn.execute_command('HSET', 'doc1', 'other', 'foo')
+    conn.execute_command('HSET', 'doc1', 'views', '1001')
+    env.assertEqual(env.cmd('FT.DEBUG', 'DOCIDTOID', 'idx', 'doc1'), docId)
+    env.expect('FT.SEARCH', 'idx', 'hello', 'SORTBY', 'views', 'RETURN', 1, 'views') \
+       .equal([1L, 'doc1', ['views', '1001']])
+
+    # the document is indexed again when an indexed field changes, or is removed
+    conn.execute_command('HSET', 'doc1', 't', 'hello there')
+    newId = env.cmd('FT.DEBUG', 'DOCIDTOID', 'idx', 'doc1')
+    env.assertGreater(newId, docId)
+    env.expect('FT.SEARCH', 'idx', 'there', 'NOCONTENT').equal([1L, 'doc1'])
+    env.expect('FT.SEARCH', 'idx', 'world', 'NOCONTENT').equal([0L])
+    conn.execute_command('HDEL', 'doc1', 'views')
+    env.assertGreater(env.cmd('FT.DEBUG', 'DOCIDTOID', 'idx', 'doc1'), newId)
@@ -0,0 +1,41 @@
+from RLTest import Env
+from includes import *
+from common import waitForIndex
+
+
+def to_dict(res):
+    return {res[i]: res[i + 1] for i in range(0, len(res), 2)}
+
+
+def testSharedIndexerPool():
+    env = Env(moduleArgs='CONCURRENT_WRITE_MODE INDEX_THREADS 2')
+    env.skipOnCluster()
+    if env.env == 'existing-env':
+        env.skip()
+    conn = env.getConnection()
+
+    # many indexes share the threads of the pool
+    for i in range(20):
+        env.expect('FT.CREATE', 'idx%d' % i, 'ON', 'HASH', 'PREFIX', 1, 'doc%d:' % i,
+                   'SCHEMA', 't', 'TEXT', 'n', 'NUMERIC').ok()
+    for i in range(20):
+        for j in range(50):
+            env.expect('FT.ADD', 'idx%d' % i, 'doc%d:%d' % (i, j), 1.0, 'FIELDS',
+                       't', 'hello world %d' % j, 'n', j).ok()
+
+    for i in range(20):
+        idx = 'idx%d' % i
+        waitForIndex(env, idx)
+        env.assertEqual(env.cmd('FT.SEARCH', idx, 'hello', 'NOCONTENT', 'LIMIT', 0, 0)[0], 50)
+        # the documents of an index get their IDs in the order they were added
+        ids = [env.cmd('FT.DEBUG', 'DOCIDTOID', idx, 'doc%d:%d' % (i, j)) for j in range(50)]
+        env.assertEqual(ids, sorted(ids))
+
+        stats = to_dict(to_dict(env.cmd('FT.INFO', idx))['indexer_stats'])
+        env.assertEqual(stats['queue_size'], 0)
+        env.assertGreaterEqual(stats['docs_indexed'], 50)
+
+    # module fields are prefixed with the name of the module
+    info = conn.execute_command('INFO', 'MODULES')
+    env.assertEqual(info['ft_threads'], 2)
+    env.assertGreater(info['ft_runs'], 0)
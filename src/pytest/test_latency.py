@@ -0,0 +1,31 @@
+from RLTest import Env
+from includes import *
+from common import waitForIndex
+
+
+def to_dict(res):
+    return {res[i]: res[i + 1] for i in range(0, len(res), 2)}
+
+
+def testLatencyStats(env):
+    env.skipOnCluster()
+    conn = env.getConnection()
+    env.expect('FT.CREATE', 'idx', 'ON', 'HASH', 'SCHEMA', 't', 'TEXT').ok()
+    waitForIndex(env, 'idx')
+    for i in range(10):
+        conn.execute_command('HSET', 'doc%d' % i, 't', 'hello world')
+
+    for _ in range(3):
+        env.cmd('FT.SEARCH', 'idx', 'hello')
+    env.cmd('FT.AGGREGATE', 'idx', 'hello', 'LOAD', '1', '@t')
+
+    info = to_dict(env.cmd('FT.INFO', 'idx'))
+    latency = to_dict(info['latency_stats'])
+    env.assertEqual(to_dict(latency['search'])['calls'], 3)
+    env.assertEqual(to_dict(latency['aggregate'])['calls'], 1)
+    env.assertEqual(to_dict(latency['hash_indexing'])['calls'], 10)
+    env.assertFalse('cursor_read' in latency)
+
+    search = to_dict(latency['search'])
+    env.assertLessEqual(search['p50'], search['max'])
+    env.assertLessEqual(search['p99'], search['max'])
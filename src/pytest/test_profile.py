@@ -0,0 +1,63 @@
+from RLTest import Env
+from includes import *
+from common import waitForIndex
+
+
+def to_dict(res):
+    return {res[i]: res[i + 1] for i in range(0, len(res), 2)}
+
+
+def testProfileSearch(env):
+    env.skipOnCluster()
+    conn = env.getConnection()
+    env.expect('FT.CREATE', 'idx', 'ON', 'HASH', 'SCHEMA', 't', 'TEXT', 'n', 'NUMERIC').ok()
+    waitForIndex(env, 'idx')
+    for i in range(100):
+        conn.execute_command('HSET', 'doc%d' % i, 't', 'hello world' if i % 2 else 'hello', 'n', i)
+
+    res = env.cmd('FT.PROFILE', 'idx', 'SEARCH', 'hello world', 'VERBATIM', 'NOCONTENT', 'LIMIT', '0', '3')
+    env.assertEqual(res[0], env.cmd('FT.SEARCH', 'idx', 'hello world', 'VERBATIM', 'NOCONTENT', 'LIMIT', '0', '3'))
+
+    profile = to_dict(res[1])
+    env.assertGreater(float(profile['Total time']), 0)
+    iterators = profile['Iterators profile']
+    env.assertEqual(len(iterators), 1)
+    root = to_dict(iterators[0])
+    env.assertEqual(root['Type'], 'INTERSECTION')
+    env.assertEqual(root['Query node'], 'INTERSECT')
+    env.assertEqual(root['Results'], 50)
+    children = [to_dict(c) for c in root['Child iterators']]
+    env.assertEqual(sorted(c['Term'] for c in children), ['hello', 'world'])
+
+    processors = [to_dict(p) for p in profile['Result processors profile']]
+    env.assertEqual(processors[0]['Type'], 'Index')
+    env.assertEqual(processors[0]['Results'], 50)
+    env.assertEqual(processors[-1]['Results'], 3)
+
+
+def testProfileAggregate(env):
+    env.skipOnCluster()
+    conn = env.getConnection()
+    env.expect('FT.CREATE', 'idx', 'ON', 'HASH', 'SCHEMA', 't', 'TEXT', 'n', 'NUMERIC').ok()
+    waitForIndex(env, 'idx')
+    for i in range(10):
+        conn.execute_command('HSET', 'doc%d' % i, 't', 'hello', 'n', i % 3)
+
+    res = env.cmd('FT.PROFILE', 'idx', 'AGGREGATE', '@n:[0 1]', 'GROUPBY', '1', '@n')
+    env.assertEqual(len(res[0]) - 1, 2)
+    profile = to_dict(res[1])
+    root = to_dict(profile['Iterators profile'][0])
+    env.assertEqual(root['Query node'], 'NUMERIC')
+    env.assertEqual(root['Term'], 'n')
+    processors = [to_dict(p)['Type'] for p in profile['Result processors profile']]
+    env.assertContains('Grouper', processors)
+
+
+def testProfileErrors(env):
+    env.skipOnCluster()
+    env.expect('FT.CREATE', 'idx', 'ON', 'HASH', 'SCHEMA', 't', 'TEXT').ok()
+    env.expect('FT.PROFILE', 'idx', 'SEARCH').raiseError()
+    env.expect('FT.PROFILE', 'idx', 'EXPLAIN', 'hello').raiseError()
+    env.expect('FT.PROFILE', 'idx', 'AGGREGATE', 'hello', 'WITHCURSOR').raiseError() \
+       .contains('Cursors cannot be profiled')
+    env.expect('FT.PROFILE', 'nosuchidx', 'SEARCH', 'hello').raiseError()
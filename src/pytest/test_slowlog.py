@@ -0,0 +1,71 @@
+from RLTest import Env
+from includes import *
+from common import waitForIndex
+
+
+def to_dict(res):
+    return {res[i]: res[i + 1] for i in range(0, len(res), 2)}
+
+
+def testSlowlog(env):
+    env.skipOnCluster()
+    conn = env.getConnection()
+    env.expect('FT.CONFIG', 'SET', 'SLOWLOG_LOG_SLOWER_THAN', '0').ok()
+    env.expect('FT.SLOWLOG', 'RESET').ok()
+    env.expect('FT.CREATE', 'idx', 'ON', 'HASH', 'SCHEMA', 't', 'TEXT', 'n', 'NUMERIC', 'SORTABLE').ok()
+    waitForIndex(env, 'idx')
+    for i in range(100):
+        conn.execute_command('HSET', 'doc%d' % i, 't', 'hello world', 'n', i)
+
+    env.cmd('FT.SEARCH', 'idx', 'hello', 'SORTBY', 'n', 'LIMIT', '0', '5')
+    env.cmd('FT.AGGREGATE', 'idx', 'hello', 'LOAD', '1', '@t')
+    env.expect('FT.SLOWLOG', 'LEN').equal(2)
+
+    entries = env.cmd('FT.SLOWLOG', 'GET')
+    env.assertEqual(len(entries), 2)
+    agg, search = entries
+    env.assertEqual(agg[0], search[0] + 1)
+    env.assertEqual(search[3], 'FT.SEARCH')
+    env.assertEqual(search[4], 'idx')
+    env.assertEqual(search[5], ['hello', 'SORTBY', 'n', 'LIMIT', '0', '5'])
+    env.assertEqual(search[6], 100)
+    stages = to_dict(search[7])
+    env.assertEqual(sorted(stages.keys()),
+                    sorted(['parse', 'expand', 'build_iterators', 'iterate', 'sort', 'load', 'reply']))
+    env.assertLessEqual(sum(stages.values()), search[2] + len(stages))
+    env.assertEqual(agg[3], 'FT.AGGREGATE')
+
+    env.assertEqual(len(env.cmd('FT.SLOWLOG', 'GET', '1')), 1)
+    env.expect('FT.SLOWLOG', 'RESET').ok()
+    env.expect('FT.SLOWLOG', 'LEN').equal(0)
+
+
+def testSlowlogCursor(env):
+    env.skipOnCluster()
+    conn = env.getConnection()
+    env.expect('FT.CONFIG', 'SET', 'SLOWLOG_LOG_SLOWER_THAN', '0').ok()
+    env.expect('FT.SLOWLOG', 'RESET').ok()
+    env.expect('FT.CREATE', 'idx', 'ON', 'HASH', 'SCHEMA', 't', 'TEXT').ok()
+    waitForIndex(env, 'idx')
+    for i in range(10):
+        conn.execute_command('HSET', 'doc%d' % i, 't', 'hello')
+
+    res, cid = env.cmd('FT.AGGREGATE', 'idx', 'hello', 'WITHCURSOR', 'COUNT', '5')
+    env.cmd('FT.CURSOR', 'READ', 'idx', cid)
+    entries = env.cmd('FT.SLOWLOG', 'GET')
+    env.assertEqual([e[3] for e in entries], ['FT.CURSOR', 'FT.AGGREGATE'])
+    env.assertEqual(to_dict(entries[0][7])['parse'], 0)
+
+
+def testSlowlogThreshold(env):
+    env.skipOnCluster()
+    env.expect('FT.CREATE', 'idx', 'ON', 'HASH', 'SCHEMA', 't', 'TEXT').ok()
+    env.expect('FT.CONFIG', 'SET', 'SLOWLOG_LOG_SLOWER_THAN', '-1').ok()
+    env.expect('FT.SLOWLOG', 'RESET').ok()
+    env.cmd('FT.SEARCH', 'idx', 'hello')
+    env.expect('FT.SLOWLOG', 'LEN').equal(0)
+
+    env.expect('FT.CONFIG', 'SET', 'SLOWLOG_LOG_SLOWER_THAN', '100000000').ok()
+    env.cmd('FT.SEARCH', 'idx', 'hello')
+    env.expect('FT.SLOWLOG', 'LEN').equal(0)
+    env.expect('FT.SLOWLOG', 'FOO').error().contains('Unknown subcommand')
@@ -3,6 +3,10 @@ from includes import *
 from common import waitForIndex
 
 
+def to_dict(res):
+    return {res[i]: res[i + 1] for i in range(0, len(res), 2)}
+
+
 def testDictAdd():
     env = Env()
     env.expect('ft.dictadd', 'dict', 'term1', 'term2', 'term3').equal(3)
@@ -202,3 +206,31 @@ def testSpellCheckIssue437():
                'Tooni toque kerfuffle', 'TERMS',
                'EXCLUDE', 'slang', 'TERMS',
                'INCLUDE', 'slang').equal([['TERM', 'tooni', [['0', 'toonie']]]])
+
+def testSpellCheckIndex():
+    env = Env(moduleArgs='SPELLCHECK_INDEX_DISTANCE 2')
+    env.expect('ft.config', 'get', 'SPELLCHECK_INDEX_DISTANCE').equal([['SPELLCHECK_INDEX_DISTANCE', '2']])
+    env.expect('ft.config', 'set', 'SPELLCHECK_INDEX_DISTANCE', '4').error()
+    env.cmd('ft.dictadd', 'dict', 'name3')
+    env.cmd('ft.create', 'idx', 'ON', 'HASH', 'SCHEMA', 'name', 'TEXT', 'body', 'TEXT')
+    waitForIndex(env, 'idx')
+    env.cmd('ft.add', 'idx', 'doc1', 1.0, 'FIELDS', 'name', 'name1', 'body', 'body1')
+    env.cmd('ft.add', 'idx', 'doc2', 1.0, 'FIELDS', 'name', 'name2', 'body', 'body2')
+    res = env.cmd('ft.spellcheck', 'idx', 'name', 'TERMS', 'INCLUDE', 'dict')
+    env.assertEqual(sorted([['0.5', 'name1'], ['0.5', 'name2']]), sorted(res[0][2][:2]))
+    env.assertEqual(['0', 'name3'], res[0][2][2])
+    # the index and the cached frequencies follow new documents
+    env.cmd('ft.add', 'idx', 'doc3', 1.0, 'FIELDS', 'name', 'name2', 'body', 'nane')
+    res = env.cmd('ft.spellcheck', 'idx', 'name')
+    env.assertEqual(['0.66666666666666663', 'name2'], res[0][2][0])
+    env.assertEqual(sorted([['0.33333333333333331', 'name1'], ['0.33333333333333331', 'nane']]),
+                    sorted(res[0][2][1:]))
+    # larger distances are served by the trie
+    env.expect('ft.spellcheck', 'idx', 'nxxx', 'DISTANCE', 3).equal([['TERM', 'nxxx', [['0.33333333333333331', 'nane']]]])
+    env.assertGreater(float(to_dict(env.cmd('ft.info', 'idx'))['spell_index_sz_mb']), 0)
+    # an index outgrowing its memory limit is dropped, and the trie serves its queries again
+    env.expect('ft.config', 'get', 'SPELLCHECK_INDEX_MAX_MEMORY').equal([['SPELLCHECK_INDEX_MAX_MEMORY', '268435456']])
+    env.expect('ft.config', 'set', 'SPELLCHECK_INDEX_MAX_MEMORY', '1').ok()
+    res = env.cmd('ft.spellcheck', 'idx', 'name')
+    env.assertEqual(['0.66666666666666663', 'name2'], res[0][2][0])
+    env.assertEqual(0, float(to_dict(env.cmd('ft.info', 'idx'))['spell_index_sz_mb']))
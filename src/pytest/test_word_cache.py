@@ -0,0 +1,49 @@
+from RLTest import Env
+from includes import *
+from common import waitForIndex
+
+
+def to_dict(res):
+    return {res[i]: res[i + 1] for i in range(0, len(res), 2)}
+
+
+def word_cache_stats(env):
+    info = to_dict(env.cmd('FT.INFO', 'idx'))
+    stats = to_dict(info['word_cache_stats'])
+    return to_dict(stats['stems']), to_dict(stats['phonetics'])
+
+
+def testWordCacheStats(env):
+    env.skipOnCluster()
+    conn = env.getConnection()
+    env.expect('FT.CREATE', 'idx', 'ON', 'HASH', 'SCHEMA', 't', 'TEXT', 'PHONETIC', 'dm:en').ok()
+    waitForIndex(env, 'idx')
+
+    stems, phonetics = word_cache_stats(env)
+    before_hits = stems['hits']
+
+    # the same words over and over, stemmed and encoded once each
+    for i in range(20):
+        conn.execute_command('HSET', 'doc%d' % i, 't', 'running dogs jumping')
+    stems, phonetics = word_cache_stats(env)
+    env.assertGreater(stems['hits'], before_hits)
+    env.assertGreater(phonetics['hits'], 0)
+    env.assertLessEqual(stems['entries'], stems['capacity'])
+
+    # queries stem with the same caches, and get the same results
+    env.assertEqual(env.cmd('FT.SEARCH', 'idx', 'run', 'NOCONTENT')[0], 20)
+    env.assertEqual(env.cmd('FT.SEARCH', 'idx', 'running', 'NOCONTENT')[0], 20)
+
+
+def testWordCacheDisabled():
+    env = Env(moduleArgs='WORD_CACHE_SIZE 0')
+    env.skipOnCluster()
+    conn = env.getConnection()
+    env.expect('FT.CREATE', 'idx', 'ON', 'HASH', 'SCHEMA', 't', 'TEXT').ok()
+    waitForIndex(env, 'idx')
+    for i in range(5):
+        conn.execute_command('HSET', 'doc%d' % i, 't', 'running dogs')
+    env.assertEqual(env.cmd('FT.SEARCH', 'idx', 'run', 'NOCONTENT')[0], 5)
+    stems, phonetics = word_cache_stats(env)
+    env.assertEqual(stems['capacity'], 0)
+    env.assertEqual(stems['hits'], 0)
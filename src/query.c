@@ -19,11 +19,13 @@
 #include "err.h"
 #include "concurrent_ctx.h"
 #include "numeric_index.h"
+#include "int_index.h"
 #include "numeric_filter.h"
 #include "util/strconv.h"
 #include "util/arr.h"
 #include "rmutil/rm_assert.h"
 #include "module.h"
+#include "profile.h"
 
 #define EFFECTIVE_FIELDMASK(q_, qn_) ((qn_)->opts.fieldMask & (q)->opts->fieldmask)
 
@@ -416,8 +418,8 @@ static IndexIterator *Query_EvalLexRangeNode(QueryEvalCtx *q, QueryNode *lx) {
     end = strToFoldedRunes(lx->lxrng.end, &nend);
   }
 
-  TrieNode_IterateRange(t->root, begin, begin ? nbegin : -1, lx->lxrng.includeBegin, end,
-                        end ? nend : -1, lx->lxrng.includeEnd, rangeIterCb, &ctx);
+  Trie_IterateRange(t, begin, begin ? nbegin : -1, lx->lxrng.includeBegin, end, end ? nend : -1,
+                    lx->lxrng.includeEnd, rangeIterCb, &ctx);
   rm_free(begin);
   rm_free(end);
   if (!ctx.its || ctx.nits == 0) {
@@ -488,7 +490,7 @@ static IndexIterator *Query_EvalWildcardNode(QueryEvalCtx *q, QueryNode *qn) {
     return NULL;
   }
 
-  return NewWildcardIterator(q->docTable->maxDocId);
+  return NewWildcardIterator(q->docTable->maxDocId, &q->docTable->live);
 }
 
 static IndexIterator *Query_EvalNotNode(QueryEvalCtx *q, QueryNode *qn) {
@@ -498,7 +500,7 @@ static IndexIterator *Query_EvalNotNode(QueryEvalCtx *q, QueryNode *qn) {
   QueryNotNode *node = &qn->inverted;
 
   return NewNotIterator(QueryNode_NumChildren(qn) ? Query_EvalNode(q, qn->children[0]) : NULL,
-                        q->docTable->maxDocId, qn->opts.weight);
+                        q->docTable->maxDocId, &q->docTable->live, qn->opts.weight);
 }
 
 static IndexIterator *Query_EvalOptionalNode(QueryEvalCtx *q, QueryNode *qn) {
@@ -518,6 +520,9 @@ static IndexIterator *Query_EvalNumericNode(QueryEvalCtx *q, QueryNumericNode *n
     return NULL;
   }
 
+  if (FieldSpec_IsInt64(fs)) {
+    return NewIntFilterIterator(q->sctx, node->nf);
+  }
   return NewNumericFilterIterator(q->sctx, node->nf, q->conc, INDEXFLD_T_NUMERIC);
 }
 
@@ -757,7 +762,7 @@ done:
   return ret;
 }
 
-IndexIterator *Query_EvalNode(QueryEvalCtx *q, QueryNode *n) {
+static IndexIterator *evalNode(QueryEvalCtx *q, QueryNode *n) {
   switch (n->type) {
     case QN_TOKEN:
       return Query_EvalTokenNode(q, n);
@@ -792,6 +797,55 @@ IndexIterator *Query_EvalNode(QueryEvalCtx *q, QueryNode *n) {
   return NULL;
 }
 
+static ProfileNode *newNodeProfile(const QueryNode *n) {
+  switch (n->type) {
+    case QN_PHRASE:
+      return NewProfileNode(n->pn.exact ? "EXACT" : "INTERSECT", NULL, 0);
+    case QN_UNION:
+      return NewProfileNode("UNION", NULL, 0);
+    case QN_TOKEN:
+      return NewProfileNode("TOKEN", n->tn.str, n->tn.len);
+    case QN_NUMERIC:
+      return NewProfileNode("NUMERIC", n->nn.nf->fieldName, strlen(n->nn.nf->fieldName));
+    case QN_NOT:
+      return NewProfileNode("NOT", NULL, 0);
+    case QN_OPTIONAL:
+      return NewProfileNode("OPTIONAL", NULL, 0);
+    case QN_GEO:
+      return NewProfileNode("GEO", n->gn.gf->property, strlen(n->gn.gf->property));
+    case QN_PREFX:
+      return NewProfileNode("PREFIX", n->pfx.str, n->pfx.len);
+    case QN_IDS:
+      return NewProfileNode("IDS", NULL, 0);
+    case QN_WILDCARD:
+      return NewProfileNode("WILDCARD", NULL, 0);
+    case QN_TAG:
+      return NewProfileNode("TAG", n->tag.fieldName, n->tag.len);
+    case QN_FUZZY:
+      return NewProfileNode("FUZZY", n->fz.tok.str, n->fz.tok.len);
+    case QN_LEXRANGE:
+      return NewProfileNode("LEXRANGE", NULL, 0);
+    case QN_NULL:
+      break;
+  }
+  return NewProfileNode("NULL", NULL, 0);
+}
+
+IndexIterator *Query_EvalNode(QueryEvalCtx *q, QueryNode *n) {
+  if (!q->profile) {
+    return evalNode(q, n);
+  }
+
+  // The nodes evaluated for the children of this node add their profiles under its own
+  ProfileNode *parent = q->profile;
+  ProfileNode *pn = newNodeProfile(n);
+  ProfileNode_AddChild(parent, pn);
+  q->profile = pn;
+  IndexIterator *it = evalNode(q, n);
+  q->profile = parent;
+  return it ? NewProfileIterator(it, pn) : NULL;
+}
+
 QueryNode *RSQuery_ParseRaw(QueryParseCtx *);
 
 int QAST_Parse(QueryAST *dst, const RedisSearchCtx *sctx, const RSSearchOptions *opts,
@@ -829,12 +883,19 @@ int QAST_Parse(QueryAST *dst, const RedisSearchCtx *sctx, const RSSearchOptions
 
 IndexIterator *QAST_Iterate(const QueryAST *qast, const RSSearchOptions *opts, RedisSearchCtx *sctx,
                             ConcurrentSearchCtx *conc) {
+  return QAST_IterateProfiled(qast, opts, sctx, conc, NULL);
+}
+
+IndexIterator *QAST_IterateProfiled(const QueryAST *qast, const RSSearchOptions *opts,
+                                    RedisSearchCtx *sctx, ConcurrentSearchCtx *conc,
+                                    ProfileNode *profile) {
   QueryEvalCtx qectx = {
       .conc = conc,
       .opts = opts,
       .numTokens = qast->numTokens,
       .docTable = &sctx->spec->docs,
       .sctx = sctx,
+      .profile = profile,
   };
   IndexIterator *root = Query_EvalNode(&qectx, qast->root);
   if (!root) {
@@ -86,6 +86,15 @@ void QAST_SetGlobalFilters(QueryAST *ast, const QAST_GlobalFilterOptions *option
 IndexIterator *QAST_Iterate(const QueryAST *ast, const RSSearchOptions *options,
                             RedisSearchCtx *sctx, ConcurrentSearchCtx *conc);
 
+struct ProfileNode;
+/**
+ * Like QAST_Iterate(), but wraps the iterator of every node in a profile iterator. The profiles
+ * of the nodes are added as children of `profile`
+ */
+IndexIterator *QAST_IterateProfiled(const QueryAST *ast, const RSSearchOptions *options,
+                                    RedisSearchCtx *sctx, ConcurrentSearchCtx *conc,
+                                    struct ProfileNode *profile);
+
 /**
  * Expand the query using a pre-registered expander. Query expansion possibly
  * modifies or adds additional search terms to the query.
@@ -37,6 +37,9 @@ typedef struct {
   size_t numTokens;
   uint32_t tokenId;
   DocTable *docTable;
+
+  // The profile of the node being evaluated, if the query is profiled
+  struct ProfileNode *profile;
 } QueryEvalCtx;
 
 struct QueryAST;
@@ -85,6 +85,9 @@ typedef struct RSDocumentMetadata_s {
   struct RSSortingVector *sortVector;
   /* Offsets of all terms in the document (in bytes). Used by highlighter */
   struct RSByteOffsets *byteOffsets;
+  /* A hash of the indexed contents of the document, used to tell if a new version of it has to be
+   * re-indexed. 0 if unknown */
+  uint64_t contentHash;
   DLLIST2_node llnode;
   uint32_t ref_count;
 } RSDocumentMetadata;
@@ -15,6 +15,8 @@
 #include "rwlock.h"
 #include "fork_gc.h"
 #include "module.h"
+#include "concurrent_ctx.h"
+#include <sys/param.h>
 
 int RediSearch_GetCApiVersion() {
   return REDISEARCH_CAPI_VERSION;
@@ -232,6 +234,186 @@ int RediSearch_IndexAddDocument(IndexSpec* sp, Document* d, int options, char**
   return err.hasErr ? REDISMODULE_ERR : REDISMODULE_OK;
 }
 
+// The number of documents collected by a bulk loader before they are indexed
+#define BULK_LOAD_BATCH INDEXER_MAX_BATCH
+
+// The number of documents each preprocessing job of a bulk loader handles
+#define BULK_LOAD_JOB_DOCS 32
+
+struct RSBulkLoader {
+  IndexSpec* sp;
+  RedisSearchCtx sctx;
+  RSAddDocumentCtx* batch[BULK_LOAD_BATCH];
+  size_t size;
+  // the preprocessing jobs of the current batch still running on the indexing pool
+  size_t pendingJobs;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  char* err;  // the first error of an indexed document
+  size_t numErrors;
+};
+
+typedef struct {
+  RSBulkLoader* bl;
+  RSAddDocumentCtx** ctxs;
+  size_t n;
+} bulkLoadJob;
+
+RSBulkLoader* RediSearch_BeginBulkLoad(IndexSpec* sp) {
+  RSBulkLoader* bl = rm_calloc(1, sizeof(*bl));
+  bl->sp = sp;
+  bl->sctx = (RedisSearchCtx){.redisCtx = NULL, .spec = sp};
+  pthread_mutex_init(&bl->lock, NULL);
+  pthread_cond_init(&bl->cond, NULL);
+  ConcurrentSearch_IndexPoolStart();
+  return bl;
+}
+
+static void bulkLoadDone(RSAddDocumentCtx* aCtx, RedisModuleCtx* ctx, void* privdata) {
+  RSBulkLoader* bl = privdata;
+  if (QueryError_HasError(&aCtx->status)) {
+    if (!bl->err) {
+      bl->err = rm_strdup(QueryError_GetError(&aCtx->status));
+    }
+    bl->numErrors++;
+  }
+}
+
+static void bulkLoadPreprocess(void* arg) {
+  bulkLoadJob* job = arg;
+  for (size_t ii = 0; ii < job->n; ++ii) {
+    RSAddDocumentCtx* aCtx = job->ctxs[ii];
+    if (Document_Preprocess(aCtx) != REDISMODULE_OK) {
+      QueryError_SetCode(&aCtx->status, QUERY_EGENERIC);
+      aCtx->stateFlags |= ACTX_F_ERRORED;
+    }
+  }
+}
+
+static void bulkLoadPreprocessThread(void* arg) {
+  bulkLoadPreprocess(arg);
+  RSBulkLoader* bl = ((bulkLoadJob*)arg)->bl;
+  pthread_mutex_lock(&bl->lock);
+  if (--bl->pendingJobs == 0) {
+    pthread_cond_signal(&bl->cond);
+  }
+  pthread_mutex_unlock(&bl->lock);
+}
+
+/* Index the pending documents of the loader. Called without the write lock, which is only taken
+ * to write the preprocessed documents to the index */
+static void bulkLoadFlush(RSBulkLoader* bl) {
+  if (!bl->size) {
+    return;
+  }
+
+  // tokenize the documents in parallel on the indexing pool, started with the loader. Nothing is
+  // written to the index at this stage
+  size_t numJobs = (bl->size + BULK_LOAD_JOB_DOCS - 1) / BULK_LOAD_JOB_DOCS;
+  bulkLoadJob jobs[numJobs];
+  int parallel = numJobs > 1;
+  bl->pendingJobs = parallel ? numJobs : 0;
+  for (size_t ii = 0; ii < numJobs; ++ii) {
+    size_t first = ii * BULK_LOAD_JOB_DOCS;
+    jobs[ii] = (bulkLoadJob){
+        .bl = bl, .ctxs = bl->batch + first, .n = MIN(BULK_LOAD_JOB_DOCS, bl->size - first)};
+    if (parallel) {
+      ConcurrentSearch_ThreadPoolRun(bulkLoadPreprocessThread, jobs + ii, CONCURRENT_POOL_INDEX);
+    } else {
+      bulkLoadPreprocess(jobs + ii);
+    }
+  }
+  pthread_mutex_lock(&bl->lock);
+  while (bl->pendingJobs) {
+    pthread_cond_wait(&bl->cond, &bl->lock);
+  }
+  pthread_mutex_unlock(&bl->lock);
+
+  RWLOCK_ACQUIRE_WRITE();
+  // chain the documents in the order they were added, which is also the order of their IDs
+  RSAddDocumentCtx *head = NULL, *tail = NULL;
+  for (size_t ii = 0; ii < bl->size; ++ii) {
+    RSAddDocumentCtx* aCtx = bl->batch[ii];
+    if (aCtx->stateFlags & ACTX_F_ERRORED) {
+      AddDocumentCtx_Finish(aCtx);
+      continue;
+    }
+    aCtx->next = NULL;
+    if (tail) {
+      tail->next = aCtx;
+    } else {
+      head = aCtx;
+    }
+    tail = aCtx;
+  }
+  bl->size = 0;
+
+  if (head) {
+    Indexer_ProcessBatch(bl->sp->indexer, head);
+  }
+  RWLOCK_RELEASE();
+}
+
+int RediSearch_BulkAdd(RSBulkLoader* bl, Document* d, int options, char** errs) {
+  RWLOCK_ACQUIRE_WRITE();
+
+  QueryError status = {0};
+  RSAddDocumentCtx* aCtx = NewAddDocumentCtx(bl->sp, d, &status);
+  if (aCtx == NULL) {
+    if (status.detail) {
+      QueryError_ClearError(&status);
+    }
+    RWLOCK_RELEASE();
+    return REDISMODULE_ERR;
+  }
+
+  // documents added earlier in the same batch are replaced (or rejected) when IDs are assigned
+  if (DocTable_GetIdR(&bl->sp->docs, d->docKey)) {
+    if (!(options & REDISEARCH_ADD_REPLACE)) {
+      if (errs) {
+        *errs = rm_strdup("Document already exists");
+      }
+      AddDocumentCtx_Free(aCtx);
+      rm_free(d);
+      RWLOCK_RELEASE();
+      return REDISMODULE_ERR;
+    }
+  }
+  RWLOCK_RELEASE();
+  rm_free(d);
+
+  aCtx->options = DOCUMENT_ADD_NOSAVE;
+  if (options & REDISEARCH_ADD_REPLACE) {
+    aCtx->options |= DOCUMENT_ADD_REPLACE;
+  }
+  aCtx->stateFlags |= ACTX_F_NOBLOCK;
+  aCtx->client.sctx = &bl->sctx;
+  aCtx->donecb = bulkLoadDone;
+  aCtx->donecbData = bl;
+  Document_MakeStringsOwner(&aCtx->doc);
+
+  bl->batch[bl->size++] = aCtx;
+  if (bl->size == BULK_LOAD_BATCH) {
+    bulkLoadFlush(bl);
+  }
+  return REDISMODULE_OK;
+}
+
+int RediSearch_EndBulkLoad(RSBulkLoader* bl, char** errs) {
+  bulkLoadFlush(bl);
+
+  pthread_mutex_destroy(&bl->lock);
+  pthread_cond_destroy(&bl->cond);
+  int rc = bl->numErrors ? REDISMODULE_ERR : REDISMODULE_OK;
+  if (errs && bl->err) {
+    *errs = bl->err;
+  } else {
+    rm_free(bl->err);
+  }
+  rm_free(bl);
+  return rc;
+}
+
 QueryNode* RediSearch_CreateTokenNode(IndexSpec* sp, const char* fieldName, const char* token) {
   QueryNode* ret = NewQueryNode(QN_TOKEN);
 
@@ -426,6 +608,9 @@ int RediSearch_QueryNodeType(QueryNode* qn) {
 
 const void* RediSearch_ResultsIteratorNext(RS_ApiIter* iter, IndexSpec* sp, size_t* len) {
   while (iter->internal->Read(iter->internal->ctx, &iter->res) != INDEXREAD_EOF) {
+    if (!DocTable_IsLive(&sp->docs, iter->res->docId)) {
+      continue;
+    }
     const RSDocumentMetadata* md = DocTable_Get(&sp->docs, iter->res->docId);
     if (md == NULL || ((md)->flags & Document_Deleted)) {
       continue;
@@ -443,6 +628,114 @@ double RediSearch_ResultsIteratorGetScore(const RS_ApiIter* it) {
   return it->scorer(&it->scargs, it->res, it->lastmd, 0);
 }
 
+static void fillColumn(const RSSortingVector* sv, int idx, RSColumnValue* out) {
+  RSValue* v = (sv && idx >= 0) ? RSSortingVector_Get((RSSortingVector*)sv, idx) : NULL;
+  if (!v || RSValue_IsNull(v)) {
+    *out = (RSColumnValue){.type = RSVALTYPE_NOTFOUND};
+    return;
+  }
+  v = RSValue_Dereference(v);
+  if (v->t == RSValue_Number) {
+    *out = (RSColumnValue){.type = RSVALTYPE_DOUBLE, .num = v->numval};
+  } else if (RSValue_IsString(v)) {
+    *out = (RSColumnValue){.type = RSVALTYPE_STRING};
+    out->str = RSValue_StringPtrLen(v, &out->len);
+  } else {
+    *out = (RSColumnValue){.type = RSVALTYPE_NOTFOUND};
+  }
+}
+
+size_t RediSearch_ResultsIteratorNextBatch(RS_ApiIter* iter, IndexSpec* sp, RSResultsBatch* batch,
+                                           size_t n) {
+  // resolve the columns once per batch, rather than once per row
+  int* colIdx = NULL;
+  if (batch->values && batch->numColumns) {
+    colIdx = rm_malloc(batch->numColumns * sizeof(*colIdx));
+    for (size_t c = 0; c < batch->numColumns; c++) {
+      colIdx[c] = IndexSpec_GetFieldSortingIndex(sp, batch->columns[c], strlen(batch->columns[c]));
+    }
+  }
+
+  size_t nread = 0;
+  while (nread < n && iter->internal->Read(iter->internal->ctx, &iter->res) != INDEXREAD_EOF) {
+    t_docId docId = iter->res->docId;
+    if (!DocTable_IsLive(&sp->docs, docId)) {
+      continue;
+    }
+    const RSDocumentMetadata* md = DocTable_Get(&sp->docs, docId);
+    if (md == NULL || ((md)->flags & Document_Deleted)) {
+      continue;
+    }
+    iter->lastmd = md;
+    batch->ids[nread] = docId;
+    if (batch->scores) {
+      batch->scores[nread] = iter->scorer(&iter->scargs, iter->res, md, 0);
+    }
+    if (batch->keys) {
+      batch->keys[nread] = md->keyPtr;
+      if (batch->keyLens) {
+        batch->keyLens[nread] = sdslen(md->keyPtr);
+      }
+    }
+    for (size_t c = 0; colIdx && c < batch->numColumns; c++) {
+      fillColumn(md->sortVector, colIdx[c], batch->values + c * n + nread);
+    }
+    nread++;
+  }
+  rm_free(colIdx);
+  return nread;
+}
+
+Bitmap* RediSearch_ResultsIteratorGetBitmap(RS_ApiIter* iter, IndexSpec* sp) {
+  Bitmap* bm = rm_malloc(sizeof(*bm));
+  Bitmap_Init(bm);
+  while (iter->internal->Read(iter->internal->ctx, &iter->res) != INDEXREAD_EOF) {
+    if (DocTable_IsLive(&sp->docs, iter->res->docId)) {
+      Bitmap_Set(bm, iter->res->docId);
+    }
+  }
+  return bm;
+}
+
+void RediSearch_BitmapFree(Bitmap* bm) {
+  Bitmap_Cleanup(bm);
+  rm_free(bm);
+}
+
+size_t RediSearch_BitmapCardinality(const Bitmap* bm) {
+  return Bitmap_Card(bm);
+}
+
+RSDocId RediSearch_BitmapNext(const Bitmap* bm, RSDocId from) {
+  return Bitmap_Next(bm, from);
+}
+
+void RediSearch_BitmapAnd(Bitmap* bm, const Bitmap* other) {
+  Bitmap_And(bm, other);
+}
+
+void RediSearch_BitmapOr(Bitmap* bm, const Bitmap* other) {
+  Bitmap_Or(bm, other);
+}
+
+void RediSearch_BitmapAndNot(Bitmap* bm, const Bitmap* other) {
+  Bitmap_AndNot(bm, other);
+}
+
+const void* RediSearch_GetDocumentKey(IndexSpec* sp, RSDocId id, size_t* len) {
+  if (!DocTable_IsLive(&sp->docs, id)) {
+    return NULL;
+  }
+  const RSDocumentMetadata* md = DocTable_Get(&sp->docs, id);
+  if (!md) {
+    return NULL;
+  }
+  if (len) {
+    *len = sdslen(md->keyPtr);
+  }
+  return md->keyPtr;
+}
+
 void RediSearch_ResultsIteratorFree(RS_ApiIter* iter) {
   if (iter->internal) {
     iter->internal->Free(iter->internal);
@@ -156,6 +156,37 @@ MODULE_API_FUNC(int, RediSearch_IndexAddDocument)(RSIndex* sp, RSDoc* d, int fla
 #define RediSearch_SpecAddDocument(sp, d) \
   RediSearch_IndexAddDocument(sp, d, REDISEARCH_ADD_REPLACE, NULL)
 
+typedef struct RSBulkLoader RSBulkLoader;
+
+/**
+ * Start loading documents into the index in bulk. Documents added to the loader
+ * are collected into batches; the documents of a batch are tokenized in parallel
+ * on the indexing thread pool (started on demand), without holding the index
+ * lock. Their terms are then merged, so that each inverted index is written once
+ * per batch.
+ *
+ * Documents become searchable as their batch is indexed, and all of them are
+ * indexed once RediSearch_EndBulkLoad() returns.
+ */
+MODULE_API_FUNC(RSBulkLoader*, RediSearch_BeginBulkLoad)(RSIndex* sp);
+
+/**
+ * Add a document to the loader, which takes ownership of it. flags may be
+ * REDISEARCH_ADD_REPLACE; without it, a document already in the index is
+ * rejected (and freed). If the document's fields are invalid, the call fails and
+ * the document is left to the caller.
+ *
+ * Errors found when the document is indexed are only reported by
+ * RediSearch_EndBulkLoad().
+ */
+MODULE_API_FUNC(int, RediSearch_BulkAdd)(RSBulkLoader* bl, RSDoc* d, int flags, char** err);
+
+/**
+ * Index the remaining documents and free the loader. Returns REDISMODULE_ERR if
+ * any document failed to be indexed; err is then set to the first error.
+ */
+MODULE_API_FUNC(int, RediSearch_EndBulkLoad)(RSBulkLoader* bl, char** err);
+
 MODULE_API_FUNC(RSQNode*, RediSearch_CreateTokenNode)
 (RSIndex* sp, const char* fieldName, const char* token);
 
@@ -214,6 +245,76 @@ MODULE_API_FUNC(void, RediSearch_ResultsIteratorReset)(RSResultsIterator* iter);
 
 MODULE_API_FUNC(double, RediSearch_ResultsIteratorGetScore)(const RSResultsIterator* it);
 
+typedef uint64_t RSDocId;
+
+/**
+ * The value of a sortable field. type is RSVALTYPE_STRING (str and len are set),
+ * RSVALTYPE_DOUBLE (num is set), or RSVALTYPE_NOTFOUND if the document has no
+ * value for the field, or the field is not sortable.
+ */
+typedef struct {
+  int type;
+  double num;
+  const char* str;
+  size_t len;
+} RSColumnValue;
+
+/**
+ * Caller-provided arrays to read results into, in bulk. Every array must have
+ * room for the number of results requested. Only ids is required; the other
+ * arrays are filled if they are not NULL.
+ *
+ * values holds the sortable fields named in columns, column after column: when
+ * reading n results, the value of column c for result r is at values[c * n + r].
+ */
+typedef struct {
+  RSDocId* ids;
+  double* scores;
+  const char** keys;
+  size_t* keyLens;
+  const char** columns;
+  size_t numColumns;
+  RSColumnValue* values;
+} RSResultsBatch;
+
+/**
+ * Read up to n results into the batch arrays. Document keys and string values
+ * point into the index, and are valid until the iterator is freed. Returns the
+ * number of results read, 0 once the iterator is exhausted.
+ */
+MODULE_API_FUNC(size_t, RediSearch_ResultsIteratorNextBatch)
+(RSResultsIterator* iter, RSIndex* sp, RSResultsBatch* batch, size_t n);
+
+/**
+ * A set of document IDs, kept as a bitmap in which empty ranges of IDs take
+ * (almost) no space. IDs are only meaningful within their index, so set
+ * operations across indexes assume the documents were given the same IDs, e.g.
+ * by being loaded in the same order.
+ */
+typedef struct Bitmap RSResultsBitmap;
+
+/**
+ * Read all the remaining results of the iterator into a new bitmap of their
+ * document IDs, without looking up the documents themselves. Free it with
+ * RediSearch_BitmapFree().
+ */
+MODULE_API_FUNC(RSResultsBitmap*, RediSearch_ResultsIteratorGetBitmap)
+(RSResultsIterator* iter, RSIndex* sp);
+
+MODULE_API_FUNC(void, RediSearch_BitmapFree)(RSResultsBitmap* bm);
+MODULE_API_FUNC(size_t, RediSearch_BitmapCardinality)(const RSResultsBitmap* bm);
+
+/** Return the first ID in the bitmap not lower than from, or 0 if there is none */
+MODULE_API_FUNC(RSDocId, RediSearch_BitmapNext)(const RSResultsBitmap* bm, RSDocId from);
+
+/** Set operations, storing their result in the first bitmap */
+MODULE_API_FUNC(void, RediSearch_BitmapAnd)(RSResultsBitmap* bm, const RSResultsBitmap* other);
+MODULE_API_FUNC(void, RediSearch_BitmapOr)(RSResultsBitmap* bm, const RSResultsBitmap* other);
+MODULE_API_FUNC(void, RediSearch_BitmapAndNot)(RSResultsBitmap* bm, const RSResultsBitmap* other);
+
+/** Get the key of a document by its ID, or NULL if there is no such document */
+MODULE_API_FUNC(const void*, RediSearch_GetDocumentKey)(RSIndex* sp, RSDocId id, size_t* len);
+
 MODULE_API_FUNC(void, RediSearch_IndexOptionsSetGCPolicy)(RSIndexOptions* options, int policy);
 
 #define RS_XAPIFUNC(X)               \
@@ -233,6 +334,9 @@ MODULE_API_FUNC(void, RediSearch_IndexOptionsSetGCPolicy)(RSIndexOptions* option
   X(DocumentAddFieldNumber)          \
   X(DocumentAddFieldString)          \
   X(IndexAddDocument)                \
+  X(BeginBulkLoad)                   \
+  X(BulkAdd)                         \
+  X(EndBulkLoad)                     \
   X(CreateTokenNode)                 \
   X(CreateNumericNode)               \
   X(CreatePrefixNode)                \
@@ -254,6 +358,15 @@ MODULE_API_FUNC(void, RediSearch_IndexOptionsSetGCPolicy)(RSIndexOptions* option
   X(ResultsIteratorReset)            \
   X(IterateQuery)                    \
   X(ResultsIteratorGetScore)         \
+  X(ResultsIteratorNextBatch)        \
+  X(ResultsIteratorGetBitmap)        \
+  X(BitmapFree)                      \
+  X(BitmapCardinality)               \
+  X(BitmapNext)                      \
+  X(BitmapAnd)                       \
+  X(BitmapOr)                        \
+  X(BitmapAndNot)                    \
+  X(GetDocumentKey)                  \
   X(IndexOptionsSetGCPolicy)         \
   X(SetCriteriaTesterThreshold)
 
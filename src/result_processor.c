@@ -4,6 +4,8 @@
 #include <util/minmax_heap.h>
 #include "ext/default.h"
 #include "rmutil/rm_assert.h"
+#include "slowlog.h"
+#include "geo_index.h"
 
 /*******************************************************************************************************************
  *  General Result Processor Helper functions
@@ -85,7 +87,12 @@ static int rpidxNext(ResultProcessor *base, SearchResult *res) {
       continue;
     }
 
-    dmd = DocTable_Get(&RP_SPEC(base)->docs, r->docId);
+    // Deleted documents are rejected with a bit test, without looking them up in the doc table
+    const DocTable *docs = &RP_SPEC(base)->docs;
+    if (!DocTable_IsLive(docs, r->docId)) {
+      continue;
+    }
+    dmd = DocTable_Get(docs, r->docId);
     if (!dmd || (dmd->flags & Document_Deleted)) {
       continue;
     }
@@ -273,12 +280,17 @@ static int rpsortNext_Yield(ResultProcessor *rp, SearchResult *r) {
   RPSorter *self = (RPSorter *)rp;
   // make sure we don't overshoot the heap size, unless the heap size is dynamic
   if (self->pq->count > 0 && (!self->size || self->offset++ < self->size)) {
+    uint64_t *stageNS = rp->parent->stageNS;
+    uint64_t start = stageNS ? Slowlog_NowNS() : 0;
     SearchResult *sr = mmh_pop_max(self->pq);
     RLookupRow oldrow = r->rowdata;
     *r = *sr;
 
     rm_free(sr);
     RLookupRow_Cleanup(&oldrow);
+    if (stageNS) {
+      stageNS[SLOWLOG_STAGE_SORT] += Slowlog_NowNS() - start;
+    }
     return RS_RESULT_OK;
   }
   return RS_RESULT_EOF;
@@ -298,6 +310,8 @@ static void rpsortFree(ResultProcessor *rp) {
 
 #define RESULT_QUEUED RS_RESULT_MAX + 1
 
+static inline int cmpByScore(const void *e1, const void *e2, const void *udata);
+
 static int rpsortNext_innerLoop(ResultProcessor *rp, SearchResult *r) {
   RPSorter *self = (RPSorter *)rp;
 
@@ -320,6 +334,9 @@ static int rpsortNext_innerLoop(ResultProcessor *rp, SearchResult *r) {
     return rc;
   }
 
+  uint64_t *stageNS = rp->parent->stageNS;
+  uint64_t start = stageNS ? Slowlog_NowNS() : 0;
+
   // If the queue is not full - we just push the result into it
   // If the pool size is 0 we always do that, letting the heap grow dynamically
   if (!self->size || self->pq->count + 1 < self->pq->size) {
@@ -328,7 +345,7 @@ static int rpsortNext_innerLoop(ResultProcessor *rp, SearchResult *r) {
     h->indexResult = NULL;
     mmh_insert(self->pq, h);
     self->pooledResult = NULL;
-    if (h->score < rp->parent->minScore) {
+    if (self->cmp == cmpByScore && h->score < rp->parent->minScore) {
       rp->parent->minScore = h->score;
     }
 
@@ -336,8 +353,9 @@ static int rpsortNext_innerLoop(ResultProcessor *rp, SearchResult *r) {
     // find the min result
     SearchResult *minh = mmh_peek_min(self->pq);
 
-    // update the min score. Irrelevant to SORTBY mode but hardly costs anything...
-    if (minh->score > rp->parent->minScore) {
+    // update the min score. Only in score mode: the scorer may come before a sorter by fields,
+    // which does not keep the best scores
+    if (self->cmp == cmpByScore && minh->score > rp->parent->minScore) {
       rp->parent->minScore = minh->score;
     }
 
@@ -353,6 +371,9 @@ static int rpsortNext_innerLoop(ResultProcessor *rp, SearchResult *r) {
       SearchResult_Clear(self->pooledResult);
     }
   }
+  if (stageNS) {
+    stageNS[SLOWLOG_STAGE_SORT] += Slowlog_NowNS() - start;
+  }
   return RESULT_QUEUED;
 }
 
@@ -459,6 +480,57 @@ void SortAscMap_Dump(uint64_t tt, size_t n) {
   printf("\n");
 }
 
+/*******************************************************************************************************************
+ *  Geo Distance Processor
+ *
+ * Writes the distance of every result from the center of a NEAREST geo filter to the row, taking it
+ * from the result's hit of the filter. It runs after the whole query was matched, and is followed
+ * by a sorter which keeps the nearest results, so that the limit applies to the results of the
+ * query rather than to the documents of the filter alone.
+ *
+ * Once its upstream is done, it caps the total number of results to the number of nearest
+ * results requested.
+ *******************************************************************************************************************/
+
+typedef struct {
+  ResultProcessor base;
+  const GeoFilter *gf;
+  const RLookupKey *distanceKey;
+} RPGeoDistance;
+
+static int rpgeoDistanceNext(ResultProcessor *base, SearchResult *r) {
+  RPGeoDistance *self = (RPGeoDistance *)base;
+  int rc;
+  while ((rc = base->upstream->Next(base->upstream, r)) == RS_RESULT_OK) {
+    double distance;
+    if (r->indexResult && GeoFilter_ResultDistance(self->gf, r->indexResult, &distance)) {
+      RLookup_WriteOwnKey(self->distanceKey, &r->rowdata, RS_NumVal(distance));
+      return RS_RESULT_OK;
+    }
+    // not a hit of the filter, which can only happen if the query does not contain it
+    base->parent->totalResults--;
+    SearchResult_Clear(r);
+  }
+  if (rc == RS_RESULT_EOF && base->parent->totalResults > self->gf->nearest) {
+    base->parent->totalResults = self->gf->nearest;
+  }
+  return rc;
+}
+
+static void rpgeoDistanceFree(ResultProcessor *base) {
+  rm_free(base);
+}
+
+ResultProcessor *RPGeoDistance_New(const GeoFilter *gf, const RLookupKey *distanceKey) {
+  RPGeoDistance *ret = rm_calloc(1, sizeof(*ret));
+  ret->gf = gf;
+  ret->distanceKey = distanceKey;
+  ret->base.name = "GeoDistance";
+  ret->base.Next = rpgeoDistanceNext;
+  ret->base.Free = rpgeoDistanceFree;
+  return &ret->base;
+}
+
 /*******************************************************************************************************************
  *  Paging Processor
  *
@@ -560,7 +632,12 @@ static int rploaderNext(ResultProcessor *base, SearchResult *r) {
   } else {
     loadopts.mode |= RLOOKUP_LOAD_ALLKEYS;
   }
+  uint64_t *stageNS = base->parent->stageNS;
+  uint64_t start = stageNS ? Slowlog_NowNS() : 0;
   RLookup_LoadDocument(lc->lk, &r->rowdata, &loadopts);
+  if (stageNS) {
+    stageNS[SLOWLOG_STAGE_LOAD] += Slowlog_NowNS() - start;
+  }
   return RS_RESULT_OK;
 }
 
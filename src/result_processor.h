@@ -74,6 +74,10 @@ typedef struct {
   QITRState state;
 
   struct timespec startTime;
+
+  // If set, the processors add the time they spend in their own stages here, in nanoseconds,
+  // indexed by SlowlogStage
+  uint64_t *stageNS;
 } QueryIterator, QueryProcessingCtx;
 
 IndexIterator *QITR_GetRootFilter(QueryIterator *it);
@@ -192,6 +196,16 @@ ResultProcessor *RPSorter_NewByScore(size_t maxresults);
 
 ResultProcessor *RPPager_New(size_t offset, size_t limit);
 
+/** The name of the property holding the distance of a result from the center of a NEAREST geo
+ * filter */
+#define GEO_DISTANCE_FIELD "__geo_distance"
+
+/** Creates a processor writing the distance of every result from the center of a NEAREST geo filter
+ * to `distanceKey`. A sorter by that key, of the size of the filter's limit, should follow it */
+struct GeoFilter;
+ResultProcessor *RPGeoDistance_New(const struct GeoFilter *gf, const RLookupKey *distanceKey);
+
+
 /*******************************************************************************************************************
  *  Loading Processor
  *
@@ -0,0 +1,200 @@
+#include <pthread.h>
+#include <string.h>
+#include <strings.h>
+#include "slowlog.h"
+#include "config.h"
+#include "rmalloc.h"
+
+typedef struct {
+  long long id;
+  long long timestamp;
+  const char *command;
+  char *index;
+  char **args;
+  size_t nargs;
+  size_t numResults;
+  uint64_t durationNS;
+  uint64_t stageNS[SLOWLOG_NUM_STAGES];
+} slowlogEntry;
+
+static const char *stageNames[SLOWLOG_NUM_STAGES] = {
+    [SLOWLOG_STAGE_PARSE] = "parse",
+    [SLOWLOG_STAGE_EXPAND] = "expand",
+    [SLOWLOG_STAGE_ITERATORS] = "build_iterators",
+    [SLOWLOG_STAGE_ITERATE] = "iterate",
+    [SLOWLOG_STAGE_SORT] = "sort",
+    [SLOWLOG_STAGE_LOAD] = "load",
+    [SLOWLOG_STAGE_REPLY] = "reply",
+};
+
+// A ring of the newest entries. The ring is resized to the configured length on the next addition
+static struct {
+  pthread_mutex_t lock;
+  slowlogEntry **entries;
+  size_t cap;
+  size_t len;
+  // The position of the next entry
+  size_t head;
+  long long nextId;
+} slowlog_g = {.lock = PTHREAD_MUTEX_INITIALIZER};
+
+static void entryFree(slowlogEntry *e) {
+  for (size_t i = 0; i < e->nargs; i++) {
+    rm_free(e->args[i]);
+  }
+  rm_free(e->args);
+  rm_free(e->index);
+  rm_free(e);
+}
+
+static slowlogEntry *newEntry(const SlowlogQuery *q) {
+  slowlogEntry *e = rm_calloc(1, sizeof(*e));
+  e->timestamp = time(NULL);
+  e->command = q->command;
+  e->index = rm_strdup(q->index);
+  e->numResults = q->numResults;
+  e->durationNS = q->durationNS;
+  memcpy(e->stageNS, q->stageNS, sizeof(e->stageNS));
+
+  // Like the SLOWLOG of redis, the last argument kept counts the ones that were dropped
+  e->nargs = q->nargs > SLOWLOG_ENTRY_MAX_ARGC ? SLOWLOG_ENTRY_MAX_ARGC : q->nargs;
+  e->args = rm_malloc(e->nargs * sizeof(*e->args));
+  for (size_t i = 0; i < e->nargs; i++) {
+    if (i == SLOWLOG_ENTRY_MAX_ARGC - 1 && q->nargs > SLOWLOG_ENTRY_MAX_ARGC) {
+      rm_asprintf(&e->args[i], "... (%zu more arguments)", q->nargs - i);
+      break;
+    }
+    size_t len = strlen(q->args[i]);
+    if (len > SLOWLOG_ENTRY_MAX_STRING) {
+      rm_asprintf(&e->args[i], "%.*s... (%zu more bytes)", SLOWLOG_ENTRY_MAX_STRING, q->args[i],
+                  len - SLOWLOG_ENTRY_MAX_STRING);
+    } else {
+      e->args[i] = rm_strndup(q->args[i], len);
+    }
+  }
+  return e;
+}
+
+/* Get the i'th newest entry. Must be called with the lock held */
+static slowlogEntry *getEntry(size_t i) {
+  return slowlog_g.entries[(slowlog_g.head + slowlog_g.cap - 1 - i) % slowlog_g.cap];
+}
+
+/* Resize the ring to cap entries, keeping the newest ones. Must be called with the lock held */
+static void resize(size_t cap) {
+  size_t len = slowlog_g.len < cap ? slowlog_g.len : cap;
+  slowlogEntry **entries = cap ? rm_calloc(cap, sizeof(*entries)) : NULL;
+  for (size_t i = 0; i < slowlog_g.len; i++) {
+    if (i < len) {
+      entries[len - 1 - i] = getEntry(i);
+    } else {
+      entryFree(getEntry(i));
+    }
+  }
+  rm_free(slowlog_g.entries);
+  slowlog_g.entries = entries;
+  slowlog_g.cap = cap;
+  slowlog_g.len = len;
+  slowlog_g.head = cap ? len % cap : 0;
+}
+
+int Slowlog_IsEnabled(void) {
+  return RSGlobalConfig.slowlogLogSlowerThan >= 0;
+}
+
+int Slowlog_Add(const SlowlogQuery *q) {
+  long long threshold = RSGlobalConfig.slowlogLogSlowerThan;
+  if (threshold < 0 || q->durationNS < (uint64_t)threshold * 1000) {
+    return 0;
+  }
+  slowlogEntry *e = newEntry(q);
+
+  pthread_mutex_lock(&slowlog_g.lock);
+  size_t cap = RSGlobalConfig.slowlogMaxLen;
+  if (cap != slowlog_g.cap) {
+    resize(cap);
+  }
+  if (!cap) {
+    pthread_mutex_unlock(&slowlog_g.lock);
+    entryFree(e);
+    return 0;
+  }
+  e->id = slowlog_g.nextId++;
+  if (slowlog_g.len == cap) {
+    entryFree(slowlog_g.entries[slowlog_g.head]);
+  } else {
+    slowlog_g.len++;
+  }
+  slowlog_g.entries[slowlog_g.head] = e;
+  slowlog_g.head = (slowlog_g.head + 1) % cap;
+  pthread_mutex_unlock(&slowlog_g.lock);
+  return 1;
+}
+
+size_t Slowlog_Len(void) {
+  pthread_mutex_lock(&slowlog_g.lock);
+  size_t len = slowlog_g.len;
+  pthread_mutex_unlock(&slowlog_g.lock);
+  return len;
+}
+
+void Slowlog_Reset(void) {
+  pthread_mutex_lock(&slowlog_g.lock);
+  for (size_t i = 0; i < slowlog_g.len; i++) {
+    entryFree(getEntry(i));
+  }
+  slowlog_g.len = 0;
+  slowlog_g.head = 0;
+  pthread_mutex_unlock(&slowlog_g.lock);
+}
+
+static void replyEntry(RedisModuleCtx *ctx, const slowlogEntry *e) {
+  RedisModule_ReplyWithArray(ctx, 8);
+  RedisModule_ReplyWithLongLong(ctx, e->id);
+  RedisModule_ReplyWithLongLong(ctx, e->timestamp);
+  RedisModule_ReplyWithLongLong(ctx, e->durationNS / 1000);
+  RedisModule_ReplyWithSimpleString(ctx, e->command);
+  RedisModule_ReplyWithStringBuffer(ctx, e->index, strlen(e->index));
+  RedisModule_ReplyWithArray(ctx, e->nargs);
+  for (size_t i = 0; i < e->nargs; i++) {
+    RedisModule_ReplyWithStringBuffer(ctx, e->args[i], strlen(e->args[i]));
+  }
+  RedisModule_ReplyWithLongLong(ctx, e->numResults);
+  RedisModule_ReplyWithArray(ctx, 2 * SLOWLOG_NUM_STAGES);
+  for (size_t i = 0; i < SLOWLOG_NUM_STAGES; i++) {
+    RedisModule_ReplyWithSimpleString(ctx, stageNames[i]);
+    RedisModule_ReplyWithLongLong(ctx, e->stageNS[i] / 1000);
+  }
+}
+
+void Slowlog_Reply(RedisModuleCtx *ctx, long long count) {
+  pthread_mutex_lock(&slowlog_g.lock);
+  size_t n = count < 0 || count > slowlog_g.len ? slowlog_g.len : count;
+  RedisModule_ReplyWithArray(ctx, n);
+  for (size_t i = 0; i < n; i++) {
+    replyEntry(ctx, getEntry(i));
+  }
+  pthread_mutex_unlock(&slowlog_g.lock);
+}
+
+int SlowlogCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc) {
+  if (argc < 2) {
+    return RedisModule_WrongArity(ctx);
+  }
+  const char *action = RedisModule_StringPtrLen(argv[1], NULL);
+  if (!strcasecmp(action, "GET") && argc <= 3) {
+    long long count = 10;
+    if (argc == 3 && RedisModule_StringToLongLong(argv[2], &count) != REDISMODULE_OK) {
+      return RedisModule_ReplyWithError(ctx, "Bad count");
+    }
+    Slowlog_Reply(ctx, count);
+  } else if (!strcasecmp(action, "LEN") && argc == 2) {
+    RedisModule_ReplyWithLongLong(ctx, Slowlog_Len());
+  } else if (!strcasecmp(action, "RESET") && argc == 2) {
+    Slowlog_Reset();
+    RedisModule_ReplyWithSimpleString(ctx, "OK");
+  } else {
+    return RedisModule_ReplyWithError(ctx, "Unknown subcommand or wrong number of arguments");
+  }
+  return REDISMODULE_OK;
+}
@@ -0,0 +1,73 @@
+#ifndef RS_SLOWLOG_H_
+#define RS_SLOWLOG_H_
+
+#include <stdint.h>
+#include <time.h>
+#include "redismodule.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The slow query log, served by FT.SLOWLOG.
+ *
+ * Like the SLOWLOG of redis, it keeps the last SLOWLOG_MAX_LEN queries that took longer than
+ * SLOWLOG_LOG_SLOWER_THAN microseconds. Every entry holds the time the query spent in each stage
+ * of its execution, so the queries driving the tail latency can be found without profiling them. A
+ * cursor read is logged on its own, with no parsing time. */
+
+/* Arguments of a query beyond this are replaced by a count of the remaining ones */
+#define SLOWLOG_ENTRY_MAX_ARGC 32
+/* Longer arguments are truncated */
+#define SLOWLOG_ENTRY_MAX_STRING 128
+
+typedef enum {
+  SLOWLOG_STAGE_PARSE,      // QAST_Parse
+  SLOWLOG_STAGE_EXPAND,     // QAST_Expand
+  SLOWLOG_STAGE_ITERATORS,  // Building the iterators, QAST_Iterate
+  SLOWLOG_STAGE_ITERATE,    // Iterating, scoring and the rest of the pipeline
+  SLOWLOG_STAGE_SORT,       // Inserting results to the heap of a sorter and popping them
+  SLOWLOG_STAGE_LOAD,       // Loading documents, RLookup_LoadDocument
+  SLOWLOG_STAGE_REPLY,      // Serializing the results
+  SLOWLOG_NUM_STAGES
+} SlowlogStage;
+
+typedef struct {
+  const char *command;
+  const char *index;
+  // The query arguments, after the index name
+  const char **args;
+  size_t nargs;
+  size_t numResults;
+  uint64_t durationNS;
+  uint64_t stageNS[SLOWLOG_NUM_STAGES];
+} SlowlogQuery;
+
+static inline uint64_t Slowlog_NowNS(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Whether queries may enter the log, and should have their stages timed */
+int Slowlog_IsEnabled(void);
+
+/* Log the query if it is slower than the threshold. Returns 1 if it was logged */
+int Slowlog_Add(const SlowlogQuery *q);
+
+/* The number of entries in the log */
+size_t Slowlog_Len(void);
+
+/* Drop all the entries of the log */
+void Slowlog_Reset(void);
+
+/* Reply with up to count entries, newest first. A negative count replies with all of them */
+void Slowlog_Reply(RedisModuleCtx *ctx, long long count);
+
+/* FT.SLOWLOG GET [count] | LEN | RESET */
+int SlowlogCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int argc);
+
+#ifdef __cplusplus
+}
+#endif
+#endif  // RS_SLOWLOG_H_
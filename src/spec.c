@@ -13,6 +13,7 @@
 #include "config.h"
 #include "cursor.h"
 #include "tag_index.h"
+#include "int_index.h"
 #include "redis_index.h"
 #include "indexer.h"
 #include "alias.h"
@@ -121,7 +122,7 @@ const char *GetFieldNameByBit(const IndexSpec *sp, t_fieldMask id) {
 * The command only receives the relevant part of argv.
 *
 * The format currently is FT.CREATE {index} [NOOFFSETS] [NOFIELDS] [NOFREQS]
-    SCHEMA {field} [TEXT [WEIGHT {weight}]] | [NUMERIC]
+    SCHEMA {field} [TEXT [WEIGHT {weight}]] | [NUMERIC [INT64]]
 */
 IndexSpec *IndexSpec_ParseRedisArgs(RedisModuleCtx *ctx, RedisModuleString *name,
                                     RedisModuleString **argv, int argc, QueryError *status) {
@@ -146,6 +147,17 @@ FieldSpec **getFieldsByType(IndexSpec *spec, FieldType type) {
   return fields;
 }
 
+FieldSpec **getRangeTreeFields(IndexSpec *spec) {
+  FieldSpec **fields = array_new(FieldSpec *, FIELDS_ARRAY_CAP);
+  for (int i = 0; i < spec->numFields; ++i) {
+    const FieldSpec *fs = spec->fields + i;
+    if (FIELD_IS(fs, INDEXFLD_T_GEO) || (FIELD_IS(fs, INDEXFLD_T_NUMERIC) && !FieldSpec_IsInt64(fs))) {
+      fields = array_append(fields, &(spec->fields[i]));
+    }
+  }
+  return fields;
+}
+
 /* Check if Redis is currently loading from RDB. Our thread starts before RDB loading is finished */
 int isRdbLoading(RedisModuleCtx *ctx) {
   long long isLoading = 0;
@@ -330,6 +342,9 @@ static int parseFieldSpec(ArgsCursor *ac, FieldSpec *fs, QueryError *status) {
     }
   } else if (AC_AdvanceIfMatch(ac, NUMERIC_STR)) {
     FieldSpec_Initialize(fs, INDEXFLD_T_NUMERIC);
+    if (AC_AdvanceIfMatch(ac, SPEC_INT64_STR)) {
+      fs->options |= FieldSpec_Int64;
+    }
   } else if (AC_AdvanceIfMatch(ac, GEO_STR)) {  // geo field
     FieldSpec_Initialize(fs, INDEXFLD_T_GEO);
   } else if (AC_AdvanceIfMatch(ac, SPEC_TAG_STR)) {  // tag field
@@ -487,7 +502,7 @@ int IndexSpec_AddFields(IndexSpec *sp, RedisModuleCtx *ctx, ArgsCursor *ac, Quer
 }
 
 /* The format currently is FT.CREATE {index} [NOOFFSETS] [NOFIELDS]
-    SCHEMA {field} [TEXT [WEIGHT {weight}]] | [NUMERIC]
+    SCHEMA {field} [TEXT [WEIGHT {weight}]] | [NUMERIC [INT64]]
   */
 IndexSpec *IndexSpec_Parse(const char *name, const char **argv, int argc, QueryError *status) {
   IndexSpec *spec = NewIndexSpec(name);
@@ -616,9 +631,17 @@ int IndexSpec_AddTerm(IndexSpec *sp, const char *term, size_t len) {
     sp->stats.numTerms++;
     sp->stats.termsSize += len;
   }
+  // the term is added once for every batch of documents it is indexed in
+  IndexSpec_InvalidateTermStats(sp, term, len);
   return isNew;
 }
 
+void IndexSpec_InvalidateTermStats(IndexSpec *sp, const char *term, size_t len) {
+  if (sp->terms->spellIdx) {
+    SpellIndex_InvalidateScore(sp->terms->spellIdx, term, len);
+  }
+}
+
 IndexSpecCache *IndexSpec_GetSpecCache(const IndexSpec *spec) {
   if (!spec->spcache) {
     ((IndexSpec *)spec)->spcache = IndexSpec_BuildSpecCache(spec);
@@ -728,6 +751,7 @@ void IndexSpec_FreeInternals(IndexSpec *spec) {
     TrieType_Free(spec->terms);
   }
   DocTable_Free(&spec->docs);
+  LatencyStats_Free(&spec->latency);
 
   if (spec->uniqueId) {
     // If uniqueid is 0, it means the index was not initialized
@@ -904,6 +928,9 @@ RedisModuleString *IndexSpec_GetFormattedKey(IndexSpec *sp, const FieldSpec *fs,
     RedisSearchCtx sctx = {.redisCtx = RSDummyContext, .spec = sp};
     switch (forType) {
       case INDEXFLD_T_NUMERIC:
+        ret = FieldSpec_IsInt64(fs) ? fmtRedisIntIndexKey(&sctx, fs->name)
+                                    : fmtRedisNumericIndexKey(&sctx, fs->name);
+        break;
       case INDEXFLD_T_GEO:  // TODO?? change the name
         ret = fmtRedisNumericIndexKey(&sctx, fs->name);
         break;
@@ -1615,6 +1642,7 @@ int IndexSpec_UpdateWithHash(IndexSpec *spec, RedisModuleCtx *ctx, RedisModuleSt
     return REDISMODULE_ERR;
   }
 
+  uint64_t start = LatencyStats_Now();
   RedisSearchCtx sctx = SEARCH_CTX_STATIC(ctx, spec);
   Document doc = {0};
   Document_Init(&doc, key, 1.0, DEFAULT_LANGUAGE);
@@ -1630,6 +1658,7 @@ int IndexSpec_UpdateWithHash(IndexSpec *spec, RedisModuleCtx *ctx, RedisModuleSt
   // doc was set DEAD in Document_Moved and was not freed since it set as NOFREEDOC
   doc.flags &= ~DOCUMENT_F_DEAD;
   Document_Free(&doc);
+  LatencyStats_RecordSince(&spec->latency, LATENCY_HASH_INDEXING, start);
   return REDISMODULE_OK;
 }
 
@@ -16,12 +16,14 @@
 #include "util/dict.h"
 #include "redisearch_api.h"
 #include "rules.h"
+#include "latency_stats.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 #define NUMERIC_STR "NUMERIC"
+#define SPEC_INT64_STR "INT64"
 #define GEO_STR "GEO"
 
 #define SPEC_NOOFFSETS_STR "NOOFFSETS"
@@ -205,6 +207,8 @@ typedef struct IndexSpec {
   size_t pending_indexing_ops;
   size_t keysIndexed, keysTotal;
   bool cascadeDelete;
+
+  LatencyStats latency;
 } IndexSpec;
 
 typedef struct {
@@ -288,6 +292,10 @@ IndexSpec *IndexSpec_ParseRedisArgs(RedisModuleCtx *ctx, RedisModuleString *name
                                     RedisModuleString **argv, int argc, QueryError *status);
 
 FieldSpec **getFieldsByType(IndexSpec *spec, FieldType type);
+
+/* Get the fields indexed in a numeric range tree - NUMERIC and GEO fields, except INT64 fields
+ * which are indexed in an IntIndex */
+FieldSpec **getRangeTreeFields(IndexSpec *spec);
 int isRdbLoading(RedisModuleCtx *ctx);
 
 /* Create a new index spec from redis arguments, set it in a redis key and start its GC.
@@ -370,6 +378,9 @@ extern void (*IndexSpec_OnCreate)(const IndexSpec *sp);
 
 int IndexSpec_AddTerm(IndexSpec *sp, const char *term, size_t len);
 
+/* Drop the cached statistics of a term whose inverted index was changed, e.g. by the GC */
+void IndexSpec_InvalidateTermStats(IndexSpec *sp, const char *term, size_t len);
+
 /* Get a random term from the index spec using weighted random. Weighted random is done by sampling
  * N terms from the index and then doing weighted random on them. A sample size of 10-20 should be
  * enough */
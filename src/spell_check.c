@@ -1,6 +1,7 @@
 #include "spell_check.h"
 #include "util/arr.h"
 #include "dictionary.h"
+#include "config.h"
 #include <stdbool.h>
 
 /** Forward declaration **/
@@ -74,11 +75,17 @@ void RS_SuggestionsFree(RS_Suggestions *s) {
  * Return the score for the given suggestion (number between 0 to 1).
  * In case the suggestion should not be added return -1.
  */
-static double SpellCheck_GetScore(SpellCheckCtx *scCtx, char *suggestion, size_t len,
+static double SpellCheck_GetScore(SpellCheckCtx *scCtx, const char *suggestion, size_t len,
                                   t_fieldMask fieldMask) {
+  // the scores of the index terms are cached in their spell index, unless we filter by fields
+  SpellIndex *cache = fieldMask == RS_FIELDMASK_ALL ? scCtx->sctx->spec->terms->spellIdx : NULL;
+  double retVal = 0;
+  if (cache && SpellIndex_GetScore(cache, suggestion, len, &retVal)) {
+    return retVal;
+  }
+
   RedisModuleKey *keyp = NULL;
   InvertedIndex *invidx = Redis_OpenInvertedIndexEx(scCtx->sctx, suggestion, len, 0, &keyp);
-  double retVal = 0;
   if (!invidx) {
     // can not find inverted index key, score is 0.
     goto end;
@@ -103,6 +110,9 @@ end:
   if (keyp) {
     RedisModule_CloseKey(keyp);
   }
+  if (cache) {
+    SpellIndex_SetScore(cache, suggestion, len, retVal);
+  }
   return retVal;
 }
 
@@ -129,8 +139,36 @@ static bool SpellCheck_IsTermExistsInTrie(Trie *t, const char *term, size_t len,
   return retVal;
 }
 
+typedef struct {
+  SpellCheckCtx *scCtx;
+  t_fieldMask fieldMask;
+  RS_Suggestions *s;
+  int incr;
+} SpellCheck_IndexCtx;
+
+static void SpellCheck_AddIndexSuggestion(const char *suggestion, size_t len, int dist, void *ctx) {
+  SpellCheck_IndexCtx *ictx = ctx;
+  double score;
+  if ((score = SpellCheck_GetScore(ictx->scCtx, suggestion, len, ictx->fieldMask)) != -1) {
+    RS_SuggestionsAdd(ictx->s, (char *)suggestion, len, score, ictx->incr);
+  }
+}
+
 static void SpellCheck_FindSuggestions(SpellCheckCtx *scCtx, Trie *t, const char *term, size_t len,
                                        t_fieldMask fieldMask, RS_Suggestions *s, int incr) {
+  // the index is built for the configured distance, so it serves every query up to it. Until it
+  // is built, or if it outgrew its memory limit, the trie is traversed
+  SpellIndex *idx = NULL;
+  if (scCtx->distance <= RSGlobalConfig.spellCheckIndexDistance) {
+    idx = Trie_GetSpellIndex(t, RSGlobalConfig.spellCheckIndexDistance,
+                             RSGlobalConfig.spellCheckIndexMaxMemory);
+  }
+  if (idx) {
+    SpellCheck_IndexCtx ictx = {.scCtx = scCtx, .fieldMask = fieldMask, .s = s, .incr = incr};
+    SpellIndex_Find(idx, term, len, scCtx->distance, SpellCheck_AddIndexSuggestion, &ictx);
+    return;
+  }
+
   rune *rstr = NULL;
   t_len slen = 0;
   float score = 0;
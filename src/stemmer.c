@@ -4,6 +4,7 @@
 #include <sys/param.h>
 #include "dep/snowball/include/libstemmer.h"
 #include "rmalloc.h"
+#include "word_cache.h"
 
 typedef struct langPair_s
 {
@@ -78,6 +79,8 @@ struct sbStemmerCtx {
   struct sb_stemmer *sb;
   char *buf;
   size_t cap;
+  // May be NULL if caching is disabled
+  WordCache *cache;
 };
 
 const char *__sbstemmer_Stem(void *ctx, const char *word, size_t len, size_t *outlen) {
@@ -85,9 +88,17 @@ const char *__sbstemmer_Stem(void *ctx, const char *word, size_t len, size_t *ou
   struct sbStemmerCtx *stctx = ctx;
   struct sb_stemmer *sb = stctx->sb;
 
-  const sb_symbol *stemmed = sb_stemmer_stem(sb, b, (int)len);
+  char cached[WORDCACHE_MAX_LEN];
+  int cachedLen = stctx->cache ? WordCache_Lookup(stctx->cache, word, len, cached) : -1;
+  const sb_symbol *stemmed = (const sb_symbol *)cached;
+  if (cachedLen < 0) {
+    stemmed = sb_stemmer_stem(sb, b, (int)len);
+    if (stemmed && stctx->cache) {
+      WordCache_Put(stctx->cache, word, len, (const char *)stemmed, sb_stemmer_length(sb));
+    }
+  }
   if (stemmed) {
-    *outlen = sb_stemmer_length(sb);
+    *outlen = cachedLen < 0 ? sb_stemmer_length(sb) : cachedLen;
 
     // if the stem and its origin are the same - don't do anything
     if (*outlen == len && strncasecmp(word, (const char *)stemmed, len) == 0) {
@@ -116,12 +127,11 @@ void __sbstemmer_Free(Stemmer *s) {
   rm_free(s);
 }
 
+/* A snowball stemmer only stems its own language, so it can only be kept for documents of that
+ * language */
 static int sbstemmer_Reset(Stemmer *stemmer, StemmerType type, RSLanguage language) {
-  if (type != stemmer->type || stemmer->language == RS_LANG_UNSUPPORTED ||
-                               stemmer->language == language) {
-    return 0;
-  }
-  return 1;
+  return type == stemmer->type && stemmer->language != RS_LANG_UNSUPPORTED &&
+         stemmer->language == language;
 }
 
 Stemmer *__newSnowballStemmer(RSLanguage language) {
@@ -136,6 +146,7 @@ Stemmer *__newSnowballStemmer(RSLanguage language) {
   ctx->cap = 24;
   ctx->buf = rm_malloc(ctx->cap);
   ctx->buf[0] = STEM_PREFIX;
+  ctx->cache = WordCache_Get(WORDCACHE_STEMS, language);
 
   Stemmer *ret = rm_malloc(sizeof(Stemmer));
   ret->ctx = ctx;
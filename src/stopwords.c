@@ -1,13 +1,32 @@
 #define __REDISEARCH_STOPORWORDS_C__
 #include "stopwords.h"
-#include "dep/triemap/triemap.h"
 #include "rmalloc.h"
+#include "util/fnv.h"
 #include <ctype.h>
+#include <string.h>
 
 #define MAX_STOPWORDLIST_SIZE 1024
 
+// The number of seeds tried for a bucket before rebuilding the table with another salt
+#define STOPWORDS_MAX_SEED_TRIES 4096
+
+/* A stopword list is immutable, so it is compiled to a perfect hash table when created: a term is
+ * hashed once, the hash picks a bucket, and the seed of that bucket points to the only slot which
+ * may hold the term. The seeds are found by trial (hash and displace), which is quick at the
+ * load factor of one half kept here. */
 typedef struct StopWordList {
-  TrieMap *m;
+  // The words, sorted and unique
+  char **words;
+  size_t *lens;
+  size_t numWords;
+  // The lengths of the words, as bits, with lengths of 63 and up all on the last bit
+  uint64_t lenMask;
+  uint64_t salt;
+  uint32_t *seeds;
+  size_t bucketMask;
+  // Indexes of the words in the slots, or -1 for empty slots
+  int32_t *slots;
+  size_t slotMask;
   size_t refcount;
 } StopWordList;
 
@@ -29,13 +48,152 @@ StopWordList *EmptyStopWordList() {
   return __empty_stopwords;
 }
 
+static inline uint64_t lenBit(size_t len) {
+  return 1ULL << (len < 63 ? len : 63);
+}
+
+static inline uint64_t hashWord(const StopWordList *sl, const char *term, size_t len) {
+  return fnv_64a_buf(term, len, sl->salt);
+}
+
+static inline size_t slotOf(const StopWordList *sl, uint64_t hash, uint32_t seed) {
+  // the murmur3 finalizer, so that every seed moves the word to an unrelated slot
+  hash ^= seed * 0x9e3779b97f4a7c15ULL;
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  return hash & sl->slotMask;
+}
+
+static inline size_t bucketOf(const StopWordList *sl, uint64_t hash) {
+  return (hash >> 32) & sl->bucketMask;
+}
+
 /* Check if a stopword list contains a term. The term must be already lowercased */
 int StopWordList_Contains(const StopWordList *sl, const char *term, size_t len) {
-  if (!sl || !term) {
+  if (!sl || !term || !(sl->lenMask & lenBit(len))) {
     return 0;
   }
 
-  return TrieMap_Find(sl->m, (char *)term, len) != TRIEMAP_NOTFOUND;
+  uint64_t hash = hashWord(sl, term, len);
+  int32_t i = sl->slots[slotOf(sl, hash, sl->seeds[bucketOf(sl, hash)])];
+  return i >= 0 && sl->lens[i] == len && !memcmp(sl->words[i], term, len);
+}
+
+static size_t nextPow2(size_t n) {
+  size_t ret = 1;
+  while (ret < n) {
+    ret <<= 1;
+  }
+  return ret;
+}
+
+static int cmpWords(const void *p1, const void *p2) {
+  const char *w1 = *(const char **)p1, *w2 = *(const char **)p2;
+  return strcmp(w1, w2);
+}
+
+/* Find a seed which places the words of a bucket, starting at head, in free slots */
+static int placeBucket(StopWordList *sl, size_t bucket, int32_t head, const int32_t *next,
+                       const uint64_t *hashes, size_t *placed) {
+  for (uint32_t seed = 0; seed < STOPWORDS_MAX_SEED_TRIES; seed++) {
+    size_t n = 0;
+    int32_t i = head;
+    for (; i >= 0; i = next[i]) {
+      size_t slot = slotOf(sl, hashes[i], seed);
+      if (sl->slots[slot] >= 0) {
+        break;
+      }
+      // claim the slot, so that the next words of the bucket don't take it too
+      sl->slots[slot] = i;
+      placed[n++] = slot;
+    }
+    if (i < 0) {
+      sl->seeds[bucket] = seed;
+      return 1;
+    }
+    while (n) {
+      sl->slots[placed[--n]] = -1;
+    }
+  }
+  return 0;
+}
+
+/* Find a seed for every bucket, placing its words in free slots. Buckets are placed from the
+ * largest, while most slots are still free. Returns 0 if some bucket can't be placed with this
+ * salt */
+static int buildTable(StopWordList *sl) {
+  size_t nbuckets = sl->bucketMask + 1;
+  uint64_t *hashes = rm_malloc(sl->numWords * sizeof(*hashes));
+  // the words of each bucket, as a linked list
+  int32_t *heads = rm_malloc(nbuckets * sizeof(*heads));
+  int32_t *next = rm_malloc(sl->numWords * sizeof(*next));
+  size_t *sizes = rm_calloc(nbuckets, sizeof(*sizes));
+  size_t *placed = rm_malloc(sl->numWords * sizeof(*placed));
+  int ok = 1;
+
+  memset(heads, -1, nbuckets * sizeof(*heads));
+  memset(sl->slots, -1, (sl->slotMask + 1) * sizeof(*sl->slots));
+  for (size_t i = 0; i < sl->numWords; i++) {
+    hashes[i] = hashWord(sl, sl->words[i], sl->lens[i]);
+    size_t b = bucketOf(sl, hashes[i]);
+    next[i] = heads[b];
+    heads[b] = i;
+    sizes[b]++;
+  }
+  size_t maxSize = 0;
+  for (size_t b = 0; b < nbuckets; b++) {
+    sl->seeds[b] = 0;
+    maxSize = sizes[b] > maxSize ? sizes[b] : maxSize;
+  }
+
+  for (size_t size = maxSize; size && ok; size--) {
+    for (size_t b = 0; b < nbuckets && ok; b++) {
+      if (sizes[b] == size) {
+        ok = placeBucket(sl, b, heads[b], next, hashes, placed);
+      }
+    }
+  }
+
+  rm_free(hashes);
+  rm_free(heads);
+  rm_free(next);
+  rm_free(sizes);
+  rm_free(placed);
+  return ok;
+}
+
+/* Create a stopword list from words allocated with rm_malloc, which the list takes */
+static StopWordList *newStopWordList(char **words, size_t len) {
+  StopWordList *sl = rm_calloc(1, sizeof(*sl));
+  sl->refcount = 1;
+
+  // the words are saved and replied in sorted order
+  qsort(words, len, sizeof(*words), cmpWords);
+  sl->words = words;
+  // drop the duplicates
+  sl->lens = rm_malloc((len ? len : 1) * sizeof(*sl->lens));
+  for (size_t i = 0; i < len; i++) {
+    if (sl->numWords && !strcmp(words[i], words[sl->numWords - 1])) {
+      rm_free(words[i]);
+      continue;
+    }
+    words[sl->numWords] = words[i];
+    sl->lens[sl->numWords] = strlen(words[i]);
+    sl->lenMask |= lenBit(sl->lens[sl->numWords]);
+    sl->numWords++;
+  }
+
+  sl->bucketMask = nextPow2(sl->numWords) - 1;
+  sl->slotMask = nextPow2(2 * sl->numWords) - 1;
+  sl->seeds = rm_malloc((sl->bucketMask + 1) * sizeof(*sl->seeds));
+  sl->slots = rm_malloc((sl->slotMask + 1) * sizeof(*sl->slots));
+  // the FNV offset basis, changed in the rare case that some words can't be placed
+  sl->salt = 0xcbf29ce484222325ULL;
+  while (!buildTable(sl)) {
+    sl->salt++;
+  }
+  return sl;
 }
 
 /* Create a new stopword list from a list of redis strings */
@@ -56,16 +214,10 @@ StopWordList *NewStopWordListCStr(const char **strs, size_t len) {
   if (len > MAX_STOPWORDLIST_SIZE) {
     len = MAX_STOPWORDLIST_SIZE;
   }
-  StopWordList *sl = rm_malloc(sizeof(*sl));
-  sl->refcount = 1;
-  sl->m = NewTrieMap();
+  char **words = rm_malloc((len ? len : 1) * sizeof(*words));
 
   for (size_t i = 0; i < len; i++) {
-
     char *t = rm_strdup(strs[i]);
-    if (t == NULL) {
-      break;
-    }
     size_t tlen = strlen(t);
 
     // lowercase the letters
@@ -74,11 +226,9 @@ StopWordList *NewStopWordListCStr(const char **strs, size_t len) {
         t[pos] = tolower(t[pos]);
       }
     }
-    // printf("Adding stopword %s\n", t);
-    TrieMap_Add(sl->m, t, tlen, NULL, NULL);
-    rm_free(t);
+    words[i] = t;
   }
-  return sl;
+  return newStopWordList(words, len);
 }
 
 void StopWordList_Ref(StopWordList *sl) {
@@ -87,7 +237,13 @@ void StopWordList_Ref(StopWordList *sl) {
 
 static void StopWordList_FreeInternal(StopWordList *sl) {
   if (sl) {
-    TrieMap_Free(sl->m, NULL);
+    for (size_t i = 0; i < sl->numWords; i++) {
+      rm_free(sl->words[i]);
+    }
+    rm_free(sl->words);
+    rm_free(sl->lens);
+    rm_free(sl->seeds);
+    rm_free(sl->slots);
   }
   rm_free(sl);
 }
@@ -119,33 +275,24 @@ void StopWordList_FreeGlobals(void) {
 /* Load a stopword list from RDB */
 StopWordList *StopWordList_RdbLoad(RedisModuleIO *rdb, int encver) {
   uint64_t elements = RedisModule_LoadUnsigned(rdb);
-  StopWordList *sl = rm_malloc(sizeof(*sl));
-  sl->m = NewTrieMap();
-  sl->refcount = 1;
+  char **words = rm_malloc((elements ? elements : 1) * sizeof(*words));
 
-  while (elements--) {
+  for (size_t i = 0; i < elements; i++) {
     size_t len;
     char *str = RedisModule_LoadStringBuffer(rdb, &len);
-    TrieMap_Add(sl->m, str, len, NULL, NULL);
+    words[i] = rm_strndup(str, len);
     RedisModule_Free(str);
   }
 
-  return sl;
+  return newStopWordList(words, elements);
 }
 
 /* Save a stopword list to RDB */
 void StopWordList_RdbSave(RedisModuleIO *rdb, StopWordList *sl) {
-
-  RedisModule_SaveUnsigned(rdb, sl->m->cardinality);
-  TrieMapIterator *it = TrieMap_Iterate(sl->m, "", 0);
-  char *str;
-  tm_len_t len;
-  void *ptr;
-
-  while (TrieMapIterator_Next(it, &str, &len, &ptr)) {
-    RedisModule_SaveStringBuffer(rdb, str, len);
+  RedisModule_SaveUnsigned(rdb, sl->numWords);
+  for (size_t i = 0; i < sl->numWords; i++) {
+    RedisModule_SaveStringBuffer(rdb, sl->words[i], sl->lens[i]);
   }
-  TrieMapIterator_Free(it);
 }
 
 void ReplyWithStopWordsList(RedisModuleCtx *ctx, struct StopWordList *sl) {
@@ -157,17 +304,8 @@ void ReplyWithStopWordsList(RedisModuleCtx *ctx, struct StopWordList *sl) {
     return;
   }
 
-  TrieMapIterator *it = TrieMap_Iterate(sl->m, "", 0);
-  char *str;
-  tm_len_t len;
-  void *ptr;
-  size_t i = 0;
-
-  RedisModule_ReplyWithArray(ctx, REDISMODULE_POSTPONED_ARRAY_LEN);
-  while (TrieMapIterator_Next(it, &str, &len, &ptr)) {
-    RedisModule_ReplyWithStringBuffer(ctx, str, len);
-    ++i;
+  RedisModule_ReplyWithArray(ctx, sl->numWords);
+  for (size_t i = 0; i < sl->numWords; i++) {
+    RedisModule_ReplyWithStringBuffer(ctx, sl->words[i], sl->lens[i]);
   }
-  RedisModule_ReplySetArrayLength(ctx, i);
-  TrieMapIterator_Free(it);
 }
@@ -58,12 +58,24 @@ char *TagIndex_SepString(char sep, char **s, size_t *toklen) {
 char *strtolower(char *str);
 
 /* Preprocess a document tag field, returning a vector of all tags split from the content */
-char **TagIndex_Preprocess(char sep, TagFieldFlags flags, const DocumentField *data) {
+char **TagIndex_Preprocess(char sep, TagFieldFlags flags, const DocumentField *data,
+                           BlkAlloc *alloc, size_t *numTags) {
   size_t sz;
-  char *p = (char *)RedisModule_StringPtrLen(data->text, &sz);
-  if (!p || sz == 0) return NULL;
-  char **ret = array_new(char *, 4);
-  char *pp = p = rm_strndup(p, sz);
+  const char *s = RedisModule_StringPtrLen(data->text, &sz);
+  *numTags = 0;
+  if (!s || sz == 0) return NULL;
+
+  // the tags are split in place, in a copy of the content
+  char *p = BlkAlloc_ArenaAlloc(alloc, sz + 1);
+  memcpy(p, s, sz);
+  p[sz] = '\0';
+  // there is a tag before every separator, and one after the last
+  size_t maxTags = 1;
+  for (size_t ii = 0; ii < sz; ++ii) {
+    maxTags += p[ii] == sep;
+  }
+  char **ret = BlkAlloc_ArenaAlloc(alloc, maxTags * sizeof(*ret));
+  size_t n = 0;
   while (p) {
     // get the next token
     size_t toklen;
@@ -75,11 +87,13 @@ char **TagIndex_Preprocess(char sep, TagFieldFlags flags, const DocumentField *d
       if (!(flags & TagField_CaseSensitive)) {
         tok = strtolower(tok);
       }
-      tok = rm_strndup(tok, MIN(toklen, MAX_TAG_LEN));
-      ret = array_append(ret, tok);
+      if (toklen > MAX_TAG_LEN) {
+        tok[MAX_TAG_LEN] = '\0';
+      }
+      ret[n++] = tok;
     }
   }
-  rm_free(pp);
+  *numTags = n;
   return ret;
 }
 
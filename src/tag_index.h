@@ -108,13 +108,10 @@ void TagIndex_Free(void *p);
 
 char *TagIndex_SepString(char sep, char **s, size_t *toklen);
 
-/* Preprocess a document tag field, returning a vector of all tags split from the content */
-char **TagIndex_Preprocess(char sep, TagFieldFlags flags, const DocumentField *data);
-
-static inline void TagIndex_FreePreprocessedData(char **s) {
-  array_foreach(s, tmpv, { rm_free(tmpv); });
-  array_free(s);
-}
+/* Preprocess a document tag field, returning a vector of all tags split from the content, and
+ * setting numTags to their number. The vector and the tags are allocated from the arena alloc */
+char **TagIndex_Preprocess(char sep, TagFieldFlags flags, const DocumentField *data,
+                           BlkAlloc *alloc, size_t *numTags);
 
 /* Index a vector of pre-processed tags for a docId */
 size_t TagIndex_Index(TagIndex *idx, const char **values, size_t n, t_docId docId);
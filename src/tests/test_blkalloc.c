@@ -80,7 +80,33 @@ static int testFreeFunc() {
   return 0;
 }
 
+// Blocks are filled up to their capacity, which may exceed the requested block size when they are
+// recycled
+static int testRecycledCapacity() {
+  BlkAlloc alloc;
+  BlkAlloc_Init(&alloc);
+
+  char *small = BlkAlloc_Alloc(&alloc, 16, 16);
+  char *big = BlkAlloc_Alloc(&alloc, 64, 64);
+  ASSERT(alloc.root != alloc.last);
+  ASSERT(big != small + 16);
+  BlkAlloc_Clear(&alloc, NULL, NULL, 0);
+
+  // the last block is the first one available
+  char *first = BlkAlloc_Alloc(&alloc, 16, 16);
+  for (size_t i = 1; i < 4; i++) {
+    ASSERT(BlkAlloc_Alloc(&alloc, 16, 16) == first + i * 16);
+  }
+  ASSERT(alloc.root == alloc.last);
+  BlkAlloc_Alloc(&alloc, 16, 16);
+  ASSERT(alloc.root != alloc.last);
+
+  BlkAlloc_FreeAll(&alloc, NULL, NULL, 0);
+  return 0;
+}
+
 TEST_MAIN({
   TESTFUNC(testBlockAlloc);
   TESTFUNC(testFreeFunc);
+  TESTFUNC(testRecycledCapacity);
 })
@@ -43,9 +43,46 @@ int testDefaultStopwords() {
   return 0;
 }
 
+int testLargeStopwordList() {
+  // words of many lengths, repeated
+  size_t n = 1024;
+  char **terms = malloc(n * sizeof(*terms));
+  for (size_t i = 0; i < n; i++) {
+    terms[i] = malloc(64);
+    sprintf(terms[i], "w%zu.%.*s", i % 800, (int)(i % 800 % 40),
+            "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx");
+  }
+  StopWordList *sl = NewStopWordListCStr((const char **)terms, n);
+  for (size_t i = 0; i < n; i++) {
+    ASSERT(StopWordList_Contains(sl, terms[i], strlen(terms[i])));
+    // prefixes and extensions of the words are not in the list
+    ASSERT(!StopWordList_Contains(sl, terms[i], strlen(terms[i]) - 1));
+    char buf[80];
+    sprintf(buf, "%sy", terms[i]);
+    ASSERT(!StopWordList_Contains(sl, buf, strlen(buf)));
+  }
+
+  StopWordList_Free(sl);
+  for (size_t i = 0; i < n; i++) {
+    free(terms[i]);
+  }
+  free(terms);
+  return 0;
+}
+
+int testEmptyStopwordList() {
+  StopWordList *sl = NewStopWordListCStr(NULL, 0);
+  ASSERT(!StopWordList_Contains(sl, "", 0));
+  ASSERT(!StopWordList_Contains(sl, "the", 3));
+  StopWordList_Free(sl);
+  return 0;
+}
+
 TEST_MAIN({
   RMUTil_InitAlloc();
   TESTFUNC(testStopwordList);
   TESTFUNC(testDefaultStopwords);
+  TESTFUNC(testLargeStopwordList);
+  TESTFUNC(testEmptyStopwordList);
   StopWordList_FreeGlobals();
 });
\ No newline at end of file
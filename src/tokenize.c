@@ -29,6 +29,51 @@ static void simpleTokenizer_Start(RSTokenizer *base, char *text, size_t len, uin
 // Normalization buffer
 #define MAX_NORMALIZE_SIZE 128
 
+#ifdef TOKSEP_SSE2
+static inline unsigned normalizeSpecialMask(__m128i v) {
+  // Blanks, control characters, escapes, and every byte above 0x7f, which is negative as a signed
+  // char
+  __m128i m = _mm_cmplt_epi8(v, _mm_set1_epi8(' ' + 1));
+  m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8(0x7f)));
+  m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+  return _mm_movemask_epi8(m);
+}
+
+static inline __m128i lowercaseAscii(__m128i v) {
+  __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+                                _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+  return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+/**
+ * Lowercases the leading bytes of a token into dst, 16 at a time, as long as they are printable
+ * ASCII which DefaultNormalize would only lowercase. Returns the number of bytes done, leaving the
+ * rest to the scalar loop. The last partial block is read past the token unless that crosses a
+ * page boundary, which is safe since the text is NUL terminated.
+ */
+static size_t normalizeAscii(const char *s, char *dst, size_t len) {
+  size_t ii = 0;
+  for (; ii + 16 <= len; ii += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(s + ii));
+    if (normalizeSpecialMask(v)) {
+      return ii;
+    }
+    _mm_storeu_si128((__m128i *)(dst + ii), lowercaseAscii(v));
+  }
+  size_t rem = len - ii;
+  if (rem && ((uintptr_t)(s + ii) & 4095) <= 4096 - 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(s + ii));
+    if (!(normalizeSpecialMask(v) & ((1u << rem) - 1))) {
+      char tmp[16];
+      _mm_storeu_si128((__m128i *)tmp, lowercaseAscii(v));
+      memcpy(dst + ii, tmp, rem);
+      ii += rem;
+    }
+  }
+  return ii;
+}
+#endif
+
 /**
  * Normalizes text.
  * - s contains the raw token
@@ -46,9 +91,18 @@ static char *DefaultNormalize(char *s, char *dst, size_t *len) {
     realDest = dst;          \
     memcpy(realDest, s, ii); \
   }
+  size_t ii = 0;
+#ifdef TOKSEP_SSE2
+  dstLen = ii = normalizeAscii(s, dst, origLen);
+  if (ii) {
+    // the bytes done are in dst, and may have been modified
+    realDest = dst;
+  }
+#endif
+
   // set to 1 if the previous character was a backslash escape
   int escaped = 0;
-  for (size_t ii = 0; ii < origLen; ++ii) {
+  for (; ii < origLen; ++ii) {
     if (isupper(s[ii])) {
       SWITCH_DEST();
       realDest[dstLen++] = tolower(s[ii]);
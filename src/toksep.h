@@ -11,11 +11,22 @@ static const char ToksepMap_g[256] = {
     ['+'] = 1, ['|'] = 1,  ['\''] = 1, ['`'] = 1, ['"'] = 1, ['<'] = 1, ['>'] = 1, ['?'] = 1,
 };
 
+// The vectorized scan reads past the end of the string, which the sanitizers would report
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(memory_sanitizer)
+#define TOKSEP_NO_SIMD
+#endif
+#endif
+#if defined(__SSE2__) && !defined(__SANITIZE_ADDRESS__) && !defined(TOKSEP_NO_SIMD)
+#include <emmintrin.h>
+#define TOKSEP_SSE2 1
+#endif
+
 /**
  * Function reads string pointed to by `s` and indicates the length of the next
  * token in `tokLen`. `s` is set to NULL if this is the last token.
  */
-static inline char *toksep(char **s, size_t *tokLen) {
+static inline char *toksep_scalar(char **s, size_t *tokLen) {
   uint8_t *pos = (uint8_t *)*s;
   char *orig = *s;
   for (; *pos; ++pos) {
@@ -35,6 +46,66 @@ static inline char *toksep(char **s, size_t *tokLen) {
   return orig;
 }
 
+#ifdef TOKSEP_SSE2
+/* A mask of the bytes of v which are separators or the terminating NUL. The separators are
+ * '\t', and all the ASCII punctuation from ' ' to '~' but '\\' and '_', which make up these
+ * ranges. Bytes above 0x7f are negative as signed chars, and never match */
+static inline unsigned toksep_sse2Mask(__m128i v) {
+#define TOKSEP_IN_RANGE(v, lo, hi) \
+  _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8((lo)-1)), _mm_cmplt_epi8(v, _mm_set1_epi8((hi) + 1)))
+  __m128i m = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_setzero_si128()),
+                           _mm_cmpeq_epi8(v, _mm_set1_epi8('\t')));
+  m = _mm_or_si128(m, TOKSEP_IN_RANGE(v, ' ', '/'));
+  m = _mm_or_si128(m, TOKSEP_IN_RANGE(v, ':', '@'));
+  m = _mm_or_si128(m, TOKSEP_IN_RANGE(v, '[', '`'));
+  m = _mm_or_si128(m, TOKSEP_IN_RANGE(v, '{', '~'));
+  m = _mm_andnot_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\')), m);
+  m = _mm_andnot_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('_')), m);
+#undef TOKSEP_IN_RANGE
+  return _mm_movemask_epi8(m);
+}
+#endif
+
+/**
+ * Same as toksep_scalar, classifying 16 bytes at a time where SSE2 is available. The loads are
+ * aligned, so they never cross a page boundary past the terminating NUL.
+ */
+static inline char *toksep(char **s, size_t *tokLen) {
+#ifdef TOKSEP_SSE2
+  char *orig = *s;
+  uint8_t *pos = (uint8_t *)orig;
+  uint8_t *block = (uint8_t *)((uintptr_t)pos & ~(uintptr_t)15);
+  // ignore the bytes of the first block which come before the token
+  unsigned mask = toksep_sse2Mask(_mm_load_si128((const __m128i *)block)) >> (pos - block)
+                                                                          << (pos - block);
+  for (;;) {
+    while (!mask) {
+      block += 16;
+      mask = toksep_sse2Mask(_mm_load_si128((const __m128i *)block));
+    }
+    pos = block + __builtin_ctz(mask);
+    mask &= mask - 1;
+    if (!*pos) {
+      // Didn't find a terminating token
+      *s = NULL;
+      *tokLen = (char *)pos - orig;
+      return orig;
+    }
+    // an escaped separator is part of the token
+    if ((char *)pos == orig || *(pos - 1) != '\\') {
+      *s = (char *)++pos;
+      *tokLen = ((char *)pos - orig) - 1;
+      if (!*pos) {
+        *s = NULL;
+      }
+      return orig;
+    }
+  }
+#else
+  return toksep_scalar(s, tokLen);
+#endif
+}
+
 static inline int istoksep(int c) {
   return ToksepMap_g[(uint8_t)c] != 0;
 }
@@ -0,0 +1,417 @@
+#include <sys/param.h>
+#include "compact_trie.h"
+#include "rmalloc.h"
+#include "util/arr.h"
+
+typedef struct {
+  TrieNode *n;
+  float maxScore;
+} ctrieQueueEntry;
+
+// comparator for sorting siblings by the best score in their subtree, descending
+static int cmpQueueEntries(const void *p1, const void *p2) {
+  const ctrieQueueEntry *e1 = p1, *e2 = p2;
+  if (e1->maxScore < e2->maxScore) {
+    return 1;
+  } else if (e1->maxScore > e2->maxScore) {
+    return -1;
+  }
+  return 0;
+}
+
+struct CompactTrieBuilder {
+  CompactTrie *t;
+  // The nodes in level order. Once the first pass is done, it holds all the nodes in their final
+  // order, with the children of every node consecutive and sorted by their best score
+  ctrieQueueEntry *queue;
+  // the next node of the queue to visit in the first pass, or to copy in the second one
+  size_t pos;
+  // whether the first pass is done, and the pools are allocated
+  int copying;
+  uint32_t nextChild, runeOffset, payloadOffset;
+};
+
+CompactTrieBuilder *NewCompactTrieBuilder(TrieNode *root) {
+  CompactTrieBuilder *b = rm_calloc(1, sizeof(*b));
+  b->t = rm_calloc(1, sizeof(*b->t));
+  b->queue = array_new(ctrieQueueEntry, 64);
+  b->queue = array_append(b->queue, ((ctrieQueueEntry){.n = root}));
+  b->nextChild = 1;
+  return b;
+}
+
+/* First pass: queue the children of a node, and count the size of its string and payload */
+static void ctrieVisit(CompactTrieBuilder *b, size_t i) {
+  TrieNode *n = b->queue[i].n;
+  size_t first = array_len(b->queue);
+  for (t_len j = 0; j < n->numChildren; j++) {
+    TrieNode *ch = __trieNode_children(n)[j];
+    ctrieQueueEntry e = {.n = ch, .maxScore = MAX(ch->score, ch->maxChildScore)};
+    b->queue = array_append(b->queue, e);
+  }
+  qsort(b->queue + first, n->numChildren, sizeof(*b->queue), cmpQueueEntries);
+
+  b->t->numRunes += n->len;
+  if (n->payload) {
+    b->t->payloadsSize += sizeof(TriePayload) + n->payload->len + 1;
+  }
+}
+
+static void ctrieAlloc(CompactTrieBuilder *b) {
+  CompactTrie *t = b->t;
+  t->numNodes = array_len(b->queue);
+  t->nodes = rm_malloc(t->numNodes * sizeof(*t->nodes));
+  t->runes = rm_malloc(MAX(t->numRunes, 1) * sizeof(*t->runes));
+  t->payloads = t->payloadsSize ? rm_malloc(t->payloadsSize) : NULL;
+  b->copying = 1;
+  b->pos = 0;
+}
+
+/* Second pass: copy a node to its place in the layout */
+static void ctrieCopy(CompactTrieBuilder *b, size_t i) {
+  CompactTrie *t = b->t;
+  TrieNode *n = b->queue[i].n;
+  CompactTrieNode *cn = &t->nodes[i];
+  *cn = (CompactTrieNode){
+      .str = b->runeOffset,
+      .children = b->nextChild,
+      .payload = CTRIE_NO_PAYLOAD,
+      .score = n->score,
+      .maxChildScore = n->maxChildScore,
+      .len = n->len,
+      .numChildren = n->numChildren,
+      .flags = n->flags,
+  };
+  b->nextChild += n->numChildren;
+
+  memcpy(t->runes + b->runeOffset, n->str, n->len * sizeof(rune));
+  b->runeOffset += n->len;
+
+  if (n->payload) {
+    TriePayload *p = (TriePayload *)(t->payloads + b->payloadOffset);
+    p->len = n->payload->len;
+    memcpy(p->data, n->payload->data, p->len);
+    p->data[p->len] = '\0';
+    cn->payload = b->payloadOffset;
+    b->payloadOffset += sizeof(TriePayload) + p->len + 1;
+  }
+
+  if (__trieNode_isTerminal(n) && !__trieNode_isDeleted(n)) {
+    t->size++;
+  }
+}
+
+CompactTrie *CompactTrieBuilder_Step(CompactTrieBuilder *b, size_t maxNodes) {
+  for (size_t i = 0; i < maxNodes; i++) {
+    if (!b->copying) {
+      if (b->pos < array_len(b->queue)) {
+        ctrieVisit(b, b->pos++);
+        continue;
+      }
+      ctrieAlloc(b);
+    }
+    if (b->pos == b->t->numNodes) {
+      break;
+    }
+    ctrieCopy(b, b->pos++);
+  }
+
+  if (!b->copying || b->pos < b->t->numNodes) {
+    return NULL;
+  }
+  CompactTrie *t = b->t;
+  b->t = NULL;
+  CompactTrieBuilder_Free(b);
+  return t;
+}
+
+void CompactTrieBuilder_Free(CompactTrieBuilder *b) {
+  if (b->t) {
+    CompactTrie_Free(b->t);
+  }
+  array_free(b->queue);
+  rm_free(b);
+}
+
+size_t CompactTrieBuilder_MemUsage(const CompactTrieBuilder *b) {
+  return sizeof(*b) + array_len(b->queue) * sizeof(*b->queue) +
+         (b->copying ? CompactTrie_MemUsage(b->t) : sizeof(*b->t));
+}
+
+CompactTrie *NewCompactTrie(TrieNode *root) {
+  return CompactTrieBuilder_Step(NewCompactTrieBuilder(root), SIZE_MAX);
+}
+
+void CompactTrie_Free(CompactTrie *t) {
+  rm_free(t->nodes);
+  rm_free(t->runes);
+  rm_free(t->payloads);
+  rm_free(t);
+}
+
+size_t CompactTrie_MemUsage(const CompactTrie *t) {
+  return sizeof(*t) + t->numNodes * sizeof(*t->nodes) + t->numRunes * sizeof(*t->runes) +
+         t->payloadsSize;
+}
+
+static CompactTrieNode *ctrieFind(const CompactTrie *t, const rune *str, t_len len) {
+  CompactTrieNode *n = t->nodes;
+  t_len offset = 0;
+  while (n) {
+    const rune *nstr = t->runes + n->str;
+    t_len localOffset = 0;
+    for (; offset < len && localOffset < n->len; offset++, localOffset++) {
+      if (str[offset] != nstr[localOffset]) {
+        break;
+      }
+    }
+    if (localOffset < n->len) {
+      // we diverged inside the node, or the string ended before it
+      return NULL;
+    }
+    if (offset == len) {
+      return __ctrieNode_isTerminal(n) && !__ctrieNode_isDeleted(n) ? n : NULL;
+    }
+
+    // find the child to continue to
+    CompactTrieNode *next = NULL;
+    for (t_len i = 0; i < n->numChildren; i++) {
+      CompactTrieNode *child = &t->nodes[n->children + i];
+      if (child->len && t->runes[child->str] == str[offset]) {
+        next = child;
+        break;
+      }
+    }
+    n = next;
+  }
+  return NULL;
+}
+
+const CompactTrieNode *CompactTrie_Find(const CompactTrie *t, const rune *str, t_len len) {
+  return ctrieFind(t, str, len);
+}
+
+int CompactTrie_Delete(CompactTrie *t, const rune *str, t_len len) {
+  CompactTrieNode *n = ctrieFind(t, str, len);
+  if (!n) {
+    return 0;
+  }
+  // The node keeps its place in the layout, and its score, which siblings are sorted by. The max
+  // scores of its ancestors become stale, but they are only an upper bound used for pruning
+  n->flags |= TRIENODE_DELETED;
+  n->flags &= ~TRIENODE_TERMINAL;
+  t->size--;
+  return 1;
+}
+
+const CompactTrieNode *CompactTrie_RandomWalk(const CompactTrie *t, int minSteps, rune **str,
+                                              t_len *len) {
+  minSteps = MAX(minSteps, 4);
+
+  uint32_t *stack = array_new(uint32_t, minSteps);
+  stack = array_append(stack, 0);
+  size_t bufLen = 0;
+  int steps = 0;
+
+  while (steps < minSteps || !__ctrieNode_isTerminal(&t->nodes[array_tail(stack)])) {
+    const CompactTrieNode *n = &t->nodes[array_tail(stack)];
+
+    /* select the next step - -1 means walk back up one level */
+    int rnd = (rand() % (n->numChildren + 1)) - 1;
+    if (rnd == -1) {
+      /* we can't walk up the top level */
+      if (array_len(stack) > 1) {
+        steps++;
+        array_pop(stack);
+        bufLen -= n->len;
+      }
+      continue;
+    }
+    uint32_t child = n->children + rnd;
+    stack = array_append(stack, child);
+    bufLen += t->nodes[child].len;
+    steps++;
+  }
+
+  rune *buf = rm_calloc(bufLen + 1, sizeof(rune));
+  size_t off = 0;
+  for (uint32_t i = 0; i < array_len(stack); i++) {
+    const CompactTrieNode *n = &t->nodes[stack[i]];
+    memcpy(buf + off, t->runes + n->str, n->len * sizeof(rune));
+    off += n->len;
+  }
+  const CompactTrieNode *ret = &t->nodes[array_tail(stack)];
+  array_free(stack);
+
+  *str = buf;
+  *len = off;
+  return ret;
+}
+
+static int ctrieRunecmp(const rune *sa, size_t na, const rune *sb, size_t nb) {
+  size_t minlen = MIN(na, nb);
+  for (size_t ii = 0; ii < minlen; ++ii) {
+    if (sa[ii] != sb[ii]) {
+      return (int)sa[ii] - (int)sb[ii];
+    }
+  }
+  return na > nb ? 1 : na < nb ? -1 : 0;
+}
+
+typedef struct {
+  const CompactTrie *t;
+  const rune *min;
+  int nmin;
+  bool includeMin;
+  const rune *max;
+  int nmax;
+  bool includeMax;
+  TrieRangeCallback *callback;
+  void *cbctx;
+  rune *buf;
+} ctrieRangeCtx;
+
+static void ctrieRangeIterate(ctrieRangeCtx *r, const CompactTrieNode *n) {
+  const CompactTrie *t = r->t;
+  r->buf = array_ensure_append(r->buf, t->runes + n->str, n->len, rune);
+  size_t blen = array_len(r->buf);
+
+  // Every string in this subtree starts with buf. If buf is below min without being a prefix of
+  // it, or above max, the whole subtree is out of range
+  int cmin = 1, cmax = -1;
+  if (r->min) {
+    cmin = ctrieRunecmp(r->buf, blen, r->min, r->nmin);
+    if (cmin < 0 && (blen > (size_t)r->nmin || memcmp(r->buf, r->min, blen * sizeof(rune)))) {
+      goto clean_stack;
+    }
+  }
+  if (r->max) {
+    cmax = ctrieRunecmp(r->buf, blen, r->max, r->nmax);
+    if (cmax > 0) {
+      goto clean_stack;
+    }
+  }
+
+  if (__ctrieNode_isTerminal(n) && !__ctrieNode_isDeleted(n) &&
+      (cmin > 0 || (cmin == 0 && r->includeMin)) && (cmax < 0 || (cmax == 0 && r->includeMax))) {
+    r->callback(r->buf, blen, r->cbctx);
+  }
+
+  for (t_len i = 0; i < n->numChildren; i++) {
+    ctrieRangeIterate(r, &t->nodes[n->children + i]);
+  }
+
+clean_stack:
+  array_trimm_len(r->buf, array_len(r->buf) - n->len);
+}
+
+void CompactTrie_IterateRange(const CompactTrie *t, const rune *min, int nmin, bool includeMin,
+                              const rune *max, int nmax, bool includeMax,
+                              TrieRangeCallback callback, void *ctx) {
+  if (min && max) {
+    int cmp = ctrieRunecmp(min, nmin, max, nmax);
+    if (cmp > 0) {
+      return;
+    }
+    if (cmp == 0) {
+      // min = max, we should just search for min and check for its existence
+      if ((includeMin || includeMax) && CompactTrie_Find(t, min, nmin)) {
+        callback(min, nmin, ctx);
+      }
+      return;
+    }
+  }
+
+  ctrieRangeCtx r = {
+      .t = t,
+      .min = min,
+      .nmin = min ? nmin : 0,
+      .includeMin = includeMin,
+      .max = max,
+      .nmax = max ? nmax : 0,
+      .includeMax = includeMax,
+      .callback = callback,
+      .cbctx = ctx,
+  };
+  r.buf = array_new(rune, TRIE_INITIAL_STRING_LEN);
+  ctrieRangeIterate(&r, t->nodes);
+  array_free(r.buf);
+}
+
+/* A child in the walk, sorted by its first rune - which is unique among its siblings */
+typedef struct {
+  int first;
+  uint32_t node;
+} ctrieWalkChild;
+
+static int cmpWalkChildren(const void *p1, const void *p2) {
+  const ctrieWalkChild *c1 = p1, *c2 = p2;
+  return c1->first - c2->first;
+}
+
+typedef struct {
+  const CompactTrie *t;
+  const rune *min;
+  int nmin;
+  TrieWalkCallback *callback;
+  void *cbctx;
+  rune *buf;
+  // the children of the nodes on the walked path, each in lexical order
+  ctrieWalkChild *children;
+} ctrieWalkCtx;
+
+static int ctrieWalkFrom(ctrieWalkCtx *w, const CompactTrieNode *n, int bounded) {
+  const CompactTrie *t = w->t;
+  w->buf = array_ensure_append(w->buf, t->runes + n->str, n->len, rune);
+  size_t blen = array_len(w->buf);
+  int rc = 0;
+
+  // Once buf is above min, so is the whole subtree. If it is below min without being a prefix of
+  // it, the whole subtree is out of range
+  if (bounded && ctrieRunecmp(w->buf, blen, w->min, w->nmin) > 0) {
+    bounded = 0;
+  } else if (bounded && (blen > (size_t)w->nmin || memcmp(w->buf, w->min, blen * sizeof(rune)))) {
+    goto clean_stack;
+  }
+
+  if (!bounded && __ctrieNode_isTerminal(n) && !__ctrieNode_isDeleted(n)) {
+    rc = w->callback(w->buf, blen, w->cbctx);
+    if (rc) {
+      goto clean_stack;
+    }
+  }
+
+  // the children are sorted by score, walk them by their first rune instead
+  size_t first = array_len(w->children);
+  for (t_len i = 0; i < n->numChildren; i++) {
+    const CompactTrieNode *child = &t->nodes[n->children + i];
+    ctrieWalkChild c = {.first = child->len ? t->runes[child->str] : -1,
+                        .node = n->children + i};
+    w->children = array_append(w->children, c);
+  }
+  qsort(w->children + first, n->numChildren, sizeof(ctrieWalkChild), cmpWalkChildren);
+  for (t_len i = 0; i < n->numChildren && !rc; i++) {
+    rc = ctrieWalkFrom(w, &t->nodes[w->children[first + i].node], bounded);
+  }
+  array_trimm_len(w->children, first);
+
+clean_stack:
+  array_trimm_len(w->buf, array_len(w->buf) - n->len);
+  return rc;
+}
+
+void CompactTrie_WalkFrom(const CompactTrie *t, const rune *min, int nmin,
+                          TrieWalkCallback callback, void *ctx) {
+  ctrieWalkCtx w = {
+      .t = t,
+      .min = min,
+      .nmin = nmin,
+      .callback = callback,
+      .cbctx = ctx,
+  };
+  w.buf = array_new(rune, TRIE_INITIAL_STRING_LEN);
+  w.children = array_new(ctrieWalkChild, 16);
+  ctrieWalkFrom(&w, t->nodes, min != NULL);
+  array_free(w.buf);
+  array_free(w.children);
+}
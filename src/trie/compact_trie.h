@@ -0,0 +1,110 @@
+#ifndef __COMPACT_TRIE_H__
+#define __COMPACT_TRIE_H__
+
+#include "trie.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A CompactTrie is a frozen copy of a TrieNode tree, flattened into a few contiguous arrays:
+ *
+ * - The nodes are kept in level order (as in LOUDS), so the children of a node are consecutive and
+ *   a node only needs the index of its first child instead of an array of child pointers.
+ * - The children of every node are sorted by their maximal score, so a top-k search can stop
+ *   scanning children as soon as one of them cannot beat the current minimal score.
+ * - The strings of all the nodes are kept in a single rune pool, and the payloads in a single
+ *   byte pool.
+ *
+ * This saves the per-node allocations and child pointers of TrieNode, and keeps the nodes that are
+ * visited together close together in memory. The layout is read-mostly: scores and payloads of
+ * existing entries cannot change, but entries can be marked as deleted. New entries are added to a
+ * (small) mutable TrieNode tree, which is periodically merged with the frozen layer - see Trie in
+ * trie_type.h */
+
+#define CTRIE_NO_PAYLOAD UINT32_MAX
+
+typedef struct CompactTrieNode {
+  // offset of the node's string in the rune pool
+  uint32_t str;
+  // index of the node's first child. The children of a node are consecutive
+  uint32_t children;
+  // offset of the node's payload (a TriePayload) in the payload pool, or CTRIE_NO_PAYLOAD
+  uint32_t payload;
+  float score;
+  float maxChildScore;
+  t_len len;
+  t_len numChildren;
+  uint8_t flags;
+} CompactTrieNode;
+
+typedef struct CompactTrie {
+  CompactTrieNode *nodes;
+  size_t numNodes;
+  rune *runes;
+  size_t numRunes;
+  char *payloads;
+  size_t payloadsSize;
+  // the number of live (terminal, non deleted) entries
+  size_t size;
+} CompactTrie;
+
+/* Create a compact copy of the trie rooted at root. The TrieNode tree is not modified */
+CompactTrie *NewCompactTrie(TrieNode *root);
+
+/* A compact copy of a TrieNode tree, laid out a few nodes at a time so that large tries can be
+ * copied without a long pause. The tree must not change until the copy is complete, except that
+ * its entries can be marked as deleted - which the copy may or may not see */
+typedef struct CompactTrieBuilder CompactTrieBuilder;
+
+CompactTrieBuilder *NewCompactTrieBuilder(TrieNode *root);
+
+/* Lay out up to maxNodes more nodes. Every node takes two steps. Returns the compact trie once it
+ * is complete, and frees the builder; returns NULL otherwise */
+CompactTrie *CompactTrieBuilder_Step(CompactTrieBuilder *b, size_t maxNodes);
+
+void CompactTrieBuilder_Free(CompactTrieBuilder *b);
+
+/* Return the number of bytes used by the builder, including the part of the trie laid out so far */
+size_t CompactTrieBuilder_MemUsage(const CompactTrieBuilder *b);
+
+void CompactTrie_Free(CompactTrie *t);
+
+/* Return the number of bytes used by the compact trie */
+size_t CompactTrie_MemUsage(const CompactTrie *t);
+
+/* Find the node of an entry. Returns NULL if the entry is not in the trie or was deleted */
+const CompactTrieNode *CompactTrie_Find(const CompactTrie *t, const rune *str, t_len len);
+
+/* Mark an entry as deleted. Returns 1 if the entry was found and deleted, 0 otherwise */
+int CompactTrie_Delete(CompactTrie *t, const rune *str, t_len len);
+
+/* Get the payload of a node, or NULL if it has none */
+static inline const TriePayload *CompactTrie_Payload(const CompactTrie *t,
+                                                     const CompactTrieNode *n) {
+  return n->payload == CTRIE_NO_PAYLOAD ? NULL : (const TriePayload *)(t->payloads + n->payload);
+}
+
+#define __ctrieNode_isTerminal(n) ((n)->flags & TRIENODE_TERMINAL)
+#define __ctrieNode_isDeleted(n) ((n)->flags & TRIENODE_DELETED)
+
+/* Walk randomly down from the root to a live entry. The trie must have live entries. The string
+ * of the entry is allocated and returned in str */
+const CompactTrieNode *CompactTrie_RandomWalk(const CompactTrie *t, int minSteps, rune **str,
+                                              t_len *len);
+
+/* Iterate all the live entries within a lexical range, with the same semantics as
+ * TrieNode_IterateRange. The callback is not called in lexical order */
+void CompactTrie_IterateRange(const CompactTrie *t, const rune *min, int nmin, bool includeMin,
+                              const rune *max, int nmax, bool includeMax,
+                              TrieRangeCallback callback, void *ctx);
+
+/* Walk the live entries greater than min (all of them if min is NULL) in lexical order, until the
+ * callback stops the walk. See TrieNode_WalkFrom */
+void CompactTrie_WalkFrom(const CompactTrie *t, const rune *min, int nmin,
+                          TrieWalkCallback callback, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
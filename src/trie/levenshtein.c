@@ -2,284 +2,268 @@
 #include <stdio.h>
 #include <sys/param.h>
 #include <string.h>
+#include <pthread.h>
 #include "levenshtein.h"
 #include "rune_util.h"
 #include "rmalloc.h"
-
-// NewSparseAutomaton creates a new automaton for the string s, with a given max
-// edit distance check
-SparseAutomaton NewSparseAutomaton(const rune *s, size_t len, int maxEdits) {
-  return (SparseAutomaton){s, len, maxEdits};
-}
-
-// Start initializes the automaton's state vector and returns it for further
-// iteration
-sparseVector *SparseAutomaton_Start(SparseAutomaton *a) {
-  int vals[a->max + 1];
-  for (int i = 0; i < a->max + 1; i++) {
-    vals[i] = i;
-  }
-
-  return newSparseVector(vals, a->max + 1);
+#include "util/fnv.h"
+#include "rmutil/rm_assert.h"
+
+/* The LRU cache of compiled automata. The list holds the most recently used automaton first */
+static struct {
+  DLLIST lru;
+  size_t size;
+  pthread_mutex_t lock;
+} levCache_g = {
+    .lru = {.next = &levCache_g.lru, .prev = &levCache_g.lru},
+    .size = 0,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static int cmpRuneMasks(const void *p1, const void *p2) {
+  const levRuneMask *m1 = p1, *m2 = p2;
+  return (int)m1->r - (int)m2->r;
 }
 
-// Step returns the next state of the automaton given a previous state and a
-// character to check
-sparseVector *SparseAutomaton_Step(SparseAutomaton *a, sparseVector *state, rune c) {
-  sparseVector *newVec = newSparseVectorCap(state->len);
-
-  if (state->len) {
-    sparseVectorEntry e = state->entries[0];
-    if (e.idx == 0 && e.val < a->max) {
-      sparseVector_append(&newVec, 0, e.val + 1);
+static LevAutomaton *levCompile(const rune *s, size_t len, int maxEdits, uint64_t hash) {
+  LevAutomaton *a = rm_calloc(1, sizeof(*a));
+  a->string = rm_malloc(MAX(len, 1) * sizeof(rune));
+  memcpy(a->string, s, len * sizeof(rune));
+  a->len = len;
+  a->max = maxEdits;
+  a->hash = hash;
+  a->matchMask = (levMask)1 << len;
+
+  for (size_t j = 0; j < len; j++) {
+    levMask bit = (levMask)1 << (j + 1);
+    if (s[j] < 128) {
+      a->asciiMasks[s[j]] |= bit;
+      continue;
     }
-  }
-
-  for (int j = 0; j < state->len; j++) {
-    sparseVectorEntry *entry = &state->entries[j];
-
-    if (entry->idx == a->len) {
-      break;
+    size_t k = 0;
+    while (k < a->numRuneMasks && a->runeMasks[k].r != s[j]) {
+      k++;
     }
-
-    register int val = state->entries[j].val;
-    // increase the cost by 1
-    if (a->string[entry->idx] != c) ++val;
-
-    if (newVec->len && newVec->entries[newVec->len - 1].idx == entry->idx) {
-      val = MIN(val, newVec->entries[newVec->len - 1].val + 1);
-    }
-
-    if (j + 1 < state->len && state->entries[j + 1].idx == entry->idx + 1) {
-      val = MIN(val, state->entries[j + 1].val + 1);
-    }
-
-    if (val <= a->max) {
-      sparseVector_append(&newVec, entry->idx + 1, val);
+    if (k == a->numRuneMasks) {
+      a->runeMasks = rm_realloc(a->runeMasks, (k + 1) * sizeof(*a->runeMasks));
+      a->runeMasks[k] = (levRuneMask){.r = s[j], .mask = 0};
+      a->numRuneMasks++;
     }
+    a->runeMasks[k].mask |= bit;
   }
-  return newVec;
-}
-
-// IsMatch returns true if the current state vector represents a string that is
-// within the max
-// edit distance from the initial automaton string
-inline int SparseAutomaton_IsMatch(SparseAutomaton *a, sparseVector *v) {
-  return v->len && v->entries[v->len - 1].idx == a->len;
-}
-
-// CanMatch returns true if there is a possibility that feeding the automaton
-// with more steps will
-// yield a match. Once CanMatch is false there is no point in continuing
-// iteration
-inline int SparseAutomaton_CanMatch(SparseAutomaton *a, sparseVector *v) {
-  return v->len > 0;
-}
-
-dfaNode *__newDfaNode(int distance, sparseVector *state) {
-  dfaNode *ret = rm_calloc(1, sizeof(dfaNode));
-  ret->fallback = NULL;
-  ret->distance = distance;
-  ret->v = state;
-  ret->edges = NULL;
-  ret->numEdges = 0;
-
-  return ret;
+  if (a->numRuneMasks > 1) {
+    qsort(a->runeMasks, a->numRuneMasks, sizeof(*a->runeMasks), cmpRuneMasks);
+  }
+  return a;
 }
 
-void __dfaNode_free(dfaNode *d) {
-  sparseVector_free(d->v);
-  if (d->edges) rm_free(d->edges);
-  rm_free(d);
+static void levFree(LevAutomaton *a) {
+  rm_free(a->string);
+  rm_free(a->runeMasks);
+  rm_free(a);
 }
 
-int __sv_equals(sparseVector *sv1, sparseVector *sv2) {
-  if (sv1->len != sv2->len) return 0;
-
-  for (int i = 0; i < sv1->len; i++) {
-    if (sv1->entries[i].idx != sv2->entries[i].idx || sv1->entries[i].val != sv2->entries[i].val) {
-      return 0;
+LevAutomaton *LevAutomaton_Acquire(const rune *s, size_t len, int maxEdits) {
+  if (len > LEV_MAX_STRING_LEN) {
+    // matching a prefix of the query instead would report wrong distances
+    return NULL;
+  }
+  rune folded[LEV_MAX_STRING_LEN];
+  for (size_t i = 0; i < len; i++) {
+    folded[i] = runeFold(s[i]);
+  }
+  uint64_t hash = fnv_64a_buf(folded, len * sizeof(rune), 0);
+  hash = fnv_64a_buf(&maxEdits, sizeof(maxEdits), hash);
+
+  pthread_mutex_lock(&levCache_g.lock);
+  DLLIST_FOREACH(it, &levCache_g.lru) {
+    LevAutomaton *a = DLLIST_ITEM(it, LevAutomaton, llnode);
+    if (a->hash == hash && a->len == len && a->max == maxEdits &&
+        !memcmp(a->string, folded, len * sizeof(rune))) {
+      dllist_delete(&a->llnode);
+      dllist_prepend(&levCache_g.lru, &a->llnode);
+      a->refcount++;
+      pthread_mutex_unlock(&levCache_g.lock);
+      return a;
     }
   }
-
-  return 1;
-}
-
-dfaNode *__dfn_getCache(Vector *cache, sparseVector *v) {
-  size_t n = Vector_Size(cache);
-  for (int i = 0; i < n; i++) {
-    dfaNode *dfn;
-    Vector_Get(cache, i, &dfn);
-
-    if (__sv_equals(v, dfn->v)) {
-      return dfn;
+  pthread_mutex_unlock(&levCache_g.lock);
+
+  // compile outside of the lock. If another thread compiles the same string meanwhile, we just end
+  // up with a duplicate entry that will age out of the cache
+  LevAutomaton *a = levCompile(folded, len, maxEdits, hash);
+  LevAutomaton *evicted = NULL;
+  a->refcount = 1;
+  a->cached = 1;
+
+  pthread_mutex_lock(&levCache_g.lock);
+  dllist_prepend(&levCache_g.lru, &a->llnode);
+  if (++levCache_g.size > LEV_CACHE_SIZE) {
+    evicted = DLLIST_ITEM(dllist_pop_tail(&levCache_g.lru), LevAutomaton, llnode);
+    levCache_g.size--;
+    evicted->cached = 0;
+    // automata still used by a filter are freed when released
+    if (evicted->refcount) {
+      evicted = NULL;
     }
   }
-  return NULL;
-}
+  pthread_mutex_unlock(&levCache_g.lock);
 
-void __dfn_putCache(Vector *cache, dfaNode *dfn) {
-  Vector_Push(cache, dfn);
+  if (evicted) {
+    levFree(evicted);
+  }
+  return a;
 }
 
-inline dfaNode *__dfn_getEdge(dfaNode *n, rune r) {
-  for (int i = 0; i < n->numEdges; i++) {
-    if (n->edges[i].r == r) {
-      return n->edges[i].n;
-    }
+void LevAutomaton_Release(LevAutomaton *a) {
+  pthread_mutex_lock(&levCache_g.lock);
+  int shouldFree = --a->refcount == 0 && !a->cached;
+  pthread_mutex_unlock(&levCache_g.lock);
+  if (shouldFree) {
+    levFree(a);
   }
-  return NULL;
 }
 
-void __dfn_addEdge(dfaNode *n, rune r, dfaNode *child) {
-  n->edges = rm_realloc(n->edges, sizeof(dfaEdge) * (n->numEdges + 1));
-  n->edges[n->numEdges++] = (dfaEdge){.r = r, .n = child};
+levMask LevAutomaton_RuneMask(const LevAutomaton *a, rune r) {
+  if (r < 128) {
+    return a->asciiMasks[r];
+  }
+  size_t lo = 0, hi = a->numRuneMasks;
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (a->runeMasks[mid].r < r) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo < a->numRuneMasks && a->runeMasks[lo].r == r ? a->runeMasks[lo].mask : 0;
 }
 
-void dfa_build(dfaNode *parent, SparseAutomaton *a, Vector *cache) {
-  parent->match = SparseAutomaton_IsMatch(a, parent->v);
-
-  for (int i = 0; i < parent->v->len; i++) {
-    if (parent->v->entries[i].idx < a->len) {
-      rune c = a->string[parent->v->entries[i].idx];
-      // printf("%c ---> ", c);
-      dfaNode *edge = __dfn_getEdge(parent, c);
-      if (edge == NULL) {
-        sparseVector *nv = SparseAutomaton_Step(a, parent->v, c);
-
-        if (nv->len > 0) {
-          dfaNode *dfn = __dfn_getCache(cache, nv);
-          if (dfn == NULL) {
-            int dist = nv->entries[nv->len - 1].val;
-            edge = __newDfaNode(dist, nv);
-            __dfn_addEdge(parent, c, edge);
-            __dfn_putCache(cache, edge);
-            dfa_build(edge, a, cache);
-            continue;
-          } else {
-            __dfn_addEdge(parent, c, dfn);
-          }
-        }
-        sparseVector_free(nv);
-      }
-    }
+int LevAutomaton_Distance(const LevAutomaton *a, const rune *s, size_t len) {
+  const int k = a->max;
+  levMask full = (a->matchMask << 1) - 1;
+  levMask state[k + 1];
+  for (int i = 0; i <= k; i++) {
+    state[i] = i < LEV_MAX_STRING_LEN ? (((levMask)1 << (i + 1)) - 1) & full : full;
   }
 
-  // if (parent->distance < a->max) {
-  sparseVector *nv = SparseAutomaton_Step(a, parent->v, 1);
-  if (nv->len > 0) {
-    dfaNode *dfn = __dfn_getCache(cache, nv);
-    if (dfn) {
-      parent->fallback = dfn;
-    } else {
-      int dist = nv->entries[nv->len - 1].val;
-      // printf("DEFAULT EDGE! edge %s - dist %d\n", a->string, dist);
-      parent->fallback = __newDfaNode(dist, nv);
-      __dfn_putCache(cache, parent->fallback);
-      dfa_build(parent->fallback, a, cache);
-      return;
+  for (size_t j = 0; j < len; j++) {
+    levMask rm = LevAutomaton_RuneMask(a, runeFold(s[j]));
+    // update in place, keeping the old R[i - 1] around for R'[i]
+    levMask prev = state[0];
+    state[0] = (state[0] << 1) & rm;
+    for (int i = 1; i <= k; i++) {
+      levMask cur = state[i];
+      state[i] = (((cur << 1) & rm) | prev | (prev << 1) | (state[i - 1] << 1)) & full;
+      prev = cur;
+    }
+    if (state[k] == 0) {
+      return k + 1;
     }
   }
-  sparseVector_free(nv);
 
-  //}
+  int d = 0;
+  while (d <= k && !(state[d] & a->matchMask)) {
+    d++;
+  }
+  return d;
 }
 
-DFAFilter NewDFAFilter(rune *str, size_t len, int maxDist, int prefixMode) {
-  Vector *cache = NewVector(dfaNode *, 8);
-
-  SparseAutomaton a = NewSparseAutomaton(str, len, maxDist);
+#define DFA_FILTER_INITIAL_DEPTH 16
 
-  sparseVector *v = SparseAutomaton_Start(&a);
-  dfaNode *dr = __newDfaNode(0, v);
-  __dfn_putCache(cache, dr);
-  dfa_build(dr, &a, cache);
+/* Push a new level on the filter's stacks, and return its state masks */
+static inline levMask *filterPush(DFAFilter *fc) {
+  size_t nmasks = fc->a->max + 1;
+  if (fc->depth == fc->cap) {
+    fc->cap *= 2;
+    fc->stack = rm_realloc(fc->stack, fc->cap * nmasks * sizeof(levMask));
+    fc->distStack = rm_realloc(fc->distStack, fc->cap * sizeof(int));
+  }
+  return fc->stack + fc->depth++ * nmasks;
+}
 
-  DFAFilter ret;
-  ret.cache = cache;
-  ret.stack = NewVector(dfaNode *, 8);
-  ret.distStack = NewVector(int, 8);
-  ret.a = a;
-  ret.prefixMode = prefixMode;
-  Vector_Push(ret.stack, dr);
-  Vector_Push(ret.distStack, (maxDist + 1));
+DFAFilter NewDFAFilter(rune *str, size_t len, int maxDist, int prefixMode) {
+  RS_LOG_ASSERT(len <= LEV_MAX_STRING_LEN, "Query too long for a Levenshtein automaton");
+  DFAFilter ret = {
+      .a = LevAutomaton_Acquire(str, len, maxDist),
+      .depth = 0,
+      .cap = DFA_FILTER_INITIAL_DEPTH,
+      .prefixMode = prefixMode,
+  };
+  ret.stack = rm_malloc(ret.cap * (maxDist + 1) * sizeof(levMask));
+  ret.distStack = rm_malloc(ret.cap * sizeof(int));
+
+  // before consuming any text, the first i runes of the query are within i edits (deletions)
+  levMask full = (ret.a->matchMask << 1) - 1;
+  levMask *state = filterPush(&ret);
+  for (int i = 0; i <= maxDist; i++) {
+    state[i] = i < LEV_MAX_STRING_LEN ? (((levMask)1 << (i + 1)) - 1) & full : full;
+  }
+  ret.distStack[0] = ret.a->len <= maxDist ? ret.a->len : maxDist + 1;
 
   return ret;
 }
 
 void DFAFilter_Free(DFAFilter *fc) {
-  for (int i = 0; i < Vector_Size(fc->cache); i++) {
-    dfaNode *dn;
-    Vector_Get(fc->cache, i, &dn);
-
-    if (dn) __dfaNode_free(dn);
-  }
-
-  Vector_Free(fc->cache);
-  Vector_Free(fc->stack);
-  Vector_Free(fc->distStack);
+  LevAutomaton_Release(fc->a);
+  rm_free(fc->stack);
+  rm_free(fc->distStack);
 }
 
 FilterCode FilterFunc(rune b, void *ctx, int *matched, void *matchCtx) {
   DFAFilter *fc = ctx;
-  dfaNode *dn;
-  int minDist;
-
-  Vector_Get(fc->stack, Vector_Size(fc->stack) - 1, &dn);
-  Vector_Get(fc->distStack, Vector_Size(fc->distStack) - 1, &minDist);
-
-  // a null node means we're in prefix mode, and we're done matching our prefix
-  if (dn == NULL) {
+  const LevAutomaton *a = fc->a;
+  const int k = a->max;
+  int dist = fc->distStack[fc->depth - 1];
+
+  levMask *next = filterPush(fc);
+  const levMask *cur = next - (k + 1);
+
+  // in prefix mode, once a prefix of the text matched and the automaton died out, everything
+  // below matches with the same distance
+  if (fc->prefixMode && dist <= k && cur[k] == 0) {
+    next[k] = 0;
+    fc->distStack[fc->depth - 1] = dist;
     *matched = 1;
-    Vector_Push(fc->stack, NULL);
-    Vector_Push(fc->distStack, minDist);
+    if (matchCtx) {
+      *(int *)matchCtx = dist;
+    }
     return F_CONTINUE;
   }
 
-  *matched = dn->match;
-
-  if (*matched) {
-    // printf("MATCH %c, dist %d\n", b, dn->distance);
-    int *pdist = matchCtx;
-    if (pdist) {
-      *pdist = MIN(dn->distance, minDist);
-    }
+  levMask full = (a->matchMask << 1) - 1;
+  levMask rm = LevAutomaton_RuneMask(a, runeFold(b));
+  // R'[i] = match | insertion | substitution | deletion
+  next[0] = (cur[0] << 1) & rm;
+  for (int i = 1; i <= k; i++) {
+    next[i] = (((cur[i] << 1) & rm) | cur[i - 1] | (cur[i - 1] << 1) | (next[i - 1] << 1)) & full;
   }
 
-  rune foldedRune = runeFold(b);
-
-  // get the next state change
-  dfaNode *next = __dfn_getEdge(dn, foldedRune);
-  if (!next) next = dn->fallback;
+  int d = 0;
+  while (d <= k && !(next[d] & a->matchMask)) {
+    d++;
+  }
+  if (fc->prefixMode) {
+    d = MIN(d, dist);
+  }
 
-  // we can continue - push the state on the stack
-  if (next) {
-    if (next->match) {
-      // printf("MATCH NEXT %c, dist %d\n", b, next->distance);
-      *matched = 1;
-      int *pdist = matchCtx;
-      if (pdist) {
-        *pdist = MIN(next->distance, minDist);
-      }
-      //    if (fc->prefixMode) next = NULL;
-    }
-    Vector_Push(fc->stack, next);
-    Vector_Push(fc->distStack, MIN(next->distance, minDist));
-    return F_CONTINUE;
-  } else if (fc->prefixMode && *matched) {
-    Vector_Push(fc->stack, NULL);
-    Vector_Push(fc->distStack, minDist);
-    return F_CONTINUE;
+  // a dead end - no continuation of the text can match
+  if (next[k] == 0 && d > k) {
+    fc->depth--;
+    *matched = 0;
+    return F_STOP;
   }
 
-  return F_STOP;
+  fc->distStack[fc->depth - 1] = d;
+  *matched = d <= k;
+  if (*matched && matchCtx) {
+    *(int *)matchCtx = d;
+  }
+  return F_CONTINUE;
 }
 
 void StackPop(void *ctx, int numLevels) {
   DFAFilter *fc = ctx;
-
-  for (int i = 0; i < numLevels; i++) {
-    Vector_Pop(fc->stack, NULL);
-    Vector_Pop(fc->distStack, NULL);
-  }
+  fc->depth -= numLevels;
 }
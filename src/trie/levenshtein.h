@@ -2,85 +2,96 @@
 #define __LEVENSHTEIN_H__
 
 #include <stdlib.h>
-#include "sparse_vector.h"
-#include "../rmutil/vector.h"
+#include <stdint.h>
 #include "trie.h"
+#include "../util/dllist.h"
 
-/*
-* SparseAutomaton is a C implementation of a levenshtein automaton using
-* sparse vectors, as described and implemented here:
-* http://julesjacobs.github.io/2015/06/17/disqus-levenshtein-simple-and-fast.html
-*
-* We then convert the automaton to a simple DFA that is faster to evaluate during the query stage.
-* This DFA is used while traversing a Trie to decide where to stop.
-*/
-typedef struct {
-    const rune *string;
-    size_t len;
-    int max;
-} SparseAutomaton;
-
-struct dfaEdge; 
-
-/* dfaNode is DFA graph node constructed using the Levenshtein automaton */
-typedef struct dfaNode {
-    int distance;
-
-    int match;
-    sparseVector *v;
-    struct dfaEdge *edges;
-    size_t numEdges;
-    struct dfaNode *fallback;
-} dfaNode;
-
-typedef struct dfaEdge {
-    dfaNode *n;
-    rune r;
-} dfaEdge;
-
-/* Get an edge for a dfa node given the next rune */
-dfaNode *__dfn_getEdge(dfaNode *n, rune r);
-
+#ifdef __cplusplus
+extern "C" {
+#endif
 
-/* Create a new DFA node */
-dfaNode *__newDfaNode(int distance, sparseVector *state);
-
-/* Recusively build the DFA node and all its descendants */
-void dfa_build(dfaNode *parent, SparseAutomaton *a, Vector *cache);
-
-/* Create a new Sparse Levenshtein Automaton  for string s and length len, with a maximal edit
- * distance of maxEdits */
-SparseAutomaton NewSparseAutomaton(const rune *s, size_t len, int maxEdits);
-
-/* Create the initial state vector of the root automaton node */
-sparseVector *SparseAutomaton_Start(SparseAutomaton *a);
-
-/* Step from a given state of the automaton to the next step given a specific character */
-sparseVector *SparseAutomaton_Step(SparseAutomaton *a, sparseVector *state, rune c);
-
-/* Is the current state of the automaton a match for the query? */
-int SparseAutomaton_IsMatch(SparseAutomaton *a, sparseVector *v);
-
-/* Can the current state lead to a possible match, or is this a dead end? */
-int SparseAutomaton_CanMatch(SparseAutomaton *a, sparseVector *v);
+/*
+ * LevAutomaton is a Levenshtein automaton for a query string, simulated bit-parallel as described
+ * by Wu & Manber and Baeza-Yates & Navarro. For a maximal edit distance k, the state of the
+ * automaton is k+1 bit masks R[0..k], where bit j of R[i] is set if the first j runes of the query
+ * are within i edits of the text consumed so far. Feeding the automaton a rune takes a few shifts
+ * and ORs per mask, and needs no allocations.
+ *
+ * The only thing we need to compile for a query is the mask of positions of each of its runes, so
+ * automata are cheap to build. Still, the same terms are looked up over and over by fuzzy queries
+ * and spell checks, so compiled automata are kept in a small LRU cache.
+ */
+
+/* A bit mask with one bit per query prefix length */
+typedef unsigned __int128 levMask;
+
+/* The maximal length of a query string, which must fit in a levMask along with the empty prefix.
+ * Longer queries are rejected; tries already reject queries longer than TRIE_MAX_PREFIX */
+#define LEV_MAX_STRING_LEN 127
+
+/* The number of compiled automata we keep in the cache */
+#define LEV_CACHE_SIZE 128
 
-/* DFAFilter is a constructed DFA used to filter the traversal on the trie */
 typedef struct {
-    // a cache of the DFA states, allowing us to re-use the same state whenever we need it
-    Vector *cache;
-    // A stack of the states leading up to the current state
-    Vector *stack;
-    // A stack of the minimal distance for each state, used for prefix matching
-    Vector *distStack;
-    // whether the filter works in prefix mode or not
-    int prefixMode;
-
-    SparseAutomaton a;
+  rune r;
+  levMask mask;
+} levRuneMask;
+
+typedef struct LevAutomaton {
+  // the folded query string
+  rune *string;
+  size_t len;
+  int max;
+  // the bit of the full query
+  levMask matchMask;
+
+  // the positions of the query runes: bit j is set if the rune is at position j-1 of the query.
+  // ASCII runes are looked up directly, the rest are sorted in runeMasks
+  levMask asciiMasks[128];
+  levRuneMask *runeMasks;
+  size_t numRuneMasks;
+
+  // cache bookkeeping, protected by the cache lock
+  uint64_t hash;
+  int refcount;
+  int cached;
+  DLLIST_node llnode;
+} LevAutomaton;
+
+/* Get the automaton for the string s and length len, with a maximal edit distance of maxEdits.
+ * The automaton is taken from the cache, or compiled and put in the cache. It must be released
+ * with LevAutomaton_Release when done. Returns NULL if the string is longer than
+ * LEV_MAX_STRING_LEN */
+LevAutomaton *LevAutomaton_Acquire(const rune *s, size_t len, int maxEdits);
+
+/* Release an automaton acquired with LevAutomaton_Acquire */
+void LevAutomaton_Release(LevAutomaton *a);
+
+/* Get the position mask of a rune in the query */
+levMask LevAutomaton_RuneMask(const LevAutomaton *a, rune r);
+
+/* Get the edit distance between the query and the string s, or a->max + 1 if it is larger than
+ * the maximal distance of the automaton */
+int LevAutomaton_Distance(const LevAutomaton *a, const rune *s, size_t len);
+
+/* DFAFilter runs a Levenshtein automaton to filter the traversal on the trie */
+typedef struct {
+  LevAutomaton *a;
+  // A stack of the states leading up to the current state, a->max + 1 masks per level
+  levMask *stack;
+  // A stack of the minimal distance of a text prefix matching the query, or a->max + 1 if there is
+  // none yet. Used for prefix matching
+  int *distStack;
+  // the number of levels in the stacks, and the number of levels allocated
+  size_t depth;
+  size_t cap;
+  // whether the filter works in prefix mode or not
+  int prefixMode;
 } DFAFilter;
 
 /* Create a new DFA filter  using a Levenshtein automaton, for the given string  and maximum
  * distance. If prefixMode is 1, we match prefixes within the given distance, and then continue
- * onwards to all suffixes. */
+ * onwards to all suffixes. The string must not be longer than LEV_MAX_STRING_LEN */
 DFAFilter NewDFAFilter(rune *str, size_t len, int maxDist, int prefixMode);
 
 /* A callback function for the DFA Filter, passed to the Trie iterator */
@@ -94,4 +105,7 @@ void StackPop(void *ctx, int numLevels);
  * is not freed by itself. */
 void DFAFilter_Free(DFAFilter *fc);
 
-#endif
\ No newline at end of file
+#ifdef __cplusplus
+}
+#endif
+#endif
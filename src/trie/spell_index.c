@@ -0,0 +1,328 @@
+#include <string.h>
+#include <sys/param.h>
+#include "spell_index.h"
+#include "levenshtein.h"
+#include "rune_util.h"
+#include "trie.h"
+#include "rmalloc.h"
+#include "util/arr.h"
+#include "util/fnv.h"
+#include "util/khash.h"
+
+// the maximal number of deletions of a prefix: sum(C(7, i)) for i <= 3
+#define SPELL_MAX_DELETES 64
+
+// a deletion pointing to more than one string holds an index into the lists array, with this flag
+#define SPELL_LIST_FLAG (1ULL << 63)
+
+KHASH_MAP_INIT_INT64(spellTerms, uint32_t);
+KHASH_MAP_INIT_INT64(spellDeletes, uint64_t);
+
+typedef struct {
+  char *str;
+  uint32_t len;
+  uint8_t deleted;
+  uint8_t hasScore;
+  // the deletions of the string are not generated yet
+  uint8_t queued;
+  double score;
+} spellTerm;
+
+struct SpellIndex {
+  int maxDist;
+  // the hash of a string to its id. Colliding strings are put under the next free hash
+  khash_t(spellTerms) * terms;
+  // the hash of a deletion to the string(s) it was generated from
+  khash_t(spellDeletes) * deletes;
+  spellTerm *strings;
+  uint32_t **lists;
+  size_t memUsage;
+  // the number of queued strings, and the lowest id among them
+  size_t numQueued;
+  size_t nextQueued;
+};
+
+SpellIndex *NewSpellIndex(int maxDist) {
+  SpellIndex *idx = rm_calloc(1, sizeof(*idx));
+  idx->maxDist = MIN(maxDist, SPELL_INDEX_MAX_DIST);
+  idx->terms = kh_init(spellTerms);
+  idx->deletes = kh_init(spellDeletes);
+  idx->strings = array_new(spellTerm, 64);
+  idx->lists = array_new(uint32_t *, 16);
+  idx->memUsage = sizeof(*idx);
+  return idx;
+}
+
+void SpellIndex_Free(SpellIndex *idx) {
+  for (size_t i = 0; i < array_len(idx->strings); i++) {
+    rm_free(idx->strings[i].str);
+  }
+  array_free(idx->strings);
+  array_free_ex(idx->lists, array_free(*(uint32_t **)ptr));
+  kh_destroy(spellTerms, idx->terms);
+  kh_destroy(spellDeletes, idx->deletes);
+  rm_free(idx);
+}
+
+size_t SpellIndex_MemUsage(const SpellIndex *idx) {
+  return idx->memUsage + array_len(idx->strings) * sizeof(spellTerm) +
+         kh_n_buckets(idx->terms) * (sizeof(uint64_t) + sizeof(uint32_t)) +
+         kh_n_buckets(idx->deletes) * 2 * sizeof(uint64_t);
+}
+
+int SpellIndex_MaxDist(const SpellIndex *idx) {
+  return idx->maxDist;
+}
+
+/* Find the id of a string. Returns -1 if it is not in the index. If slot is given, it is set to
+ * the hash the string is (or should be) put under */
+static int64_t spellFindString(const SpellIndex *idx, const char *s, size_t len, uint64_t *slot) {
+  uint64_t h = fnv_64a_buf((void *)s, len, 0);
+  for (;; h++) {
+    khiter_t k = kh_get(spellTerms, idx->terms, h);
+    if (k == kh_end(idx->terms)) {
+      break;
+    }
+    const spellTerm *t = &idx->strings[kh_value(idx->terms, k)];
+    if (t->len == len && !memcmp(t->str, s, len)) {
+      return kh_value(idx->terms, k);
+    }
+  }
+  if (slot) {
+    *slot = h;
+  }
+  return -1;
+}
+
+/* Decode and fold a string into runes. Returns 0 if it is too long to be indexed */
+static int spellToRunes(const char *s, size_t len, rune *out, size_t *rlen) {
+  if (len > TRIE_INITIAL_STRING_LEN * sizeof(rune)) {
+    return 0;
+  }
+  *rlen = strToRunesN(s, len, out);
+  if (*rlen > TRIE_MAX_PREFIX) {
+    return 0;
+  }
+  for (size_t i = 0; i < *rlen; i++) {
+    out[i] = runeFold(out[i]);
+  }
+  return 1;
+}
+
+typedef struct {
+  uint64_t hashes[SPELL_MAX_DELETES];
+  size_t n;
+} spellDeletesSet;
+
+/* Collect the hashes of all the strings we get by deleting up to maxDist runes from s. A string
+ * reached twice is only expanded once */
+static void genDeletes(const rune *s, size_t len, int maxDist, spellDeletesSet *out) {
+  uint64_t h = fnv_64a_buf((void *)s, len * sizeof(rune), 0);
+  for (size_t i = 0; i < out->n; i++) {
+    if (out->hashes[i] == h) {
+      return;
+    }
+  }
+  if (out->n == SPELL_MAX_DELETES) {
+    return;
+  }
+  out->hashes[out->n++] = h;
+  if (maxDist == 0 || len == 0) {
+    return;
+  }
+
+  rune buf[SPELL_INDEX_PREFIX_LEN];
+  for (size_t i = 0; i < len; i++) {
+    memcpy(buf, s, i * sizeof(rune));
+    memcpy(buf + i, s + i + 1, (len - i - 1) * sizeof(rune));
+    genDeletes(buf, len - 1, maxDist - 1, out);
+  }
+}
+
+static void spellAddDelete(SpellIndex *idx, uint64_t h, uint32_t id) {
+  int rc;
+  khiter_t k = kh_put(spellDeletes, idx->deletes, h, &rc);
+  if (rc != 0) {
+    kh_value(idx->deletes, k) = id;
+    return;
+  }
+  uint64_t v = kh_value(idx->deletes, k);
+  if (v & SPELL_LIST_FLAG) {
+    uint32_t **l = &idx->lists[v & ~SPELL_LIST_FLAG];
+    idx->memUsage -= array_len(*l) * sizeof(uint32_t);
+    *l = array_append(*l, id);
+    idx->memUsage += array_len(*l) * sizeof(uint32_t);
+  } else {
+    uint32_t *l = array_new(uint32_t, 2);
+    l = array_append(l, (uint32_t)v);
+    l = array_append(l, id);
+    kh_value(idx->deletes, k) = array_len(idx->lists) | SPELL_LIST_FLAG;
+    idx->lists = array_append(idx->lists, l);
+    idx->memUsage += sizeof(array_hdr_t) + 2 * sizeof(uint32_t);
+  }
+}
+
+static void spellAddDeletes(SpellIndex *idx, uint32_t id, const rune *runes, size_t rlen) {
+  spellDeletesSet dels = {.n = 0};
+  genDeletes(runes, MIN(rlen, SPELL_INDEX_PREFIX_LEN), idx->maxDist, &dels);
+  for (size_t i = 0; i < dels.n; i++) {
+    spellAddDelete(idx, dels.hashes[i], id);
+  }
+}
+
+/* Add a string to the index, generating its deletions unless it is queued */
+static void spellAdd(SpellIndex *idx, const char *s, size_t len, int queue) {
+  int64_t id = spellFindString(idx, s, len, NULL);
+  if (id >= 0) {
+    // a deleted string keeps its deletions, we only need to revive it
+    idx->strings[id].deleted = 0;
+    return;
+  }
+
+  rune runes[TRIE_INITIAL_STRING_LEN * sizeof(rune) + 1];
+  size_t rlen;
+  if (!spellToRunes(s, len, runes, &rlen)) {
+    return;
+  }
+
+  uint64_t slot;
+  spellFindString(idx, s, len, &slot);
+  uint32_t newId = array_len(idx->strings);
+  spellTerm t = {.str = rm_malloc(len), .len = len, .queued = queue};
+  memcpy(t.str, s, len);
+  idx->strings = array_append(idx->strings, t);
+  idx->memUsage += len;
+  int rc;
+  khiter_t k = kh_put(spellTerms, idx->terms, slot, &rc);
+  kh_value(idx->terms, k) = newId;
+
+  if (queue) {
+    if (!idx->numQueued++) {
+      idx->nextQueued = newId;
+    }
+  } else {
+    spellAddDeletes(idx, newId, runes, rlen);
+  }
+}
+
+void SpellIndex_Add(SpellIndex *idx, const char *s, size_t len) {
+  spellAdd(idx, s, len, 0);
+}
+
+void SpellIndex_Queue(SpellIndex *idx, const char *s, size_t len) {
+  spellAdd(idx, s, len, 1);
+}
+
+int SpellIndex_Build(SpellIndex *idx, size_t n) {
+  for (; idx->numQueued && n; idx->nextQueued++) {
+    spellTerm *t = &idx->strings[idx->nextQueued];
+    if (!t->queued) {
+      continue;
+    }
+    rune runes[TRIE_INITIAL_STRING_LEN * sizeof(rune) + 1];
+    size_t rlen;
+    spellToRunes(t->str, t->len, runes, &rlen);
+    spellAddDeletes(idx, idx->nextQueued, runes, rlen);
+    t->queued = 0;
+    idx->numQueued--;
+    n--;
+  }
+  return !idx->numQueued;
+}
+
+int SpellIndex_IsBuilt(const SpellIndex *idx) {
+  return !idx->numQueued;
+}
+
+void SpellIndex_Delete(SpellIndex *idx, const char *s, size_t len) {
+  int64_t id = spellFindString(idx, s, len, NULL);
+  if (id >= 0) {
+    idx->strings[id].deleted = 1;
+    idx->strings[id].hasScore = 0;
+  }
+}
+
+static int cmpIds(const void *p1, const void *p2) {
+  uint32_t a = *(const uint32_t *)p1, b = *(const uint32_t *)p2;
+  return a < b ? -1 : a > b ? 1 : 0;
+}
+
+size_t SpellIndex_Find(SpellIndex *idx, const char *s, size_t len, int maxDist,
+                       SpellIndexCallback cb, void *ctx) {
+  rune runes[TRIE_INITIAL_STRING_LEN * sizeof(rune) + 1];
+  size_t rlen;
+  if (!spellToRunes(s, len, runes, &rlen) || rlen > LEV_MAX_STRING_LEN) {
+    return 0;
+  }
+  maxDist = MIN(maxDist, idx->maxDist);
+
+  spellDeletesSet dels = {.n = 0};
+  genDeletes(runes, MIN(rlen, SPELL_INDEX_PREFIX_LEN), maxDist, &dels);
+
+  // collect the candidates of all the deletions, each one once
+  uint32_t *cands = array_new(uint32_t, 16);
+  for (size_t i = 0; i < dels.n; i++) {
+    khiter_t k = kh_get(spellDeletes, idx->deletes, dels.hashes[i]);
+    if (k == kh_end(idx->deletes)) {
+      continue;
+    }
+    uint64_t v = kh_value(idx->deletes, k);
+    if (v & SPELL_LIST_FLAG) {
+      uint32_t *l = idx->lists[v & ~SPELL_LIST_FLAG];
+      cands = array_ensure_append(cands, l, array_len(l), uint32_t);
+    } else {
+      cands = array_append(cands, (uint32_t)v);
+    }
+  }
+  qsort(cands, array_len(cands), sizeof(*cands), cmpIds);
+
+  size_t found = 0;
+  LevAutomaton *a = LevAutomaton_Acquire(runes, rlen, maxDist);
+  rune crunes[TRIE_INITIAL_STRING_LEN * sizeof(rune) + 1];
+  for (size_t i = 0; i < array_len(cands); i++) {
+    if (i > 0 && cands[i] == cands[i - 1]) {
+      continue;
+    }
+    const spellTerm *t = &idx->strings[cands[i]];
+    if (t->deleted) {
+      continue;
+    }
+    // the strings of candidates are close in length to the query, which is short enough
+    size_t clen = strToRunesN(t->str, t->len, crunes);
+    if (clen > rlen + maxDist || clen + maxDist < rlen) {
+      continue;
+    }
+    int d = LevAutomaton_Distance(a, crunes, clen);
+    if (d <= maxDist) {
+      cb(t->str, t->len, d, ctx);
+      found++;
+    }
+  }
+  LevAutomaton_Release(a);
+  array_free(cands);
+  return found;
+}
+
+int SpellIndex_GetScore(const SpellIndex *idx, const char *s, size_t len, double *score) {
+  int64_t id = spellFindString(idx, s, len, NULL);
+  if (id < 0 || !idx->strings[id].hasScore) {
+    return 0;
+  }
+  *score = idx->strings[id].score;
+  return 1;
+}
+
+void SpellIndex_SetScore(SpellIndex *idx, const char *s, size_t len, double score) {
+  int64_t id = spellFindString(idx, s, len, NULL);
+  if (id >= 0 && !idx->strings[id].deleted) {
+    idx->strings[id].score = score;
+    idx->strings[id].hasScore = 1;
+  }
+}
+
+void SpellIndex_InvalidateScore(SpellIndex *idx, const char *s, size_t len) {
+  int64_t id = spellFindString(idx, s, len, NULL);
+  if (id >= 0) {
+    idx->strings[id].hasScore = 0;
+  }
+}
@@ -0,0 +1,75 @@
+#ifndef __SPELL_INDEX_H__
+#define __SPELL_INDEX_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* SpellIndex is a symmetric-delete (SymSpell) index over the strings of a trie, used to find the
+ * spelling suggestions of a term without traversing the trie.
+ *
+ * Every string is indexed under all the strings we get by deleting up to maxDist runes from its
+ * (folded) prefix of SPELL_INDEX_PREFIX_LEN runes. Two strings within an edit distance of d always
+ * share a string we get by deleting at most d runes from each of them, so the candidates for a
+ * term are found with a few hash lookups of its own deletions. Candidates are then checked with a
+ * Levenshtein automaton.
+ *
+ * Generating the deletions is most of the cost of indexing a string, so a large index is built by
+ * queueing its strings first, and then generating their deletions a few strings at a time.
+ *
+ * Every indexed string also has a score slot, which FT.SPELLCHECK uses to cache the document
+ * frequency of the index terms. */
+
+#define SPELL_INDEX_PREFIX_LEN 7
+#define SPELL_INDEX_MAX_DIST 3
+
+typedef struct SpellIndex SpellIndex;
+
+/* Create a new index serving queries of up to maxDist edits */
+SpellIndex *NewSpellIndex(int maxDist);
+void SpellIndex_Free(SpellIndex *idx);
+size_t SpellIndex_MemUsage(const SpellIndex *idx);
+
+/* The maximal distance of queries the index can serve */
+int SpellIndex_MaxDist(const SpellIndex *idx);
+
+/* Add a string to the index. Adding an existing string does nothing */
+void SpellIndex_Add(SpellIndex *idx, const char *s, size_t len);
+
+/* Add a string to the index without generating its deletions: SpellIndex_Find does not find it
+ * until SpellIndex_Build gets to it. Adding an existing string does nothing */
+void SpellIndex_Queue(SpellIndex *idx, const char *s, size_t len);
+
+/* Generate the deletions of up to n queued strings, in the order they were queued. Returns 1 once
+ * no string is queued */
+int SpellIndex_Build(SpellIndex *idx, size_t n);
+
+/* Whether the deletions of all the strings were generated */
+int SpellIndex_IsBuilt(const SpellIndex *idx);
+
+/* Remove a string from the index */
+void SpellIndex_Delete(SpellIndex *idx, const char *s, size_t len);
+
+typedef void (*SpellIndexCallback)(const char *s, size_t len, int dist, void *ctx);
+
+/* Call the callback for every string in the index within maxDist edits of s, which must not be
+ * larger than the maximal distance of the index. Returns the number of strings found */
+size_t SpellIndex_Find(SpellIndex *idx, const char *s, size_t len, int maxDist,
+                       SpellIndexCallback cb, void *ctx);
+
+/* Get the cached score of a string. Returns 0 if the string is not indexed or has no score */
+int SpellIndex_GetScore(const SpellIndex *idx, const char *s, size_t len, double *score);
+
+/* Cache the score of an indexed string */
+void SpellIndex_SetScore(SpellIndex *idx, const char *s, size_t len, double score);
+
+/* Drop the cached score of a string */
+void SpellIndex_InvalidateScore(SpellIndex *idx, const char *s, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -1,9 +1,9 @@
 #include <sys/param.h>
 #include "trie.h"
 #include "util/bsearch.h"
-#include "sparse_vector.h"
 #include "redisearch.h"
 #include "util/arr.h"
+#include "compact_trie.h"
 
 size_t __trieNode_Sizeof(t_len numChildren, t_len slen) {
   return sizeof(TrieNode) + numChildren * sizeof(TrieNode *) + sizeof(rune) * (slen + 1);
@@ -210,6 +210,8 @@ int TrieNode_Add(TrieNode **np, rune *str, t_len len, RSPayload *payload, float
     if (str[offset] == child->str[0]) {
       int rc = TrieNode_Add(&child, str + offset, len - offset, payload, score, op);
       __trieNode_children(n)[i] = child;
+      // in increment mode the new score of the entry is only known below
+      n->maxChildScore = MAX(n->maxChildScore, MAX(child->score, child->maxChildScore));
       return rc;
     }
   }
@@ -258,6 +260,36 @@ float TrieNode_Find(TrieNode *n, rune *str, t_len len) {
   return 0;
 }
 
+TrieNode *TrieNode_Get(TrieNode *n, const rune *str, t_len len) {
+  t_len offset = 0;
+  while (n) {
+    t_len localOffset = 0;
+    for (; offset < len && localOffset < n->len; offset++, localOffset++) {
+      if (str[offset] != n->str[localOffset]) {
+        return NULL;
+      }
+    }
+    if (localOffset < n->len) {
+      // the string ended inside the node
+      return NULL;
+    }
+    if (offset == len) {
+      return __trieNode_isTerminal(n) && !__trieNode_isDeleted(n) ? n : NULL;
+    }
+
+    TrieNode *next = NULL;
+    for (t_len i = 0; i < n->numChildren; i++) {
+      TrieNode *child = __trieNode_children(n)[i];
+      if (str[offset] == child->str[0]) {
+        next = child;
+        break;
+      }
+    }
+    n = next;
+  }
+  return NULL;
+}
+
 void __trieNode_sortChildren(TrieNode *n);
 
 /* Optimize the node and its children:
@@ -281,7 +313,7 @@ void __trieNode_optimizeChildren(TrieNode *n) {
       // just "fill" the hole with the next node up
       while (i < n->numChildren - 1) {
         nodes[i] = nodes[i + 1];
-        n->maxChildScore = MAX(n->maxChildScore, nodes[i]->maxChildScore);
+        n->maxChildScore = MAX(n->maxChildScore, MAX(nodes[i]->score, nodes[i]->maxChildScore));
         i++;
       }
       // reduce child count
@@ -293,7 +325,7 @@ void __trieNode_optimizeChildren(TrieNode *n) {
       if (nodes[i] && nodes[i]->numChildren == 1) {
         nodes[i] = __trieNode_MergeWithSingleChild(nodes[i]);
       }
-      n->maxChildScore = MAX(n->maxChildScore, nodes[i]->maxChildScore);
+      n->maxChildScore = MAX(n->maxChildScore, MAX(nodes[i]->score, nodes[i]->maxChildScore));
     }
     i++;
   }
@@ -401,6 +433,20 @@ inline void __ti_Push(TrieIterator *it, TrieNode *node, int skipped) {
     sn->stringOffset = 0;
     sn->isSkipped = skipped;
     sn->n = node;
+    sn->cn = NULL;
+    sn->state = ITERSTATE_SELF;
+  }
+}
+
+/* Push a node of a frozen layer on the iterator's stack */
+static inline void __ti_PushCompact(TrieIterator *it, const CompactTrieNode *node) {
+  if (it->stackOffset < TRIE_INITIAL_STRING_LEN - 1) {
+    stackNode *sn = &it->stack[it->stackOffset++];
+    sn->childOffset = 0;
+    sn->stringOffset = 0;
+    sn->isSkipped = 0;
+    sn->n = NULL;
+    sn->cn = node;
     sn->state = ITERSTATE_SELF;
   }
 }
@@ -423,6 +469,18 @@ inline int __ti_step(TrieIterator *it, void *matchCtx) {
   }
 
   stackNode *current = __ti_current(it);
+  const rune *nstr;
+  t_len nlen;
+  uint8_t nflags;
+  if (current->cn) {
+    nstr = it->ct->runes + current->cn->str;
+    nlen = current->cn->len;
+    nflags = current->cn->flags;
+  } else {
+    nstr = current->n->str;
+    nlen = current->n->len;
+    nflags = current->n->flags;
+  }
 
   int matched = 0;
   // printf("[%.*s]current %p (%.*s %f), state %d, string offset %d/%d, child
@@ -438,9 +496,9 @@ inline int __ti_step(TrieIterator *it, void *matchCtx) {
 
     case ITERSTATE_SELF:
 
-      if (current->stringOffset < current->n->len) {
+      if (current->stringOffset < nlen) {
         // get the current rune to feed the filter
-        rune b = current->n->str[current->stringOffset];
+        rune b = nstr[current->stringOffset];
 
         if (it->filter) {
           // run the next character in the filter
@@ -466,8 +524,8 @@ inline int __ti_step(TrieIterator *it, void *matchCtx) {
         // if we don't have a filter, a "match" is when we reach the end of the
         // node
         if (!it->filter) {
-          if (current->n->len > 0 && current->stringOffset == current->n->len &&
-              __trieNode_isTerminal(current->n) && !__trieNode_isDeleted(current->n)) {
+          if (nlen > 0 && current->stringOffset == nlen && (nflags & TRIENODE_TERMINAL) &&
+              !(nflags & TRIENODE_DELETED)) {
             matched = 1;
           }
         }
@@ -480,6 +538,23 @@ inline int __ti_step(TrieIterator *it, void *matchCtx) {
 
     case ITERSTATE_CHILDREN:
     default:
+      if (current->cn) {
+        const CompactTrieNode *cn = current->cn;
+        if (current->childOffset < cn->numChildren) {
+          const CompactTrieNode *ch = &it->ct->nodes[cn->children + current->childOffset++];
+          if (ch->maxChildScore >= it->minScore || ch->score >= it->minScore) {
+            __ti_PushCompact(it, ch);
+            it->nodesConsumed++;
+          } else {
+            // the children are sorted by their best score, so none of the next ones can do better
+            it->nodesSkipped += cn->numChildren - current->childOffset + 1;
+            current->childOffset = cn->numChildren;
+          }
+        } else {
+          __ti_Pop(it);
+        }
+        break;
+      }
       if (current->n->sortmode != TRIENODE_SORTED_SCORE) {
         __trieNode_sortChildren(current->n);
       }
@@ -518,33 +593,75 @@ void TrieIterator_Free(TrieIterator *it) {
   rm_free(it);
 }
 
+TrieIterator *CompactTrie_Iterate(const CompactTrie *t, StepFilter f, StackPopCallback pf,
+                                  void *ctx) {
+  TrieIterator *it = rm_calloc(1, sizeof(TrieIterator));
+  it->filter = f;
+  it->popCallback = pf;
+  it->minScore = 0;
+  it->ctx = ctx;
+  it->ct = t;
+  __ti_PushCompact(it, t->nodes);
+
+  return it;
+}
+
 int TrieIterator_Next(TrieIterator *it, rune **ptr, t_len *len, RSPayload *payload, float *score,
                       void *matchCtx) {
   int rc;
-  while ((rc = __ti_step(it, matchCtx)) != __STEP_STOP) {
-    if (rc == __STEP_MATCH) {
+  while (1) {
+    while ((rc = __ti_step(it, matchCtx)) != __STEP_STOP) {
+      if (rc != __STEP_MATCH) {
+        continue;
+      }
       stackNode *sn = __ti_current(it);
-
-      if (__trieNode_isTerminal(sn->n) && sn->n->len == sn->stringOffset &&
-          !__trieNode_isDeleted(sn->n)) {
-        *ptr = it->buf;
-        *len = it->bufOffset;
+      const TriePayload *pl;
+      if (sn->cn) {
+        if (!__ctrieNode_isTerminal(sn->cn) || sn->cn->len != sn->stringOffset ||
+            __ctrieNode_isDeleted(sn->cn)) {
+          continue;
+        }
+        *score = sn->cn->score;
+        pl = CompactTrie_Payload(it->ct, sn->cn);
+      } else {
+        if (!__trieNode_isTerminal(sn->n) || sn->n->len != sn->stringOffset ||
+            __trieNode_isDeleted(sn->n)) {
+          continue;
+        }
         *score = sn->n->score;
-        if (payload != NULL) {
-          if (sn->n->payload != NULL) {
-            payload->data = sn->n->payload->data;
-            payload->len = sn->n->payload->len;
-          } else {
-            payload->data = NULL;
-            payload->len = 0;
-          }
+        pl = sn->n->payload;
+      }
+
+      *ptr = it->buf;
+      *len = it->bufOffset;
+      if (payload != NULL) {
+        if (pl != NULL) {
+          payload->data = (char *)pl->data;
+          payload->len = pl->len;
+        } else {
+          payload->data = NULL;
+          payload->len = 0;
         }
-        return 1;
       }
+      return 1;
     }
-  }
 
-  return 0;
+    // we're done with this layer. Move on to the next one, if there is one. The filter's state is
+    // back at the root by now, since every node we've pushed was also popped
+    it->bufOffset = 0;
+    if (it->nextRoot) {
+      it->ct = NULL;
+      __ti_Push(it, it->nextRoot, 0);
+      it->nextRoot = NULL;
+      continue;
+    }
+    if (!it->nextLayer) {
+      return 0;
+    }
+    it->ct = it->nextLayer;
+    it->nextLayer = NULL;
+    __ti_PushCompact(it, it->ct->nodes);
+  }
 }
 
 TrieNode *TrieNode_RandomWalk(TrieNode *n, int minSteps, rune **str, t_len *len) {
@@ -858,3 +975,63 @@ void TrieNode_IterateRange(TrieNode *n, const rune *min, int nmin, bool includeM
   rangeIterate(n, min, nmin, max, nmax, &r);
   array_free(r.buf);
 }
+
+typedef struct {
+  const rune *min;
+  int nmin;
+  TrieWalkCallback *callback;
+  void *cbctx;
+  rune *buf;
+  // the children of the nodes on the walked path, each in lexical order
+  TrieNode **children;
+} WalkCtx;
+
+/* Walk the subtree of n, bounded by min if bounded is set. Returns nonzero once the walk stops */
+static int walkFrom(TrieNode *n, WalkCtx *w, int bounded) {
+  w->buf = array_ensure_append(w->buf, n->str, n->len, rune);
+  size_t blen = array_len(w->buf);
+  int rc = 0;
+
+  // Every string in this subtree starts with buf. Once buf is above min, so is the whole subtree.
+  // If it is below min without being a prefix of it, the whole subtree is out of range
+  if (bounded && runecmp(w->buf, blen, w->min, w->nmin) > 0) {
+    bounded = 0;
+  } else if (bounded && (blen > (size_t)w->nmin || memcmp(w->buf, w->min, blen * sizeof(rune)))) {
+    goto clean_stack;
+  }
+
+  if (!bounded && __trieNode_isTerminal(n) && !__trieNode_isDeleted(n)) {
+    rc = w->callback(w->buf, blen, w->cbctx);
+    if (rc) {
+      goto clean_stack;
+    }
+  }
+
+  size_t first = array_len(w->children);
+  w->children = array_ensure_append(w->children, __trieNode_children(n), n->numChildren,
+                                    TrieNode *);
+  qsort(w->children + first, n->numChildren, sizeof(TrieNode *), cmpLexFull);
+  for (t_len ii = 0; ii < n->numChildren && !rc; ++ii) {
+    rc = walkFrom(w->children[first + ii], w, bounded);
+  }
+  array_trimm_len(w->children, first);
+
+clean_stack:
+  array_trimm_len(w->buf, array_len(w->buf) - n->len);
+  return rc;
+}
+
+void TrieNode_WalkFrom(TrieNode *n, const rune *min, int nmin, TrieWalkCallback callback,
+                       void *ctx) {
+  WalkCtx w = {
+      .min = min,
+      .nmin = nmin,
+      .callback = callback,
+      .cbctx = ctx,
+  };
+  w.buf = array_new(rune, TRIE_INITIAL_STRING_LEN);
+  w.children = array_new(TrieNode *, 16);
+  walkFrom(n, &w, min != NULL);
+  array_free(w.buf);
+  array_free(w.children);
+}
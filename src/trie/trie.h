@@ -114,6 +114,10 @@ int TrieNode_Add(TrieNode **n, rune *str, t_len len, RSPayload *payload, float s
  * Note that you cannot put entries with zero score */
 float TrieNode_Find(TrieNode *n, rune *str, t_len len);
 
+/* Find the node of a live entry with a given string and length. Returns NULL if the entry was not
+ * found or was deleted */
+TrieNode *TrieNode_Get(TrieNode *n, const rune *str, t_len len);
+
 /* Mark a node as deleted. For simplicity for now we don't actually delete
  * anything,
  * but the node will not be persisted to disk, thus deleted after reload.
@@ -123,10 +127,15 @@ int TrieNode_Delete(TrieNode *n, rune *str, t_len len);
 /* Free the trie's root and all its children recursively */
 void TrieNode_Free(TrieNode *n);
 
+struct CompactTrie;
+struct CompactTrieNode;
+
 /* trie iterator stack node. for internal use only */
 typedef struct {
   int state;
   TrieNode *n;
+  // the node, if we're iterating a frozen layer (see compact_trie.h). n is NULL in that case
+  const struct CompactTrieNode *cn;
   t_len stringOffset;
   t_len childOffset;
   int isSkipped;
@@ -160,6 +169,12 @@ typedef struct TrieIterator {
   int nodesSkipped;
   StackPopCallback popCallback;
   void *ctx;
+  // the frozen layer we're iterating, if any
+  const struct CompactTrie *ct;
+  // a mutable layer to iterate once we are done with the current one, before nextLayer
+  TrieNode *nextRoot;
+  // a frozen layer to iterate once we are done with the current one
+  const struct CompactTrie *nextLayer;
 } TrieIterator;
 
 /* push a new trie iterator stack node  */
@@ -191,6 +206,10 @@ int __ti_step(TrieIterator *it, void *matchCtx);
  * continue iterating the entire trie. ctx is the filter's context */
 TrieIterator *TrieNode_Iterate(TrieNode *n, StepFilter f, StackPopCallback pf, void *ctx);
 
+/* Iterate a frozen trie layer with a step filter, see TrieNode_Iterate */
+TrieIterator *CompactTrie_Iterate(const struct CompactTrie *t, StepFilter f, StackPopCallback pf,
+                                  void *ctx);
+
 /* Free a trie iterator */
 void TrieIterator_Free(TrieIterator *it);
 
@@ -219,6 +238,15 @@ void TrieNode_IterateRange(TrieNode *n, const rune *min, int minlen, bool includ
                            const rune *max, int maxlen, bool includeMax, TrieRangeCallback callback,
                            void *ctx);
 
+/* A callback walking the entries of a trie, returning nonzero to stop the walk */
+typedef int(TrieWalkCallback)(const rune *, size_t, void *);
+
+/* Walk the live entries greater than min (all of them if min is NULL) in lexical order, until the
+ * callback stops the walk. Unlike TrieNode_IterateRange, the order of the children of the nodes is
+ * left as is */
+void TrieNode_WalkFrom(TrieNode *n, const rune *min, int nmin, TrieWalkCallback callback,
+                       void *ctx);
+
 #ifdef __cplusplus
 }
 #endif
@@ -3,6 +3,7 @@
 #include "../rmutil/util.h"
 #include "../util/heap.h"
 #include "../util/misc.h"
+#include "../util/arr.h"
 #include "rune_util.h"
 
 #include "trie_type.h"
@@ -14,15 +15,270 @@
 #include <limits.h>
 #include "rmalloc.h"
 
+static TrieNode *newTrieRoot() {
+  rune *rs = strToRunes("", 0);
+  TrieNode *root = __newTrieNode(rs, 0, 0, NULL, 0, 0, 0, 0);
+  rm_free(rs);
+  return root;
+}
+
 Trie *NewTrie() {
   Trie *tree = rm_malloc(sizeof(Trie));
-  rune *rs = strToRunes("", 0);
-  tree->root = __newTrieNode(rs, 0, 0, NULL, 0, 0, 0, 0);
+  tree->root = newTrieRoot();
+  tree->frozen = NULL;
+  tree->sealed = NULL;
   tree->size = 0;
-  rm_free(rs);
+  tree->spellIdx = NULL;
+  tree->spellIdxMaxMem = 0;
+  tree->spellIdxOutgrew = 0;
+  tree->spellQueueing = 0;
+  tree->spellCursor = NULL;
+  tree->spellCursorLen = 0;
+  tree->merge = NULL;
   return tree;
 }
 
+/* Iterate all the layers of the trie - first the mutable one, then the sealed and frozen ones */
+static TrieIterator *trieIterate(Trie *t, StepFilter f, StackPopCallback pf, void *ctx) {
+  TrieIterator *it = TrieNode_Iterate(t->root, f, pf, ctx);
+  it->nextRoot = t->sealed;
+  it->nextLayer = t->frozen;
+  return it;
+}
+
+typedef struct {
+  rune *str;
+  t_len len;
+} trieDeletedEntry;
+
+typedef struct TrieMerge {
+  // the frozen entries left to move to the delta, or NULL once they were all moved
+  TrieIterator *it;
+  // the layout of the sealed delta, once the frozen entries were moved
+  CompactTrieBuilder *builder;
+  // the number of live entries in the sealed delta
+  size_t sealedSize;
+  // the entries deleted from the sealed delta since it was sealed, which the layout may have
+  // missed
+  trieDeletedEntry *deleted;
+} TrieMerge;
+
+/* Seal the delta, and start laying it out as the next frozen layer */
+static void trieMergeSeal(Trie *t) {
+  TrieMerge *m = t->merge;
+  t->sealed = t->root;
+  t->root = newTrieRoot();
+  m->sealedSize = t->size;
+  m->builder = NewCompactTrieBuilder(t->sealed);
+}
+
+static void trieMergeStart(Trie *t) {
+  TrieMerge *m = rm_calloc(1, sizeof(*m));
+  m->deleted = array_new(trieDeletedEntry, 8);
+  t->merge = m;
+  if (t->frozen) {
+    m->it = CompactTrie_Iterate(t->frozen, NULL, NULL, NULL);
+  } else {
+    trieMergeSeal(t);
+  }
+}
+
+static void trieMergeFree(TrieMerge *m) {
+  if (m->it) {
+    TrieIterator_Free(m->it);
+  }
+  if (m->builder) {
+    CompactTrieBuilder_Free(m->builder);
+  }
+  for (size_t i = 0; i < array_len(m->deleted); i++) {
+    rm_free(m->deleted[i].str);
+  }
+  array_free(m->deleted);
+  rm_free(m);
+}
+
+/* Advance the ongoing merge by up to steps entries or nodes */
+static void trieMergeStep(Trie *t, size_t steps) {
+  TrieMerge *m = t->merge;
+  while (m->it && steps) {
+    rune *rstr;
+    t_len len;
+    float score;
+    RSPayload payload = {.data = NULL, .len = 0};
+    if (!TrieIterator_Next(m->it, &rstr, &len, &payload, &score, NULL)) {
+      // every frozen entry is in the delta now
+      TrieIterator_Free(m->it);
+      m->it = NULL;
+      CompactTrie_Free(t->frozen);
+      t->frozen = NULL;
+      trieMergeSeal(t);
+      break;
+    }
+    // the iterator is not affected by marking its current entry as deleted
+    TrieNode_Add(&t->root, rstr, len, payload.len ? &payload : NULL, score, ADD_REPLACE);
+    CompactTrie_Delete(t->frozen, rstr, len);
+    steps--;
+  }
+
+  if (!m->builder || !steps) {
+    return;
+  }
+  CompactTrie *ct = CompactTrieBuilder_Step(m->builder, steps);
+  if (!ct) {
+    return;
+  }
+  m->builder = NULL;
+  for (size_t i = 0; i < array_len(m->deleted); i++) {
+    CompactTrie_Delete(ct, m->deleted[i].str, m->deleted[i].len);
+  }
+  t->frozen = ct;
+  TrieNode_Free(t->sealed);
+  t->sealed = NULL;
+  trieMergeFree(m);
+  t->merge = NULL;
+}
+
+void Trie_Freeze(Trie *t) {
+  if (t->merge) {
+    trieMergeStep(t, SIZE_MAX);
+  }
+  trieMergeStart(t);
+  trieMergeStep(t, SIZE_MAX);
+}
+
+/* Delete an entry from the sealed or frozen layer, where entries are only marked as deleted. Puts
+ * the score of the entry in score, if given. Returns 1 if the entry was found and deleted */
+static int trieDeleteReadOnly(Trie *t, const rune *runes, t_len len, float *score) {
+  const CompactTrieNode *fn = t->frozen ? CompactTrie_Find(t->frozen, runes, len) : NULL;
+  if (fn) {
+    if (score) *score = fn->score;
+    return CompactTrie_Delete(t->frozen, runes, len);
+  }
+
+  TrieNode *sn = t->sealed ? TrieNode_Get(t->sealed, runes, len) : NULL;
+  if (!sn) {
+    return 0;
+  }
+  if (score) *score = sn->score;
+  // keep the structure of the sealed delta intact for its layout, and delete the entry from the
+  // new frozen layer once it is done
+  sn->flags |= TRIENODE_DELETED;
+  sn->flags &= ~TRIENODE_TERMINAL;
+  t->merge->sealedSize--;
+  trieDeletedEntry e = {.str = rm_malloc(len * sizeof(rune)), .len = len};
+  memcpy(e.str, runes, len * sizeof(rune));
+  t->merge->deleted = array_append(t->merge->deleted, e);
+  return 1;
+}
+
+static void trieSpellIndexFree(Trie *t) {
+  SpellIndex_Free(t->spellIdx);
+  t->spellIdx = NULL;
+  t->spellQueueing = 0;
+  rm_free(t->spellCursor);
+  t->spellCursor = NULL;
+}
+
+typedef struct {
+  rune *str;
+  t_len len;
+} trieSpellString;
+
+typedef struct {
+  trieSpellString *strings;
+  size_t max;
+  size_t found;
+} trieSpellQueueCtx;
+
+static int trieSpellQueueCollect(const rune *str, size_t len, void *ctx) {
+  trieSpellQueueCtx *q = ctx;
+  trieSpellString s = {.str = rm_malloc(len * sizeof(rune)), .len = len};
+  memcpy(s.str, str, len * sizeof(rune));
+  q->strings = array_append(q->strings, s);
+  return ++q->found == q->max;
+}
+
+static int cmpSpellStrings(const void *p1, const void *p2) {
+  const trieSpellString *s1 = p1, *s2 = p2;
+  for (t_len i = 0; i < s1->len && i < s2->len; i++) {
+    if (s1->str[i] != s2->str[i]) {
+      return (int)s1->str[i] - (int)s2->str[i];
+    }
+  }
+  return (int)s1->len - (int)s2->len;
+}
+
+/* Queue the next n strings of the trie to the spell index. Every live entry is in exactly one of
+ * the layers, so the next n strings of the trie are the first n of the next n strings of every
+ * layer. Resuming from the last string queued, rather than from a position in the layers, keeps
+ * the queueing correct across the writes and merges in between */
+static void trieSpellIndexQueue(Trie *t, size_t n) {
+  trieSpellQueueCtx q = {.strings = array_new(trieSpellString, n), .max = n};
+  int nmin = t->spellCursor ? t->spellCursorLen : -1;
+  TrieNode_WalkFrom(t->root, t->spellCursor, nmin, trieSpellQueueCollect, &q);
+  if (t->sealed) {
+    q.found = 0;
+    TrieNode_WalkFrom(t->sealed, t->spellCursor, nmin, trieSpellQueueCollect, &q);
+  }
+  if (t->frozen) {
+    q.found = 0;
+    CompactTrie_WalkFrom(t->frozen, t->spellCursor, nmin, trieSpellQueueCollect, &q);
+  }
+
+  size_t numStrings = array_len(q.strings);
+  qsort(q.strings, numStrings, sizeof(*q.strings), cmpSpellStrings);
+  for (size_t i = 0; i < MIN(n, numStrings); i++) {
+    size_t slen;
+    char *s = runesToStr(q.strings[i].str, q.strings[i].len, &slen);
+    SpellIndex_Queue(t->spellIdx, s, slen);
+    rm_free(s);
+  }
+
+  rm_free(t->spellCursor);
+  t->spellCursor = NULL;
+  if (numStrings < n) {
+    t->spellQueueing = 0;
+  } else {
+    t->spellCursor = q.strings[n - 1].str;
+    t->spellCursorLen = q.strings[n - 1].len;
+    q.strings[n - 1].str = NULL;
+  }
+  for (size_t i = 0; i < numStrings; i++) {
+    rm_free(q.strings[i].str);
+  }
+  array_free(q.strings);
+}
+
+/* Queue and build the spell index by up to n strings, and drop it if it outgrew its memory limit */
+static void trieSpellIndexStep(Trie *t, size_t n) {
+  if (t->spellQueueing) {
+    trieSpellIndexQueue(t, n);
+  }
+  SpellIndex_Build(t->spellIdx, n);
+  if (t->spellIdxMaxMem && SpellIndex_MemUsage(t->spellIdx) > t->spellIdxMaxMem) {
+    trieSpellIndexFree(t);
+    t->spellIdxOutgrew = t->spellIdxMaxMem;
+  }
+}
+
+SpellIndex *Trie_GetSpellIndex(Trie *t, int maxDist, size_t maxMem) {
+  if (t->spellIdx && SpellIndex_MaxDist(t->spellIdx) < maxDist) {
+    trieSpellIndexFree(t);
+  }
+  t->spellIdxMaxMem = maxMem;
+  if (!t->spellIdx) {
+    if (t->spellIdxOutgrew && maxMem && maxMem <= t->spellIdxOutgrew) {
+      return NULL;
+    }
+    t->spellIdxOutgrew = 0;
+    t->spellIdx = NewSpellIndex(maxDist);
+    t->spellQueueing = 1;
+  }
+
+  trieSpellIndexStep(t, TRIE_SPELL_BUILD_STEP);
+  return t->spellIdx && !t->spellQueueing && SpellIndex_IsBuilt(t->spellIdx) ? t->spellIdx : NULL;
+}
+
 int Trie_Insert(Trie *t, RedisModuleString *s, double score, int incr, RSPayload *payload) {
   size_t len;
   const char *str = RedisModule_StringPtrLen(s, &len);
@@ -69,30 +325,75 @@ int Trie_InsertStringBuffer(Trie *t, const char *s, size_t len, double score, in
   if (len > TRIE_INITIAL_STRING_LEN * sizeof(rune)) {
     return 0;
   }
+  size_t slen = len;
   runeBuf buf;
   rune *runes = runeBufFill(s, len, &buf, &len);
   int rc;
+  int removed = 0;
 
   if (runes && len && len < TRIE_INITIAL_STRING_LEN) {
-    rc = TrieNode_Add(&t->root, runes, len, payload, (float)score, incr ? ADD_INCR : ADD_REPLACE);
-    t->size += rc;
+    float oldScore;
+    if (score != 0 && trieDeleteReadOnly(t, runes, len, &oldScore)) {
+      // the entry is in a read only layer - move it to the mutable layer, unless its score dropped
+      // to 0, which TrieNode_Add does not add
+      float newScore = incr ? oldScore + (float)score : (float)score;
+      if (newScore == 0) {
+        t->size--;
+        removed = 1;
+      } else {
+        TrieNode_Add(&t->root, runes, len, payload, newScore, ADD_REPLACE);
+      }
+      rc = 0;
+    } else {
+      rc = TrieNode_Add(&t->root, runes, len, payload, (float)score, incr ? ADD_INCR : ADD_REPLACE);
+      t->size += rc;
+    }
   } else {
     rc = 0;
   }
 
   runeBufFree(&buf);
+
+  if (rc && t->spellIdx) {
+    SpellIndex_Add(t->spellIdx, s, slen);
+  } else if (removed && t->spellIdx) {
+    SpellIndex_Delete(t->spellIdx, s, slen);
+  }
+  if (t->spellIdx) {
+    trieSpellIndexStep(t, TRIE_SPELL_WRITE_STEP);
+  }
+
+  size_t frozenSize = t->frozen ? t->frozen->size : 0;
+  if (rc && !t->merge && t->size - frozenSize >= MAX(TRIE_DELTA_MERGE_MIN, frozenSize / 4)) {
+    trieMergeStart(t);
+  }
+  if (t->merge) {
+    trieMergeStep(t, TRIE_MERGE_STEP);
+  }
   return rc;
 }
 
 int Trie_Delete(Trie *t, const char *s, size_t len) {
-
+  size_t slen = len;
   rune *runes = strToRunes(s, &len);
   if (!runes || len > TRIE_INITIAL_STRING_LEN) {
     return 0;
   }
   int rc = TrieNode_Delete(t->root, runes, len);
+  if (!rc) {
+    rc = trieDeleteReadOnly(t, runes, len, NULL);
+  }
   t->size -= rc;
   rm_free(runes);
+  if (rc && t->spellIdx) {
+    SpellIndex_Delete(t->spellIdx, s, slen);
+  }
+  if (t->spellIdx) {
+    trieSpellIndexStep(t, TRIE_SPELL_WRITE_STEP);
+  }
+  if (t->merge) {
+    trieMergeStep(t, TRIE_MERGE_STEP);
+  }
   return rc;
 }
 
@@ -129,32 +430,245 @@ TrieIterator *Trie_Iterate(Trie *t, const char *prefix, size_t len, int maxDist,
   DFAFilter *fc = rm_malloc(sizeof(*fc));
   *fc = NewDFAFilter(runes, rlen, maxDist, prefixMode);
 
-  TrieIterator *it = TrieNode_Iterate(t->root, FilterFunc, StackPop, fc);
+  TrieIterator *it = trieIterate(t, FilterFunc, StackPop, fc);
   rm_free(runes);
   return it;
 }
 
-Vector *Trie_Search(Trie *tree, const char *s, size_t len, size_t num, int maxDist, int prefixMode,
-                    int trim, int optimize) {
+/* The length penalty of prefix searches. Note that len is the byte length of the query */
+static inline float trieLengthPenalty(float score, size_t slen, size_t len) {
+  return score / sqrt(1 + (slen >= len ? slen - len : len - slen));
+}
 
-  if (len > TRIE_MAX_PREFIX * sizeof(rune)) {
-    return NULL;
-  }
+/* A node of either layer of the trie, visited by a best-first search */
+typedef struct {
+  TrieNode *n;
+  // the node in the frozen layer, if n is NULL
+  const CompactTrieNode *cn;
+  // the index of the parent's path, or -1 for a top node
+  int parent;
+  // the length of the string up to and including the node
+  t_len depth;
+} trieSearchPath;
+
+typedef enum {
+  // an entry, with its final score
+  TS_ENTRY,
+  // a subtree, bounded by the best score any entry in it can get
+  TS_SUBTREE,
+  // the remaining children of a frozen node, from a given child on. The children of frozen nodes
+  // are sorted by their maximal score, so we visit them lazily
+  TS_CHILDREN,
+} trieSearchItemType;
+
+typedef struct {
+  float bound;
+  uint8_t type;
+  // the path of the node, or of the parent for TS_CHILDREN
+  uint32_t path;
+  t_len child;
+} trieSearchItem;
+
+typedef struct {
+  const Trie *t;
+  const rune *runes;
   size_t rlen;
-  rune *runes = strToFoldedRunes(s, &rlen);
-  // make sure query length does not overflow
-  if (!runes || rlen >= TRIE_MAX_PREFIX) {
-    rm_free(runes);
-    return NULL;
+  size_t len;
+  trieSearchPath *paths;
+  trieSearchItem *items;
+  heap_t *pq;
+} trieSearch;
+
+/* The heap holds indexes into the items array, which may move as it grows */
+static int cmpSearchItems(const void *p1, const void *p2, const void *udata) {
+  const trieSearch *ts = udata;
+  const trieSearchItem *i1 = &ts->items[(uintptr_t)p1], *i2 = &ts->items[(uintptr_t)p2];
+  if (i1->bound < i2->bound) {
+    return -1;
+  } else if (i1->bound > i2->bound) {
+    return 1;
+  }
+  // entries first, so we can stop as soon as possible
+  return (int)(i1->type == TS_ENTRY) - (int)(i2->type == TS_ENTRY);
+}
+
+static void tsPush(trieSearch *ts, trieSearchItemType type, uint32_t path, t_len child,
+                   float bound) {
+  trieSearchItem item = {.bound = bound, .type = type, .path = path, .child = child};
+  ts->items = array_append(ts->items, item);
+  heap_offer(&ts->pq, (void *)(uintptr_t)(array_len(ts->items) - 1));
+}
+
+static uint32_t tsAddPath(trieSearch *ts, TrieNode *n, const CompactTrieNode *cn, int parent) {
+  t_len depth = (parent >= 0 ? ts->paths[parent].depth : 0) + (n ? n->len : cn->len);
+  trieSearchPath p = {.n = n, .cn = cn, .parent = parent, .depth = depth};
+  ts->paths = array_append(ts->paths, p);
+  return array_len(ts->paths) - 1;
+}
+
+static inline const rune *tsNodeStr(const trieSearch *ts, const trieSearchPath *p) {
+  return p->n ? p->n->str : ts->t->frozen->runes + p->cn->str;
+}
+
+/* Copy the string of a path to buf, which must hold depth runes */
+static void tsPathString(const trieSearch *ts, const trieSearchPath *p, rune *buf) {
+  for (; p; p = p->parent >= 0 ? &ts->paths[p->parent] : NULL) {
+    t_len nlen = p->n ? p->n->len : p->cn->len;
+    memcpy(buf + p->depth - nlen, tsNodeStr(ts, p), nlen * sizeof(rune));
   }
+}
+
+/* The best score of an entry in the subtree of a path */
+static float tsSubtreeBound(const trieSearch *ts, const trieSearchPath *p) {
+  float maxScore = p->n ? MAX(p->n->score, p->n->maxChildScore)
+                        : MAX(p->cn->score, p->cn->maxChildScore);
+  // all the entries in the subtree are at least as long as the path
+  return trieLengthPenalty(maxScore, MAX(p->depth, ts->len), ts->len);
+}
+
+/* Push the entry of a path, and its children */
+static void tsExpand(trieSearch *ts, uint32_t pi) {
+  const trieSearchPath *p = &ts->paths[pi];
+  int flags = p->n ? p->n->flags : p->cn->flags;
+  if ((flags & TRIENODE_TERMINAL) && !(flags & TRIENODE_DELETED)) {
+    float score = p->n ? p->n->score : p->cn->score;
+    if (p->depth == ts->rlen) {
+      // an exact match always comes first. The query is folded, so compare the entry's string
+      rune buf[TRIE_MAX_PREFIX];
+      tsPathString(ts, p, buf);
+      if (p->depth > 0 && !memcmp(buf, ts->runes, p->depth * sizeof(rune))) {
+        score = INT_MAX;
+      }
+    }
+    tsPush(ts, TS_ENTRY, pi, 0, trieLengthPenalty(score, p->depth, ts->len));
+  }
+
+  if (p->n) {
+    TrieNode *n = p->n;
+    for (t_len i = 0; i < n->numChildren; i++) {
+      uint32_t ci = tsAddPath(ts, __trieNode_children(n)[i], NULL, pi);
+      tsPush(ts, TS_SUBTREE, ci, 0, tsSubtreeBound(ts, &ts->paths[ci]));
+    }
+  } else if (p->cn->numChildren) {
+    const CompactTrieNode *ch = &ts->t->frozen->nodes[p->cn->children];
+    tsPush(ts, TS_CHILDREN, pi, 0,
+           trieLengthPenalty(MAX(ch->score, ch->maxChildScore), MAX(p->depth + 1, ts->len),
+                             ts->len));
+  }
+}
+
+/* Find the nodes where the query ends, and expand them. Strings are matched case insensitively,
+ * so the query can end in more than one node */
+static void tsLocate(trieSearch *ts, TrieNode *n, const CompactTrieNode *cn, int parent,
+                     size_t off) {
+  const rune *str = n ? n->str : ts->t->frozen->runes + cn->str;
+  t_len nlen = n ? n->len : cn->len;
+  for (t_len i = 0; i < nlen && off < ts->rlen; i++, off++) {
+    if (runeFold(str[i]) != ts->runes[off]) {
+      return;
+    }
+  }
+  uint32_t pi = tsAddPath(ts, n, cn, parent);
+  if (off == ts->rlen) {
+    tsExpand(ts, pi);
+    return;
+  }
+
+  t_len numChildren = n ? n->numChildren : cn->numChildren;
+  for (t_len i = 0; i < numChildren; i++) {
+    TrieNode *chn = n ? __trieNode_children(n)[i] : NULL;
+    const CompactTrieNode *chcn = n ? NULL : &ts->t->frozen->nodes[cn->children + i];
+    const rune *chstr = chn ? chn->str : ts->t->frozen->runes + chcn->str;
+    if ((chn ? chn->len : chcn->len) && runeFold(chstr[0]) == ts->runes[off]) {
+      tsLocate(ts, chn, chcn, pi, off);
+    }
+  }
+}
+
+static TrieSearchResult *tsNewResult(trieSearch *ts, const trieSearchItem *item) {
+  const trieSearchPath *p = &ts->paths[item->path];
+  rune buf[p->depth + 1];
+  tsPathString(ts, p, buf);
+
+  TrieSearchResult *ent = rm_malloc(sizeof(*ent));
+  ent->str = runesToStr(buf, p->depth, &ent->len);
+  ent->score = item->bound;
+  const TriePayload *payload =
+      p->n ? p->n->payload : CompactTrie_Payload(ts->t->frozen, p->cn);
+  ent->payload = payload ? (char *)payload->data : NULL;
+  ent->plen = payload ? payload->len : 0;
+  return ent;
+}
+
+/* Find the top num completions of a prefix, best first. Every subtree is bounded by the best
+ * score of its entries with the smallest length penalty they can get, so once an entry is the best
+ * item in the queue, no entry we did not see yet can beat it, and we stop after num entries */
+static Vector *trieSearchPrefix(Trie *tree, const rune *runes, size_t rlen, size_t len,
+                                size_t num) {
+  trieSearch ts = {
+      .t = tree,
+      .runes = runes,
+      .rlen = rlen,
+      .len = len,
+      .paths = array_new(trieSearchPath, 16),
+      .items = array_new(trieSearchItem, 16),
+  };
+  ts.pq = heap_new(cmpSearchItems, &ts);
+
+  tsLocate(&ts, tree->root, NULL, -1, 0);
+  if (tree->sealed) {
+    tsLocate(&ts, tree->sealed, NULL, -1, 0);
+  }
+  if (tree->frozen) {
+    tsLocate(&ts, NULL, tree->frozen->nodes, -1, 0);
+  }
+
+  Vector *ret = NewVector(TrieSearchResult *, MIN(num, 64));
+  while (Vector_Size(ret) < num && heap_count(ts.pq)) {
+    trieSearchItem item = ts.items[(uintptr_t)heap_poll(ts.pq)];
+    switch (item.type) {
+      case TS_ENTRY: {
+        TrieSearchResult *ent = tsNewResult(&ts, &item);
+        Vector_Push(ret, ent);
+        break;
+      }
+
+      case TS_SUBTREE:
+        tsExpand(&ts, item.path);
+        break;
+
+      case TS_CHILDREN: {
+        // visit the next child, and leave the rest for later
+        const CompactTrieNode *parent = ts.paths[item.path].cn;
+        const CompactTrieNode *ch = &tree->frozen->nodes[parent->children + item.child];
+        uint32_t ci = tsAddPath(&ts, NULL, ch, item.path);
+        tsPush(&ts, TS_SUBTREE, ci, 0, tsSubtreeBound(&ts, &ts.paths[ci]));
+        if (item.child + 1 < parent->numChildren) {
+          ch++;
+          tsPush(&ts, TS_CHILDREN, item.path, item.child + 1,
+                 trieLengthPenalty(MAX(ch->score, ch->maxChildScore),
+                                   MAX(ts.paths[item.path].depth + 1, len), len));
+        }
+        break;
+      }
+    }
+  }
+
+  heap_free(ts.pq);
+  array_free(ts.paths);
+  array_free(ts.items);
+  return ret;
+}
 
+/* Find the top num matches of a query by traversing the trie with a Levenshtein automaton */
+static Vector *trieSearchFuzzy(Trie *tree, const rune *runes, size_t rlen, size_t len, size_t num,
+                               int maxDist, int prefixMode) {
   heap_t *pq = rm_malloc(heap_sizeof(num));
   heap_init(pq, cmpEntries, NULL, num);
 
-  DFAFilter fc = NewDFAFilter(runes, rlen, maxDist, prefixMode);
+  DFAFilter fc = NewDFAFilter((rune *)runes, rlen, maxDist, prefixMode);
 
-  TrieIterator *it = TrieNode_Iterate(tree->root, FilterFunc, StackPop, &fc);
-  // TrieIterator *it = TrieNode_Iterate(tree->root,NULL, NULL, NULL);
+  TrieIterator *it = trieIterate(tree, FilterFunc, StackPop, &fc);
   rune *rstr;
   t_len slen;
   float score;
@@ -179,7 +693,7 @@ Vector *Trie_Search(Trie *tree, const char *s, size_t len, size_t num, int maxDi
     }
     // in prefix mode we also factor in the total length of the suffix
     if (prefixMode) {
-      ent->score /= sqrt(1 + (slen >= len ? slen - len : len - slen));
+      ent->score = trieLengthPenalty(ent->score, slen, len);
     }
 
     if (heap_count(pq) < heap_size(pq)) {
@@ -234,8 +748,33 @@ Vector *Trie_Search(Trie *tree, const char *s, size_t len, size_t num, int maxDi
     TrieSearchResult *h = heap_poll(pq);
     Vector_Put(ret, n - i - 1, h);
   }
+  TrieIterator_Free(it);
+  DFAFilter_Free(&fc);
+  heap_free(pq);
+  return ret;
+}
+
+Vector *Trie_Search(Trie *tree, const char *s, size_t len, size_t num, int maxDist, int prefixMode,
+                    int trim, int optimize) {
+
+  if (len > TRIE_MAX_PREFIX * sizeof(rune)) {
+    return NULL;
+  }
+  size_t rlen;
+  rune *runes = strToFoldedRunes(s, &rlen);
+  // make sure query length does not overflow
+  if (!runes || rlen >= TRIE_MAX_PREFIX) {
+    rm_free(runes);
+    return NULL;
+  }
+
+  // plain completions are found best first, fuzzy ones with the automaton
+  Vector *ret = prefixMode && maxDist == 0
+                    ? trieSearchPrefix(tree, runes, rlen, len, num)
+                    : trieSearchFuzzy(tree, runes, rlen, len, num, maxDist, prefixMode);
 
   // trim the results to remove irrelevant results
+  size_t n = Vector_Size(ret);
   if (trim) {
     float maxScore = 0;
     int i;
@@ -259,10 +798,6 @@ Vector *Trie_Search(Trie *tree, const char *s, size_t len, size_t num, int maxDi
   }
 
   rm_free(runes);
-  TrieIterator_Free(it);
-  DFAFilter_Free(&fc);
-  heap_free(pq);
-
   return ret;
 }
 
@@ -275,20 +810,72 @@ int Trie_RandomKey(Trie *t, char **str, t_len *len, double *score) {
   t_len rlen;
 
   // TODO: deduce steps from cardinality properly
-  TrieNode *n =
-      TrieNode_RandomWalk(t->root, 2 + rand() % 8 + (int)round(logb(1 + t->size)), &rstr, &rlen);
-  if (!n) {
-    return 0;
+  int steps = 2 + rand() % 8 + (int)round(logb(1 + t->size));
+  // pick a layer in proportion to the number of entries it holds
+  size_t frozenSize = t->frozen ? t->frozen->size : 0;
+  size_t sealedSize = t->sealed ? t->merge->sealedSize : 0;
+  size_t pick = rand() % t->size;
+  if (pick < frozenSize) {
+    const CompactTrieNode *n = CompactTrie_RandomWalk(t->frozen, steps, &rstr, &rlen);
+    *score = n->score;
+  } else {
+    TrieNode *root = pick < frozenSize + sealedSize ? t->sealed : t->root;
+    TrieNode *n = TrieNode_RandomWalk(root, steps, &rstr, &rlen);
+    if (!n) {
+      return 0;
+    }
+    *score = n->score;
   }
   size_t sz;
   *str = runesToStr(rstr, rlen, &sz);
   *len = sz;
   rm_free(rstr);
-
-  *score = n->score;
   return 1;
 }
 
+void Trie_IterateRange(Trie *t, const rune *min, int nmin, bool includeMin, const rune *max,
+                       int nmax, bool includeMax, TrieRangeCallback callback, void *ctx) {
+  TrieNode_IterateRange(t->root, min, nmin, includeMin, max, nmax, includeMax, callback, ctx);
+  if (t->sealed) {
+    TrieNode_IterateRange(t->sealed, min, nmin, includeMin, max, nmax, includeMax, callback, ctx);
+  }
+  if (t->frozen) {
+    CompactTrie_IterateRange(t->frozen, min, nmin, includeMin, max, nmax, includeMax, callback,
+                             ctx);
+  }
+}
+
+static size_t trieNodeMemUsage(const TrieNode *n) {
+  size_t sz = __trieNode_Sizeof(n->numChildren, n->len);
+  if (n->payload) {
+    sz += sizeof(TriePayload) + n->payload->len + 1;
+  }
+  for (t_len i = 0; i < n->numChildren; i++) {
+    sz += trieNodeMemUsage(__trieNode_children(n)[i]);
+  }
+  return sz;
+}
+
+size_t Trie_MemUsage(const Trie *t) {
+  size_t sz = sizeof(*t) + trieNodeMemUsage(t->root);
+  if (t->frozen) {
+    sz += CompactTrie_MemUsage(t->frozen);
+  }
+  if (t->sealed) {
+    sz += trieNodeMemUsage(t->sealed);
+  }
+  if (t->merge) {
+    sz += sizeof(*t->merge) + array_len(t->merge->deleted) * sizeof(*t->merge->deleted);
+    if (t->merge->builder) {
+      sz += CompactTrieBuilder_MemUsage(t->merge->builder);
+    }
+  }
+  if (t->spellIdx) {
+    sz += SpellIndex_MemUsage(t->spellIdx);
+  }
+  return sz;
+}
+
 /***************************************************************
  *
  *                       Trie type methods
@@ -323,7 +910,10 @@ void *TrieType_GenericLoad(RedisModuleIO *rdb, int loadPayloads) {
     RedisModule_Free(str);
     if (payload.data != NULL) RedisModule_Free(payload.data);
   }
-  // TrieNode_Print(tree->root, 0, 0);
+  // loaded tries are mostly read from, so lay them out compactly right away
+  if (tree->size) {
+    Trie_Freeze(tree);
+  }
   return tree;
 }
 
@@ -337,7 +927,7 @@ void TrieType_GenericSave(RedisModuleIO *rdb, Trie *tree, int savePayloads) {
   //  RedisModule_Log(ctx, "notice", "Trie: saving %zd nodes.", tree->size);
   int count = 0;
   if (tree->root) {
-    TrieIterator *it = TrieNode_Iterate(tree->root, NULL, NULL, NULL);
+    TrieIterator *it = trieIterate(tree, NULL, NULL, NULL);
     rune *rstr;
     t_len len;
     float score;
@@ -380,17 +970,34 @@ void TrieType_Free(void *value) {
 
     TrieNode_Free(tree->root);
   }
+  if (tree->frozen) {
+    CompactTrie_Free(tree->frozen);
+  }
+  if (tree->sealed) {
+    TrieNode_Free(tree->sealed);
+  }
+  if (tree->merge) {
+    trieMergeFree(tree->merge);
+  }
+  if (tree->spellIdx) {
+    trieSpellIndexFree(tree);
+  }
 
   rm_free(tree);
 }
 
+size_t TrieType_MemUsage(const void *value) {
+  return Trie_MemUsage(value);
+}
+
 int TrieType_Register(RedisModuleCtx *ctx) {
 
   RedisModuleTypeMethods tm = {.version = REDISMODULE_TYPE_METHOD_VERSION,
                                .rdb_load = TrieType_RdbLoad,
                                .rdb_save = TrieType_RdbSave,
                                .aof_rewrite = GenericAofRewrite_DisabledHandler,
-                               .free = TrieType_Free};
+                               .free = TrieType_Free,
+                               .mem_usage = TrieType_MemUsage};
 
   TrieType = RedisModule_CreateDataType(ctx, "trietype0", TRIE_ENCVER_CURRENT, &tm);
   if (TrieType == NULL) {
@@ -4,7 +4,10 @@
 #include "../redismodule.h"
 
 #include "trie.h"
+#include "compact_trie.h"
 #include "levenshtein.h"
+#include "spell_index.h"
+#include "../rmutil/vector.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -15,11 +18,51 @@ extern RedisModuleType *TrieType;
 #define TRIE_ENCVER_CURRENT 1
 #define TRIE_ENCVER_NOPAYLOADS 0
 
+/* A trie is kept in two layers: a frozen, compact layer holding the bulk of the entries, and a
+ * small mutable TrieNode tree ("delta") that new entries are added to. Every live entry is in
+ * exactly one of the layers.
+ *
+ * Once the delta grows large enough, both layers are merged into a new frozen layer. The merge is
+ * done a few entries at a time on every write to the trie, so that no single write pays for
+ * rebuilding the whole trie: first the frozen entries are moved to the delta, then the delta is
+ * sealed and laid out as the next frozen layer, while new entries go to a new delta. The sealed
+ * delta is read along with the other layers until the merge is done */
 typedef struct {
   TrieNode *root;
+  CompactTrie *frozen;
+  // the delta being laid out by an ongoing merge, or NULL. It is read only, except that its
+  // entries can be marked as deleted
+  TrieNode *sealed;
+  // the total number of entries in all the layers
   size_t size;
+  // an optional index for fuzzy lookups, kept in sync with the entries once started. It is built
+  // a few strings at a time, see Trie_GetSpellIndex
+  SpellIndex *spellIdx;
+  // the memory limit of the spell index (0 for none), and the last limit it outgrew
+  size_t spellIdxMaxMem;
+  size_t spellIdxOutgrew;
+  // set while the strings of the trie are queued to a new spell index, in lexical order. The last
+  // string queued so far is kept, or NULL before the first one
+  int spellQueueing;
+  rune *spellCursor;
+  t_len spellCursorLen;
+  // the state of an ongoing merge, or NULL
+  struct TrieMerge *merge;
 } Trie;
 
+/* A merge starts once the delta has this many entries, or a quarter of the entries of the frozen
+ * layer, the larger of the two */
+#define TRIE_DELTA_MERGE_MIN (1 << 16)
+
+/* The number of entries moved, or nodes laid out, by an ongoing merge on every write. A merge
+ * takes a few steps per entry, so this makes sure it is done long before the next one is due */
+#define TRIE_MERGE_STEP 128
+
+/* The number of strings queued to, and built in, the spell index on every call to
+ * Trie_GetSpellIndex, and on every write to the trie */
+#define TRIE_SPELL_BUILD_STEP 4096
+#define TRIE_SPELL_WRITE_STEP 64
+
 typedef struct {
   char *str;
   size_t len;
@@ -46,6 +89,27 @@ Vector *Trie_Search(Trie *tree, const char *s, size_t len, size_t num, int maxDi
  * Otherwise we return an iterator to all strings within maxDist Levenshtein distance */
 TrieIterator *Trie_Iterate(Trie *t, const char *prefix, size_t len, int maxDist, int prefixMode);
 
+/* Get the spell index of the trie, if it has a complete index serving maxDist edits. Otherwise
+ * start building one, or continue building it, and return NULL.
+ *
+ * A few strings of the trie are queued in the index, and their deletions generated, on every call
+ * and write to the trie. Strings written meanwhile go to the index right away. An index taking
+ * more than maxMem bytes (0 for no limit) is dropped, and is only built again with a larger
+ * limit */
+SpellIndex *Trie_GetSpellIndex(Trie *t, int maxDist, size_t maxMem);
+
+/* Merge all the layers of the trie into a single frozen layer right away, finishing any ongoing
+ * merge first */
+void Trie_Freeze(Trie *t);
+
+/* Iterate all the entries within a lexical range, in both layers of the trie. See
+ * TrieNode_IterateRange */
+void Trie_IterateRange(Trie *t, const rune *min, int nmin, bool includeMin, const rune *max,
+                       int nmax, bool includeMax, TrieRangeCallback callback, void *ctx);
+
+/* Return the number of bytes used by the trie */
+size_t Trie_MemUsage(const Trie *t);
+
 /* Get a random key from the trie, and put the node's score in the score pointer. Returns 0 if the
  * trie is empty and we cannot do that */
 int Trie_RandomKey(Trie *t, char **str, t_len *len, double *score);
@@ -57,6 +121,7 @@ void *TrieType_RdbLoad(RedisModuleIO *rdb, int encver);
 void TrieType_RdbSave(RedisModuleIO *rdb, void *value);
 void TrieType_Digest(RedisModuleDigest *digest, void *value);
 void TrieType_Free(void *value);
+size_t TrieType_MemUsage(const void *value);
 
 #ifdef __cplusplus
 }
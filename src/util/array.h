@@ -4,6 +4,10 @@
 #include <stdlib.h>
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef struct {
   void *(*Alloc)(size_t);
   void *(*Realloc)(void *, size_t);
@@ -66,4 +70,7 @@ void Array_ShrinkToSize(Array *array);
 #define ARRAY_GETARRAY_AS(arr, T) ((T)((arr)->data))
 #define ARRAY_ADD_AS(arr, T) Array_Add(arr, sizeof(T))
 #define ARRAY_GETITEM_AS(arr, ix, T) (ARRAY_GETARRAY_AS(arr, T) + ix)
+#ifdef __cplusplus
+}
+#endif
 #endif
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "bitmap.h"
+#include "rmalloc.h"
+#include <string.h>
+
+#define CHUNK_SIZE (BITMAP_CHUNK_WORDS * sizeof(uint64_t))
+
+void Bitmap_Init(Bitmap *bm) {
+  bm->chunks = NULL;
+  bm->numChunks = 0;
+  bm->numAllocated = 0;
+  bm->card = 0;
+}
+
+void Bitmap_Cleanup(Bitmap *bm) {
+  for (size_t ii = 0; ii < bm->numChunks; ++ii) {
+    if (bm->chunks[ii]) {
+      rm_free(bm->chunks[ii]);
+    }
+  }
+  rm_free(bm->chunks);
+  Bitmap_Init(bm);
+}
+
+static uint64_t *getChunkForWrite(Bitmap *bm, size_t chunk) {
+  if (chunk >= bm->numChunks) {
+    // Grow geometrically so that appending ids in increasing order is amortized
+    size_t newNum = bm->numChunks ? bm->numChunks : 1;
+    while (newNum <= chunk) {
+      newNum *= 2;
+    }
+    bm->chunks = rm_realloc(bm->chunks, newNum * sizeof(*bm->chunks));
+    memset(bm->chunks + bm->numChunks, 0, (newNum - bm->numChunks) * sizeof(*bm->chunks));
+    bm->numChunks = newNum;
+  }
+  if (!bm->chunks[chunk]) {
+    bm->chunks[chunk] = rm_calloc(1, CHUNK_SIZE);
+    bm->numAllocated++;
+  }
+  return bm->chunks[chunk];
+}
+
+int Bitmap_Set(Bitmap *bm, uint64_t id) {
+  uint64_t *words = getChunkForWrite(bm, BITMAP_CHUNK_OF(id));
+  uint64_t *w = words + BITMAP_WORD_OF(id);
+  uint64_t mask = 1ULL << BITMAP_BIT_OF(id);
+  if (*w & mask) {
+    return 0;
+  }
+  *w |= mask;
+  bm->card++;
+  return 1;
+}
+
+static void releaseIfEmpty(Bitmap *bm, size_t chunk) {
+  const uint64_t *words = bm->chunks[chunk];
+  for (size_t ii = 0; ii < BITMAP_CHUNK_WORDS; ++ii) {
+    if (words[ii]) {
+      return;
+    }
+  }
+  rm_free(bm->chunks[chunk]);
+  bm->chunks[chunk] = NULL;
+  bm->numAllocated--;
+}
+
+int Bitmap_Clear(Bitmap *bm, uint64_t id) {
+  size_t chunk = BITMAP_CHUNK_OF(id);
+  if (chunk >= bm->numChunks || !bm->chunks[chunk]) {
+    return 0;
+  }
+  uint64_t *w = bm->chunks[chunk] + BITMAP_WORD_OF(id);
+  uint64_t mask = 1ULL << BITMAP_BIT_OF(id);
+  if (!(*w & mask)) {
+    return 0;
+  }
+  *w &= ~mask;
+  bm->card--;
+  if (!*w) {
+    releaseIfEmpty(bm, chunk);
+  }
+  return 1;
+}
+
+uint64_t Bitmap_Next(const Bitmap *bm, uint64_t from) {
+  size_t chunk = BITMAP_CHUNK_OF(from);
+  size_t word = BITMAP_WORD_OF(from);
+  // mask out the bits below `from` in the first word we examine
+  uint64_t mask = ~0ULL << BITMAP_BIT_OF(from);
+
+  for (; chunk < bm->numChunks; ++chunk, word = 0, mask = ~0ULL) {
+    const uint64_t *words = bm->chunks[chunk];
+    if (!words) {
+      continue;
+    }
+    for (; word < BITMAP_CHUNK_WORDS; ++word, mask = ~0ULL) {
+      uint64_t w = words[word] & mask;
+      if (w) {
+        return (uint64_t)chunk * BITMAP_CHUNK_BITS + word * BITMAP_WORD_BITS + __builtin_ctzll(w);
+      }
+    }
+  }
+  return 0;
+}
+
+void Bitmap_AndNot(Bitmap *bm, const Bitmap *other) {
+  size_t n = bm->numChunks < other->numChunks ? bm->numChunks : other->numChunks;
+  for (size_t chunk = 0; chunk < n; ++chunk) {
+    uint64_t *words = bm->chunks[chunk];
+    const uint64_t *owords = other->chunks[chunk];
+    if (!words || !owords) {
+      continue;
+    }
+    for (size_t ii = 0; ii < BITMAP_CHUNK_WORDS; ++ii) {
+      bm->card -= __builtin_popcountll(words[ii] & owords[ii]);
+      words[ii] &= ~owords[ii];
+    }
+    releaseIfEmpty(bm, chunk);
+  }
+}
+
+void Bitmap_And(Bitmap *bm, const Bitmap *other) {
+  for (size_t chunk = 0; chunk < bm->numChunks; ++chunk) {
+    uint64_t *words = bm->chunks[chunk];
+    if (!words) {
+      continue;
+    }
+    const uint64_t *owords = Bitmap_GetChunk(other, chunk);
+    for (size_t ii = 0; ii < BITMAP_CHUNK_WORDS; ++ii) {
+      uint64_t w = owords ? words[ii] & owords[ii] : 0;
+      bm->card -= __builtin_popcountll(words[ii] ^ w);
+      words[ii] = w;
+    }
+    releaseIfEmpty(bm, chunk);
+  }
+}
+
+void Bitmap_Or(Bitmap *bm, const Bitmap *other) {
+  for (size_t chunk = 0; chunk < other->numChunks; ++chunk) {
+    const uint64_t *owords = other->chunks[chunk];
+    if (!owords) {
+      continue;
+    }
+    uint64_t *words = getChunkForWrite(bm, chunk);
+    for (size_t ii = 0; ii < BITMAP_CHUNK_WORDS; ++ii) {
+      bm->card += __builtin_popcountll(owords[ii] & ~words[ii]);
+      words[ii] |= owords[ii];
+    }
+  }
+}
+
+size_t Bitmap_MemUsage(const Bitmap *bm) {
+  return sizeof(*bm) + bm->numChunks * sizeof(*bm->chunks) + bm->numAllocated * CHUNK_SIZE;
+}
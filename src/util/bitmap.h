@@ -0,0 +1,81 @@
+#ifndef RS_BITMAP_H_
+#define RS_BITMAP_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Bitmap - a growable bitmap addressed by (document) id.
+// Bits are kept in fixed-size chunks, and a chunk is only allocated once a bit inside it is set.
+// A range of ids with no bits set therefore costs a single NULL pointer, and scans skip it
+// without touching memory.
+
+#define BITMAP_WORD_BITS 64
+#define BITMAP_CHUNK_WORDS 64
+#define BITMAP_CHUNK_BITS (BITMAP_WORD_BITS * BITMAP_CHUNK_WORDS)
+
+#define BITMAP_CHUNK_OF(id) ((id) / BITMAP_CHUNK_BITS)
+#define BITMAP_WORD_OF(id) (((id) % BITMAP_CHUNK_BITS) / BITMAP_WORD_BITS)
+#define BITMAP_BIT_OF(id) ((id) % BITMAP_WORD_BITS)
+
+typedef struct Bitmap {
+  // Chunk pointers. A NULL chunk has all of its bits cleared
+  uint64_t **chunks;
+  // Number of entries in `chunks`
+  uint32_t numChunks;
+  // Number of allocated (non NULL) chunks
+  uint32_t numAllocated;
+  // Number of bits set in the bitmap
+  size_t card;
+} Bitmap;
+
+/* Initialize an empty bitmap. No memory is allocated until a bit is set */
+void Bitmap_Init(Bitmap *bm);
+
+/* Free all the memory held by the bitmap. The bitmap is left empty and may be reused */
+void Bitmap_Cleanup(Bitmap *bm);
+
+/* Set the bit for id. Returns 1 if the bit was previously cleared, 0 otherwise */
+int Bitmap_Set(Bitmap *bm, uint64_t id);
+
+/* Clear the bit for id, releasing its chunk if it becomes empty. Returns 1 if the bit was
+ * previously set, 0 otherwise */
+int Bitmap_Clear(Bitmap *bm, uint64_t id);
+
+/* Return the first set bit which is greater or equal to `from`, skipping unallocated chunks and
+ * empty words. Returns 0 if there are no more set bits - bit 0 is never a valid document id */
+uint64_t Bitmap_Next(const Bitmap *bm, uint64_t from);
+
+/* Clear every bit in `bm` that is set in `other` */
+void Bitmap_AndNot(Bitmap *bm, const Bitmap *other);
+
+/* Clear every bit in `bm` that is not set in `other` */
+void Bitmap_And(Bitmap *bm, const Bitmap *other);
+
+/* Set every bit in `bm` that is set in `other` */
+void Bitmap_Or(Bitmap *bm, const Bitmap *other);
+
+/* Return the number of bytes used by the bitmap */
+size_t Bitmap_MemUsage(const Bitmap *bm);
+
+/* Get the words of a chunk, or NULL if the chunk has no bits set */
+static inline const uint64_t *Bitmap_GetChunk(const Bitmap *bm, size_t chunk) {
+  return chunk < bm->numChunks ? bm->chunks[chunk] : NULL;
+}
+
+/* Return 1 if the bit for id is set */
+static inline int Bitmap_Test(const Bitmap *bm, uint64_t id) {
+  const uint64_t *words = Bitmap_GetChunk(bm, BITMAP_CHUNK_OF(id));
+  return words && (words[BITMAP_WORD_OF(id)] >> BITMAP_BIT_OF(id)) & 1;
+}
+
+/* Number of bits set in the bitmap */
+#define Bitmap_Card(bm) ((bm)->card)
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -39,6 +39,20 @@ static inline void BlkAlloc_Init(BlkAlloc *alloc) {
  */
 void *BlkAlloc_Alloc(BlkAlloc *alloc, size_t elemSize, size_t blockSize);
 
+// The size of the blocks of an arena (see BlkAlloc_ArenaAlloc)
+#define BLKALLOC_ARENA_BLOCK_SIZE 4096
+
+/**
+ * Allocate size bytes aligned to 16 bytes, from blocks of BLKALLOC_ARENA_BLOCK_SIZE, or of the
+ * size of a larger allocation. This makes the allocator an arena of objects of any size, which
+ * are all released at once.
+ */
+static inline void *BlkAlloc_ArenaAlloc(BlkAlloc *alloc, size_t size) {
+  size = (size + 15) & ~(size_t)15;
+  return BlkAlloc_Alloc(alloc, size,
+                        size > BLKALLOC_ARENA_BLOCK_SIZE ? size : BLKALLOC_ARENA_BLOCK_SIZE);
+}
+
 typedef void (*BlkAllocCleaner)(void *ptr, void *arg);
 
 /**
@@ -0,0 +1,57 @@
+#include "histogram.h"
+#include <math.h>
+
+static inline size_t histBucket(uint64_t v) {
+  if (v < HIST_SUB_BUCKETS) {
+    return v;
+  }
+  if (v >> HIST_MAX_BITS) {
+    return HIST_NUM_BUCKETS - 1;
+  }
+  int shift = 63 - __builtin_clzll(v) - HIST_SUB_BUCKET_BITS;
+  return (shift + 1) * HIST_SUB_BUCKETS + ((v >> shift) & (HIST_SUB_BUCKETS - 1));
+}
+
+/* The highest value counted in a bucket */
+static inline uint64_t histBucketMax(size_t b) {
+  if (b < HIST_SUB_BUCKETS) {
+    return b;
+  }
+  int shift = b / HIST_SUB_BUCKETS - 1;
+  uint64_t low = (uint64_t)(HIST_SUB_BUCKETS + b % HIST_SUB_BUCKETS) << shift;
+  return low + ((uint64_t)1 << shift) - 1;
+}
+
+void Histogram_Record(Histogram *h, uint64_t v) {
+  __atomic_fetch_add(&h->buckets[histBucket(v)], 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&h->total, v, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&h->count, 1, __ATOMIC_RELAXED);
+
+  uint64_t max = __atomic_load_n(&h->max, __ATOMIC_RELAXED);
+  while (v > max &&
+         !__atomic_compare_exchange_n(&h->max, &max, v, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+}
+
+uint64_t Histogram_Percentile(const Histogram *h, double p) {
+  uint64_t count = __atomic_load_n(&h->count, __ATOMIC_RELAXED);
+  if (!count) {
+    return 0;
+  }
+  uint64_t max = __atomic_load_n(&h->max, __ATOMIC_RELAXED);
+  uint64_t rank = (uint64_t)ceil(p / 100 * count);
+  if (rank == 0) {
+    rank = 1;
+  }
+
+  uint64_t seen = 0;
+  for (size_t b = 0; b < HIST_NUM_BUCKETS; b++) {
+    seen += __atomic_load_n(&h->buckets[b], __ATOMIC_RELAXED);
+    if (seen >= rank) {
+      uint64_t v = histBucketMax(b);
+      return v < max && b < HIST_NUM_BUCKETS - 1 ? v : max;
+    }
+  }
+  // The count was bumped by a writer that has not reached the bucket yet
+  return max;
+}
@@ -0,0 +1,43 @@
+#ifndef RS_HISTOGRAM_H_
+#define RS_HISTOGRAM_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Histogram - a log-linear histogram of latencies, laid out like an HdrHistogram.
+// Values below HIST_SUB_BUCKETS get a bucket each. Above that, every power of two range is split
+// into HIST_SUB_BUCKETS buckets of equal width, so the value reported for a percentile is within
+// 1/HIST_SUB_BUCKETS of the recorded ones. Values of HIST_MAX_BITS bits and up share the last
+// bucket.
+//
+// Recording never takes a lock: the counters are updated with relaxed atomic additions, so
+// concurrent writers never lose a value, and a reader may see a histogram in the middle of an
+// update.
+
+#define HIST_SUB_BUCKET_BITS 3
+#define HIST_SUB_BUCKETS (1 << HIST_SUB_BUCKET_BITS)
+#define HIST_MAX_BITS 36
+#define HIST_NUM_BUCKETS ((HIST_MAX_BITS - HIST_SUB_BUCKET_BITS + 1) * HIST_SUB_BUCKETS)
+
+typedef struct {
+  uint64_t count;
+  uint64_t total;
+  uint64_t max;
+  uint64_t buckets[HIST_NUM_BUCKETS];
+} Histogram;
+
+/* Record a value */
+void Histogram_Record(Histogram *h, uint64_t v);
+
+/* Get the value at percentile p (0-100): the highest value of the bucket holding it, capped by the
+ * largest recorded value. Returns 0 for an empty histogram */
+uint64_t Histogram_Percentile(const Histogram *h, double p);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,116 @@
+#include "timer_wheel.h"
+#include <string.h>
+
+#define LEVEL_SHIFT(level) ((level)*TIMERWHEEL_LEVEL_BITS)
+#define SLOT_MASK (TIMERWHEEL_SLOTS - 1)
+#define WHEEL_SPAN (1ULL << LEVEL_SHIFT(TIMERWHEEL_LEVELS))
+
+void TimerWheel_Init(TimerWheel *w, uint64_t now) {
+  for (size_t level = 0; level < TIMERWHEEL_LEVELS; level++) {
+    for (size_t idx = 0; idx < TIMERWHEEL_SLOTS; idx++) {
+      dllist_init(&w->slots[level][idx]);
+    }
+  }
+  memset(w->occupied, 0, sizeof(w->occupied));
+  w->tick = now;
+  w->count = 0;
+}
+
+/* Put the timer in the slot of its expiry, relative to the current tick. Timers expiring before
+ * tick `first` are put in its slot */
+static void place(TimerWheel *w, TimerWheelNode *n, uint64_t first) {
+  uint64_t key = n->expiry;
+  if (key < first) {
+    key = first;
+  } else if (key - w->tick >= WHEEL_SPAN) {
+    key = w->tick + WHEEL_SPAN - 1;
+  }
+
+  uint64_t delta = key - w->tick;
+  size_t level = 0;
+  while (level < TIMERWHEEL_LEVELS - 1 && delta >> LEVEL_SHIFT(level + 1)) {
+    level++;
+  }
+  size_t idx = (key >> LEVEL_SHIFT(level)) & SLOT_MASK;
+  dllist_append(&w->slots[level][idx], &n->llnode);
+  w->occupied[level] |= 1ULL << idx;
+  n->slot = level * TIMERWHEEL_SLOTS + idx;
+}
+
+void TimerWheel_Add(TimerWheel *w, TimerWheelNode *n, uint64_t expiry) {
+  n->expiry = expiry;
+  place(w, n, w->tick + 1);
+  w->count++;
+}
+
+void TimerWheel_Remove(TimerWheel *w, TimerWheelNode *n) {
+  size_t level = n->slot / TIMERWHEEL_SLOTS, idx = n->slot % TIMERWHEEL_SLOTS;
+  dllist_delete(&n->llnode);
+  if (DLLIST_IS_EMPTY(&w->slots[level][idx])) {
+    w->occupied[level] &= ~(1ULL << idx);
+  }
+  w->count--;
+}
+
+/* The first tick after the current one which starts an occupied slot of the level, or UINT64_MAX
+ * if the level is empty */
+static uint64_t nextSlotStart(const TimerWheel *w, size_t level) {
+  uint64_t occupied = w->occupied[level];
+  if (!occupied) {
+    return UINT64_MAX;
+  }
+  // slots are numbered by the ticks they start at, shifted by the width of the level's slots
+  uint64_t first = (w->tick >> LEVEL_SHIFT(level)) + 1;
+  size_t pos = first & SLOT_MASK;
+  uint64_t ahead = occupied >> pos;
+  uint64_t skip =
+      ahead ? __builtin_ctzll(ahead) : TIMERWHEEL_SLOTS - pos + __builtin_ctzll(occupied);
+  return (first + skip) << LEVEL_SHIFT(level);
+}
+
+/* Move the timers of a slot starting at the current tick down the wheel. The ones expiring at this
+ * tick go to the first level, to expire right away; none of them goes back to the same slot */
+static void cascade(TimerWheel *w, size_t level, size_t idx) {
+  DLLIST *slot = &w->slots[level][idx];
+  w->occupied[level] &= ~(1ULL << idx);
+  while (!(DLLIST_IS_EMPTY(slot))) {
+    TimerWheelNode *n = DLLIST_ITEM(slot->next, TimerWheelNode, llnode);
+    dllist_delete(&n->llnode);
+    place(w, n, w->tick);
+  }
+}
+
+size_t TimerWheel_Advance(TimerWheel *w, uint64_t now, DLLIST *expired) {
+  size_t numExpired = 0;
+  while (w->tick < now) {
+    // jump straight to the next tick with anything to do
+    uint64_t next = UINT64_MAX;
+    for (size_t level = 0; level < TIMERWHEEL_LEVELS; level++) {
+      uint64_t start = nextSlotStart(w, level);
+      next = start < next ? start : next;
+    }
+    if (next > now) {
+      w->tick = now;
+      break;
+    }
+    w->tick = next;
+
+    for (size_t level = TIMERWHEEL_LEVELS - 1; level > 0; level--) {
+      if (!(next & ((1ULL << LEVEL_SHIFT(level)) - 1))) {
+        cascade(w, level, (next >> LEVEL_SHIFT(level)) & SLOT_MASK);
+      }
+    }
+
+    size_t idx = next & SLOT_MASK;
+    DLLIST *slot = &w->slots[0][idx];
+    while (!(DLLIST_IS_EMPTY(slot))) {
+      DLLIST_node *it = slot->next;
+      dllist_delete(it);
+      dllist_append(expired, it);
+      numExpired++;
+    }
+    w->occupied[0] &= ~(1ULL << idx);
+  }
+  w->count -= numExpired;
+  return numExpired;
+}
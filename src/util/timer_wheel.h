@@ -0,0 +1,66 @@
+#ifndef RS_TIMER_WHEEL_H_
+#define RS_TIMER_WHEEL_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "dllist.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// TimerWheel - a hierarchical timing wheel.
+// Timers are kept in slots by the tick they expire at: the first level has a slot for each of the
+// next 64 ticks, and the slots of every further level are 64 times as wide as the ones below. When
+// the wheel reaches the start of a slot, its timers move down to the level below, until they reach
+// the first level and expire. Advancing the wheel thus costs in proportion to the timers which
+// expire and the occupied slots it passes, and not to the number of timers in the wheel.
+//
+// Timers further away than the span of the wheel (64^4 ticks) are kept in its last slot, and moved
+// again when the wheel reaches it. The wheel is not thread safe.
+
+#define TIMERWHEEL_LEVEL_BITS 6
+#define TIMERWHEEL_SLOTS (1 << TIMERWHEEL_LEVEL_BITS)
+#define TIMERWHEEL_LEVELS 4
+
+typedef struct {
+  DLLIST_node llnode;
+  // The tick the timer expires at
+  uint64_t expiry;
+  // The slot the timer is in, as level * TIMERWHEEL_SLOTS + index
+  uint16_t slot;
+} TimerWheelNode;
+
+typedef struct {
+  DLLIST slots[TIMERWHEEL_LEVELS][TIMERWHEEL_SLOTS];
+  // Bitmaps of the non-empty slots of every level
+  uint64_t occupied[TIMERWHEEL_LEVELS];
+  // The last tick the wheel was advanced to
+  uint64_t tick;
+  // The number of timers in the wheel
+  size_t count;
+} TimerWheel;
+
+/* Initialize an empty wheel, starting at tick `now` */
+void TimerWheel_Init(TimerWheel *w, uint64_t now);
+
+/* Add a timer expiring at tick `expiry`. A timer which expired already expires on the next tick */
+void TimerWheel_Add(TimerWheel *w, TimerWheelNode *n, uint64_t expiry);
+
+/* Remove a timer which did not expire yet */
+void TimerWheel_Remove(TimerWheel *w, TimerWheelNode *n);
+
+/* Whether the node is linked: a timer of a wheel, or an expired one not taken off its list yet.
+ * Nodes must be zeroed before they are first added */
+static inline int TimerWheel_IsQueued(const TimerWheelNode *n) {
+  return n->llnode.next != NULL;
+}
+
+/* Advance the wheel to tick `now`, and move the timers expiring by then to the `expired` list.
+ * Returns the number of expired timers */
+size_t TimerWheel_Advance(TimerWheel *w, uint64_t now, DLLIST *expired);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
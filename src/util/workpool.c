@@ -0,0 +1,186 @@
+#include "workpool.h"
+#include <pthread.h>
+#include <string.h>
+#include "rmalloc.h"
+
+typedef struct {
+  WorkPool_Func func;
+  void *arg;
+} workTask;
+
+typedef struct {
+  pthread_mutex_t lock;
+  // A ring of tasks
+  workTask *tasks;
+  size_t cap;
+  size_t head;
+  size_t len;
+  uint64_t done;
+  uint64_t stolen;
+  pthread_t thr;
+  WorkPool *pool;
+} workQueue;
+
+struct WorkPool {
+  workQueue *queues;
+  size_t numThreads;
+  // The queue the next task added from outside the pool goes to
+  size_t next;
+  // The number of queued tasks. It may briefly drop below zero, when a task is taken before its
+  // addition is counted
+  long pending;
+  // Threads with nothing to do wait for tasks on the condition
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  size_t idle;
+  int stop;
+};
+
+// The queue of the running pool thread
+static __thread workQueue *currentQueue_g = NULL;
+
+static void queuePush(workQueue *q, workTask t) {
+  pthread_mutex_lock(&q->lock);
+  if (q->len == q->cap) {
+    size_t cap = q->cap ? q->cap * 2 : 16;
+    workTask *tasks = rm_malloc(cap * sizeof(*tasks));
+    for (size_t i = 0; i < q->len; i++) {
+      tasks[i] = q->tasks[(q->head + i) % q->cap];
+    }
+    rm_free(q->tasks);
+    q->tasks = tasks;
+    q->cap = cap;
+    q->head = 0;
+  }
+  q->tasks[(q->head + q->len++) % q->cap] = t;
+  pthread_mutex_unlock(&q->lock);
+}
+
+/* Take the first task of the queue, or the last one when stealing it. Returns 0 if the queue is
+ * empty */
+static int queueTake(workQueue *q, workTask *t, int steal) {
+  pthread_mutex_lock(&q->lock);
+  if (!q->len) {
+    pthread_mutex_unlock(&q->lock);
+    return 0;
+  }
+  if (steal) {
+    *t = q->tasks[(q->head + q->len - 1) % q->cap];
+  } else {
+    *t = q->tasks[q->head];
+    q->head = (q->head + 1) % q->cap;
+  }
+  q->len--;
+  pthread_mutex_unlock(&q->lock);
+  return 1;
+}
+
+static int takeTask(workQueue *self, workTask *t) {
+  WorkPool *p = self->pool;
+  if (queueTake(self, t, 0)) {
+    return 1;
+  }
+  size_t id = self - p->queues;
+  for (size_t i = 1; i < p->numThreads; i++) {
+    if (queueTake(&p->queues[(id + i) % p->numThreads], t, 1)) {
+      __atomic_add_fetch(&self->stolen, 1, __ATOMIC_RELAXED);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static void *workerMain(void *arg) {
+  workQueue *self = arg;
+  WorkPool *p = self->pool;
+  currentQueue_g = self;
+
+  for (;;) {
+    workTask t;
+    if (takeTask(self, &t)) {
+      __atomic_sub_fetch(&p->pending, 1, __ATOMIC_ACQ_REL);
+      t.func(t.arg);
+      __atomic_add_fetch(&self->done, 1, __ATOMIC_RELAXED);
+      continue;
+    }
+
+    pthread_mutex_lock(&p->lock);
+    while (__atomic_load_n(&p->pending, __ATOMIC_ACQUIRE) <= 0 && !p->stop) {
+      p->idle++;
+      pthread_cond_wait(&p->cond, &p->lock);
+      p->idle--;
+    }
+    int done = p->stop && __atomic_load_n(&p->pending, __ATOMIC_ACQUIRE) <= 0;
+    pthread_mutex_unlock(&p->lock);
+    if (done) {
+      break;
+    }
+  }
+  return NULL;
+}
+
+WorkPool *NewWorkPool(size_t numThreads) {
+  WorkPool *p = rm_calloc(1, sizeof(*p));
+  p->numThreads = numThreads ? numThreads : 1;
+  p->queues = rm_calloc(p->numThreads, sizeof(*p->queues));
+  pthread_mutex_init(&p->lock, NULL);
+  pthread_cond_init(&p->cond, NULL);
+  for (size_t i = 0; i < p->numThreads; i++) {
+    p->queues[i].pool = p;
+    pthread_mutex_init(&p->queues[i].lock, NULL);
+  }
+  for (size_t i = 0; i < p->numThreads; i++) {
+    pthread_create(&p->queues[i].thr, NULL, workerMain, &p->queues[i]);
+  }
+  return p;
+}
+
+void WorkPool_Add(WorkPool *p, WorkPool_Func func, void *arg) {
+  workQueue *q = currentQueue_g;
+  if (!q || q->pool != p) {
+    q = &p->queues[__atomic_fetch_add(&p->next, 1, __ATOMIC_RELAXED) % p->numThreads];
+  }
+  queuePush(q, (workTask){.func = func, .arg = arg});
+  __atomic_add_fetch(&p->pending, 1, __ATOMIC_ACQ_REL);
+
+  // the count of pending tasks is checked under the lock before waiting, so no wakeup is lost
+  pthread_mutex_lock(&p->lock);
+  if (p->idle) {
+    pthread_cond_signal(&p->cond);
+  }
+  pthread_mutex_unlock(&p->lock);
+}
+
+void WorkPool_GetStats(WorkPool *p, WorkPoolStats *stats) {
+  memset(stats, 0, sizeof(*stats));
+  stats->numThreads = p->numThreads;
+  for (size_t i = 0; i < p->numThreads; i++) {
+    workQueue *q = &p->queues[i];
+    pthread_mutex_lock(&q->lock);
+    size_t len = q->len;
+    pthread_mutex_unlock(&q->lock);
+    stats->queued += len;
+    stats->maxQueued = len > stats->maxQueued ? len : stats->maxQueued;
+    stats->done += __atomic_load_n(&q->done, __ATOMIC_RELAXED);
+    stats->stolen += __atomic_load_n(&q->stolen, __ATOMIC_RELAXED);
+  }
+}
+
+void WorkPool_Free(WorkPool *p) {
+  pthread_mutex_lock(&p->lock);
+  p->stop = 1;
+  pthread_cond_broadcast(&p->cond);
+  pthread_mutex_unlock(&p->lock);
+
+  for (size_t i = 0; i < p->numThreads; i++) {
+    pthread_join(p->queues[i].thr, NULL);
+  }
+  for (size_t i = 0; i < p->numThreads; i++) {
+    pthread_mutex_destroy(&p->queues[i].lock);
+    rm_free(p->queues[i].tasks);
+  }
+  pthread_mutex_destroy(&p->lock);
+  pthread_cond_destroy(&p->cond);
+  rm_free(p->queues);
+  rm_free(p);
+}
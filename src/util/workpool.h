@@ -0,0 +1,50 @@
+#ifndef RS_WORKPOOL_H_
+#define RS_WORKPOOL_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// WorkPool - a work stealing thread pool.
+// Every thread has its own queue of tasks. A task added by a thread of the pool goes to the back of
+// that thread's queue, so work which schedules more work stays on a warm cache; a task added from
+// outside the pool goes to the queues in turn. A thread runs the tasks of its queue in order, and
+// when it runs out, steals from the back of the other queues before going to sleep.
+//
+// Tasks run in no particular order with respect to each other: a task which must not run
+// concurrently with another has to be serialized by its owner (e.g. by scheduling itself again).
+
+typedef void (*WorkPool_Func)(void *arg);
+
+typedef struct WorkPool WorkPool;
+
+typedef struct {
+  size_t numThreads;
+  // Tasks waiting in the queues
+  size_t queued;
+  // The longest queue
+  size_t maxQueued;
+  // Tasks run, and the ones of them taken from the queue of another thread
+  uint64_t done;
+  uint64_t stolen;
+} WorkPoolStats;
+
+/* Create a pool of numThreads threads, and start them */
+WorkPool *NewWorkPool(size_t numThreads);
+
+/* Queue a call of func(arg) */
+void WorkPool_Add(WorkPool *p, WorkPool_Func func, void *arg);
+
+void WorkPool_GetStats(WorkPool *p, WorkPoolStats *stats);
+
+/* Run all the queued tasks, including the ones they add, then stop the threads and free the pool.
+ * Must not be called from a thread of the pool */
+void WorkPool_Free(WorkPool *p);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
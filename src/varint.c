@@ -109,6 +109,15 @@ size_t VVW_Write(VarintVectorWriter *w, uint32_t i) {
   return n;
 }
 
+void VVW_Append(VarintVectorWriter *w, VarintVectorWriter *src, uint32_t delta) {
+  BufferReader br = {.buf = &src->buf, .pos = 0};
+  uint32_t cur = 0;
+  for (size_t ii = 0; ii < src->nmemb; ++ii) {
+    cur += ReadVarint(&br);
+    VVW_Write(w, cur + delta);
+  }
+}
+
 // Truncate the vector
 size_t VVW_Truncate(VarintVectorWriter *w) {
   return Buffer_Truncate(&w->buf, 0);
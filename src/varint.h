@@ -55,6 +55,8 @@ typedef struct {
 VarintVectorWriter *NewVarintVectorWriter(size_t cap);
 size_t VVW_Write(VarintVectorWriter *w, uint32_t i);
 size_t VVW_Truncate(VarintVectorWriter *w);
+/* Write the members of src to w, each increased by delta */
+void VVW_Append(VarintVectorWriter *w, VarintVectorWriter *src, uint32_t delta);
 void VVW_Free(VarintVectorWriter *w);
 void VVW_Init(VarintVectorWriter *w, size_t cap);
 
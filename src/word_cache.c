@@ -0,0 +1,164 @@
+#include <pthread.h>
+#include <string.h>
+#include "word_cache.h"
+#include "config.h"
+#include "rmalloc.h"
+#include "util/fnv.h"
+
+// The number of locks guarding the slots of a cache
+#define WORDCACHE_NUM_LOCKS 64
+
+typedef struct {
+  uint32_t hash;
+  // A length of 0 marks an empty slot
+  uint8_t wordLen;
+  uint8_t valueLen;
+  char word[WORDCACHE_MAX_LEN];
+  char value[WORDCACHE_MAX_LEN];
+} wordCacheSlot;
+
+struct WordCache {
+  wordCacheSlot *slots;
+  size_t mask;
+  uint64_t hits;
+  uint64_t misses;
+  size_t entries;
+  pthread_mutex_t locks[WORDCACHE_NUM_LOCKS];
+};
+
+static const char *kindNames[WORDCACHE_NUM_KINDS] = {
+    [WORDCACHE_STEMS] = "stems",
+    [WORDCACHE_PHONETICS] = "phonetics",
+};
+
+static WordCache *caches_g[WORDCACHE_NUM_KINDS][RS_LANG_UNSUPPORTED];
+
+static WordCache *newCache(size_t size) {
+  size_t cap = 1;
+  while (cap < size) {
+    cap <<= 1;
+  }
+  WordCache *c = rm_calloc(1, sizeof(*c));
+  c->slots = rm_calloc(cap, sizeof(*c->slots));
+  c->mask = cap - 1;
+  for (size_t i = 0; i < WORDCACHE_NUM_LOCKS; i++) {
+    pthread_mutex_init(&c->locks[i], NULL);
+  }
+  return c;
+}
+
+static void freeCache(WordCache *c) {
+  for (size_t i = 0; i < WORDCACHE_NUM_LOCKS; i++) {
+    pthread_mutex_destroy(&c->locks[i]);
+  }
+  rm_free(c->slots);
+  rm_free(c);
+}
+
+WordCache *WordCache_Get(WordCacheKind kind, RSLanguage language) {
+  if (kind == WORDCACHE_PHONETICS || language >= RS_LANG_UNSUPPORTED) {
+    language = RS_LANG_ENGLISH;
+  }
+  WordCache **cp = &caches_g[kind][language];
+  WordCache *c = __atomic_load_n(cp, __ATOMIC_ACQUIRE);
+  if (c || !RSGlobalConfig.wordCacheSize) {
+    return c;
+  }
+  // Another thread may allocate it at the same time, in which case we use its cache
+  WordCache *newc = newCache(RSGlobalConfig.wordCacheSize);
+  if (__atomic_compare_exchange_n(cp, &c, newc, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+    return newc;
+  }
+  freeCache(newc);
+  return c;
+}
+
+static inline uint32_t hashWord(const char *word, size_t len) {
+  return rs_fnv_32a_buf(word, len, 0);
+}
+
+int WordCache_Lookup(WordCache *c, const char *word, size_t len, char *buf) {
+  int ret = -1;
+  // long words count as misses, since they are never cached
+  if (len < WORDCACHE_MAX_LEN) {
+    uint32_t hash = hashWord(word, len);
+    size_t pos = hash & c->mask;
+    wordCacheSlot *slot = &c->slots[pos];
+
+    pthread_mutex_lock(&c->locks[pos % WORDCACHE_NUM_LOCKS]);
+    if (slot->hash == hash && slot->wordLen == len && !memcmp(slot->word, word, len)) {
+      ret = slot->valueLen;
+      memcpy(buf, slot->value, ret);
+      buf[ret] = '\0';
+    }
+    pthread_mutex_unlock(&c->locks[pos % WORDCACHE_NUM_LOCKS]);
+  }
+
+  __atomic_fetch_add(ret < 0 ? &c->misses : &c->hits, 1, __ATOMIC_RELAXED);
+  return ret;
+}
+
+void WordCache_Put(WordCache *c, const char *word, size_t len, const char *value, size_t vlen) {
+  if (!len || len >= WORDCACHE_MAX_LEN || vlen >= WORDCACHE_MAX_LEN) {
+    return;
+  }
+  uint32_t hash = hashWord(word, len);
+  size_t pos = hash & c->mask;
+  wordCacheSlot *slot = &c->slots[pos];
+
+  pthread_mutex_lock(&c->locks[pos % WORDCACHE_NUM_LOCKS]);
+  if (!slot->wordLen) {
+    __atomic_fetch_add(&c->entries, 1, __ATOMIC_RELAXED);
+  }
+  slot->hash = hash;
+  slot->wordLen = len;
+  slot->valueLen = vlen;
+  memcpy(slot->word, word, len);
+  memcpy(slot->value, value, vlen);
+  pthread_mutex_unlock(&c->locks[pos % WORDCACHE_NUM_LOCKS]);
+}
+
+void WordCache_GetStats(WordCacheKind kind, WordCacheStats *stats) {
+  memset(stats, 0, sizeof(*stats));
+  for (size_t i = 0; i < RS_LANG_UNSUPPORTED; i++) {
+    WordCache *c = __atomic_load_n(&caches_g[kind][i], __ATOMIC_ACQUIRE);
+    if (c) {
+      stats->hits += __atomic_load_n(&c->hits, __ATOMIC_RELAXED);
+      stats->misses += __atomic_load_n(&c->misses, __ATOMIC_RELAXED);
+      stats->entries += __atomic_load_n(&c->entries, __ATOMIC_RELAXED);
+      stats->capacity += c->mask + 1;
+    }
+  }
+}
+
+void WordCache_ReplyStats(RedisModuleCtx *ctx) {
+  RedisModule_ReplyWithArray(ctx, 2 * WORDCACHE_NUM_KINDS);
+  for (size_t i = 0; i < WORDCACHE_NUM_KINDS; i++) {
+    WordCacheStats st;
+    WordCache_GetStats(i, &st);
+    uint64_t lookups = st.hits + st.misses;
+    RedisModule_ReplyWithSimpleString(ctx, kindNames[i]);
+    RedisModule_ReplyWithArray(ctx, 10);
+    RedisModule_ReplyWithSimpleString(ctx, "hits");
+    RedisModule_ReplyWithLongLong(ctx, st.hits);
+    RedisModule_ReplyWithSimpleString(ctx, "misses");
+    RedisModule_ReplyWithLongLong(ctx, st.misses);
+    RedisModule_ReplyWithSimpleString(ctx, "hit_ratio");
+    RedisModule_ReplyWithDouble(ctx, lookups ? (double)st.hits / lookups : 0);
+    RedisModule_ReplyWithSimpleString(ctx, "entries");
+    RedisModule_ReplyWithLongLong(ctx, st.entries);
+    RedisModule_ReplyWithSimpleString(ctx, "capacity");
+    RedisModule_ReplyWithLongLong(ctx, st.capacity);
+  }
+}
+
+void WordCache_FreeAll(void) {
+  for (size_t i = 0; i < WORDCACHE_NUM_KINDS; i++) {
+    for (size_t j = 0; j < RS_LANG_UNSUPPORTED; j++) {
+      if (caches_g[i][j]) {
+        freeCache(caches_g[i][j]);
+        caches_g[i][j] = NULL;
+      }
+    }
+  }
+}
@@ -0,0 +1,66 @@
+#ifndef RS_WORD_CACHE_H_
+#define RS_WORD_CACHE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "redismodule.h"
+#include "stemmer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Memoization caches of the stems and the phonetic codes of words.
+ *
+ * Word frequencies are Zipfian, so a few thousand words make up most of the tokens of a text, and
+ * stemming or encoding each of them once saves most of the work of the tokenizer and the query
+ * expanders. There is a cache of stems per language, and a cache of phonetic codes per algorithm
+ * (only double metaphone for now). They are shared by indexing and queries.
+ *
+ * A cache is a direct mapped table of WORD_CACHE_SIZE slots: a word may only be stored in the slot
+ * its hash points to, replacing the word stored there. The slots are guarded by a set of locks, so
+ * threads rarely wait for each other. Words and values of WORDCACHE_MAX_LEN bytes and up are not
+ * cached. */
+
+#define WORDCACHE_MAX_LEN 32
+
+typedef enum {
+  WORDCACHE_STEMS,
+  WORDCACHE_PHONETICS,
+  WORDCACHE_NUM_KINDS
+} WordCacheKind;
+
+typedef struct WordCache WordCache;
+
+typedef struct {
+  uint64_t hits;
+  uint64_t misses;
+  size_t entries;
+  size_t capacity;
+} WordCacheStats;
+
+/* Get the cache of the stems of a language, or of the phonetic codes of words (for which the
+ * language is ignored). The caches are allocated on first use. Returns NULL if caching is
+ * disabled */
+WordCache *WordCache_Get(WordCacheKind kind, RSLanguage language);
+
+/* Look a word up. If it is cached, copy its value to buf, which must hold WORDCACHE_MAX_LEN bytes,
+ * and return the value's length. Returns -1 if the word is not cached */
+int WordCache_Lookup(WordCache *c, const char *word, size_t len, char *buf);
+
+/* Cache the value of a word, if both are short enough */
+void WordCache_Put(WordCache *c, const char *word, size_t len, const char *value, size_t vlen);
+
+/* Sum the stats of the caches of a kind */
+void WordCache_GetStats(WordCacheKind kind, WordCacheStats *stats);
+
+/* Reply with the stats of all the caches, for FT.INFO */
+void WordCache_ReplyStats(RedisModuleCtx *ctx);
+
+/* Free all the caches */
+void WordCache_FreeAll(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif  // RS_WORD_CACHE_H_